@@ -0,0 +1,109 @@
+/*
+ * c2c: latencia de traspaso de una linea de cache entre cada par de CPU (ver cpuid_c2c.h).
+ *
+ *      c2c [-c LISTA] [-s | -p PARES] [-n IDAS]
+ *
+ * LISTA sustituye al mask de afinidad ("0-15,32-47"), -s mide los pares de uno en uno, -p
+ * limita cuantos pares se miden a la vez y -n son las idas y vueltas por muestra. Muestra la
+ * matriz en nanosegundos, la relacion de cada par segun la topologia (S hilos del mismo
+ * nucleo, 2 misma L2, 3 misma L3, P mismo paquete, R otro paquete) y un resumen por relacion.
+ */
+
+// cpuid_percpu.h necesita _GNU_SOURCE en Linux antes de cualquier include del sistema
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
+#include "cpuid_c2c.h"
+#include "cpuid_watch.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static const char c2c_letters[CPUID_C2C_RELATIONS] = { '-', 'S', '2', '3', 'P', 'R', '?' };
+
+int main(int argc, char **argv) {
+    static CPUID_H(cpumask) list;
+    static uint32_t         cpus[CPUID_CPUMASK_MAX_CPUS];
+    CPUID_H(c2c)            c2c;
+    size_t                  n_cpus      = 0;
+    int                     has_list    = 0;
+    unsigned                max_pairs   = 0;
+    unsigned                round_trips = 0;
+
+    for (int arg = 1; arg < argc; arg++) {
+        if (strcmp(argv[arg], "-c") == 0 && arg + 1 < argc) {
+            if (cpuid_cpumask_parse(argv[++arg], &list) != 0) goto usage;
+            n_cpus   = cpuid_cpumask_list(&list, cpus, CPUID_CPUMASK_MAX_CPUS);
+            has_list = 1;
+        } else if (strcmp(argv[arg], "-s") == 0) {
+            max_pairs = 1;
+        } else if (strcmp(argv[arg], "-p") == 0 && arg + 1 < argc) {
+            max_pairs = (unsigned)strtoul(argv[++arg], NULL, 10);
+        } else if (strcmp(argv[arg], "-n") == 0 && arg + 1 < argc) {
+            round_trips = (unsigned)strtoul(argv[++arg], NULL, 10);
+        } else {
+            goto usage;
+        }
+    }
+
+    clock_t begin    = clock();
+    time_t  start    = time(NULL);
+    int     measured = cpuid_c2c_measure(&c2c, has_list ? cpus : NULL, n_cpus, NULL, max_pairs, round_trips);
+    if (measured < 0) {
+        fprintf(stderr, "no se pudo medir (sin memoria o sin hilos)\n");
+        return 1;
+    }
+    uint32_t n = c2c.n_cpus;
+
+    printf("latencia (ns):\n%5s", "");
+    for (uint32_t j = 0; j < n; j++) printf(" %5u", (unsigned)c2c.cpus[j]);
+    printf("\n");
+    for (uint32_t i = 0; i < n; i++) {
+        printf("%5u", (unsigned)c2c.cpus[i]);
+        for (uint32_t j = 0; j < n; j++) {
+            double ns = cpuid_c2c_latency(&c2c, i, j);
+            if (i == j)      printf(" %5s", "-");
+            else if (ns < 0) printf(" %5s", "?");
+            else             printf(" %5.0f", ns);
+        }
+        printf("\n");
+    }
+
+    printf("\nrelacion:\n%5s", "");
+    for (uint32_t j = 0; j < n; j++) printf(" %5u", (unsigned)c2c.cpus[j]);
+    printf("\n");
+    for (uint32_t i = 0; i < n; i++) {
+        printf("%5u", (unsigned)c2c.cpus[i]);
+        for (uint32_t j = 0; j < n; j++) printf(" %5c", c2c_letters[cpuid_c2c_relation_at(&c2c, i, j)]);
+        printf("\n");
+    }
+
+    printf("\n%-8s %6s %8s %8s %8s\n", "relacion", "pares", "min", "media", "max");
+    for (int r = CPUID_C2C_SMT; r < CPUID_C2C_RELATIONS; r++) {
+        double   min = 0, max = 0, sum = 0;
+        unsigned count = 0;
+        for (uint32_t i = 0; i < n; i++) {
+            for (uint32_t j = i + 1; j < n; j++) {
+                double ns = cpuid_c2c_latency(&c2c, i, j);
+                if ((int)cpuid_c2c_relation_at(&c2c, i, j) != r || ns < 0) continue;
+                if (count == 0 || ns < min) min = ns;
+                if (count == 0 || ns > max) max = ns;
+                sum += ns;
+                count++;
+            }
+        }
+        if (count != 0) printf("%-8s %6u %8.1f %8.1f %8.1f\n",
+            cpuid_c2c_relation_name((CPUID_H(c2c_relation))r), count, min, sum / count, max);
+    }
+    printf("\n%d pares medidos en %.0f s (%.2f s de CPU)\n", measured, difftime(time(NULL), start),
+        (double)(clock() - begin) / CLOCKS_PER_SEC);
+    cpuid_c2c_free(&c2c);
+    return 0;
+
+usage:
+    fprintf(stderr, "uso: %s [-c LISTA] [-s | -p PARES] [-n IDAS]\n", argv[0]);
+    return 2;
+}
@@ -6,6 +6,9 @@
 #endif
 
 #include "cpuid.h"
+#ifdef _MSC_VER
+#include <intrin.h>     // __cpuidex, _xgetbv
+#endif
 #ifndef M_RDTSC_ASM
 #ifdef _MSC_VER
 #define M_RDTSC_ASM(var1, var2) { \ // Código de ensamblador para MSVC(visual estudio)
@@ -227,19 +230,79 @@ static inline uint8_t get_flags_bit(uint8_t bit) {
     return (get_flags() >> bit) & 1; 
 }
 
+/*
+ * Tabla de byte a sus 8 bits en texto ('0'/'1', bit 7 primero), generada en compilacion.
+ * Cada byte se convierte con una copia de 8 bytes en lugar de 8 llamadas a printf.
+ */
+#define CPUID_BITS_ROW(b) { \
+    '0' + (((b) >> 7) & 1), '0' + (((b) >> 6) & 1), '0' + (((b) >> 5) & 1), '0' + (((b) >> 4) & 1), \
+    '0' + (((b) >> 3) & 1), '0' + (((b) >> 2) & 1), '0' + (((b) >> 1) & 1), '0' + ((b) & 1) }
+#define CPUID_BITS_4(b)   CPUID_BITS_ROW(b), CPUID_BITS_ROW((b) + 1), CPUID_BITS_ROW((b) + 2), CPUID_BITS_ROW((b) + 3)
+#define CPUID_BITS_16(b)  CPUID_BITS_4(b),   CPUID_BITS_4((b) + 4),   CPUID_BITS_4((b) + 8),   CPUID_BITS_4((b) + 12)
+#define CPUID_BITS_64(b)  CPUID_BITS_16(b),  CPUID_BITS_16((b) + 16), CPUID_BITS_16((b) + 32), CPUID_BITS_16((b) + 48)
+static const char cpuid_bits_table[256][8] = {
+    CPUID_BITS_64(0), CPUID_BITS_64(64), CPUID_BITS_64(128), CPUID_BITS_64(192)
+};
+#undef CPUID_BITS_64
+#undef CPUID_BITS_16
+#undef CPUID_BITS_4
+#undef CPUID_BITS_ROW
+
+char *cpuid_bits_expand(char *out, void const * const ptr, size_t const size) {
+    unsigned char const *b = (unsigned char const *) ptr;
+    for (size_t i = size; i-- > 0; ) {
+        memcpy(out, cpuid_bits_table[b[i]], 8);
+        out += 8;
+    }
+    return out;
+}
+
+void cpuid_render_bits(CPUID_H(sink) *sink, size_t const size, void const * const ptr) {
+    unsigned char const *b = (unsigned char const *) ptr;
+    char text[16 * 8];
+
+    // de 16 en 16 bytes, empezando por los mas significativos
+    for (size_t end = size; end > 0; ) {
+        size_t chunk = end < 16 ? end : 16;
+        end -= chunk;
+        cpuid_bits_expand(text, b + end, chunk);
+        cpuid_sink_write(sink, text, chunk * 8);
+    }
+}
+
+/*
+ * Salida de los print*: el texto que generan los cpuid_render_* pasa por printf (printf_color,
+ * o nada con DISABLE_FUNCS_EXTERNS) en trozos de hasta 256 bytes terminados en '\0'. Con el
+ * buffer intermedio de los print* cada volcado de 2048 bytes son como mucho 8 llamadas.
+ */
+static size_t cpuid_print_callback(void *context, const char *data, size_t len) {
+    char chunk[257];
+    (void)context;
+    for (size_t done = 0; done < len; ) {
+        size_t n = len - done < sizeof(chunk) - 1 ? len - done : sizeof(chunk) - 1;
+        memcpy(chunk, data + done, n);
+        chunk[n] = '\0';
+        printf("%s", chunk);
+        done += n;
+    }
+    return len;
+}
+
+// los print* acumulan todo el texto aqui y lo pasan a printf de una vez
+#define CPUID_PRINT_STAGING 2048
+
+static inline void cpuid_print_sink(CPUID_H(sink) *sink, char *staging, size_t capacity) {
+    cpuid_sink_callback(sink, cpuid_print_callback, NULL, staging, capacity);
+}
+
 void printBits(size_t const size, void const * const ptr)
 {
-    unsigned char *b = (unsigned char*) ptr;
-    unsigned char byte;
-    int i, j;
-    
-    for (i = size-1; i >= 0; i--) {
-        for (j = 7; j >= 0; j--) {
-            byte = (b[i] >> j) & 1;
-            printf("%u", byte);
-        }
-    }
-    puts("");
+    char staging[CPUID_PRINT_STAGING];
+    CPUID_H(sink) sink;
+    cpuid_print_sink(&sink, staging, sizeof(staging));
+    cpuid_render_bits(&sink, size, ptr);
+    cpuid_sink_putc(&sink, '\n');
+    cpuid_sink_flush(&sink);
 }
 
 void call_cpuid(uint32_t eax_in, uint32_t ecx_in, uint32_t *a, uint32_t *b, uint32_t *c, uint32_t *d) {
@@ -259,6 +322,25 @@ void call_cpuid(uint32_t eax_in, uint32_t ecx_in, uint32_t *a, uint32_t *b, uint
     #endif
 }
 
+/*
+ * XGETBV lee un registro de control extendido: XCR0 (ecx_in = 0) tiene un bit por componente
+ * de estado que el sistema operativo guarda en los cambios de contexto (1 SSE, 2 AVX, 5-7 AVX-512,
+ * 17-18 AMX). La instruccion da #UD si CR4.OSXSAVE no esta activo (CPUID.1:ECX[27]).
+ */
+uint64_t call_xgetbv(uint32_t ecx_in) {
+    #ifdef _MSC_VER
+        return _xgetbv(ecx_in);
+    #else
+        uint32_t a, d;
+        __asm__ volatile (
+            "xgetbv"
+            : "=a" (a), "=d" (d)
+            : "c" (ecx_in)
+        );
+        return a | ((uint64_t)d << 32);
+    #endif
+}
+
 static inline uint8_t Get_Processor_Family_ID(Processor_Info_and_Feature_Bits *MyProcessor_Info_and_Feature_Bits){
     return MyProcessor_Info_and_Feature_Bits->Model + (MyProcessor_Info_and_Feature_Bits->Extended_Model_ID << 4);
 }
@@ -274,144 +356,96 @@ static inline uint16_t Get_CPUID_signature(Processor_Info_and_Feature_Bits *MyPr
            (MyProcessor_Info_and_Feature_Bits->Stepping_ID   );
 }
 
-void printInformation_Feature_Bits(uint32_t edx, uint32_t ecx) {
-    cpuid_feat_ecx *MyCpuid_feat_ecx = (cpuid_feat_ecx*)&ecx;
-    cpuid_feat_edx *MyCpuid_feat_edx = (cpuid_feat_edx*)&edx;
-
-    printf(
-        "uint32_t SSE3       :1 = 0x%x;\n"
-        "uint32_t PCLMUL     :1 = 0x%x;\n"
-        "uint32_t DTES64     :1 = 0x%x;\n"
-        "uint32_t MONITOR    :1 = 0x%x;\n"
-        "uint32_t DS_CPL     :1 = 0x%x;\n"
-        "uint32_t VMX        :1 = 0x%x;\n"
-        "uint32_t SMX        :1 = 0x%x;\n"
-        "uint32_t EST        :1 = 0x%x;\n"
-        "uint32_t TM2        :1 = 0x%x;\n"
-        "uint32_t SSSE3      :1 = 0x%x;\n"
-        "uint32_t CID        :1 = 0x%x;\n"
-        "uint32_t SDBG       :1 = 0x%x;\n"
-        "uint32_t FMA        :1 = 0x%x;\n"
-        "uint32_t CX16       :1 = 0x%x;\n"
-        "uint32_t XTPR       :1 = 0x%x;\n"
-        "uint32_t PDCM       :1 = 0x%x;\n"
-        "uint32_t RESERVADO  :1 = 0x%x;\n"
-        "uint32_t PCID       :1 = 0x%x;\n"
-        "uint32_t DCA        :1 = 0x%x;\n"
-        "uint32_t SSE4_1     :1 = 0x%x;\n"
-        "uint32_t SSE4_2     :1 = 0x%x;\n"
-        "uint32_t X2APIC     :1 = 0x%x;\n"
-        "uint32_t MOVBE      :1 = 0x%x;\n"
-        "uint32_t POPCNT     :1 = 0x%x;\n"
-        "uint32_t TSC        :1 = 0x%x;\n"
-        "uint32_t AES        :1 = 0x%x;\n"
-        "uint32_t XSAVE      :1 = 0x%x;\n"
-        "uint32_t OSXSAVE    :1 = 0x%x;\n"
-        "uint32_t AVX        :1 = 0x%x;\n"
-        "uint32_t F16C       :1 = 0x%x;\n"
-        "uint32_t RDRAND     :1 = 0x%x;\n"
-        "uint32_t HYPERVISOR :1 = 0x%x;\n",
-        MyCpuid_feat_ecx->SSE3,      MyCpuid_feat_ecx->PCLMUL, MyCpuid_feat_ecx->DTES64, MyCpuid_feat_ecx->MONITOR, 
-        MyCpuid_feat_ecx->DS_CPL,    MyCpuid_feat_ecx->VMX,    MyCpuid_feat_ecx->SMX,    MyCpuid_feat_ecx->EST, 
-        MyCpuid_feat_ecx->TM2,       MyCpuid_feat_ecx->SSSE3,  MyCpuid_feat_ecx->CID,    MyCpuid_feat_ecx->SDBG, 
-        MyCpuid_feat_ecx->FMA,       MyCpuid_feat_ecx->CX16,   MyCpuid_feat_ecx->XTPR,   MyCpuid_feat_ecx->PDCM, 
-        MyCpuid_feat_ecx->RESERVADO, MyCpuid_feat_ecx->PCID,   MyCpuid_feat_ecx->DCA,    MyCpuid_feat_ecx->SSE4_1, 
-        MyCpuid_feat_ecx->SSE4_2,    MyCpuid_feat_ecx->X2APIC, MyCpuid_feat_ecx->MOVBE,  MyCpuid_feat_ecx->POPCNT, 
-        MyCpuid_feat_ecx->TSC,       MyCpuid_feat_ecx->AES,    MyCpuid_feat_ecx->XSAVE,  MyCpuid_feat_ecx->OSXSAVE, 
-        MyCpuid_feat_ecx->AVX,       MyCpuid_feat_ecx->F16C,   MyCpuid_feat_ecx->RDRAND, MyCpuid_feat_ecx->HYPERVISOR
-    );
-
-    printf(
-        "uint32_t FPU        :1 = 0x%x;\n"
-        "uint32_t VME        :1 = 0x%x;\n"
-        "uint32_t DE         :1 = 0x%x;\n"
-        "uint32_t PSE        :1 = 0x%x;\n"
-        "uint32_t TSC        :1 = 0x%x;\n"
-        "uint32_t MSR        :1 = 0x%x;\n"
-        "uint32_t PAE        :1 = 0x%x;\n"
-        "uint32_t MCE        :1 = 0x%x;\n"
-        "uint32_t CX8        :1 = 0x%x;\n"
-        "uint32_t APIC       :1 = 0x%x;\n"
-        "uint32_t RESERVADO  :1 = 0x%x;\n"
-        "uint32_t SEP        :1 = 0x%x;\n"
-        "uint32_t MTRR       :1 = 0x%x;\n"
-        "uint32_t PGE        :1 = 0x%x;\n"
-        "uint32_t MCA        :1 = 0x%x;\n"
-        "uint32_t CMOV       :1 = 0x%x;\n"
-        "uint32_t PAT        :1 = 0x%x;\n"
-        "uint32_t PSE36      :1 = 0x%x;\n"
-        "uint32_t PSN        :1 = 0x%x;\n"
-        "uint32_t CLFLUSH    :1 = 0x%x;\n"
-        "uint32_t NX         :1 = 0x%x;\n"
-        "uint32_t DS         :1 = 0x%x;\n"
-        "uint32_t ACPI       :1 = 0x%x;\n"
-        "uint32_t MMX        :1 = 0x%x;\n"
-        "uint32_t FXSR       :1 = 0x%x;\n"
-        "uint32_t SSE        :1 = 0x%x;\n"
-        "uint32_t SSE2       :1 = 0x%x;\n"
-        "uint32_t SS         :1 = 0x%x;\n"
-        "uint32_t HTT        :1 = 0x%x;\n"
-        "uint32_t TM         :1 = 0x%x;\n"
-        "uint32_t IA64       :1 = 0x%x;\n"
-        "uint32_t PBE        :1 = 0x%x;\n",        
-        MyCpuid_feat_edx->FPU,  MyCpuid_feat_edx->VME,        MyCpuid_feat_edx->DE, 
-        MyCpuid_feat_edx->PSE,  MyCpuid_feat_edx->TSC,        MyCpuid_feat_edx->MSR, 
-        MyCpuid_feat_edx->PAE,  MyCpuid_feat_edx->MCE,        MyCpuid_feat_edx->CX8, 
-        MyCpuid_feat_edx->APIC, MyCpuid_feat_edx->RESERVADO , MyCpuid_feat_edx->SEP, 
-        MyCpuid_feat_edx->MTRR, MyCpuid_feat_edx->PGE,        MyCpuid_feat_edx->MCA, 
-        MyCpuid_feat_edx->CMOV, MyCpuid_feat_edx->PAT,        MyCpuid_feat_edx->PSE36, 
-        MyCpuid_feat_edx->PSN,  MyCpuid_feat_edx->CLFLUSH,    MyCpuid_feat_edx->NX, 
-        MyCpuid_feat_edx->DS,   MyCpuid_feat_edx->ACPI,       MyCpuid_feat_edx->MMX, 
-        MyCpuid_feat_edx->FXSR, MyCpuid_feat_edx->SSE,        MyCpuid_feat_edx->SSE2, 
-        MyCpuid_feat_edx->SS,   MyCpuid_feat_edx->HTT,        MyCpuid_feat_edx->TM, 
-        MyCpuid_feat_edx->IA64, MyCpuid_feat_edx->PBE          
-    );
+// escribe name y lo rellena con espacios hasta width caracteres (como "%-*s")
+static void cpuid_render_padded(CPUID_H(sink) *sink, const char *name, size_t width) {
+    static const char spaces[] = "                                ";
+    size_t len = strlen(name);
+    cpuid_sink_write(sink, name, len);
+    if (len < width) cpuid_sink_write(sink, spaces, width - len < sizeof(spaces) - 1 ? width - len : sizeof(spaces) - 1);
+}
 
+#define CPUID_RENDER_NAME(name, bit) [bit] = #name,
+static const char *const cpuid_render_names_ecx[32] = { CPUID_FEAT_ECX_FIELDS(CPUID_RENDER_NAME) };
+static const char *const cpuid_render_names_edx[32] = { CPUID_FEAT_EDX_FIELDS(CPUID_RENDER_NAME) };
+#undef CPUID_RENDER_NAME
+
+// "uint32_t NOMBRE     :1 = 0xB;" por cada bit del registro
+static void cpuid_render_feature_register(CPUID_H(sink) *sink, const char *const names[32], uint32_t reg) {
+    for (int bit = 0; bit < 32; bit++) {
+        cpuid_sink_write(sink, "uint32_t ", sizeof("uint32_t ") - 1);
+        cpuid_render_padded(sink, names[bit], 11);
+        cpuid_sink_write(sink, ":1 = 0x", sizeof(":1 = 0x") - 1);
+        cpuid_sink_putc(sink, (char)('0' + ((reg >> bit) & 1)));
+        cpuid_sink_write(sink, ";\n", 2);
+    }
 }
 
-void printAdditional_Information_Feature_Bits(uint32_t ebx) {
-    Additional_Information_Feature_Bits *MyAdditional_Information_Feature_Bits = (Additional_Information_Feature_Bits*)&ebx;
-    printf(
-        "Brand_Index         :8  = 0x%02x;\n"  
-        "CLFLUSH             :8  = 0x%02x;\n"  
-        "Max_ID_addressable  :8  = 0x%02x;\n"  
-        "Local_APIC_ID       :8  = 0x%02x;\n",    
-        MyAdditional_Information_Feature_Bits->Brand_Index,
-        MyAdditional_Information_Feature_Bits->CLFLUSH,
-        MyAdditional_Information_Feature_Bits->Max_ID_addressable,
-        MyAdditional_Information_Feature_Bits->Local_APIC_ID
-    );
+void cpuid_render_Information_Feature_Bits(CPUID_H(sink) *sink, uint32_t edx, uint32_t ecx) {
+    cpuid_render_feature_register(sink, cpuid_render_names_ecx, ecx);
+    cpuid_render_feature_register(sink, cpuid_render_names_edx, edx);
 }
 
-void printProcessor_Info_and_Feature_Bits(uint32_t eax) {
+void cpuid_render_Additional_Information_Feature_Bits(CPUID_H(sink) *sink, uint32_t ebx) {
+    #define CPUID_RENDER_FIELD(name, shift, width)                          \
+        cpuid_render_padded(sink, #name, 20);                              \
+        cpuid_sink_write(sink, ":8  = 0x", sizeof(":8  = 0x") - 1);        \
+        cpuid_sink_hex(sink, (ebx >> (shift)) & ((1u << (width)) - 1), 2); \
+        cpuid_sink_write(sink, ";\n", 2);
+    CPUID_ADDITIONAL_INFO_FIELDS(CPUID_RENDER_FIELD)
+    #undef CPUID_RENDER_FIELD
+}
+
+void cpuid_render_Processor_Info_and_Feature_Bits(CPUID_H(sink) *sink, uint32_t eax) {
+    typedef struct { const char *name; uint8_t shift, width; } field;
+    #define CPUID_RENDER_FIELD(name, shift, width) { #name, shift, width },
+    static const field fields[] = { CPUID_PROCESSOR_INFO_FIELDS(CPUID_RENDER_FIELD) };
+    #undef CPUID_RENDER_FIELD
     Processor_Info_and_Feature_Bits *MyProcessor_Info_and_Feature_Bits = (Processor_Info_and_Feature_Bits*)&eax;
-    printf("EAX                :32 = 0b"); 
-    printBits(sizeof(eax), &eax);
+
+    cpuid_sink_puts(sink, "EAX                :32 = 0b");
+    cpuid_render_bits(sink, sizeof(eax), &eax);
+    cpuid_sink_putc(sink, '\n');
+
     // 0000  0000_0000 1011 00 00 0110 0111 0001
-    printf(
-        "Reserved1           :4  = 0x%02x;\n"  // 31 - 28
-        "Extended_Family_ID  :8  = 0x%02x;\n"  // 27 - 20
-        "Extended_Model_ID   :4  = 0x%02x;\n"  // 19 - 16
-        "Reserved2           :2  = 0x%02x;\n"  // 15 - 14
-        "Processor_Type      :2  = 0x%02x;\n"  // 13 - 12
-        "Family_ID           :4  = 0x%02x;\n"  // 11 - 8
-        "Model               :4  = 0x%02x;\n"  // 7  - 4
-        "Stepping_ID         :4  = 0x%02x;\n", // 3  - 0
-        MyProcessor_Info_and_Feature_Bits->Reserved1,
-        MyProcessor_Info_and_Feature_Bits->Extended_Family_ID,
-        MyProcessor_Info_and_Feature_Bits->Extended_Model_ID,
-        MyProcessor_Info_and_Feature_Bits->Reserved2,
-        MyProcessor_Info_and_Feature_Bits->Processor_Type,
-        MyProcessor_Info_and_Feature_Bits->Family_ID,
-        MyProcessor_Info_and_Feature_Bits->Model,
-        MyProcessor_Info_and_Feature_Bits->Stepping_ID
-    );
-    printf(
-        "All_Model              = 0x%02x;\n"
-        "CPUID signature        = 0x%04x;\n", 
-        Get_Processor_Family_ID(MyProcessor_Info_and_Feature_Bits),
-        Get_CPUID_signature(MyProcessor_Info_and_Feature_Bits)
-    );
+    // del bit 31 al 0, al contrario que la lista de campos
+    for (size_t i = sizeof(fields) / sizeof(fields[0]); i-- > 0; ) {
+        cpuid_render_padded(sink, fields[i].name, 20);
+        cpuid_sink_putc(sink, ':');
+        cpuid_sink_putc(sink, (char)('0' + fields[i].width));
+        cpuid_sink_write(sink, "  = 0x", sizeof("  = 0x") - 1);
+        cpuid_sink_hex(sink, (eax >> fields[i].shift) & ((1u << fields[i].width) - 1), 2);
+        cpuid_sink_write(sink, ";\n", 2);
+    }
+
+    cpuid_sink_puts(sink, "All_Model              = 0x");
+    cpuid_sink_hex(sink, Get_Processor_Family_ID(MyProcessor_Info_and_Feature_Bits), 2);
+    cpuid_sink_puts(sink, ";\nCPUID signature        = 0x");
+    cpuid_sink_hex(sink, Get_CPUID_signature(MyProcessor_Info_and_Feature_Bits), 4);
+    cpuid_sink_write(sink, ";\n", 2);
+}
+
+void printInformation_Feature_Bits(uint32_t edx, uint32_t ecx) {
+    char staging[CPUID_PRINT_STAGING];
+    CPUID_H(sink) sink;
+    cpuid_print_sink(&sink, staging, sizeof(staging));
+    cpuid_render_Information_Feature_Bits(&sink, edx, ecx);
+    cpuid_sink_flush(&sink);
+}
+
+void printAdditional_Information_Feature_Bits(uint32_t ebx) {
+    char staging[CPUID_PRINT_STAGING];
+    CPUID_H(sink) sink;
+    cpuid_print_sink(&sink, staging, sizeof(staging));
+    cpuid_render_Additional_Information_Feature_Bits(&sink, ebx);
+    cpuid_sink_flush(&sink);
+}
+
+void printProcessor_Info_and_Feature_Bits(uint32_t eax) {
+    char staging[CPUID_PRINT_STAGING];
+    CPUID_H(sink) sink;
+    cpuid_print_sink(&sink, staging, sizeof(staging));
+    cpuid_render_Processor_Info_and_Feature_Bits(&sink, eax);
+    cpuid_sink_flush(&sink);
 }
 
 /*
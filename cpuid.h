@@ -536,6 +536,119 @@ typedef struct cpuid_feat_edx {
 
 #pragma pack(pop)
 
+/*
+ * Listas X-macro con los campos de cpuid_feat_ecx y cpuid_feat_edx en forma (nombre, bit).
+ * Siguen el mismo orden que las estructuras de arriba y permiten generar tablas de nombres,
+ * getters, etc. sin repetir la lista de caracteristicas en cada modulo:
+ *
+ *      #define NOMBRE(name, bit) [bit] = #name,
+ *      static const char *nombres_ecx[32] = { CPUID_FEAT_ECX_FIELDS(NOMBRE) };
+ */
+#define CPUID_FEAT_ECX_FIELDS(X) \
+    X(SSE3,        0) X(PCLMUL,      1) X(DTES64,      2) X(MONITOR,     3) \
+    X(DS_CPL,      4) X(VMX,         5) X(SMX,         6) X(EST,         7) \
+    X(TM2,         8) X(SSSE3,       9) X(CID,        10) X(SDBG,       11) \
+    X(FMA,        12) X(CX16,       13) X(XTPR,       14) X(PDCM,       15) \
+    X(RESERVADO,  16) X(PCID,       17) X(DCA,        18) X(SSE4_1,     19) \
+    X(SSE4_2,     20) X(X2APIC,     21) X(MOVBE,      22) X(POPCNT,     23) \
+    X(TSC,        24) X(AES,        25) X(XSAVE,      26) X(OSXSAVE,    27) \
+    X(AVX,        28) X(F16C,       29) X(RDRAND,     30) X(HYPERVISOR, 31)
+
+#define CPUID_FEAT_EDX_FIELDS(X) \
+    X(FPU,         0) X(VME,         1) X(DE,          2) X(PSE,         3) \
+    X(TSC,         4) X(MSR,         5) X(PAE,         6) X(MCE,         7) \
+    X(CX8,         8) X(APIC,        9) X(RESERVADO,  10) X(SEP,        11) \
+    X(MTRR,       12) X(PGE,        13) X(MCA,        14) X(CMOV,       15) \
+    X(PAT,        16) X(PSE36,      17) X(PSN,        18) X(CLFLUSH,    19) \
+    X(NX,         20) X(DS,         21) X(ACPI,       22) X(MMX,        23) \
+    X(FXSR,       24) X(SSE,        25) X(SSE2,       26) X(SS,         27) \
+    X(HTT,        28) X(TM,         29) X(IA64,       30) X(PBE,        31)
+
+/*
+ * Bits de caracteristicas de otras hojas en la misma forma (nombre, bit). Solo se listan los bits
+ * con nombre; los reservados y los campos de varios bits (MAWAU de 7.0:ECX) no aparecen.
+ */
+// CPUID EAX=7, ECX=0: Extended Features, registro EBX
+#define CPUID_FEAT7_EBX_FIELDS(X) \
+    X(FSGSBASE,          0) X(TSC_ADJUST,        1) X(SGX,               2) X(BMI1,              3) \
+    X(HLE,               4) X(AVX2,              5) X(FDP_EXCPTN_ONLY,   6) X(SMEP,              7) \
+    X(BMI2,              8) X(ERMS,              9) X(INVPCID,          10) X(RTM,              11) \
+    X(RDT_M,            12) X(FPU_CSDS,         13) X(MPX,              14) X(RDT_A,            15) \
+    X(AVX512F,          16) X(AVX512DQ,         17) X(RDSEED,           18) X(ADX,              19) \
+    X(SMAP,             20) X(AVX512_IFMA,      21) X(CLFLUSHOPT,       23) X(CLWB,             24) \
+    X(INTEL_PT,         25) X(AVX512PF,         26) X(AVX512ER,         27) X(AVX512CD,         28) \
+    X(SHA,              29) X(AVX512BW,         30) X(AVX512VL,         31)
+
+// CPUID EAX=7, ECX=0: Extended Features, registro ECX
+#define CPUID_FEAT7_ECX_FIELDS(X) \
+    X(PREFETCHWT1,       0) X(AVX512_VBMI,       1) X(UMIP,              2) X(PKU,               3) \
+    X(OSPKE,             4) X(WAITPKG,           5) X(AVX512_VBMI2,      6) X(CET_SS,            7) \
+    X(GFNI,              8) X(VAES,              9) X(VPCLMULQDQ,       10) X(AVX512_VNNI,      11) \
+    X(AVX512_BITALG,    12) X(TME_EN,           13) X(AVX512_VPOPCNTDQ, 14) X(LA57,             16) \
+    X(RDPID,            22) X(KL,               23) X(BUS_LOCK_DETECT,  24) X(CLDEMOTE,         25) \
+    X(MOVDIRI,          27) X(MOVDIR64B,        28) X(ENQCMD,           29) X(SGX_LC,           30) \
+    X(PKS,              31)
+
+// CPUID EAX=7, ECX=0: Extended Features, registro EDX
+#define CPUID_FEAT7_EDX_FIELDS(X) \
+    X(SGX_KEYS,          1) X(AVX512_4VNNIW,     2) X(AVX512_4FMAPS,     3) X(FSRM,              4) \
+    X(UINTR,             5) X(AVX512_VP2INTERSECT, 8) X(SRBDS_CTRL,      9) X(MD_CLEAR,         10) \
+    X(RTM_ALWAYS_ABORT, 11) X(TSX_FORCE_ABORT,  13) X(SERIALIZE,        14) X(HYBRID,           15) \
+    X(TSXLDTRK,         16) X(PCONFIG,          18) X(ARCH_LBR,         19) X(CET_IBT,          20) \
+    X(AMX_BF16,         22) X(AVX512_FP16,      23) X(AMX_TILE,         24) X(AMX_INT8,         25) \
+    X(SPEC_CTRL,        26) X(STIBP,            27) X(L1D_FLUSH,        28) X(ARCH_CAPABILITIES, 29) \
+    X(CORE_CAPABILITIES, 30) X(SSBD,            31)
+
+// CPUID EAX=7, ECX=1: Extended Features, registro EAX
+#define CPUID_FEAT7_1_EAX_FIELDS(X) \
+    X(AVX_VNNI,          4) X(AVX512_BF16,       5) X(FZLRM,            10) X(FSRS,             11) \
+    X(FSRCS,            12) X(HRESET,           22) X(AVX_IFMA,         23) X(LAM,              26)
+
+// CPUID EAX=0Dh, ECX=1: instrucciones XSAVE, registro EAX
+#define CPUID_FEATD_1_EAX_FIELDS(X) \
+    X(XSAVEOPT,          0) X(XSAVEC,            1) X(XGETBV_ECX1,       2) X(XSAVES,            3) \
+    X(XFD,               4)
+
+// CPUID EAX=80000001h: Extended Processor Info and Feature Bits, registro ECX
+#define CPUID_FEAT_EXT_ECX_FIELDS(X) \
+    X(LAHF_LM,           0) X(CMP_LEGACY,        1) X(SVM,               2) X(EXTAPIC,           3) \
+    X(CR8_LEGACY,        4) X(ABM,               5) X(SSE4A,             6) X(MISALIGNSSE,       7) \
+    X(PREFETCHW,         8) X(OSVW,              9) X(IBS,              10) X(XOP,              11) \
+    X(SKINIT,           12) X(WDT,              13) X(LWP,              15) X(FMA4,             16) \
+    X(TCE,              17) X(NODEID_MSR,       19) X(TBM,              21) X(TOPOEXT,          22) \
+    X(PERFCTR_CORE,     23) X(PERFCTR_NB,       24) X(DBX,              26) X(PERFTSC,          27) \
+    X(PERFCTR_LLC,      28) X(MONITORX,         29) X(ADDR_MASK_EXT,    30)
+
+// CPUID EAX=80000001h: Extended Processor Info and Feature Bits, registro EDX (solo los bits propios,
+// no los que repiten los de EDX con EAX=1 salvo NX, que en Intel solo es valido aqui)
+#define CPUID_FEAT_EXT_EDX_FIELDS(X) \
+    X(SYSCALL,          11) X(MP,               19) X(NX,               20) X(MMXEXT,           22) \
+    X(FXSR_OPT,         25) X(PDPE1GB,          26) X(RDTSCP,           27) X(LM,               29) \
+    X(AMD3DNOWEXT,      30) X(AMD3DNOW,         31)
+
+// CPUID EAX=80000008h: Extended Feature Extensions ID, registro EBX
+#define CPUID_FEAT_EXT8_EBX_FIELDS(X) \
+    X(CLZERO,            0) X(IRPERF,            1) X(XSAVEERPTR,        2) X(RDPRU,             4) \
+    X(WBNOINVD,          9)
+
+// Campos de Processor_Info_and_Feature_Bits (EAX con EAX=1) en forma (nombre, bit_inicial, ancho).
+#define CPUID_PROCESSOR_INFO_FIELDS(X) \
+    X(Stepping_ID,         0, 4) \
+    X(Model,               4, 4) \
+    X(Family_ID,           8, 4) \
+    X(Processor_Type,     12, 2) \
+    X(Reserved2,          14, 2) \
+    X(Extended_Model_ID,  16, 4) \
+    X(Extended_Family_ID, 20, 8) \
+    X(Reserved1,          28, 4)
+
+// Campos de Additional_Information_Feature_Bits (EBX con EAX=1) en forma (nombre, bit_inicial, ancho).
+#define CPUID_ADDITIONAL_INFO_FIELDS(X) \
+    X(Brand_Index,         0, 8) \
+    X(CLFLUSH,             8, 8) \
+    X(Max_ID_addressable, 16, 8) \
+    X(Local_APIC_ID,      24, 8)
+
 typedef enum Processor_Family_ID_Amd {
     Amd486         = 0x4,
     Amd5x86        = Amd486,
@@ -733,5 +846,36 @@ typedef enum CPUID_FEAT {
     CPUID_FEAT_EDX_PBE          = 1 << 31
 } CPUID_FEAT;
 
+// destino de salida de los decodificadores cpuid_render_*
+#include "cpuid_sink.h"
+
+/*
+ * Prototipos de las funciones de cpuid.c. Son necesarios cuando cpuid.c no se incluye en la
+ * unidad de traduccion y se enlaza desde cpuid.o (por ejemplo desde el modulo de python).
+ */
+void call_cpuid(uint32_t eax_in, uint32_t ecx_in, uint32_t *a, uint32_t *b, uint32_t *c, uint32_t *d);
+uint64_t call_xgetbv(uint32_t ecx_in);  // XCR[ecx_in]; solo si CPUID.1:ECX.OSXSAVE esta activo
+int  is_cpuid_supported();
+void printBits(size_t const size, void const * const ptr);
+void printInformation_Feature_Bits(uint32_t edx, uint32_t ecx);
+void printAdditional_Information_Feature_Bits(uint32_t ebx);
+void printProcessor_Info_and_Feature_Bits(uint32_t eax);
+
+/*
+ * Decodificadores con destino configurable: generan el mismo texto que las funciones print*
+ * (que ahora son envoltorios de estas sobre printf) pero lo escriben en un sink, por ejemplo
+ * en un buffer del llamador. cpuid_render_bits no anade el salto de linea final de printBits.
+ */
+void cpuid_render_bits(CPUID_H(sink) *sink, size_t const size, void const * const ptr);
+
+/*
+ * Escribe en out los 8 * size bits de ptr en texto ('0'/'1', del bit mas significativo de
+ * ptr[size - 1] al bit 0 de ptr[0], como printBits) sin '\0'. Devuelve out + 8 * size.
+ */
+char *cpuid_bits_expand(char *out, void const * const ptr, size_t const size);
+void cpuid_render_Information_Feature_Bits(CPUID_H(sink) *sink, uint32_t edx, uint32_t ecx);
+void cpuid_render_Additional_Information_Feature_Bits(CPUID_H(sink) *sink, uint32_t ebx);
+void cpuid_render_Processor_Info_and_Feature_Bits(CPUID_H(sink) *sink, uint32_t eax);
+
 #include "cpuid.c"
 #endif
\ No newline at end of file
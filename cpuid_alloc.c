@@ -0,0 +1,181 @@
+#ifndef __CPUID_ALLOC_C__
+#define __CPUID_ALLOC_C__
+
+#include "cpuid_alloc.h"
+#include "cpuid_atomic.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// resultados de cpuid_alloc_line_size/cpuid_alloc_interference_size, 0 hasta calcularlos
+static uint32_t cpuid_alloc_line_cache;
+static uint32_t cpuid_alloc_interference_cache;
+
+/*
+ * Tamano de linea de las hojas de caches deterministas (4 u 8000001Dh): el mayor de todos, o
+ * solo el de la L2 si l2_only. Devuelve 0 si la hoja no existe.
+ */
+static size_t cpuid_alloc_leaf_line(uint32_t leaf, int l2_only) {
+    uint32_t eax, ebx, ecx, edx;
+    size_t   line = 0;
+
+    call_cpuid(leaf & 0x80000000, 0, &eax, &ebx, &ecx, &edx);
+    if (eax < leaf) return 0;
+    for (uint32_t subleaf = 0; subleaf < 32; subleaf++) {
+        call_cpuid(leaf, subleaf, &eax, &ebx, &ecx, &edx);
+        if ((eax & 0x1f) == 0) break;       // no hay mas caches
+        if (l2_only && ((eax >> 5) & 0x7) != 2) continue;
+        if ((size_t)(ebx & 0xfff) + 1 > line) line = (size_t)(ebx & 0xfff) + 1;
+    }
+    return line;
+}
+
+size_t cpuid_alloc_line_size(void) {
+    uint32_t eax, ebx, ecx, edx;
+    size_t   line = cpuid_atomic_load_u32(&cpuid_alloc_line_cache);
+    if (line != 0) return line;
+
+    call_cpuid(0, 0, &eax, &ebx, &ecx, &edx);
+    if (eax >= 1) {
+        Additional_Information_Feature_Bits bits;
+        call_cpuid(1, 0, &eax, &ebx, &ecx, &edx);
+        memcpy(&bits, &ebx, sizeof(bits));
+        line = (size_t)bits.CLFLUSH * 8;
+    }
+    size_t leaf4 = cpuid_alloc_leaf_line(0x00000004, 0);
+    size_t amd   = cpuid_alloc_leaf_line(0x8000001d, 0);
+    if (leaf4 > line) line = leaf4;
+    if (amd   > line) line = amd;
+    if (line == 0 || (line & (line - 1)) != 0) line = 64;
+
+    cpuid_atomic_store_u32(&cpuid_alloc_line_cache, line);
+    return line;
+}
+
+size_t cpuid_alloc_interference_size(void) {
+    uint32_t eax, ebx, ecx, edx;
+    size_t   size = cpuid_atomic_load_u32(&cpuid_alloc_interference_cache);
+    if (size != 0) return size;
+
+    size = cpuid_alloc_line_size();
+    call_cpuid(0, 0, &eax, &ebx, &ecx, &edx);
+    // "GenuineIntel": el prefetcher de linea adyacente existe desde NetBurst (familia 15) y en
+    // todos los nucleos de la familia 6 en adelante, y trabaja sobre la L2
+    if (ebx == 0x756e6547 && edx == 0x49656e69 && ecx == 0x6c65746e && eax >= 4) {
+        call_cpuid(1, 0, &eax, &ebx, &ecx, &edx);
+        uint32_t family = (eax >> 8) & 0xf;
+        if (family == 0xf) family += (eax >> 20) & 0xff;
+        if (family >= 6 && cpuid_alloc_leaf_line(0x00000004, 1) == 64 && size == 64) size = 128;
+    }
+
+    cpuid_atomic_store_u32(&cpuid_alloc_interference_cache, size);
+    return size;
+}
+
+// bloque nuevo con al menos size bytes utiles, alineados a align
+static CPUID_H(arena_chunk) *cpuid_arena_new_chunk(size_t size, size_t align) {
+    CPUID_H(arena_chunk) *chunk = malloc(sizeof(*chunk) + align - 1 + size);
+    if (chunk == NULL) return NULL;
+    chunk->next = NULL;
+    chunk->size = size;
+    chunk->data = (unsigned char*)(((uintptr_t)(chunk + 1) + align - 1) & ~(uintptr_t)(align - 1));
+    return chunk;
+}
+
+void cpuid_arena_init(CPUID_H(arena) *arena, size_t align, size_t chunk_size) {
+    memset(arena, 0, sizeof(*arena));
+    arena->align      = align != 0 ? align : cpuid_alloc_interference_size();
+    arena->chunk_size = chunk_size != 0 ? chunk_size : CPUID_ARENA_CHUNK;
+}
+
+void *cpuid_arena_alloc(CPUID_H(arena) *arena, size_t size) {
+    // el objeto ocupa bloques de interferencia enteros para que el siguiente no comparta ninguno
+    size_t padded = (size + arena->align - 1) & ~(arena->align - 1);
+    if (padded == 0) padded = arena->align;
+    if (padded < size) return NULL;
+
+    if (padded > arena->chunk_size) {
+        // objeto mas grande que un bloque: bloque propio detras del actual, que se sigue usando
+        CPUID_H(arena_chunk) *chunk = cpuid_arena_new_chunk(padded, arena->align);
+        if (chunk == NULL) return NULL;
+        if (arena->chunks != NULL) {
+            chunk->next         = arena->chunks->next;
+            arena->chunks->next = chunk;
+        } else {
+            arena->chunks = chunk;
+            arena->used   = padded;
+        }
+        return chunk->data;
+    }
+    if (arena->chunks == NULL || arena->chunks->size - arena->used < padded) {
+        CPUID_H(arena_chunk) *chunk = cpuid_arena_new_chunk(arena->chunk_size, arena->align);
+        if (chunk == NULL) return NULL;
+        chunk->next   = arena->chunks;
+        arena->chunks = chunk;
+        arena->used   = 0;
+    }
+    void *object = arena->chunks->data + arena->used;
+    arena->used += padded;
+    return object;
+}
+
+void *cpuid_arena_calloc(CPUID_H(arena) *arena, size_t count, size_t size) {
+    if (size != 0 && count > SIZE_MAX / size) return NULL;
+    void *object = cpuid_arena_alloc(arena, count * size);
+    if (object != NULL) memset(object, 0, count * size);
+    return object;
+}
+
+void cpuid_arena_reset(CPUID_H(arena) *arena) {
+    if (arena->chunks == NULL) return;
+    CPUID_H(arena_chunk) *chunk = arena->chunks->next;
+    while (chunk != NULL) {
+        CPUID_H(arena_chunk) *next = chunk->next;
+        free(chunk);
+        chunk = next;
+    }
+    arena->chunks->next = NULL;
+    arena->used         = 0;
+}
+
+void cpuid_arena_free(CPUID_H(arena) *arena) {
+    cpuid_arena_reset(arena);
+    free(arena->chunks);
+    arena->chunks = NULL;
+}
+
+void cpuid_slab_init(CPUID_H(slab) *slab, size_t object_size, size_t align) {
+    memset(slab, 0, sizeof(*slab));
+    cpuid_arena_init(&slab->arena, align, 0);
+    slab->object_size = object_size;
+    // la lista de libres guarda un puntero dentro de cada objeto libre
+    size_t size  = object_size > sizeof(void*) ? object_size : sizeof(void*);
+    slab->stride = (size + slab->arena.align - 1) & ~(slab->arena.align - 1);
+}
+
+void *cpuid_slab_alloc(CPUID_H(slab) *slab) {
+    void *object = slab->free_list;
+    if (object != NULL) {
+        memcpy(&slab->free_list, object, sizeof(void*));
+    } else {
+        object = cpuid_arena_alloc(&slab->arena, slab->stride);
+        if (object == NULL) return NULL;
+    }
+    slab->live++;
+    return object;
+}
+
+void cpuid_slab_release(CPUID_H(slab) *slab, void *object) {
+    if (object == NULL) return;
+    memcpy(object, &slab->free_list, sizeof(void*));
+    slab->free_list = object;
+    slab->live--;
+}
+
+void cpuid_slab_free(CPUID_H(slab) *slab) {
+    cpuid_arena_free(&slab->arena);
+    slab->free_list = NULL;
+    slab->live      = 0;
+}
+
+#endif
@@ -0,0 +1,89 @@
+#ifndef __CPUID_ALLOC_H__
+#define __CPUID_ALLOC_H__
+
+/*
+ * Reserva de memoria sin comparticion falsa (false sharing).
+ *
+ * Dos hilos que escriben en variables distintas de la misma linea de cache se la quitan el uno
+ * al otro en cada escritura. El tamano de linea sale de CPUID.1:EBX.CLFLUSH * 8 (ver
+ * Additional_Information_Feature_Bits en cpuid.h) y de las hojas de caches deterministas (4 en
+ * Intel, 8000001Dh en AMD). Ademas, el prefetcher espacial de la L2 de Intel trae la linea
+ * pareja de cada linea de 64 bytes (las dos mitades de un bloque de 128 alineado), asi que
+ * en esos procesadores la distancia que evita interferencias es de 128 bytes:
+ *
+ *      cpuid_alloc_line_size()          64
+ *      cpuid_alloc_interference_size()  128 en Intel con L2 de lineas de 64, si no la linea
+ *
+ * Sobre ese tamano se ofrecen:
+ *
+ *  - CPUID_H(arena): reserva lineal por bloques grandes; cada objeto empieza en su propio
+ *    bloque de interferencia y ocupa un numero entero de ellos. Se libera todo de una vez.
+ *  - CPUID_H(slab): objetos de tamano fijo sacados de una arena, con lista de libres.
+ *
+ * Ninguno de los dos es seguro entre hilos: se reserva desde un hilo y se reparten los objetos
+ * (cada hilo su contador, su cola, ...), que es justo el caso en el que importa la separacion.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "cpuid.h"
+
+#define CPUID_ARENA_CHUNK (64 * 1024)   // tamano de bloque por defecto
+
+typedef struct CPUID_H(arena_chunk) {
+    struct CPUID_H(arena_chunk) *next;
+    size_t                       size;  // bytes utiles tras la cabecera y el relleno
+    unsigned char               *data;  // alineado a la alineacion de la arena
+} CPUID_H(arena_chunk);
+
+typedef struct CPUID_H(arena) {
+    size_t                align;        // alineacion y granulo de cada objeto
+    size_t                chunk_size;
+    CPUID_H(arena_chunk) *chunks;       // el primero es el actual
+    size_t                used;         // bytes usados del bloque actual
+} CPUID_H(arena);
+
+typedef struct CPUID_H(slab) {
+    CPUID_H(arena) arena;
+    size_t         object_size;         // tamano pedido
+    size_t         stride;              // tamano con relleno, multiplo de arena.align
+    void          *free_list;           // objetos liberados, enlazados por su primer puntero
+    size_t         live;                // objetos reservados y no liberados
+} CPUID_H(slab);
+
+// tamano de linea de cache segun CPUID, o 64 si no se sabe
+size_t cpuid_alloc_line_size(void);
+
+// distancia minima entre dos objetos escritos por hilos distintos
+size_t cpuid_alloc_interference_size(void);
+
+/*
+ * align = 0 usa cpuid_alloc_interference_size() y chunk_size = 0 usa CPUID_ARENA_CHUNK.
+ * align debe ser potencia de 2. No reserva memoria hasta la primera peticion.
+ */
+void  cpuid_arena_init(CPUID_H(arena) *arena, size_t align, size_t chunk_size);
+
+// memoria sin inicializar para size bytes, o NULL sin memoria
+void *cpuid_arena_alloc(CPUID_H(arena) *arena, size_t size);
+
+// como cpuid_arena_alloc pero a 0
+void *cpuid_arena_calloc(CPUID_H(arena) *arena, size_t count, size_t size);
+
+// olvida todos los objetos y conserva solo el bloque mas reciente para reutilizarlo
+void  cpuid_arena_reset(CPUID_H(arena) *arena);
+
+void  cpuid_arena_free(CPUID_H(arena) *arena);
+
+// object_size > 0; align como en cpuid_arena_init
+void  cpuid_slab_init(CPUID_H(slab) *slab, size_t object_size, size_t align);
+
+void *cpuid_slab_alloc(CPUID_H(slab) *slab);
+
+// devuelve un objeto de cpuid_slab_alloc a la lista de libres
+void  cpuid_slab_release(CPUID_H(slab) *slab, void *object);
+
+void  cpuid_slab_free(CPUID_H(slab) *slab);
+
+#include "cpuid_alloc.c"
+#endif
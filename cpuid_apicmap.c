@@ -0,0 +1,123 @@
+#ifndef __CPUID_APICMAP_C__
+#define __CPUID_APICMAP_C__
+
+#include "cpuid_apicmap.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define CPUID_APICMAP_PAGE (1u << CPUID_APICMAP_PAGE_BITS)
+
+static int cpuid_apicmap_u32_cmp(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t*)a, y = *(const uint32_t*)b;
+    return x < y ? -1 : x > y;
+}
+
+// core y package llevan aqui el identificador de grupo de la topologia hasta densificarlos
+static int cpuid_apicmap_entry_cmp(const void *a, const void *b) {
+    return cpuid_apicmap_u32_cmp(&((const CPUID_H(apicmap_entry)*)a)->apic_id, &((const CPUID_H(apicmap_entry)*)b)->apic_id);
+}
+
+/*
+ * Sustituye el identificador de grupo de cada entrada (en el campo indicado por offset) por
+ * su posicion entre los identificadores distintos. Devuelve cuantos hay, o -1 sin memoria.
+ */
+static int cpuid_apicmap_densify(CPUID_H(apicmap_entry) *entries, uint32_t n, size_t offset) {
+    uint32_t *ids = malloc(sizeof(*ids) * (n != 0 ? n : 1));
+    if (ids == NULL) return -1;
+    for (uint32_t i = 0; i < n; i++) memcpy(&ids[i], (const char*)&entries[i] + offset, sizeof(uint32_t));
+    qsort(ids, n, sizeof(*ids), cpuid_apicmap_u32_cmp);
+
+    uint32_t distinct = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        if (i == 0 || ids[i] != ids[distinct - 1]) ids[distinct++] = ids[i];
+    }
+    for (uint32_t i = 0; i < n; i++) {
+        uint32_t *field = (uint32_t*)((char*)&entries[i] + offset);
+        uint32_t  rank  = (uint32_t)((uint32_t*)bsearch(field, ids, distinct, sizeof(*ids), cpuid_apicmap_u32_cmp) - ids);
+        *field = rank;
+    }
+    free(ids);
+    return (int)distinct;
+}
+
+int cpuid_apicmap_build(CPUID_H(apicmap) *map, const CPUID_H(topology) *topo) {
+    memset(map, 0, sizeof(*map));
+
+    map->entries = malloc(sizeof(*map->entries) * (topo->n_cpus != 0 ? topo->n_cpus : 1));
+    if (map->entries == NULL) goto fail;
+    for (size_t i = 0; i < topo->n_cpus; i++) {
+        const uint32_t *v = topo->cpus[i].values;
+        if (v[CPUID_TOPO_APIC_ID] == CPUID_TOPO_UNKNOWN || v[CPUID_TOPO_CORE] == CPUID_TOPO_UNKNOWN
+            || v[CPUID_TOPO_PACKAGE] == CPUID_TOPO_UNKNOWN) continue;
+        CPUID_H(apicmap_entry) *e = &map->entries[map->n_entries++];
+        e->apic_id = v[CPUID_TOPO_APIC_ID];
+        e->cpu     = topo->cpus[i].cpu;
+        e->core    = v[CPUID_TOPO_CORE];
+        e->package = v[CPUID_TOPO_PACKAGE];
+    }
+    qsort(map->entries, map->n_entries, sizeof(*map->entries), cpuid_apicmap_entry_cmp);
+
+    int cores    = cpuid_apicmap_densify(map->entries, map->n_entries, offsetof(CPUID_H(apicmap_entry), core));
+    int packages = cpuid_apicmap_densify(map->entries, map->n_entries, offsetof(CPUID_H(apicmap_entry), package));
+    if (cores < 0 || packages < 0) goto fail;
+    map->n_cores    = (uint32_t)cores;
+    map->n_packages = (uint32_t)packages;
+
+    // paginas: solo se reserva memoria para las que tienen algun APIC ID
+    uint32_t max_cpu = 0, used = 0;
+    for (uint32_t i = 0; i < map->n_entries; i++) {
+        if (i > 0 && map->entries[i].apic_id == map->entries[i - 1].apic_id) goto fail;
+        if (i == 0 || (map->entries[i].apic_id >> CPUID_APICMAP_PAGE_BITS) != (map->entries[i - 1].apic_id >> CPUID_APICMAP_PAGE_BITS)) used++;
+        if (map->entries[i].cpu > max_cpu) max_cpu = map->entries[i].cpu;
+    }
+    map->n_pages  = map->n_entries != 0 ? (map->entries[map->n_entries - 1].apic_id >> CPUID_APICMAP_PAGE_BITS) + 1 : 0;
+    map->n_by_cpu = map->n_entries != 0 ? (size_t)max_cpu + 1 : 0;
+    map->pages    = calloc(map->n_pages != 0 ? map->n_pages : 1, sizeof(*map->pages));
+    map->storage  = malloc(sizeof(*map->storage) * CPUID_APICMAP_PAGE * (used != 0 ? used : 1));
+    map->by_cpu   = malloc(sizeof(*map->by_cpu) * (map->n_by_cpu != 0 ? map->n_by_cpu : 1));
+    if (map->pages == NULL || map->storage == NULL || map->by_cpu == NULL) goto fail;
+    memset(map->storage, 0xff, sizeof(*map->storage) * CPUID_APICMAP_PAGE * used);
+    memset(map->by_cpu, 0xff, sizeof(*map->by_cpu) * map->n_by_cpu);
+
+    uint32_t *next = map->storage;
+    for (uint32_t i = 0; i < map->n_entries; i++) {
+        const CPUID_H(apicmap_entry) *e = &map->entries[i];
+        size_t page = e->apic_id >> CPUID_APICMAP_PAGE_BITS;
+        if (map->pages[page] == NULL) {
+            map->pages[page] = next;
+            next += CPUID_APICMAP_PAGE;
+        }
+        map->pages[page][e->apic_id & (CPUID_APICMAP_PAGE - 1)] = i;
+        map->by_cpu[e->cpu] = i;
+    }
+    return 0;
+
+fail:
+    cpuid_apicmap_free(map);
+    return -1;
+}
+
+int cpuid_apicmap_take(CPUID_H(apicmap) *map) {
+    CPUID_H(snapshot) snapshot;
+    CPUID_H(topology) topo;
+
+    memset(map, 0, sizeof(*map));
+    if (cpuid_snapshot_take(&snapshot, NULL, 0, NULL, 0, 0) < 0) return -1;
+    int status = cpuid_topology_from_cpuid(&topo, &snapshot);
+    cpuid_snapshot_free(&snapshot);
+    if (status != 0) return -1;
+    status = cpuid_apicmap_build(map, &topo);
+    cpuid_topology_free(&topo);
+    return status;
+}
+
+void cpuid_apicmap_free(CPUID_H(apicmap) *map) {
+    free(map->entries);
+    free(map->pages);
+    free(map->storage);
+    free(map->by_cpu);
+    memset(map, 0, sizeof(*map));
+}
+
+#endif
@@ -0,0 +1,76 @@
+#ifndef __CPUID_APICMAP_H__
+#define __CPUID_APICMAP_H__
+
+/*
+ * Tabla densa entre x2APIC IDs y indices logicos.
+ *
+ * Los x2APIC IDs tienen huecos (cada nivel de la hoja 0Bh/1Fh reserva una potencia de 2 de IDs
+ * aunque no se usen todos, ver CPUID_INTEL_THREAD_CORE_AND_CACHE_TOPOLOGY2 en cpuid.h), asi
+ * que un array por CPU indexado por APIC ID desperdicia memoria o se desborda (como los 16 de
+ * Locals_APICs en pruebas5.c). La tabla da a cada CPU un indice denso 0..n-1, ordenado por
+ * APIC ID para que los hilos de un nucleo y los nucleos de un paquete queden seguidos, y los
+ * indices densos de su nucleo y su paquete:
+ *
+ *      uint32_t i = cpuid_apicmap_index(&map, apic_id);    // 2 accesos a memoria
+ *      contadores[i]++;                                      // array de map.n_entries
+ *
+ * De APIC ID a indice se pasa por una tabla de dos niveles (paginas de 256 IDs, solo las que
+ * tienen alguno), asi que la memoria depende de los IDs usados y no del mayor de ellos.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "cpuid_topology.h"
+
+#define CPUID_APICMAP_NONE       UINT32_MAX
+#define CPUID_APICMAP_PAGE_BITS  8
+
+typedef struct CPUID_H(apicmap_entry) {
+    uint32_t apic_id;
+    uint32_t cpu;           // numero de CPU del sistema operativo
+    uint32_t core;          // indice denso del nucleo, 0..n_cores-1
+    uint32_t package;       // indice denso del paquete, 0..n_packages-1
+} CPUID_H(apicmap_entry);
+
+typedef struct CPUID_H(apicmap) {
+    CPUID_H(apicmap_entry) *entries;    // por indice denso
+    uint32_t                n_entries;
+    uint32_t                n_cores;
+    uint32_t                n_packages;
+    uint32_t              **pages;      // pages[apic_id >> 8][apic_id & 0xff]: indice o CPUID_APICMAP_NONE
+    size_t                  n_pages;
+    uint32_t               *storage;    // memoria de todas las paginas
+    uint32_t               *by_cpu;     // by_cpu[cpu]: indice o CPUID_APICMAP_NONE
+    size_t                  n_by_cpu;
+} CPUID_H(apicmap);
+
+/*
+ * Construye la tabla con las CPU de la topologia que tienen APIC ID, nucleo y paquete.
+ * Devuelve 0, o -1 sin memoria o si dos CPU tienen el mismo APIC ID.
+ */
+int cpuid_apicmap_build(CPUID_H(apicmap) *map, const CPUID_H(topology) *topo);
+
+/*
+ * Construye la tabla con la topologia de CPUID de las CPU del mask de afinidad.
+ */
+int cpuid_apicmap_take(CPUID_H(apicmap) *map);
+
+void cpuid_apicmap_free(CPUID_H(apicmap) *map);
+
+static inline uint32_t cpuid_apicmap_index(const CPUID_H(apicmap) *map, uint32_t apic_id) {
+    size_t page = apic_id >> CPUID_APICMAP_PAGE_BITS;
+    if (page >= map->n_pages || map->pages[page] == NULL) return CPUID_APICMAP_NONE;
+    return map->pages[page][apic_id & ((1u << CPUID_APICMAP_PAGE_BITS) - 1)];
+}
+
+static inline uint32_t cpuid_apicmap_cpu_index(const CPUID_H(apicmap) *map, uint32_t cpu) {
+    return cpu < map->n_by_cpu ? map->by_cpu[cpu] : CPUID_APICMAP_NONE;
+}
+
+static inline const CPUID_H(apicmap_entry) *cpuid_apicmap_at(const CPUID_H(apicmap) *map, uint32_t index) {
+    return index < map->n_entries ? &map->entries[index] : NULL;
+}
+
+#include "cpuid_apicmap.c"
+#endif
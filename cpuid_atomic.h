@@ -0,0 +1,43 @@
+#ifndef __CPUID_ATOMIC_H__
+#define __CPUID_ATOMIC_H__
+
+/*
+ * Operaciones atomicas minimas usadas por los modulos de la libreria. Con GCC/Clang se usan
+ * los builtins __atomic (no dependen de <stdatomic.h>, que MSVC no tuvo hasta hace poco) y con
+ * MSVC las funciones Interlocked.
+ */
+
+#include <stdint.h>
+
+#if defined(_MSC_VER) && !defined(__GNUC__)
+    #include <intrin.h>
+    #define cpuid_atomic_fetch_add_u32(ptr, val) \
+        ((uint32_t)_InterlockedExchangeAdd((volatile long*)(ptr), (long)(val)))
+    #define cpuid_atomic_fetch_add_u64(ptr, val) \
+        ((uint64_t)_InterlockedExchangeAdd64((volatile long long*)(ptr), (long long)(val)))
+    #define cpuid_atomic_load_u32(ptr)           (*(volatile uint32_t*)(ptr))
+    // en 32 bits una lectura de 64 bits no es atomica: se hace con un CAS que no cambia nada
+    #define cpuid_atomic_load_u64(ptr)           ((uint64_t)_InterlockedCompareExchange64((volatile long long*)(ptr), 0, 0))
+    #define cpuid_atomic_store_u32(ptr, val)     _InterlockedExchange((volatile long*)(ptr), (long)(val))
+    // devuelve distinto de 0 si *ptr valia expected y se sustituyo por desired
+    #define cpuid_atomic_cas_u32(ptr, expected, desired) \
+        (_InterlockedCompareExchange((volatile long*)(ptr), (long)(desired), (long)(expected)) == (long)(expected))
+    // en x86 solo hace falta que el compilador no mueva los accesos a memoria
+    #define cpuid_atomic_fence_acquire()         _ReadWriteBarrier()
+    #define cpuid_atomic_fence_release()         _ReadWriteBarrier()
+#else
+    #define cpuid_atomic_fetch_add_u32(ptr, val) __atomic_fetch_add((ptr), (uint32_t)(val), __ATOMIC_RELAXED)
+    #define cpuid_atomic_fetch_add_u64(ptr, val) __atomic_fetch_add((ptr), (uint64_t)(val), __ATOMIC_RELAXED)
+    #define cpuid_atomic_load_u32(ptr)           __atomic_load_n((ptr), __ATOMIC_ACQUIRE)
+    #define cpuid_atomic_load_u64(ptr)           __atomic_load_n((ptr), __ATOMIC_RELAXED)
+    #define cpuid_atomic_store_u32(ptr, val)     __atomic_store_n((ptr), (uint32_t)(val), __ATOMIC_RELEASE)
+    #define cpuid_atomic_cas_u32(ptr, expected, desired) __extension__ ({ \
+        uint32_t cpuid_atomic_expected_ = (uint32_t)(expected);               \
+        __atomic_compare_exchange_n((ptr), &cpuid_atomic_expected_, (uint32_t)(desired), 0, \
+            __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);                              \
+    })
+    #define cpuid_atomic_fence_acquire()         __atomic_thread_fence(__ATOMIC_ACQUIRE)
+    #define cpuid_atomic_fence_release()         __atomic_thread_fence(__ATOMIC_RELEASE)
+#endif
+
+#endif
@@ -0,0 +1,335 @@
+#ifndef __CPUID_C2C_C__
+#define __CPUID_C2C_C__
+
+#include "cpuid_c2c.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <pthread.h>
+    #include <sched.h>
+#endif
+
+#define CPUID_C2C_SAMPLES     7         // muestras por par; se guarda la mediana
+#define CPUID_C2C_ROUND_TRIPS 1000
+#define CPUID_C2C_SPINS       (1u << 14) // vueltas de espera antes de ceder la CPU
+
+static const char *const cpuid_c2c_relation_names[CPUID_C2C_RELATIONS] = {
+    "-", "smt", "l2", "l3", "paquete", "remoto", "?"
+};
+
+const char *cpuid_c2c_relation_name(CPUID_H(c2c_relation) relation) {
+    return (unsigned)relation < CPUID_C2C_RELATIONS ? cpuid_c2c_relation_names[relation] : "?";
+}
+
+CPUID_H(c2c_relation) cpuid_c2c_classify(const CPUID_H(topology_cpu) *a, const CPUID_H(topology_cpu) *b) {
+    static const struct { CPUID_H(topology_field) field; CPUID_H(c2c_relation) relation; } levels[] = {
+        { CPUID_TOPO_CORE, CPUID_C2C_SMT }, { CPUID_TOPO_L2, CPUID_C2C_L2 },
+        { CPUID_TOPO_L3, CPUID_C2C_L3 },    { CPUID_TOPO_PACKAGE, CPUID_C2C_PACKAGE },
+    };
+    if (a == NULL || b == NULL) return CPUID_C2C_UNKNOWN;
+    if (a->cpu == b->cpu) return CPUID_C2C_SELF;
+
+    for (size_t i = 0; i < sizeof(levels) / sizeof(levels[0]); i++) {
+        uint32_t x = a->values[levels[i].field], y = b->values[levels[i].field];
+        if (x != CPUID_TOPO_UNKNOWN && x == y) return levels[i].relation;
+    }
+    uint32_t pa = a->values[CPUID_TOPO_PACKAGE], pb = b->values[CPUID_TOPO_PACKAGE];
+    return pa != CPUID_TOPO_UNKNOWN && pb != CPUID_TOPO_UNKNOWN ? CPUID_C2C_REMOTE : CPUID_C2C_UNKNOWN;
+}
+
+typedef struct cpuid_c2c_pair {
+    uint32_t a;                 // indices en cpus; a mide y b responde
+    uint32_t b;
+} cpuid_c2c_pair;
+
+typedef struct cpuid_c2c_job {
+    CPUID_H(c2c)   *c2c;
+    cpuid_c2c_pair *pairs;      // todos los pares, ronda tras ronda
+    size_t         *steps;      // steps[s]..steps[s + 1]: pares que se miden a la vez
+    size_t          n_steps;
+    uint32_t      **lines;      // una linea por par de un paso
+    uint32_t       *pinned;     // por hilo
+    unsigned        round_trips;
+    double          tsc_hz;
+    uint32_t        start;      // 1 para empezar, 2 para abandonar (atomico)
+    uint32_t        arrived;    // barrera entre pasos (atomicos)
+    uint32_t        generation;
+} cpuid_c2c_job;
+
+typedef struct cpuid_c2c_worker_arg {
+    cpuid_c2c_job *job;
+    uint32_t       index;
+} cpuid_c2c_worker_arg;
+
+static inline void cpuid_c2c_wait(unsigned *spins) {
+    if (++*spins < CPUID_C2C_SPINS) {
+#if defined(_MSC_VER) && !defined(__GNUC__)
+        _mm_pause();
+#else
+        __asm__ volatile ("pause");
+#endif
+        return;
+    }
+    *spins = 0;
+#ifdef _WIN32
+    SwitchToThread();
+#else
+    sched_yield();
+#endif
+}
+
+static void cpuid_c2c_barrier(cpuid_c2c_job *job) {
+    uint32_t generation = cpuid_atomic_load_u32(&job->generation);
+    unsigned spins      = 0;
+
+    cpuid_atomic_fence_release();
+    if (cpuid_atomic_fetch_add_u32(&job->arrived, 1) + 1 == job->c2c->n_cpus) {
+        cpuid_atomic_store_u32(&job->arrived, 0);
+        cpuid_atomic_store_u32(&job->generation, generation + 1);
+        return;
+    }
+    while (cpuid_atomic_load_u32(&job->generation) == generation) cpuid_c2c_wait(&spins);
+}
+
+static int cpuid_c2c_double_cmp(const void *a, const void *b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return x < y ? -1 : x > y;
+}
+
+// lado que mide: devuelve la mediana de la mitad de la ida y vuelta en nanosegundos
+static double cpuid_c2c_ping(cpuid_c2c_job *job, uint32_t *line) {
+    double   samples[CPUID_C2C_SAMPLES];
+    uint32_t k = 0;
+    unsigned spins = 0;
+
+    for (int s = 0; s < CPUID_C2C_SAMPLES; s++) {
+        // la primera ida sincroniza con el otro hilo y no se cuenta
+        while (!cpuid_atomic_cas_u32(line, 2 * k, 2 * k + 1)) cpuid_c2c_wait(&spins);
+        k++;
+        uint64_t begin = cpuid_tsc_read();
+        for (unsigned i = 0; i < job->round_trips; i++, k++) {
+            while (!cpuid_atomic_cas_u32(line, 2 * k, 2 * k + 1)) cpuid_c2c_wait(&spins);
+        }
+        uint64_t end = cpuid_tsc_read();
+        samples[s] = (double)(end - begin) * 1e9 / job->tsc_hz / (2.0 * job->round_trips);
+    }
+    // espera la ultima vuelta y deja la linea lista para el siguiente par
+    while (cpuid_atomic_load_u32(line) != 2 * k) cpuid_c2c_wait(&spins);
+    cpuid_atomic_store_u32(line, 0);
+
+    qsort(samples, CPUID_C2C_SAMPLES, sizeof(samples[0]), cpuid_c2c_double_cmp);
+    return samples[CPUID_C2C_SAMPLES / 2];
+}
+
+static void cpuid_c2c_pong(cpuid_c2c_job *job, uint32_t *line) {
+    uint32_t total = CPUID_C2C_SAMPLES * (job->round_trips + 1);
+    unsigned spins = 0;
+    for (uint32_t k = 0; k < total; k++) {
+        while (!cpuid_atomic_cas_u32(line, 2 * k + 1, 2 * k + 2)) cpuid_c2c_wait(&spins);
+    }
+}
+
+static void cpuid_c2c_run(cpuid_c2c_job *job, uint32_t self) {
+    CPUID_H(c2c) *c2c   = job->c2c;
+    unsigned      spins = 0;
+
+    while (cpuid_atomic_load_u32(&job->start) == 0) cpuid_c2c_wait(&spins);
+    if (cpuid_atomic_load_u32(&job->start) != 1) return;
+
+    job->pinned[self] = cpuid_pin_current_thread(c2c->cpus[self]) == 0;
+    cpuid_c2c_barrier(job);
+
+    for (size_t s = 0; s < job->n_steps; s++) {
+        for (size_t p = job->steps[s]; p < job->steps[s + 1]; p++) {
+            const cpuid_c2c_pair *pair = &job->pairs[p];
+            if ((pair->a != self && pair->b != self) || !job->pinned[pair->a] || !job->pinned[pair->b]) continue;
+
+            uint32_t *line = job->lines[p - job->steps[s]];
+            if (pair->a == self) {
+                double ns = cpuid_c2c_ping(job, line);
+                c2c->latency_ns[(size_t)pair->a * c2c->n_cpus + pair->b] = ns;
+                c2c->latency_ns[(size_t)pair->b * c2c->n_cpus + pair->a] = ns;
+            } else {
+                cpuid_c2c_pong(job, line);
+            }
+            break;
+        }
+        cpuid_c2c_barrier(job);
+    }
+}
+
+#ifdef _WIN32
+static DWORD WINAPI cpuid_c2c_worker(LPVOID arg) {
+    cpuid_c2c_run(((cpuid_c2c_worker_arg*)arg)->job, ((cpuid_c2c_worker_arg*)arg)->index);
+    return 0;
+}
+#else
+static void *cpuid_c2c_worker(void *arg) {
+    cpuid_c2c_run(((cpuid_c2c_worker_arg*)arg)->job, ((cpuid_c2c_worker_arg*)arg)->index);
+    return NULL;
+}
+#endif
+
+/*
+ * Torneo de todos contra todos por el metodo del circulo: el jugador m-1 queda fijo y los
+ * demas giran. Con n impar el jugador m-1 no existe y su rival descansa esa ronda.
+ */
+static size_t cpuid_c2c_schedule(uint32_t n, unsigned max_pairs, cpuid_c2c_pair *pairs, size_t *steps) {
+    uint32_t m       = n + (n & 1);
+    size_t   n_pairs = 0, n_steps = 0;
+
+    steps[0] = 0;
+    for (uint32_t r = 0; m >= 2 && r < m - 1; r++) {
+        size_t in_step = 0;
+        for (uint32_t i = 0; i < m / 2; i++) {
+            uint32_t a = i == 0 ? m - 1 : (r + i) % (m - 1);
+            uint32_t b = i == 0 ? r     : (r + m - 1 - i) % (m - 1);
+            if (a >= n || b >= n) continue;
+            if (max_pairs != 0 && in_step == max_pairs) {
+                steps[++n_steps] = n_pairs;
+                in_step = 0;
+            }
+            pairs[n_pairs].a = a < b ? a : b;
+            pairs[n_pairs].b = a < b ? b : a;
+            n_pairs++;
+            in_step++;
+        }
+        if (in_step != 0) steps[++n_steps] = n_pairs;
+    }
+    return n_steps;
+}
+
+int cpuid_c2c_measure(
+    CPUID_H(c2c) *c2c, const uint32_t *cpus, size_t n_cpus, const CPUID_H(topology) *topo,
+    unsigned max_pairs, unsigned round_trips
+) {
+    CPUID_H(topology)     own_topo = { 0 };
+    CPUID_H(snapshot)     snapshot = { 0 };
+    CPUID_H(arena)        arena;
+    cpuid_c2c_job         job      = { 0 };
+    cpuid_c2c_worker_arg *args     = NULL;
+    uint32_t             *own_cpus = NULL;
+    const CPUID_H(topology_cpu) **topo_cpus = NULL;     // entrada de topo de cada cpus[i]
+    int                   status   = -1;
+
+    memset(c2c, 0, sizeof(*c2c));
+    cpuid_arena_init(&arena, 0, 0);
+    if (cpus == NULL) {
+        n_cpus   = cpuid_affinity_cpus(NULL, 0);
+        own_cpus = malloc(sizeof(*own_cpus) * (n_cpus != 0 ? n_cpus : 1));
+        if (own_cpus == NULL) goto done;
+        size_t total = cpuid_affinity_cpus(own_cpus, n_cpus);
+        if (total < n_cpus) n_cpus = total;
+        cpus = own_cpus;
+    }
+    if (n_cpus == 0) goto done;
+
+    uint32_t n = (uint32_t)n_cpus;
+    size_t   n_pairs = (size_t)n * (n - 1) / 2;
+    c2c->n_cpus     = n;
+    c2c->cpus       = malloc(sizeof(*c2c->cpus) * n);
+    c2c->latency_ns = malloc(sizeof(*c2c->latency_ns) * n * n);
+    c2c->relation   = malloc(sizeof(*c2c->relation) * n * n);
+    job.pairs       = malloc(sizeof(*job.pairs) * (n_pairs != 0 ? n_pairs : 1));
+    job.steps       = malloc(sizeof(*job.steps) * (n_pairs + 1));
+    job.lines       = malloc(sizeof(*job.lines) * (n / 2 != 0 ? n / 2 : 1));
+    job.pinned      = calloc(n, sizeof(*job.pinned));
+    args            = malloc(sizeof(*args) * n);
+    topo_cpus       = malloc(sizeof(*topo_cpus) * n);
+    if (c2c->cpus == NULL || c2c->latency_ns == NULL || c2c->relation == NULL || job.pairs == NULL
+        || job.steps == NULL || job.lines == NULL || job.pinned == NULL || args == NULL
+        || topo_cpus == NULL) goto done;
+    memcpy(c2c->cpus, cpus, sizeof(*c2c->cpus) * n);
+
+    // relaciones segun la topologia
+    if (topo == NULL) {
+        if (cpuid_snapshot_take(&snapshot, NULL, 0, cpus, n, 0) < 0) goto done;
+        if (cpuid_topology_from_cpuid(&own_topo, &snapshot) != 0) goto done;
+        topo = &own_topo;
+    }
+    // cada CPU se busca una vez en topo, no una por par
+    for (uint32_t i = 0; i < n; i++) {
+        topo_cpus[i] = NULL;
+        for (size_t k = 0; k < topo->n_cpus && topo_cpus[i] == NULL; k++) {
+            if (topo->cpus[k].cpu == cpus[i]) topo_cpus[i] = &topo->cpus[k];
+        }
+    }
+    for (uint32_t i = 0; i < n; i++) {
+        for (uint32_t j = 0; j < n; j++) {
+            c2c->relation[(size_t)i * n + j]   = (uint8_t)(i == j ? CPUID_C2C_SELF : cpuid_c2c_classify(topo_cpus[i], topo_cpus[j]));
+            c2c->latency_ns[(size_t)i * n + j] = i == j ? 0 : -1;
+        }
+    }
+
+    job.c2c         = c2c;
+    job.n_steps     = cpuid_c2c_schedule(n, max_pairs, job.pairs, job.steps);
+    job.round_trips = round_trips != 0 ? round_trips : CPUID_C2C_ROUND_TRIPS;
+    job.tsc_hz      = cpuid_tsc_hz(100);
+    for (uint32_t i = 0; i < n / 2; i++) {
+        job.lines[i] = cpuid_arena_calloc(&arena, 1, sizeof(uint32_t));
+        if (job.lines[i] == NULL) goto done;
+    }
+
+    // el hilo que llama no participa: fijarlo cambiaria su afinidad
+    unsigned created = 0;
+#ifdef _WIN32
+    HANDLE    *threads = malloc(sizeof(*threads) * n);
+#else
+    pthread_t *threads = malloc(sizeof(*threads) * n);
+#endif
+    if (threads == NULL) goto done;
+    for (; created < n; created++) {
+        args[created].job   = &job;
+        args[created].index = created;
+#ifdef _WIN32
+        threads[created] = CreateThread(NULL, 0, cpuid_c2c_worker, &args[created], 0, NULL);
+        if (threads[created] == NULL) break;
+#else
+        if (pthread_create(&threads[created], NULL, cpuid_c2c_worker, &args[created]) != 0) break;
+#endif
+    }
+    // la barrera cuenta con todos los hilos: si falta alguno no se empieza
+    cpuid_atomic_store_u32(&job.start, created == n ? 1 : 2);
+    for (unsigned t = 0; t < created; t++) {
+#ifdef _WIN32
+        WaitForSingleObject(threads[t], INFINITE);
+        CloseHandle(threads[t]);
+#else
+        pthread_join(threads[t], NULL);
+#endif
+    }
+    free(threads);
+    if (created != n) goto done;
+
+    status = 0;
+    for (size_t p = 0; p < n_pairs; p++) {
+        if (c2c->latency_ns[(size_t)job.pairs[p].a * n + job.pairs[p].b] >= 0) status++;
+    }
+
+done:
+    if (status < 0) cpuid_c2c_free(c2c);
+    cpuid_topology_free(&own_topo);
+    cpuid_snapshot_free(&snapshot);
+    cpuid_arena_free(&arena);
+    free(job.pairs);
+    free(job.steps);
+    free(job.lines);
+    free(job.pinned);
+    free(args);
+    free(own_cpus);
+    free(topo_cpus);
+    return status;
+}
+
+void cpuid_c2c_free(CPUID_H(c2c) *c2c) {
+    free(c2c->cpus);
+    free(c2c->latency_ns);
+    free(c2c->relation);
+    memset(c2c, 0, sizeof(*c2c));
+}
+
+#endif
@@ -0,0 +1,79 @@
+#ifndef __CPUID_C2C_H__
+#define __CPUID_C2C_H__
+
+/*
+ * Latencia de traspaso de una linea de cache entre cada par de CPU.
+ *
+ * La topologia dice que CPU comparten nucleo, L2, L3 o paquete, pero no cuanto cuesta que una
+ * linea pase de una a otra (en un mismo paquete puede variar segun la distancia en el anillo
+ * o la malla). Para cada par se fijan dos hilos, uno en cada CPU, que se pasan la linea con
+ * CAS: el primero cambia el valor de 2k a 2k+1 y el segundo de 2k+1 a 2k+2, asi que cada ida
+ * y vuelta son dos traspasos de la linea; la latencia es la mitad de la ida y vuelta (mediana
+ * de varias muestras, en ciclos del TSC pasados a ns con cpuid_tsc_hz).
+ *
+ * Los pares se miden en paralelo: con un torneo de todos contra todos (metodo del circulo)
+ * cada una de las n-1 rondas forma n/2 pares disjuntos, que se miden a la vez, cada uno con su
+ * propia linea en su propio bloque de cpuid_alloc_interference_size(). max_pairs limita
+ * cuantos pares se miden a la vez (1 para medir de uno en uno, sin la interferencia de los
+ * demas en el anillo o la malla).
+ *
+ * Cada CPU tiene un hilo propio fijado en ella durante toda la medida. Si hay menos CPU
+ * fisicas que hilos (una VM sobrecomprometida) las esperas ceden la CPU tras un rato girando.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "cpuid_alloc.h"
+#include "cpuid_atomic.h"
+#include "cpuid_percpu.h"
+#include "cpuid_topology.h"
+#include "cpuid_tsc.h"
+
+typedef enum CPUID_H(c2c_relation) {
+    CPUID_C2C_SELF = 0,
+    CPUID_C2C_SMT,              // hilos del mismo nucleo
+    CPUID_C2C_L2,               // nucleos que comparten L2 (modulo o cluster)
+    CPUID_C2C_L3,               // nucleos que comparten L3 (CCX)
+    CPUID_C2C_PACKAGE,          // mismo paquete, distinta L3
+    CPUID_C2C_REMOTE,           // otro paquete
+    CPUID_C2C_UNKNOWN,
+    CPUID_C2C_RELATIONS
+} CPUID_H(c2c_relation);
+
+typedef struct CPUID_H(c2c) {
+    uint32_t  n_cpus;
+    uint32_t *cpus;             // numero de CPU de cada fila y columna
+    double   *latency_ns;       // latency_ns[i * n_cpus + j], 0 en la diagonal, -1 sin medir
+    uint8_t  *relation;         // CPUID_H(c2c_relation) de cada par, mismo orden
+} CPUID_H(c2c);
+
+// nombre corto de la relacion ("smt", "l2", "l3", "paquete", "remoto", ...)
+const char *cpuid_c2c_relation_name(CPUID_H(c2c_relation) relation);
+
+// relacion entre dos CPU segun sus campos de topologia
+CPUID_H(c2c_relation) cpuid_c2c_classify(const CPUID_H(topology_cpu) *a, const CPUID_H(topology_cpu) *b);
+
+/*
+ * Mide la matriz de las n_cpus CPU de cpus (NULL usa el mask de afinidad). topo da las
+ * relaciones (NULL usa la topologia de CPUID de esas CPU); max_pairs = 0 mide todos los pares
+ * de cada ronda a la vez; round_trips = 0 usa 1000 idas y vueltas por muestra.
+ * Devuelve el numero de pares medidos, o -1 sin memoria o si no se pudieron crear los hilos.
+ */
+int  cpuid_c2c_measure(
+    CPUID_H(c2c) *c2c, const uint32_t *cpus, size_t n_cpus, const CPUID_H(topology) *topo,
+    unsigned max_pairs, unsigned round_trips
+);
+
+void cpuid_c2c_free(CPUID_H(c2c) *c2c);
+
+static inline double cpuid_c2c_latency(const CPUID_H(c2c) *c2c, uint32_t i, uint32_t j) {
+    return c2c->latency_ns[(size_t)i * c2c->n_cpus + j];
+}
+
+static inline CPUID_H(c2c_relation) cpuid_c2c_relation_at(const CPUID_H(c2c) *c2c, uint32_t i, uint32_t j) {
+    return (CPUID_H(c2c_relation))c2c->relation[(size_t)i * c2c->n_cpus + j];
+}
+
+#include "cpuid_c2c.c"
+#endif
@@ -0,0 +1,74 @@
+#ifndef __CPUID_CURRENT_C__
+#define __CPUID_CURRENT_C__
+
+#include "cpuid_current.h"
+
+#define CPUID_CURRENT_TRIES 8   // intentos de comparar TSC_AUX con el sistema sin migrar entre medias
+
+uint32_t cpuid_current_selected = CPUID_CURRENT_NONE;
+
+const char *cpuid_current_method_name(CPUID_H(current_method) method) {
+    switch (method) {
+        case CPUID_CURRENT_RDPID:  return "rdpid";
+        case CPUID_CURRENT_RDTSCP: return "rdtscp";
+        case CPUID_CURRENT_OS:     return "os";
+        default:                   return "none";
+    }
+}
+
+// bit de CPUID, comprobando antes que la hoja existe
+static int cpuid_current_cpuid_bit(uint32_t leaf, int reg, uint32_t bit) {
+    uint32_t r[4];
+    call_cpuid(leaf & 0x80000000, 0, &r[0], &r[1], &r[2], &r[3]);
+    if (r[0] < leaf) return 0;
+    call_cpuid(leaf, 0, &r[0], &r[1], &r[2], &r[3]);
+    return (r[reg] >> bit) & 1;
+}
+
+/*
+ * Comprueba que el numero de CPU de TSC_AUX es el que da el sistema. Si el hilo migra entre
+ * las dos consultas al sistema se repite la comparacion.
+ */
+static int cpuid_current_aux_matches(CPUID_H(current_method) method) {
+#if defined(_WIN32) || defined(__linux__)
+    for (int i = 0; i < CPUID_CURRENT_TRIES; i++) {
+        uint32_t before = cpuid_current_os();
+        uint32_t aux    = cpuid_current_cpu_with(method);
+        uint32_t after  = cpuid_current_os();
+        if (before == after) return aux == before;
+    }
+#else
+    (void)method;
+#endif
+    return 0;
+}
+
+int cpuid_current_supported(CPUID_H(current_method) method) {
+    switch (method) {
+        case CPUID_CURRENT_RDPID:
+            return cpuid_current_cpuid_bit(0x00000007, 2, 22) && cpuid_current_aux_matches(method);
+        case CPUID_CURRENT_RDTSCP:
+            return cpuid_current_cpuid_bit(0x80000001, 3, 27) && cpuid_current_aux_matches(method);
+        case CPUID_CURRENT_OS:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+CPUID_H(current_method) cpuid_current_init(void) {
+    uint32_t selected = cpuid_atomic_load_u32(&cpuid_current_selected);
+    if (selected != CPUID_CURRENT_NONE) return (CPUID_H(current_method))selected;
+
+    CPUID_H(current_method) method = CPUID_CURRENT_OS;
+    if      (cpuid_current_supported(CPUID_CURRENT_RDPID))  method = CPUID_CURRENT_RDPID;
+    else if (cpuid_current_supported(CPUID_CURRENT_RDTSCP)) method = CPUID_CURRENT_RDTSCP;
+
+    // si otro hilo eligio antes se usa el suyo
+    if (!cpuid_atomic_cas_u32(&cpuid_current_selected, CPUID_CURRENT_NONE, method)) {
+        return (CPUID_H(current_method))cpuid_atomic_load_u32(&cpuid_current_selected);
+    }
+    return method;
+}
+
+#endif
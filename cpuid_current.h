@@ -0,0 +1,122 @@
+#ifndef __CPUID_CURRENT_H__
+#define __CPUID_CURRENT_H__
+
+/*
+ * CPU logica en la que se ejecuta el hilo, en pocos nanosegundos, para indexar contadores y
+ * reservas por CPU.
+ *
+ * Leer el APIC ID con CPUID (hoja 1 o 0Bh) es lento y dentro de una VM provoca una salida al
+ * hipervisor, y sched_getcpu pasa por el vDSO. En su lugar se usa, por orden:
+ *
+ *  - RDPID (CPUID.7.0:ECX[22]): lee IA32_TSC_AUX sin leer el TSC.
+ *  - RDTSCP (CPUID.80000001h:EDX[27]): lee IA32_TSC_AUX ademas del TSC.
+ *  - el sistema operativo: sched_getcpu en Linux, GetCurrentProcessorNumber en Windows.
+ *
+ * Linux guarda en TSC_AUX el numero de CPU en los bits 11:0 (y el nodo NUMA a partir del bit
+ * 12); otros sistemas no garantizan nada, asi que RDPID/RDTSCP solo se usan si al iniciar
+ * coinciden con lo que dice el sistema. El metodo se elige una vez en cpuid_current_init (que
+ * cpuid_current_cpu llama si hace falta) y despues cada llamada es un switch y una instruccion.
+ *
+ * El resultado puede estar obsoleto en cuanto se devuelve (el hilo puede migrar), asi que
+ * solo sirve para repartir carga: el acceso al fragmento de la CPU debe seguir siendo atomico.
+ */
+
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
+#include <stdint.h>
+
+#include "cpuid.h"
+#include "cpuid_atomic.h"
+
+#if defined(_MSC_VER) && !defined(__GNUC__)
+    #include <intrin.h>
+#endif
+
+#ifdef _WIN32
+    #include <windows.h>
+#elif defined(__linux__)
+    #include <sched.h>
+#endif
+
+typedef enum CPUID_H(current_method) {
+    CPUID_CURRENT_NONE   = 0,   // todavia sin elegir
+    CPUID_CURRENT_RDPID  = 1,
+    CPUID_CURRENT_RDTSCP = 2,
+    CPUID_CURRENT_OS     = 3,   // en sistemas sin llamada para ello devuelve siempre 0
+} CPUID_H(current_method);
+
+#define CPUID_CURRENT_AUX_CPU_MASK 0xfffu   // bits de TSC_AUX con el numero de CPU en Linux
+
+// metodo elegido por cpuid_current_init (un CPUID_H(current_method)), CPUID_CURRENT_NONE hasta entonces
+extern uint32_t cpuid_current_selected;
+
+/*
+ * Elige el metodo la primera vez y lo devuelve; nunca devuelve CPUID_CURRENT_NONE. Se puede
+ * llamar desde varios hilos a la vez: todos eligen el mismo.
+ */
+CPUID_H(current_method) cpuid_current_init(void);
+
+// nombre del metodo ("rdpid", "rdtscp", "os" o "none")
+const char *cpuid_current_method_name(CPUID_H(current_method) method);
+
+// devuelve distinto de 0 si el procesador y el sistema permiten usar el metodo
+int cpuid_current_supported(CPUID_H(current_method) method);
+
+// TSC_AUX con RDPID; solo si cpuid_current_supported(CPUID_CURRENT_RDPID)
+static inline uint32_t cpuid_current_rdpid(void) {
+#if defined(_MSC_VER) && !defined(__GNUC__)
+    return _rdpid_u32();
+#else
+    uintptr_t aux;
+    // rdpid rax/eax, codificado a mano para ensambladores que no la conocen
+    __asm__ volatile (".byte 0xf3, 0x0f, 0xc7, 0xf8" : "=a" (aux));
+    return (uint32_t)aux;
+#endif
+}
+
+// TSC_AUX con RDTSCP; solo si cpuid_current_supported(CPUID_CURRENT_RDTSCP)
+static inline uint32_t cpuid_current_rdtscp(void) {
+#if defined(_MSC_VER) && !defined(__GNUC__)
+    unsigned int aux;
+    (void)__rdtscp(&aux);
+    return aux;
+#else
+    uint32_t lo, hi, aux;
+    __asm__ volatile ("rdtscp" : "=a" (lo), "=d" (hi), "=c" (aux));
+    (void)lo; (void)hi;
+    return aux;
+#endif
+}
+
+static inline uint32_t cpuid_current_os(void) {
+#ifdef _WIN32
+    return (uint32_t)GetCurrentProcessorNumber();
+#elif defined(__linux__)
+    int cpu = sched_getcpu();
+    return cpu >= 0 ? (uint32_t)cpu : 0;
+#else
+    return 0;
+#endif
+}
+
+// CPU actual con un metodo concreto (para comparar metodos); el metodo debe estar soportado
+static inline uint32_t cpuid_current_cpu_with(CPUID_H(current_method) method) {
+    switch (method) {
+        case CPUID_CURRENT_RDPID:  return cpuid_current_rdpid()  & CPUID_CURRENT_AUX_CPU_MASK;
+        case CPUID_CURRENT_RDTSCP: return cpuid_current_rdtscp() & CPUID_CURRENT_AUX_CPU_MASK;
+        case CPUID_CURRENT_OS:     return cpuid_current_os();
+        default:                   return 0;
+    }
+}
+
+// numero de CPU logica del sistema operativo en la que se ejecuta el hilo
+static inline uint32_t cpuid_current_cpu(void) {
+    CPUID_H(current_method) method = (CPUID_H(current_method))cpuid_atomic_load_u32(&cpuid_current_selected);
+    if (method == CPUID_CURRENT_NONE) method = cpuid_current_init();
+    return cpuid_current_cpu_with(method);
+}
+
+#include "cpuid_current.c"
+#endif
@@ -0,0 +1,235 @@
+#ifndef __CPUID_DIFF_C__
+#define __CPUID_DIFF_C__
+
+#include "cpuid_diff.h"
+
+#include <string.h>
+
+// campo con nombre dentro de un registro de una hoja (subhoja 0)
+typedef struct CPUID_H(diff_field) {
+    uint32_t    leaf;
+    uint8_t     reg;
+    uint8_t     shift;
+    uint8_t     width;
+    const char *name;
+} CPUID_H(diff_field);
+
+#define CPUID_DIFF_FIELD_EAX1(name, shift, width) { CPUID_GETFEATURES,   CPUID_DIFF_EAX, shift, width, #name },
+#define CPUID_DIFF_FIELD_EBX1(name, shift, width) { CPUID_GETFEATURES,   CPUID_DIFF_EBX, shift, width, #name },
+#define CPUID_DIFF_FIELD_ECX1(name, bit)          { CPUID_GETFEATURES,   CPUID_DIFF_ECX, bit,   1,     #name },
+#define CPUID_DIFF_FIELD_EDX1(name, bit)          { CPUID_GETFEATURES,   CPUID_DIFF_EDX, bit,   1,     #name },
+#define CPUID_DIFF_FIELD_EBX7(name, bit)          { 0x07,                CPUID_DIFF_EBX, bit,   1,     #name },
+#define CPUID_DIFF_FIELD_ECX7(name, bit)          { 0x07,                CPUID_DIFF_ECX, bit,   1,     #name },
+#define CPUID_DIFF_FIELD_EDX7(name, bit)          { 0x07,                CPUID_DIFF_EDX, bit,   1,     #name },
+#define CPUID_DIFF_FIELD_ECX_EXT(name, bit)       { CPUID_INTELFEATURES, CPUID_DIFF_ECX, bit,   1,     #name },
+#define CPUID_DIFF_FIELD_EDX_EXT(name, bit)       { CPUID_INTELFEATURES, CPUID_DIFF_EDX, bit,   1,     #name },
+static const CPUID_H(diff_field) cpuid_diff_field_table[] = {
+    { CPUID_GETVENDORSTRING, CPUID_DIFF_EAX, 0, 32, "max_leaf" },
+    { CPUID_GETVENDORSTRING, CPUID_DIFF_EBX, 0, 32, "vendor"   },
+    { CPUID_GETVENDORSTRING, CPUID_DIFF_ECX, 0, 32, "vendor"   },
+    { CPUID_GETVENDORSTRING, CPUID_DIFF_EDX, 0, 32, "vendor"   },
+    CPUID_PROCESSOR_INFO_FIELDS(CPUID_DIFF_FIELD_EAX1)
+    CPUID_ADDITIONAL_INFO_FIELDS(CPUID_DIFF_FIELD_EBX1)
+    CPUID_FEAT_ECX_FIELDS(CPUID_DIFF_FIELD_ECX1)
+    CPUID_FEAT_EDX_FIELDS(CPUID_DIFF_FIELD_EDX1)
+    CPUID_FEAT7_EBX_FIELDS(CPUID_DIFF_FIELD_EBX7)
+    CPUID_FEAT7_ECX_FIELDS(CPUID_DIFF_FIELD_ECX7)
+    CPUID_FEAT7_EDX_FIELDS(CPUID_DIFF_FIELD_EDX7)
+    { CPUID_INTELEXTENDED,   CPUID_DIFF_EAX, 0, 32, "max_extended_leaf" },
+    CPUID_FEAT_EXT_ECX_FIELDS(CPUID_DIFF_FIELD_ECX_EXT)
+    CPUID_FEAT_EXT_EDX_FIELDS(CPUID_DIFF_FIELD_EDX_EXT)
+};
+#undef CPUID_DIFF_FIELD_EAX1
+#undef CPUID_DIFF_FIELD_EBX1
+#undef CPUID_DIFF_FIELD_ECX1
+#undef CPUID_DIFF_FIELD_EDX1
+#undef CPUID_DIFF_FIELD_EBX7
+#undef CPUID_DIFF_FIELD_ECX7
+#undef CPUID_DIFF_FIELD_EDX7
+#undef CPUID_DIFF_FIELD_ECX_EXT
+#undef CPUID_DIFF_FIELD_EDX_EXT
+
+#define CPUID_DIFF_N_FIELDS (sizeof(cpuid_diff_field_table) / sizeof(cpuid_diff_field_table[0]))
+
+static inline uint32_t cpuid_diff_field_mask(const CPUID_H(diff_field) *field) {
+    return (field->width == 32 ? 0xffffffffu : ((1u << field->width) - 1)) << field->shift;
+}
+
+uint32_t cpuid_diff_variant_mask(uint32_t leaf, CPUID_H(diff_register) reg) {
+    switch (leaf) {
+        case 0x01:          // EBX[31:24]: APIC ID inicial
+            return reg == CPUID_DIFF_EBX ? 0xff000000u : 0;
+        case 0x0B:          // EDX: x2APIC ID del procesador logico
+        case 0x1F:
+        case 0x80000026:
+            return reg == CPUID_DIFF_EDX ? 0xffffffffu : 0;
+        case 0x1A:          // EAX: tipo de nucleo en procesadores hibridos
+            return reg == CPUID_DIFF_EAX ? 0xffffffffu : 0;
+        case 0x8000001E:    // EAX: APIC ID extendido, EBX[7:0]: core/compute unit, ECX[7:0]: nodo
+            if (reg == CPUID_DIFF_EAX) return 0xffffffffu;
+            if (reg == CPUID_DIFF_EBX || reg == CPUID_DIFF_ECX) return 0xffu;
+            return 0;
+    }
+    return 0;
+}
+
+static inline int cpuid_diff_order(const CPUID_H(record) *a, const CPUID_H(record) *b) {
+    if (a->leaf    != b->leaf)    return a->leaf    < b->leaf    ? -1 : 1;
+    if (a->subleaf != b->subleaf) return a->subleaf < b->subleaf ? -1 : 1;
+    return 0;
+}
+
+static inline void cpuid_diff_push(
+    CPUID_H(diff) *out, size_t max, size_t *total,
+    const CPUID_H(record) *r, uint32_t reg, uint32_t kind, uint32_t a, uint32_t b
+) {
+    if (*total < max) {
+        CPUID_H(diff) *d = &out[*total];
+        d->leaf    = r->leaf;
+        d->subleaf = r->subleaf;
+        d->reg     = reg;
+        d->kind    = kind;
+        d->a       = a;
+        d->b       = b;
+        d->mask    = a ^ b;
+    }
+    (*total)++;
+}
+
+// las 4 entradas de una hoja que solo esta en una de las tablas
+static void cpuid_diff_push_only(
+    CPUID_H(diff) *out, size_t max, size_t *total, const CPUID_H(record) *r, uint32_t kind, unsigned flags
+) {
+    const uint32_t regs[4] = { r->eax, r->ebx, r->ecx, r->edx };
+    for (uint32_t reg = 0; reg < 4; reg++) {
+        uint32_t value = regs[reg];
+        if (flags & CPUID_DIFF_NORMALIZE) value &= ~cpuid_diff_variant_mask(r->leaf, (CPUID_H(diff_register))reg);
+        cpuid_diff_push(out, max, total, r, reg, kind, kind == CPUID_DIFF_ONLY_A ? value : 0, kind == CPUID_DIFF_ONLY_B ? value : 0);
+    }
+}
+
+size_t cpuid_diff_records(
+    const CPUID_H(record) *a, size_t n_a,
+    const CPUID_H(record) *b, size_t n_b,
+    unsigned flags, CPUID_H(diff) *out, size_t max
+) {
+    size_t i = 0, j = 0, total = 0;
+
+    while (i < n_a || j < n_b) {
+        // los registros que no se pudieron ejecutar cuentan como ausentes
+        if (i < n_a && a[i].status != CPUID_RECORD_OK) { i++; continue; }
+        if (j < n_b && b[j].status != CPUID_RECORD_OK) { j++; continue; }
+
+        int order = (i == n_a) ? 1 : (j == n_b) ? -1 : cpuid_diff_order(&a[i], &b[j]);
+        if (order < 0) {
+            cpuid_diff_push_only(out, max, &total, &a[i++], CPUID_DIFF_ONLY_A, flags);
+            continue;
+        }
+        if (order > 0) {
+            cpuid_diff_push_only(out, max, &total, &b[j++], CPUID_DIFF_ONLY_B, flags);
+            continue;
+        }
+
+        const CPUID_H(record) *ra = &a[i++], *rb = &b[j++];
+        const uint32_t va[4] = { ra->eax, ra->ebx, ra->ecx, ra->edx };
+        const uint32_t vb[4] = { rb->eax, rb->ebx, rb->ecx, rb->edx };
+        // camino rapido: la gran mayoria de hojas son identicas
+        if (memcmp(va, vb, sizeof(va)) == 0) continue;
+
+        for (uint32_t reg = 0; reg < 4; reg++) {
+            uint32_t x = va[reg], y = vb[reg];
+            if (x == y) continue;
+            if (flags & CPUID_DIFF_NORMALIZE) {
+                uint32_t keep = ~cpuid_diff_variant_mask(ra->leaf, (CPUID_H(diff_register))reg);
+                x &= keep;
+                y &= keep;
+                if (x == y) continue;
+            }
+            cpuid_diff_push(out, max, &total, ra, reg, CPUID_DIFF_CHANGED, x, y);
+        }
+    }
+    return total;
+}
+
+size_t cpuid_diff_snapshots(
+    const CPUID_H(snapshot) *a, const CPUID_H(snapshot) *b,
+    unsigned flags, CPUID_H(diff) *out, size_t max
+) {
+    return cpuid_diff_records(
+        a->records, a->n_cpus != 0 ? a->n_leaves : 0,
+        b->records, b->n_cpus != 0 ? b->n_leaves : 0,
+        flags, out, max
+    );
+}
+
+size_t cpuid_diff_fields(const CPUID_H(diff) *diff, const char **names, size_t max) {
+    size_t total = 0;
+    if (diff->subleaf != 0) return 0;
+    for (size_t k = 0; k < CPUID_DIFF_N_FIELDS; k++) {
+        const CPUID_H(diff_field) *field = &cpuid_diff_field_table[k];
+        if (field->leaf != diff->leaf || field->reg != diff->reg) continue;
+        if ((diff->mask & cpuid_diff_field_mask(field)) == 0) continue;
+        // vendor ocupa tres registros: un nombre por registro distinto
+        if (total < max) names[total] = field->name;
+        total++;
+    }
+    return total;
+}
+
+void cpuid_diff_render(CPUID_H(sink) *sink, const CPUID_H(diff) *diffs, size_t n) {
+    static const char *const reg_names[4] = { " eax ", " ebx ", " ecx ", " edx " };
+
+    for (size_t i = 0; i < n; i++) {
+        const CPUID_H(diff) *d = &diffs[i];
+        uint32_t covered = 0;
+
+        cpuid_sink_hex(sink, d->leaf, 8);
+        cpuid_sink_putc(sink, '.');
+        cpuid_sink_hex(sink, d->subleaf, 8);
+        cpuid_sink_write(sink, reg_names[d->reg & 3], 5);
+
+        if (d->kind == CPUID_DIFF_ONLY_B) cpuid_sink_write(sink, "(ausente)", 9);
+        else                              cpuid_sink_hex(sink, d->a, 8);
+        cpuid_sink_write(sink, " -> ", 4);
+        if (d->kind == CPUID_DIFF_ONLY_A) cpuid_sink_write(sink, "(ausente)", 9);
+        else                              cpuid_sink_hex(sink, d->b, 8);
+
+        if (d->kind == CPUID_DIFF_CHANGED) {
+            // campos con nombre de cpuid.h
+            for (size_t k = 0; d->subleaf == 0 && k < CPUID_DIFF_N_FIELDS; k++) {
+                const CPUID_H(diff_field) *field = &cpuid_diff_field_table[k];
+                uint32_t mask = cpuid_diff_field_mask(field);
+                if (field->leaf != d->leaf || field->reg != d->reg || (d->mask & mask) == 0) continue;
+                covered |= mask;
+
+                cpuid_sink_putc(sink, ' ');
+                cpuid_sink_puts(sink, field->name);
+                cpuid_sink_putc(sink, ' ');
+                if (field->width == 1) {
+                    cpuid_sink_putc(sink, (char)('0' + ((d->a >> field->shift) & 1)));
+                    cpuid_sink_write(sink, " -> ", 4);
+                    cpuid_sink_putc(sink, (char)('0' + ((d->b >> field->shift) & 1)));
+                } else {
+                    cpuid_sink_write(sink, "0x", 2);
+                    cpuid_sink_hex(sink, (d->a & mask) >> field->shift, 1);
+                    cpuid_sink_write(sink, " -> 0x", 6);
+                    cpuid_sink_hex(sink, (d->b & mask) >> field->shift, 1);
+                }
+            }
+            // el resto de bits, por numero
+            for (int bit = 0; bit < 32; bit++) {
+                if (!((d->mask & ~covered) >> bit & 1)) continue;
+                cpuid_sink_write(sink, " bit ", 5);
+                if (bit >= 10) cpuid_sink_putc(sink, (char)('0' + bit / 10));
+                cpuid_sink_putc(sink, (char)('0' + bit % 10));
+                cpuid_sink_putc(sink, ' ');
+                cpuid_sink_putc(sink, (char)('0' + ((d->a >> bit) & 1)));
+                cpuid_sink_write(sink, " -> ", 4);
+                cpuid_sink_putc(sink, (char)('0' + ((d->b >> bit) & 1)));
+            }
+        }
+        cpuid_sink_putc(sink, '\n');
+    }
+}
+
+#endif
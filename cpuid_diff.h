@@ -0,0 +1,98 @@
+#ifndef __CPUID_DIFF_H__
+#define __CPUID_DIFF_H__
+
+/*
+ * Diferencias entre dos tablas de registros de CPUID (dos hosts, o el mismo host antes y
+ * despues de una actualizacion de microcodigo o de una migracion en vivo).
+ *
+ * La comparacion es una mezcla lineal de las dos tablas, que deben estar ordenadas por hoja
+ * y subhoja (el orden de cpuid_snapshot_default_leaves), y genera una entrada por registro
+ * distinto. Con CPUID_DIFF_NORMALIZE se ignoran los campos que dependen del procesador logico
+ * que ejecuto CPUID (APIC ID, x2APIC ID, tipo de nucleo hibrido, ...), asi dos CPU o dos hosts
+ * iguales no aparecen como distintos. Las diferencias se traducen a los nombres de campos y
+ * caracteristicas de cpuid.h (CPUID_FEAT_*_FIELDS, CPUID_PROCESSOR_INFO_FIELDS, ...) con
+ * cpuid_diff_fields o cpuid_diff_render.
+ *
+ * No reserva memoria: el llamador da la tabla de salida.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "cpuid_snapshot.h"
+
+typedef enum CPUID_H(diff_flags) {
+    CPUID_DIFF_RAW       = 0,
+    CPUID_DIFF_NORMALIZE = 1 << 0, // ignora los campos que varian entre procesadores logicos
+} CPUID_H(diff_flags);
+
+typedef enum CPUID_H(diff_register) {
+    CPUID_DIFF_EAX = 0,
+    CPUID_DIFF_EBX = 1,
+    CPUID_DIFF_ECX = 2,
+    CPUID_DIFF_EDX = 3,
+} CPUID_H(diff_register);
+
+typedef enum CPUID_H(diff_kind) {
+    CPUID_DIFF_CHANGED = 0, // la hoja esta en las dos tablas con valores distintos
+    CPUID_DIFF_ONLY_A  = 1, // solo esta en a (o en b no se pudo ejecutar); b vale 0
+    CPUID_DIFF_ONLY_B  = 2, // solo esta en b; a vale 0
+} CPUID_H(diff_kind);
+
+typedef struct CPUID_H(diff) {
+    uint32_t leaf;
+    uint32_t subleaf;
+    uint32_t reg;      // CPUID_H(diff_register)
+    uint32_t kind;     // CPUID_H(diff_kind)
+    uint32_t a;        // valor en a (normalizado si se pidio)
+    uint32_t b;        // valor en b (normalizado si se pidio)
+    uint32_t mask;     // bits distintos, a ^ b
+} CPUID_H(diff);
+
+/*
+ * Compara dos tablas de registros de una CPU cada una (ordenadas por hoja y subhoja).
+ * Las hojas que solo estan en una tabla generan las 4 entradas de sus registros.
+ * Los registros con estado distinto de CPUID_RECORD_OK cuentan como ausentes.
+ *
+ * Escribe como maximo max entradas en out y devuelve el total, que puede ser mayor que max
+ * (0 si las tablas son iguales).
+ */
+size_t cpuid_diff_records(
+    const CPUID_H(record) *a, size_t n_a,
+    const CPUID_H(record) *b, size_t n_b,
+    unsigned flags, CPUID_H(diff) *out, size_t max
+);
+
+/*
+ * Compara la primera CPU de cada snapshot (con CPUID_DIFF_NORMALIZE cualquier CPU representa al host).
+ */
+size_t cpuid_diff_snapshots(
+    const CPUID_H(snapshot) *a, const CPUID_H(snapshot) *b,
+    unsigned flags, CPUID_H(diff) *out, size_t max
+);
+
+/*
+ * Bits de un registro que dependen del procesador logico (los que ignora CPUID_DIFF_NORMALIZE).
+ */
+uint32_t cpuid_diff_variant_mask(uint32_t leaf, CPUID_H(diff_register) reg);
+
+/*
+ * Nombres de los campos con nombre conocido (hojas 0, 1, 7 y 80000000h-80000001h) afectados por una
+ * diferencia. Escribe como maximo max nombres y devuelve el total. Los bits que no
+ * pertenecen a ningun campo conocido no se cuentan.
+ */
+size_t cpuid_diff_fields(const CPUID_H(diff) *diff, const char **names, size_t max);
+
+/*
+ * Una linea por diferencia:
+ *
+ *      00000001.00000000 ecx 7ffa3203 -> fffa3203 HYPERVISOR 0 -> 1
+ *      00000001.00000000 eax 000806f8 -> 000806f7 Stepping_ID 0x8 -> 0x7
+ *      00000007.00000000 ebx f1bf27eb -> f1bf27ea FSGSBASE 1 -> 0
+ *      00000006.00000000 eax 00000077 -> 00000075 bit 1 1 -> 0
+ *      0000001f.00000003 eax 00000000 -> (ausente)
+ */
+void cpuid_diff_render(CPUID_H(sink) *sink, const CPUID_H(diff) *diffs, size_t n);
+
+#include "cpuid_diff.c"
+#endif
@@ -0,0 +1,317 @@
+#ifndef __CPUID_FEATURES_C__
+#define __CPUID_FEATURES_C__
+
+#include "cpuid_features.h"
+
+#include <string.h>
+
+#define CPUID_FEATURE_1_ECX(name, bit)    { CPUID_GETFEATURES,   0, CPUID_DIFF_ECX, bit, #name },
+#define CPUID_FEATURE_1_EDX(name, bit)    { CPUID_GETFEATURES,   0, CPUID_DIFF_EDX, bit, #name },
+#define CPUID_FEATURE_7_EBX(name, bit)    { 0x07,                0, CPUID_DIFF_EBX, bit, #name },
+#define CPUID_FEATURE_7_ECX(name, bit)    { 0x07,                0, CPUID_DIFF_ECX, bit, #name },
+#define CPUID_FEATURE_7_EDX(name, bit)    { 0x07,                0, CPUID_DIFF_EDX, bit, #name },
+#define CPUID_FEATURE_7_1_EAX(name, bit)  { 0x07,                1, CPUID_DIFF_EAX, bit, #name },
+#define CPUID_FEATURE_EXT_ECX(name, bit)  { CPUID_INTELFEATURES, 0, CPUID_DIFF_ECX, bit, #name },
+#define CPUID_FEATURE_EXT_EDX(name, bit)  { CPUID_INTELFEATURES, 0, CPUID_DIFF_EDX, bit, #name },
+#define CPUID_FEATURE_D_1_EAX(name, bit)  { 0x0D,                1, CPUID_DIFF_EAX, bit, #name },
+#define CPUID_FEATURE_EXT8_EBX(name, bit) { 0x80000008,          0, CPUID_DIFF_EBX, bit, #name },
+static const CPUID_H(feature) cpuid_feature_table[] = {
+    CPUID_FEAT_EDX_FIELDS(CPUID_FEATURE_1_EDX)
+    CPUID_FEAT_ECX_FIELDS(CPUID_FEATURE_1_ECX)
+    CPUID_FEAT7_EBX_FIELDS(CPUID_FEATURE_7_EBX)
+    CPUID_FEAT7_ECX_FIELDS(CPUID_FEATURE_7_ECX)
+    CPUID_FEAT7_EDX_FIELDS(CPUID_FEATURE_7_EDX)
+    CPUID_FEAT7_1_EAX_FIELDS(CPUID_FEATURE_7_1_EAX)
+    CPUID_FEATD_1_EAX_FIELDS(CPUID_FEATURE_D_1_EAX)
+    CPUID_FEAT_EXT_ECX_FIELDS(CPUID_FEATURE_EXT_ECX)
+    CPUID_FEAT_EXT_EDX_FIELDS(CPUID_FEATURE_EXT_EDX)
+    CPUID_FEAT_EXT8_EBX_FIELDS(CPUID_FEATURE_EXT8_EBX)
+};
+#undef CPUID_FEATURE_1_ECX
+#undef CPUID_FEATURE_1_EDX
+#undef CPUID_FEATURE_7_EBX
+#undef CPUID_FEATURE_7_ECX
+#undef CPUID_FEATURE_7_EDX
+#undef CPUID_FEATURE_7_1_EAX
+#undef CPUID_FEATURE_EXT_ECX
+#undef CPUID_FEATURE_EXT_EDX
+#undef CPUID_FEATURE_D_1_EAX
+#undef CPUID_FEATURE_EXT8_EBX
+
+#define CPUID_FEATURES_N (sizeof(cpuid_feature_table) / sizeof(cpuid_feature_table[0]))
+_Static_assert(CPUID_FEATURES_N <= CPUID_FEATURESET_WORDS * 64, "CPUID_FEATURESET_WORDS es demasiado pequeno");
+
+size_t cpuid_features_count(void) {
+    return CPUID_FEATURES_N;
+}
+
+const CPUID_H(feature) *cpuid_feature_at(size_t id) {
+    return id < CPUID_FEATURES_N ? &cpuid_feature_table[id] : NULL;
+}
+
+static int cpuid_features_same_name(const char *a, const char *b) {
+    for (;; a++, b++) {
+        char x = *a, y = *b;
+        if (x >= 'a' && x <= 'z') x = (char)(x - 'a' + 'A');
+        if (y >= 'a' && y <= 'z') y = (char)(y - 'a' + 'A');
+        if (x != y)     return 0;
+        if (x == '\0')  return 1;
+    }
+}
+
+int cpuid_feature_find(const char *name) {
+    for (size_t id = 0; id < CPUID_FEATURES_N; id++) {
+        if (cpuid_features_same_name(cpuid_feature_table[id].name, name)) return (int)id;
+    }
+    return -1;
+}
+
+static inline uint32_t cpuid_features_reg(const CPUID_H(record) *r, uint8_t reg) {
+    switch (reg) {
+        case CPUID_DIFF_EAX: return r->eax;
+        case CPUID_DIFF_EBX: return r->ebx;
+        case CPUID_DIFF_ECX: return r->ecx;
+        default:             return r->edx;
+    }
+}
+
+static const CPUID_H(record) *cpuid_features_find_record(
+    const CPUID_H(record) *block, size_t n, uint32_t leaf, uint32_t subleaf
+) {
+    for (size_t j = 0; j < n; j++) {
+        if (block[j].leaf == leaf && block[j].subleaf == subleaf) {
+            return block[j].status == CPUID_RECORD_OK ? &block[j] : NULL;
+        }
+    }
+    return NULL;
+}
+
+void cpuid_features_decode(const CPUID_H(record) *block, size_t n, CPUID_H(featureset) *set) {
+    memset(set, 0, sizeof(*set));
+
+    // la tabla esta agrupada por hoja y subhoja: se busca cada registro una sola vez
+    const CPUID_H(record) *r = NULL;
+    for (size_t id = 0; id < CPUID_FEATURES_N; id++) {
+        const CPUID_H(feature) *f = &cpuid_feature_table[id];
+        if (r == NULL || r->leaf != f->leaf || r->subleaf != f->subleaf) {
+            r = cpuid_features_find_record(block, n, f->leaf, f->subleaf);
+        }
+        if (r != NULL && (cpuid_features_reg(r, f->reg) >> f->bit) & 1) {
+            set->bits[id / 64] |= 1ull << (id % 64);
+        }
+    }
+}
+
+int cpuid_featureset_has(const CPUID_H(featureset) *set, const char *name) {
+    for (size_t id = 0; id < CPUID_FEATURES_N; id++) {
+        if (cpuid_featureset_test(set, id) && cpuid_features_same_name(cpuid_feature_table[id].name, name)) return 1;
+    }
+    return 0;
+}
+
+// 1 si el area de XSAVE de los componentes activos llega al final del componente
+static int cpuid_features_state_enabled(const CPUID_H(record) *block, size_t n, uint32_t component) {
+    const CPUID_H(record) *area  = cpuid_features_find_record(block, n, 0x0D, 0);
+    const CPUID_H(record) *state = cpuid_features_find_record(block, n, 0x0D, component);
+    if (area == NULL) return 1;
+    if (state == NULL || state->eax == 0) return 0;
+    return (uint64_t)state->ebx + state->eax <= area->ebx;
+}
+
+// quita las caracteristicas cuyo estado no guarda el sistema operativo
+static void cpuid_features_mask_state(CPUID_H(featureset) *set, int avx, int avx512, int amx) {
+    // instrucciones con codificacion VEX o EVEX, que necesitan el estado de AVX
+    static const char *const vex[] = { "FMA", "F16C", "VAES", "VPCLMULQDQ", "XOP", "FMA4" };
+
+    for (size_t id = 0; id < CPUID_FEATURES_N; id++) {
+        const char *name = cpuid_feature_table[id].name;
+        int         drop = 0;
+        if (strncmp(name, "AVX512", 6) == 0) {
+            drop = !avx512;
+        } else if (strncmp(name, "AMX_", 4) == 0) {
+            drop = !amx;
+        } else if (strncmp(name, "AVX", 3) == 0) {
+            drop = !avx;
+        } else {
+            for (size_t k = 0; k < sizeof(vex) / sizeof(vex[0]); k++) {
+                if (strcmp(name, vex[k]) == 0) drop = !avx;
+            }
+        }
+        if (drop) set->bits[id / 64] &= ~(1ull << (id % 64));
+    }
+}
+
+void cpuid_features_usable(const CPUID_H(record) *block, size_t n, CPUID_H(featureset) *set) {
+    cpuid_features_decode(block, n, set);
+
+    int avx = cpuid_featureset_has(set, "OSXSAVE") && cpuid_features_state_enabled(block, n, 2);
+    cpuid_features_mask_state(set,
+        avx,
+        avx && cpuid_features_state_enabled(block, n, 7),
+        avx && cpuid_features_state_enabled(block, n, 18)
+    );
+}
+
+void cpuid_features_current(CPUID_H(featureset) *set) {
+    static const uint32_t leaves[][2] = {
+        { 0x01, 0 }, { 0x07, 0 }, { 0x07, 1 }, { 0x0D, 1 },
+        { CPUID_INTELFEATURES, 0 }, { 0x80000008, 0 },
+    };
+    CPUID_H(record) block[sizeof(leaves) / sizeof(leaves[0])];
+    size_t          n = 0;
+    uint32_t        eax, ebx, ecx, edx;
+
+    call_cpuid(CPUID_GETVENDORSTRING, 0, &eax, &ebx, &ecx, &edx);
+    uint32_t max_basic = eax;
+    call_cpuid(CPUID_INTELEXTENDED, 0, &eax, &ebx, &ecx, &edx);
+    uint32_t max_ext = (eax & 0xffff0000) == CPUID_INTELEXTENDED ? eax : 0;
+
+    for (size_t k = 0; k < sizeof(leaves) / sizeof(leaves[0]); k++) {
+        uint32_t leaf = leaves[k][0];
+        if (leaf < CPUID_INTELEXTENDED ? leaf > max_basic : leaf > max_ext) continue;
+        memset(&block[n], 0, sizeof(block[n]));
+        block[n].leaf    = leaf;
+        block[n].subleaf = leaves[k][1];
+        call_cpuid(leaf, leaves[k][1], &block[n].eax, &block[n].ebx, &block[n].ecx, &block[n].edx);
+        n++;
+    }
+    cpuid_features_decode(block, n, set);
+
+    uint64_t xcr0 = cpuid_featureset_has(set, "OSXSAVE") ? call_xgetbv(0) : 0;
+    cpuid_features_mask_state(set,
+        (xcr0 & 0x06) == 0x06,          // SSE y AVX
+        (xcr0 & 0xe6) == 0xe6,          // y opmask, ZMM0-15 altos y ZMM16-31
+        (xcr0 & 0x60006) == 0x60006     // y TILECFG y TILEDATA
+    );
+}
+
+// 12 caracteres de un fabricante: hasta el primer '\0' y sin espacios a los lados
+static void cpuid_features_vendor(char out[13], uint32_t a, uint32_t b, uint32_t c) {
+    char text[12];
+    memcpy(text + 0, &a, 4);
+    memcpy(text + 4, &b, 4);
+    memcpy(text + 8, &c, 4);
+
+    size_t end = 0;
+    while (end < sizeof(text) && text[end] != '\0') end++;
+    size_t begin = 0;
+    while (begin < end && text[begin] == ' ') begin++;
+    while (end > begin && text[end - 1] == ' ') end--;
+
+    memcpy(out, text + begin, end - begin);
+    out[end - begin] = '\0';
+}
+
+// tamano en KiB de una cache descrita con el formato de CPUID EAX=4 (el mismo que 8000001Dh)
+static inline uint32_t cpuid_features_cache_kb(const CPUID_H(record) *r) {
+    uint64_t ways       = (r->ebx >> 22) + 1;
+    uint64_t partitions = ((r->ebx >> 12) & 0x3ff) + 1;
+    uint64_t line       = (r->ebx & 0xfff) + 1;
+    uint64_t sets       = (uint64_t)r->ecx + 1;
+    return (uint32_t)(ways * partitions * line * sets / 1024);
+}
+
+void cpuid_host_info_decode(const CPUID_H(record) *block, size_t n, CPUID_H(host_info) *info) {
+    uint32_t l3_share      = 0;     // procesadores logicos que comparten una L3
+    uint32_t topo_threads  = 0;     // de la hoja 0Bh o 1Fh (1Fh tiene prioridad)
+    uint32_t topo_smt      = 0;
+    uint32_t topo_leaf     = 0;
+    uint32_t legacy_threads = 0;    // CPUID.1:EBX[23:16] o 80000008h:ECX[7:0] + 1
+    uint32_t amd_smt       = 0;     // 8000001Eh:EBX[15:8] + 1
+    uint32_t ext_l2_kb     = 0;     // 80000006h, solo si no hay hoja 4 ni 8000001Dh
+    uint32_t ext_l3_kb     = 0;
+    int      hypervisor    = 0;
+
+    memset(info, 0, sizeof(*info));
+
+    for (size_t j = 0; j < n; j++) {
+        const CPUID_H(record) *r = &block[j];
+        if (r->status != CPUID_RECORD_OK) continue;
+
+        switch (r->leaf) {
+            case CPUID_GETVENDORSTRING:
+                cpuid_features_vendor(info->vendor, r->ebx, r->edx, r->ecx);
+                break;
+
+            case CPUID_GETFEATURES: {
+                Processor_Info_and_Feature_Bits proc;
+                memcpy(&proc, &r->eax, sizeof(proc));
+                info->family   = proc.Family_ID;
+                info->model    = proc.Model;
+                info->stepping = proc.Stepping_ID;
+                if (proc.Family_ID == 0xf) info->family += proc.Extended_Family_ID;
+                if (proc.Family_ID == 0x6 || proc.Family_ID == 0xf) info->model += (uint32_t)proc.Extended_Model_ID << 4;
+                // HTT: EBX[23:16] es el numero de IDs de procesador logico del paquete
+                legacy_threads = (r->edx >> 28) & 1 ? (r->ebx >> 16) & 0xff : 1;
+                hypervisor     = (int)((r->ecx >> 31) & 1);
+                break;
+            }
+
+            case 0x04:
+            case 0x8000001D: {
+                uint32_t type  = r->eax & 0x1f;
+                uint32_t level = (r->eax >> 5) & 0x7;
+                if (type == 0 || type == 2) break;      // sin cache o de instrucciones
+                if (level == 2 && info->l2_kb == 0) info->l2_kb = cpuid_features_cache_kb(r);
+                if (level == 3 && info->l3_kb == 0) {
+                    info->l3_kb = cpuid_features_cache_kb(r);
+                    l3_share    = ((r->eax >> 14) & 0xfff) + 1;
+                }
+                break;
+            }
+
+            case 0x0B:
+            case 0x1F: {
+                uint32_t type  = (r->ecx >> 8) & 0xff;
+                uint32_t count = r->ebx & 0xffff;
+                if (type == 0 || count == 0) break;
+                if (topo_leaf != r->leaf) {
+                    if (topo_leaf == 0x1F) break;      // ya hay datos de 1Fh
+                    topo_leaf    = r->leaf;
+                    topo_threads = 0;
+                    topo_smt     = 0;
+                }
+                // EBX cuenta los procesadores logicos hasta este nivel: el ultimo nivel es el paquete
+                if (type == 1) topo_smt = count;
+                topo_threads = count;
+                break;
+            }
+
+            case 0x40000000:
+                if (hypervisor) cpuid_features_vendor(info->hypervisor, r->ebx, r->ecx, r->edx);
+                break;
+
+            case 0x80000006:
+                // AMD y Zhaoxin: L2 en ECX[31:16] KiB y L3 en EDX[31:18] * 512 KiB
+                ext_l2_kb = r->ecx >> 16;
+                ext_l3_kb = (r->edx >> 18) * 512;
+                break;
+
+            case 0x80000008:
+                if ((r->ecx & 0xff) != 0) legacy_threads = (r->ecx & 0xff) + 1;
+                break;
+
+            case 0x8000001E:
+                amd_smt = ((r->ebx >> 8) & 0xff) + 1;
+                break;
+        }
+    }
+
+    if (info->l2_kb == 0) info->l2_kb = ext_l2_kb;
+    if (info->l3_kb == 0) info->l3_kb = ext_l3_kb;
+
+    if (topo_threads != 0) {
+        info->threads = topo_threads;
+        info->cores   = topo_threads / (topo_smt != 0 ? topo_smt : 1);
+    } else {
+        info->threads = legacy_threads != 0 ? legacy_threads : 1;
+        info->cores   = info->threads / (amd_smt != 0 ? amd_smt : 1);
+    }
+    if (info->cores == 0) info->cores = 1;
+
+    // l3_share esta redondeado a potencia de 2: se redondea hacia abajo el numero de instancias
+    uint32_t instances = l3_share != 0 ? info->threads / l3_share : 1;
+    info->l3_total_kb  = info->l3_kb * (instances != 0 ? instances : 1);
+}
+
+#endif
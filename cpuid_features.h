@@ -0,0 +1,101 @@
+#ifndef __CPUID_FEATURES_H__
+#define __CPUID_FEATURES_H__
+
+/*
+ * Decodificacion de un bloque de registros de una CPU (el formato de cpuid_snapshot.h, ordenado
+ * por hoja y subhoja) a datos que se pueden comparar entre hosts sin volver a mirar los registros:
+ *
+ *  - un conjunto de bits con una entrada por caracteristica con nombre de cpuid.h
+ *    (CPUID_FEAT_*_FIELDS de las hojas 1, 7.0, 7.1, 0Dh.1, 80000001h y 80000008h), y
+ *  - los datos numericos del procesador que se usan para planificar (familia, modelo, caches,
+ *    procesadores logicos y nucleos por paquete) y los fabricantes de CPU y de hipervisor.
+ *
+ * Un mismo nombre puede aparecer en varias hojas (TSC en 1:ECX y 1:EDX, NX en 1:EDX y
+ * 80000001h:EDX): cpuid_feature_find devuelve la primera entrada y cpuid_featureset_has
+ * mira todas las que tienen ese nombre.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "cpuid_diff.h"
+
+#define CPUID_FEATURESET_WORDS 4    // 256 caracteristicas como maximo
+
+typedef struct CPUID_H(feature) {
+    uint32_t    leaf;
+    uint32_t    subleaf;
+    uint8_t     reg;       // CPUID_H(diff_register)
+    uint8_t     bit;
+    const char *name;
+} CPUID_H(feature);
+
+typedef struct CPUID_H(featureset) {
+    uint64_t bits[CPUID_FEATURESET_WORDS];  // bit i = caracteristica i de cpuid_feature_at
+} CPUID_H(featureset);
+
+typedef struct CPUID_H(host_info) {
+    char     vendor[13];       // CPUID EAX=0
+    char     hypervisor[13];   // CPUID EAX=40000000h sin espacios a los lados, "" si no hay
+    uint32_t family;           // familia y modelo "visibles" (con los campos extendidos)
+    uint32_t model;
+    uint32_t stepping;
+    uint32_t l2_kb;            // una instancia de la cache (la de un nucleo)
+    uint32_t l3_kb;            // una instancia de la L3 (por paquete en Intel, por CCX en AMD)
+    uint32_t l3_total_kb;      // L3 de todo el paquete (l3_kb por el numero de instancias)
+    uint32_t threads;          // procesadores logicos por paquete
+    uint32_t cores;            // nucleos por paquete
+} CPUID_H(host_info);
+
+/*
+ * Tabla de caracteristicas con nombre. Los identificadores son los indices de la tabla
+ * y son estables mientras no cambien las listas de cpuid.h.
+ */
+size_t cpuid_features_count(void);
+const CPUID_H(feature) *cpuid_feature_at(size_t id);
+
+/*
+ * Primer identificador con ese nombre (sin distinguir mayusculas), o -1.
+ */
+int cpuid_feature_find(const char *name);
+
+/*
+ * Rellena set con las caracteristicas activas en el bloque. Las hojas que no estan en el
+ * bloque (o no se pudieron ejecutar) cuentan como ceros.
+ */
+void cpuid_features_decode(const CPUID_H(record) *block, size_t n, CPUID_H(featureset) *set);
+
+/*
+ * Como cpuid_features_decode, pero solo con las caracteristicas que un programa puede usar:
+ * las de AVX (AVX, AVX2, FMA, F16C, VAES, ...) y AVX-512 se quitan si el sistema operativo
+ * no guarda su estado en los cambios de contexto. Eso se deduce de OSXSAVE y del tamano del
+ * area de XSAVE para los componentes activos en XCR0 (CPUID.0Dh.0:EBX), que tiene que cubrir
+ * el componente de AVX (0Dh.2), el ultimo de AVX-512 (0Dh.7) o el de AMX (0Dh.18).
+ * Sin la hoja 0Dh basta OSXSAVE.
+ */
+void cpuid_features_usable(const CPUID_H(record) *block, size_t n, CPUID_H(featureset) *set);
+
+/*
+ * Caracteristicas que puede usar el programa en la CPU actual: ejecuta las hojas de la tabla y
+ * mira los componentes activos en XCR0 con XGETBV en lugar de deducirlos de la hoja 0Dh.
+ * En Linux AMX ademas necesita que el proceso lo pida con arch_prctl(ARCH_REQ_XCOMP_PERM).
+ */
+void cpuid_features_current(CPUID_H(featureset) *set);
+
+static inline int cpuid_featureset_test(const CPUID_H(featureset) *set, size_t id) {
+    return (int)((set->bits[id / 64] >> (id % 64)) & 1);
+}
+
+/*
+ * 1 si alguna de las caracteristicas con ese nombre esta activa.
+ */
+int cpuid_featureset_has(const CPUID_H(featureset) *set, const char *name);
+
+/*
+ * Rellena info a partir de las hojas 0, 1, 4, 0Bh/1Fh, 40000000h y 8000000xh del bloque.
+ * Los datos que el bloque no permite calcular quedan a 0.
+ */
+void cpuid_host_info_decode(const CPUID_H(record) *block, size_t n, CPUID_H(host_info) *info);
+
+#include "cpuid_features.c"
+#endif
@@ -0,0 +1,967 @@
+#ifndef __CPUID_INDEX_C__
+#define __CPUID_INDEX_C__
+
+#include "cpuid_index.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define CPUID_INDEX_MMAP 1
+#endif
+
+// contenido de un bloque: los mismos valores que refs para vacio y lleno
+#define CPUID_INDEX_REF_EMPTY   0
+#define CPUID_INDEX_REF_FULL    1
+#define CPUID_INDEX_REF_LITERAL 2
+
+typedef struct CPUID_H(index_field) {
+    const char *name;
+    size_t      offset;     // en CPUID_H(host_info)
+} CPUID_H(index_field);
+
+static const CPUID_H(index_field) cpuid_index_numeric[] = {
+    { "family",      offsetof(CPUID_H(host_info), family)      },
+    { "model",       offsetof(CPUID_H(host_info), model)       },
+    { "stepping",    offsetof(CPUID_H(host_info), stepping)    },
+    { "l2_kb",       offsetof(CPUID_H(host_info), l2_kb)       },
+    { "l3_kb",       offsetof(CPUID_H(host_info), l3_kb)       },
+    { "l3_total_kb", offsetof(CPUID_H(host_info), l3_total_kb) },
+    { "threads",     offsetof(CPUID_H(host_info), threads)     },
+    { "cores",       offsetof(CPUID_H(host_info), cores)       },
+};
+
+static const CPUID_H(index_field) cpuid_index_categories[] = {
+    { "vendor",     offsetof(CPUID_H(host_info), vendor)     },
+    { "hypervisor", offsetof(CPUID_H(host_info), hypervisor) },
+};
+
+#define CPUID_INDEX_N_NUMERIC    (sizeof(cpuid_index_numeric) / sizeof(cpuid_index_numeric[0]))
+#define CPUID_INDEX_N_CATEGORIES (sizeof(cpuid_index_categories) / sizeof(cpuid_index_categories[0]))
+
+/*
+ * Construccion
+ */
+
+// columna en construccion y como saber si un perfil la cumple
+typedef struct CPUID_H(index_column_def) {
+    CPUID_H(index_column) column;
+    CPUID_H(featureset)   mask;      // CPUID_INDEX_FEATURE: caracteristicas con ese nombre
+    size_t                offset;    // CPUID_INDEX_CATEGORY y CPUID_INDEX_SLICE: campo de host_info
+    size_t                value;     // CPUID_INDEX_CATEGORY: posicion del valor en name
+} CPUID_H(index_column_def);
+
+static int cpuid_index_profile_has(const CPUID_H(index_column_def) *def, const CPUID_H(index_profile) *profile) {
+    const char *field = (const char *)&profile->info + def->offset;
+
+    switch (def->column.kind) {
+        case CPUID_INDEX_FEATURE:
+            for (size_t w = 0; w < CPUID_FEATURESET_WORDS; w++) {
+                if (profile->features.bits[w] & def->mask.bits[w]) return 1;
+            }
+            return 0;
+        case CPUID_INDEX_CATEGORY:
+            return strcmp(def->column.name + def->value, field) == 0;
+        default: {
+            uint32_t value;
+            memcpy(&value, field, sizeof(value));
+            return (int)((value >> def->column.slice) & 1);
+        }
+    }
+}
+
+static CPUID_H(index_column_def) *cpuid_index_find_def(
+    CPUID_H(index_column_def) *defs, size_t n, uint32_t kind, const char *name
+) {
+    for (size_t i = 0; i < n; i++) {
+        if (defs[i].column.kind == kind && strcmp(defs[i].column.name, name) == 0) return &defs[i];
+    }
+    return NULL;
+}
+
+static CPUID_H(index_column_def) *cpuid_index_columns(
+    const CPUID_H(index_profile) *profiles, size_t n_profiles, size_t *n_out
+) {
+    size_t cap = cpuid_features_count() + n_profiles * CPUID_INDEX_N_CATEGORIES + CPUID_INDEX_N_NUMERIC * 32;
+    CPUID_H(index_column_def) *defs = calloc(cap, sizeof(*defs));
+    size_t n = 0;
+    if (defs == NULL) return NULL;
+
+    // una columna por nombre de caracteristica
+    for (size_t id = 0; id < cpuid_features_count(); id++) {
+        const char *name = cpuid_feature_at(id)->name;
+        if (strcmp(name, "RESERVADO") == 0) continue;
+
+        CPUID_H(index_column_def) *def = cpuid_index_find_def(defs, n, CPUID_INDEX_FEATURE, name);
+        if (def == NULL) {
+            def = &defs[n++];
+            snprintf(def->column.name, sizeof(def->column.name), "%s", name);
+            def->column.kind = CPUID_INDEX_FEATURE;
+        }
+        def->mask.bits[id / 64] |= 1ull << (id % 64);
+    }
+
+    // una columna por valor distinto de cada categoria
+    for (size_t f = 0; f < CPUID_INDEX_N_CATEGORIES; f++) {
+        for (size_t p = 0; p < n_profiles; p++) {
+            const char *value = (const char *)&profiles[p].info + cpuid_index_categories[f].offset;
+            char        name[CPUID_INDEX_NAME_MAX];
+            if (value[0] == '\0') continue;
+            snprintf(name, sizeof(name), "%s=%s", cpuid_index_categories[f].name, value);
+            if (cpuid_index_find_def(defs, n, CPUID_INDEX_CATEGORY, name) != NULL) continue;
+
+            CPUID_H(index_column_def) *def = &defs[n++];
+            memcpy(def->column.name, name, sizeof(name));
+            def->column.kind = CPUID_INDEX_CATEGORY;
+            def->offset      = cpuid_index_categories[f].offset;
+            def->value       = strlen(cpuid_index_categories[f].name) + 1;
+        }
+    }
+
+    // campos numericos: tantos slices como bits tiene el mayor valor (al menos uno)
+    for (size_t f = 0; f < CPUID_INDEX_N_NUMERIC; f++) {
+        uint32_t max = 0;
+        for (size_t p = 0; p < n_profiles; p++) {
+            uint32_t value;
+            memcpy(&value, (const char *)&profiles[p].info + cpuid_index_numeric[f].offset, sizeof(value));
+            if (value > max) max = value;
+        }
+        uint32_t width = 1;
+        while (width < 32 && (max >> width) != 0) width++;
+
+        for (uint32_t k = 0; k < width; k++) {
+            CPUID_H(index_column_def) *def = &defs[n++];
+            snprintf(def->column.name, sizeof(def->column.name), "%s", cpuid_index_numeric[f].name);
+            def->column.kind  = CPUID_INDEX_SLICE;
+            def->column.slice = k;
+            def->offset       = cpuid_index_numeric[f].offset;
+        }
+    }
+
+    *n_out = n;
+    return defs;
+}
+
+// literales distintos con una tabla hash de direccionamiento abierto (0 libre, k + 1 literal k)
+typedef struct CPUID_H(index_literals) {
+    uint64_t *words;
+    size_t    n;
+    size_t    cap;
+    uint32_t *table;
+    size_t    table_cap;    // potencia de 2
+} CPUID_H(index_literals);
+
+static inline uint64_t cpuid_index_hash(const uint64_t *words) {
+    uint64_t h = 0;
+    for (size_t i = 0; i < CPUID_INDEX_CHUNK_WORDS; i++) {
+        h = (h ^ words[i]) * 0x9e3779b97f4a7c15ULL;
+        h ^= h >> 29;
+    }
+    return h;
+}
+
+static int cpuid_index_rehash(CPUID_H(index_literals) *lit, size_t table_cap) {
+    uint32_t *table = calloc(table_cap, sizeof(*table));
+    if (table == NULL) return -1;
+    for (size_t k = 0; k < lit->n; k++) {
+        size_t i = (size_t)cpuid_index_hash(lit->words + k * CPUID_INDEX_CHUNK_WORDS) & (table_cap - 1);
+        while (table[i] != 0) i = (i + 1) & (table_cap - 1);
+        table[i] = (uint32_t)(k + 1);
+    }
+    free(lit->table);
+    lit->table     = table;
+    lit->table_cap = table_cap;
+    return 0;
+}
+
+// devuelve el numero del literal, o -1 sin memoria
+static long cpuid_index_intern(CPUID_H(index_literals) *lit, const uint64_t *words) {
+    const size_t bytes = sizeof(uint64_t) * CPUID_INDEX_CHUNK_WORDS;
+
+    if ((lit->n + 1) * 4 > lit->table_cap * 3) {
+        if (cpuid_index_rehash(lit, lit->table_cap != 0 ? lit->table_cap * 2 : 1024) != 0) return -1;
+    }
+    size_t mask = lit->table_cap - 1;
+    size_t i    = (size_t)cpuid_index_hash(words) & mask;
+    for (; lit->table[i] != 0; i = (i + 1) & mask) {
+        size_t k = lit->table[i] - 1;
+        if (memcmp(lit->words + k * CPUID_INDEX_CHUNK_WORDS, words, bytes) == 0) return (long)k;
+    }
+
+    if (lit->n == lit->cap) {
+        size_t    cap   = lit->cap != 0 ? lit->cap * 2 : 256;
+        uint64_t *grown = realloc(lit->words, cap * bytes);
+        if (grown == NULL) return -1;
+        lit->words = grown;
+        lit->cap   = cap;
+    }
+    memcpy(lit->words + lit->n * CPUID_INDEX_CHUNK_WORDS, words, bytes);
+    lit->table[i] = (uint32_t)(lit->n + 1);
+    return (long)lit->n++;
+}
+
+// bits [begin, end) de un bloque
+static void cpuid_index_set_range(uint64_t *words, size_t begin, size_t end) {
+    while (begin < end) {
+        size_t   w    = begin / 64;
+        size_t   bit  = begin % 64;
+        size_t   n    = end - begin < 64 - bit ? end - begin : 64 - bit;
+        uint64_t mask = n == 64 ? ~0ull : ((1ull << n) - 1) << bit;
+        words[w] |= mask;
+        begin    += n;
+    }
+}
+
+typedef struct CPUID_H(index_run) {
+    uint32_t profile;
+    uint32_t begin;     // filas del bloque [begin, end)
+    uint32_t end;
+} CPUID_H(index_run);
+
+static int cpuid_index_pad(FILE *file, uint64_t *pos, uint64_t to) {
+    static const char zeros[64] = { 0 };
+    while (*pos < to) {
+        size_t n = to - *pos < sizeof(zeros) ? (size_t)(to - *pos) : sizeof(zeros);
+        if (fwrite(zeros, 1, n, file) != n) return -1;
+        *pos += n;
+    }
+    return 0;
+}
+
+static int cpuid_index_put(FILE *file, uint64_t *pos, const void *data, size_t len) {
+    if (len != 0 && fwrite(data, 1, len, file) != len) return -1;
+    *pos += len;
+    return 0;
+}
+
+#define CPUID_INDEX_ALIGN(x, a) (((x) + (a) - 1) / (a) * (a))
+
+int cpuid_index_write(
+    const char *path,
+    const char *const *names, const uint32_t *row_profile, size_t n_rows,
+    const CPUID_H(index_profile) *profiles, size_t n_profiles
+) {
+    CPUID_H(index_column_def) *defs    = NULL;
+    uint64_t                  *member  = NULL;
+    uint32_t                  *refs    = NULL;
+    uint32_t                  *offsets = NULL;
+    CPUID_H(index_run)        *runs    = NULL;
+    CPUID_H(index_literals)    lit     = { 0 };
+    char                      *tmp     = NULL;
+    FILE                      *file    = NULL;
+    size_t                     n_columns;
+    int                        result  = -1;
+
+    if (n_rows > UINT32_MAX) return -1;
+    for (size_t r = 0; r < n_rows; r++) {
+        if (row_profile[r] >= n_profiles) return -1;
+    }
+
+    defs = cpuid_index_columns(profiles, n_profiles, &n_columns);
+    if (defs == NULL) goto done;
+
+    // columnas que cumple cada perfil
+    size_t col_words = (n_columns + 63) / 64;
+    member = calloc(n_profiles * col_words + 1, sizeof(*member));
+    if (member == NULL) goto done;
+    for (size_t p = 0; p < n_profiles; p++) {
+        for (size_t c = 0; c < n_columns; c++) {
+            if (cpuid_index_profile_has(&defs[c], &profiles[p])) member[p * col_words + c / 64] |= 1ull << (c % 64);
+        }
+    }
+
+    size_t n_chunks = (n_rows + CPUID_INDEX_CHUNK_ROWS - 1) / CPUID_INDEX_CHUNK_ROWS;
+    refs = malloc(sizeof(*refs) * (n_chunks * n_columns + 1));
+    runs = malloc(sizeof(*runs) * CPUID_INDEX_CHUNK_ROWS);
+    if (refs == NULL || runs == NULL) goto done;
+
+    for (size_t chunk = 0; chunk < n_chunks; chunk++) {
+        size_t first = chunk * CPUID_INDEX_CHUNK_ROWS;
+        size_t rows  = n_rows - first < CPUID_INDEX_CHUNK_ROWS ? n_rows - first : CPUID_INDEX_CHUNK_ROWS;
+        size_t n_runs = 0;
+
+        // filas seguidas con el mismo perfil
+        for (size_t r = 0; r < rows; r++) {
+            uint32_t p = row_profile[first + r];
+            if (n_runs != 0 && runs[n_runs - 1].profile == p) {
+                runs[n_runs - 1].end++;
+            } else {
+                runs[n_runs].profile = p;
+                runs[n_runs].begin   = (uint32_t)r;
+                runs[n_runs].end     = (uint32_t)r + 1;
+                n_runs++;
+            }
+        }
+
+        for (size_t c = 0; c < n_columns; c++) {
+            size_t set = 0;
+            for (size_t k = 0; k < n_runs; k++) {
+                if ((member[runs[k].profile * col_words + c / 64] >> (c % 64)) & 1) set += runs[k].end - runs[k].begin;
+            }
+
+            uint32_t ref;
+            if (set == 0) {
+                ref = CPUID_INDEX_REF_EMPTY;
+            } else if (set == rows) {
+                // en el ultimo bloque "lleno" son todas las filas que existen
+                ref = CPUID_INDEX_REF_FULL;
+            } else {
+                uint64_t words[CPUID_INDEX_CHUNK_WORDS] = { 0 };
+                for (size_t k = 0; k < n_runs; k++) {
+                    if ((member[runs[k].profile * col_words + c / 64] >> (c % 64)) & 1) {
+                        cpuid_index_set_range(words, runs[k].begin, runs[k].end);
+                    }
+                }
+                long k = cpuid_index_intern(&lit, words);
+                if (k < 0 || (uint64_t)k >= UINT32_MAX - CPUID_INDEX_REF_LITERAL) goto done;
+                ref = CPUID_INDEX_REF_LITERAL + (uint32_t)k;
+            }
+            refs[chunk * n_columns + c] = ref;
+        }
+    }
+
+    // nombres de los hosts
+    offsets = malloc(sizeof(*offsets) * (n_rows + 1));
+    if (offsets == NULL) goto done;
+    uint64_t blob = 0;
+    for (size_t r = 0; r < n_rows; r++) {
+        offsets[r] = (uint32_t)blob;
+        blob      += strlen(names[r]);
+        if (blob > UINT32_MAX) goto done;
+    }
+    offsets[n_rows] = (uint32_t)blob;
+
+    CPUID_H(index_header) header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, CPUID_INDEX_MAGIC, sizeof(header.magic));
+    header.n_rows          = (uint32_t)n_rows;
+    header.n_chunks        = (uint32_t)n_chunks;
+    header.n_columns       = (uint32_t)n_columns;
+    header.n_literals      = (uint32_t)lit.n;
+    header.columns_offset  = sizeof(header);
+    header.refs_offset     = CPUID_INDEX_ALIGN(header.columns_offset + sizeof(CPUID_H(index_column)) * n_columns, 8);
+    header.literals_offset = CPUID_INDEX_ALIGN(header.refs_offset + sizeof(uint32_t) * n_chunks * n_columns, 64);
+    header.names_offset    = header.literals_offset + sizeof(uint64_t) * CPUID_INDEX_CHUNK_WORDS * lit.n;
+    header.size            = header.names_offset + sizeof(uint32_t) * (n_rows + 1) + blob;
+
+    tmp = malloc(strlen(path) + 5);
+    if (tmp == NULL) goto done;
+    sprintf(tmp, "%s.tmp", path);
+    file = fopen(tmp, "wb");
+    if (file == NULL) goto done;
+
+    uint64_t pos = 0;
+    if (cpuid_index_put(file, &pos, &header, sizeof(header)) != 0) goto done;
+    for (size_t c = 0; c < n_columns; c++) {
+        if (cpuid_index_put(file, &pos, &defs[c].column, sizeof(defs[c].column)) != 0) goto done;
+    }
+    if (cpuid_index_pad(file, &pos, header.refs_offset) != 0) goto done;
+    if (cpuid_index_put(file, &pos, refs, sizeof(*refs) * n_chunks * n_columns) != 0) goto done;
+    if (cpuid_index_pad(file, &pos, header.literals_offset) != 0) goto done;
+    if (cpuid_index_put(file, &pos, lit.words, sizeof(uint64_t) * CPUID_INDEX_CHUNK_WORDS * lit.n) != 0) goto done;
+    if (cpuid_index_put(file, &pos, offsets, sizeof(*offsets) * (n_rows + 1)) != 0) goto done;
+    for (size_t r = 0; r < n_rows; r++) {
+        if (cpuid_index_put(file, &pos, names[r], offsets[r + 1] - offsets[r]) != 0) goto done;
+    }
+
+    int closed = fclose(file);
+    file = NULL;
+    if (closed != 0) goto done;
+#ifdef _WIN32
+    remove(path);   // rename no reemplaza un fichero existente
+#endif
+    if (rename(tmp, path) != 0) goto done;
+    result = 0;
+
+done:
+    if (file != NULL) fclose(file);
+    if (result != 0 && tmp != NULL) remove(tmp);
+    free(tmp);
+    free(offsets);
+    free(runs);
+    free(refs);
+    free(member);
+    free(defs);
+    free(lit.words);
+    free(lit.table);
+    return result;
+}
+
+/*
+ * Lectura
+ */
+
+static int cpuid_index_section(const CPUID_H(index_header) *header, uint64_t offset, uint64_t len) {
+    return offset % 8 == 0 && offset <= header->size && len <= header->size - offset;
+}
+
+static int cpuid_index_validate(CPUID_H(index) *index) {
+    const CPUID_H(index_header) *h = (const CPUID_H(index_header) *)index->base;
+
+    if (index->size < sizeof(*h) || memcmp(h->magic, CPUID_INDEX_MAGIC, sizeof(h->magic)) != 0) return -1;
+    if (h->size != index->size) return -1;
+    if (h->n_chunks != ((uint64_t)h->n_rows + CPUID_INDEX_CHUNK_ROWS - 1) / CPUID_INDEX_CHUNK_ROWS) return -1;
+
+    uint64_t refs = (uint64_t)h->n_chunks * h->n_columns;
+    if (!cpuid_index_section(h, h->columns_offset,  sizeof(CPUID_H(index_column)) * (uint64_t)h->n_columns)) return -1;
+    if (!cpuid_index_section(h, h->refs_offset,     sizeof(uint32_t) * refs))                                return -1;
+    if (!cpuid_index_section(h, h->literals_offset, sizeof(uint64_t) * CPUID_INDEX_CHUNK_WORDS * (uint64_t)h->n_literals)) return -1;
+    if (!cpuid_index_section(h, h->names_offset,    sizeof(uint32_t) * ((uint64_t)h->n_rows + 1)))           return -1;
+
+    index->header       = h;
+    index->columns      = (const CPUID_H(index_column) *)(index->base + h->columns_offset);
+    index->refs         = (const uint32_t *)(index->base + h->refs_offset);
+    index->literals     = (const uint64_t *)(index->base + h->literals_offset);
+    index->name_offsets = (const uint32_t *)(index->base + h->names_offset);
+    index->names        = (const char *)(index->name_offsets + h->n_rows + 1);
+
+    for (uint32_t c = 0; c < h->n_columns; c++) {
+        if (index->columns[c].name[CPUID_INDEX_NAME_MAX - 1] != '\0') return -1;
+    }
+    return 0;
+}
+
+int cpuid_index_open(CPUID_H(index) *index, const char *path) {
+    memset(index, 0, sizeof(*index));
+
+#ifdef CPUID_INDEX_MMAP
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return -1;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        close(fd);
+        return -1;
+    }
+    void *base = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) return -1;
+    index->base   = base;
+    index->size   = (size_t)st.st_size;
+    index->mapped = 1;
+#else
+    FILE *file = fopen(path, "rb");
+    if (file == NULL) return -1;
+    long size = -1;
+    if (fseek(file, 0, SEEK_END) == 0) size = ftell(file);
+    unsigned char *base = size > 0 ? malloc((size_t)size) : NULL;
+    int ok = base != NULL && fseek(file, 0, SEEK_SET) == 0 && fread(base, 1, (size_t)size, file) == (size_t)size;
+    fclose(file);
+    if (!ok) {
+        free(base);
+        return -1;
+    }
+    index->base = base;
+    index->size = (size_t)size;
+#endif
+
+    if (cpuid_index_validate(index) != 0) {
+        cpuid_index_close(index);
+        return -1;
+    }
+    return 0;
+}
+
+void cpuid_index_close(CPUID_H(index) *index) {
+#ifdef CPUID_INDEX_MMAP
+    if (index->mapped) munmap((void *)index->base, index->size);
+    else               free((void *)index->base);
+#else
+    free((void *)index->base);
+#endif
+    memset(index, 0, sizeof(*index));
+}
+
+const char *cpuid_index_host(const CPUID_H(index) *index, size_t row, size_t *len) {
+    const CPUID_H(index_header) *h = index->header;
+    uint64_t blob = h->size - h->names_offset - sizeof(uint32_t) * ((uint64_t)h->n_rows + 1);
+
+    *len = 0;
+    if (row >= h->n_rows) return index->names;
+    uint32_t begin = index->name_offsets[row], end = index->name_offsets[row + 1];
+    if (begin > end || end > blob) return index->names;
+    *len = end - begin;
+    return index->names + begin;
+}
+
+/*
+ * Consultas
+ */
+
+typedef struct CPUID_H(index_parser) {
+    const CPUID_H(index) *index;
+    const char           *text;
+    const char           *p;
+    CPUID_H(index_query) *query;
+    size_t                depth;      // bitmaps en la pila al ejecutar lo emitido
+    char                 *error;
+    size_t                error_cap;
+    int                   failed;
+} CPUID_H(index_parser);
+
+static void cpuid_index_fail(CPUID_H(index_parser) *ps, const char *message) {
+    if (ps->failed) return;
+    ps->failed = 1;
+    if (ps->error != NULL && ps->error_cap != 0) {
+        snprintf(ps->error, ps->error_cap, "posicion %u: %s", (unsigned)(ps->p - ps->text), message);
+    }
+}
+
+static void cpuid_index_emit(CPUID_H(index_parser) *ps, uint32_t code, uint32_t column, uint32_t width, uint32_t compare, uint32_t value) {
+    if (ps->failed) return;
+    if (ps->query->n_ops == CPUID_INDEX_MAX_OPS) {
+        cpuid_index_fail(ps, "consulta demasiado larga");
+        return;
+    }
+    if (code == CPUID_INDEX_OP_AND || code == CPUID_INDEX_OP_OR) ps->depth--;
+    else if (code != CPUID_INDEX_OP_NOT)                         ps->depth++;
+    if (ps->depth > CPUID_INDEX_MAX_DEPTH) {
+        cpuid_index_fail(ps, "consulta demasiado anidada");
+        return;
+    }
+    CPUID_H(index_op) *op = &ps->query->ops[ps->query->n_ops++];
+    op->code    = code;
+    op->column  = column;
+    op->width   = width;
+    op->compare = compare;
+    op->value   = value;
+}
+
+static inline void cpuid_index_ws(CPUID_H(index_parser) *ps) {
+    while (*ps->p == ' ' || *ps->p == '\t' || *ps->p == '\n' || *ps->p == '\r') ps->p++;
+}
+
+static int cpuid_index_accept(CPUID_H(index_parser) *ps, char ch) {
+    cpuid_index_ws(ps);
+    if (*ps->p != ch) return 0;
+    ps->p++;
+    return 1;
+}
+
+static inline int cpuid_index_name_char(char ch) {
+    return (ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z') || (ch >= '0' && ch <= '9') || ch == '_';
+}
+
+// nombre o valor de una categoria (entre comillas si tiene espacios). Devuelve su longitud.
+static size_t cpuid_index_word(CPUID_H(index_parser) *ps, char *out, size_t cap, int quoted) {
+    size_t len = 0;
+    cpuid_index_ws(ps);
+    if (quoted && *ps->p == '"') {
+        ps->p++;
+        while (*ps->p != '"') {
+            if (*ps->p == '\0') {
+                cpuid_index_fail(ps, "falta '\"'");
+                return 0;
+            }
+            if (len + 1 < cap) out[len] = *ps->p;
+            len++;
+            ps->p++;
+        }
+        ps->p++;
+    } else {
+        for (; cpuid_index_name_char(*ps->p); ps->p++, len++) {
+            if (len + 1 < cap) out[len] = *ps->p;
+        }
+    }
+    if (len + 1 > cap) {
+        cpuid_index_fail(ps, "nombre demasiado largo");
+        return 0;
+    }
+    out[len] = '\0';
+    return len;
+}
+
+static int cpuid_index_comparator(CPUID_H(index_parser) *ps) {
+    cpuid_index_ws(ps);
+    const char *p = ps->p;
+    int         op;
+    size_t      len = 2;
+
+    if      (p[0] == '>' && p[1] == '=') op = CPUID_INDEX_GE;
+    else if (p[0] == '<' && p[1] == '=') op = CPUID_INDEX_LE;
+    else if (p[0] == '!' && p[1] == '=') op = CPUID_INDEX_NE;
+    else if (p[0] == '=' && p[1] == '=') op = CPUID_INDEX_EQ;
+    else {
+        len = 1;
+        if      (p[0] == '>') op = CPUID_INDEX_GT;
+        else if (p[0] == '<') op = CPUID_INDEX_LT;
+        else if (p[0] == '=') op = CPUID_INDEX_EQ;
+        else return -1;
+    }
+    ps->p += len;
+    return op;
+}
+
+static void cpuid_index_category(CPUID_H(index_parser) *ps, const char *field, int compare) {
+    char value[CPUID_INDEX_NAME_MAX];
+    char name[CPUID_INDEX_NAME_MAX * 2];
+
+    if (compare != CPUID_INDEX_EQ && compare != CPUID_INDEX_NE) {
+        cpuid_index_fail(ps, "vendor e hypervisor solo admiten = y !=");
+        return;
+    }
+    if (cpuid_index_word(ps, value, sizeof(value), 1) == 0) {
+        cpuid_index_fail(ps, "falta el valor");
+        return;
+    }
+    snprintf(name, sizeof(name), "%s=%s", field, value);
+
+    const CPUID_H(index_header) *h = ps->index->header;
+    uint32_t code = CPUID_INDEX_OP_EMPTY, column = 0;
+    for (uint32_t c = 0; c < h->n_columns; c++) {
+        if (ps->index->columns[c].kind == CPUID_INDEX_CATEGORY && strcmp(ps->index->columns[c].name, name) == 0) {
+            code   = CPUID_INDEX_OP_COLUMN;
+            column = c;
+            break;
+        }
+    }
+    cpuid_index_emit(ps, code, column, 0, 0, 0);
+    if (compare == CPUID_INDEX_NE) cpuid_index_emit(ps, CPUID_INDEX_OP_NOT, 0, 0, 0, 0);
+}
+
+static void cpuid_index_numeric_compare(CPUID_H(index_parser) *ps, const char *field, int compare) {
+    const CPUID_H(index_header) *h = ps->index->header;
+    uint32_t first = 0, width = 0;
+
+    for (uint32_t c = 0; c < h->n_columns; c++) {
+        const CPUID_H(index_column) *col = &ps->index->columns[c];
+        if (col->kind != CPUID_INDEX_SLICE || !cpuid_features_same_name(col->name, field)) continue;
+        if (width == 0) first = c;
+        width++;
+    }
+    if (width == 0 || width > 32) {
+        cpuid_index_fail(ps, "campo desconocido");
+        return;
+    }
+
+    cpuid_index_ws(ps);
+    uint64_t value = 0;
+    if (*ps->p < '0' || *ps->p > '9') {
+        cpuid_index_fail(ps, "se esperaba un numero");
+        return;
+    }
+    for (; *ps->p >= '0' && *ps->p <= '9'; ps->p++) {
+        value = value * 10 + (uint64_t)(*ps->p - '0');
+        if (value > UINT32_MAX) value = (uint64_t)UINT32_MAX + 1;    // mayor que cualquier valor indexado
+    }
+
+    // constantes que no caben en los slices: el resultado no depende de los hosts
+    if (value >> width != 0) {
+        int none = compare == CPUID_INDEX_GE || compare == CPUID_INDEX_GT || compare == CPUID_INDEX_EQ;
+        cpuid_index_emit(ps, none ? CPUID_INDEX_OP_EMPTY : CPUID_INDEX_OP_FULL, 0, 0, 0, 0);
+        return;
+    }
+    cpuid_index_emit(ps, CPUID_INDEX_OP_COMPARE, first, width, (uint32_t)compare, (uint32_t)value);
+}
+
+static void cpuid_index_expr(CPUID_H(index_parser) *ps);
+
+static void cpuid_index_factor(CPUID_H(index_parser) *ps) {
+    char name[CPUID_INDEX_NAME_MAX];
+
+    if (ps->failed) return;
+    if (cpuid_index_accept(ps, '!')) {
+        cpuid_index_factor(ps);
+        cpuid_index_emit(ps, CPUID_INDEX_OP_NOT, 0, 0, 0, 0);
+        return;
+    }
+    if (cpuid_index_accept(ps, '(')) {
+        cpuid_index_expr(ps);
+        if (!cpuid_index_accept(ps, ')')) cpuid_index_fail(ps, "falta ')'");
+        return;
+    }
+    if (cpuid_index_word(ps, name, sizeof(name), 0) == 0) {
+        cpuid_index_fail(ps, "se esperaba un nombre, '!' o '('");
+        return;
+    }
+
+    int compare = cpuid_index_comparator(ps);
+    if (compare >= 0) {
+        for (size_t f = 0; f < CPUID_INDEX_N_CATEGORIES; f++) {
+            if (cpuid_features_same_name(cpuid_index_categories[f].name, name)) {
+                cpuid_index_category(ps, cpuid_index_categories[f].name, compare);
+                return;
+            }
+        }
+        cpuid_index_numeric_compare(ps, name, compare);
+        return;
+    }
+
+    const CPUID_H(index_header) *h = ps->index->header;
+    for (uint32_t c = 0; c < h->n_columns; c++) {
+        const CPUID_H(index_column) *col = &ps->index->columns[c];
+        if (col->kind == CPUID_INDEX_FEATURE && cpuid_features_same_name(col->name, name)) {
+            cpuid_index_emit(ps, CPUID_INDEX_OP_COLUMN, c, 0, 0, 0);
+            return;
+        }
+    }
+    // una caracteristica que existe pero que no tiene columna no la cumple ningun host
+    if (cpuid_feature_find(name) >= 0) {
+        cpuid_index_emit(ps, CPUID_INDEX_OP_EMPTY, 0, 0, 0, 0);
+        return;
+    }
+    cpuid_index_fail(ps, "caracteristica desconocida");
+}
+
+static void cpuid_index_term(CPUID_H(index_parser) *ps) {
+    cpuid_index_factor(ps);
+    while (!ps->failed && cpuid_index_accept(ps, '&')) {
+        cpuid_index_accept(ps, '&');
+        cpuid_index_factor(ps);
+        cpuid_index_emit(ps, CPUID_INDEX_OP_AND, 0, 0, 0, 0);
+    }
+}
+
+static void cpuid_index_expr(CPUID_H(index_parser) *ps) {
+    cpuid_index_term(ps);
+    while (!ps->failed && cpuid_index_accept(ps, '|')) {
+        cpuid_index_accept(ps, '|');
+        cpuid_index_term(ps);
+        cpuid_index_emit(ps, CPUID_INDEX_OP_OR, 0, 0, 0, 0);
+    }
+}
+
+int cpuid_index_compile(
+    const CPUID_H(index) *index, const char *text, CPUID_H(index_query) *query, char *error, size_t error_cap
+) {
+    CPUID_H(index_parser) ps;
+    memset(&ps, 0, sizeof(ps));
+    ps.index     = index;
+    ps.text      = text;
+    ps.p         = text;
+    ps.query     = query;
+    ps.error     = error;
+    ps.error_cap = error_cap;
+    query->n_ops = 0;
+
+    cpuid_index_expr(&ps);
+    cpuid_index_ws(&ps);
+    if (*ps.p != '\0') cpuid_index_fail(&ps, "texto de mas al final");
+    return ps.failed ? -1 : 0;
+}
+
+// un bloque durante la evaluacion: vacio, lleno o literal (en el indice o en un buffer de la pila)
+typedef struct CPUID_H(index_value) {
+    uint32_t        kind;     // CPUID_INDEX_REF_*
+    const uint64_t *words;
+} CPUID_H(index_value);
+
+static inline CPUID_H(index_value) cpuid_index_fetch(const CPUID_H(index) *index, size_t chunk, uint32_t column) {
+    const CPUID_H(index_header) *h = index->header;
+    uint32_t             ref = index->refs[chunk * h->n_columns + column];
+    CPUID_H(index_value) v   = { ref, NULL };
+
+    if (ref >= CPUID_INDEX_REF_LITERAL) {
+        v.kind = CPUID_INDEX_REF_LITERAL;
+        if (ref - CPUID_INDEX_REF_LITERAL >= h->n_literals) v.kind = CPUID_INDEX_REF_EMPTY;
+        else v.words = index->literals + (size_t)(ref - CPUID_INDEX_REF_LITERAL) * CPUID_INDEX_CHUNK_WORDS;
+    }
+    return v;
+}
+
+// los resultados literales siempre quedan en dst (que puede ser uno de los operandos)
+static CPUID_H(index_value) cpuid_index_copy(CPUID_H(index_value) a, int negate, uint64_t *dst) {
+    if (a.kind != CPUID_INDEX_REF_LITERAL) {
+        if (negate) a.kind ^= 1;    // vacio <-> lleno
+        return a;
+    }
+    uint64_t flip = negate ? ~0ull : 0;
+    for (size_t i = 0; i < CPUID_INDEX_CHUNK_WORDS; i++) dst[i] = a.words[i] ^ flip;
+    a.words = dst;
+    return a;
+}
+
+// a & b, o a & ~b con negate_b
+static CPUID_H(index_value) cpuid_index_and(CPUID_H(index_value) a, CPUID_H(index_value) b, int negate_b, uint64_t *dst) {
+    static const CPUID_H(index_value) empty = { CPUID_INDEX_REF_EMPTY, NULL };
+
+    if (negate_b && b.kind != CPUID_INDEX_REF_LITERAL) {
+        b.kind  ^= 1;
+        negate_b = 0;
+    }
+    if (a.kind == CPUID_INDEX_REF_EMPTY || b.kind == CPUID_INDEX_REF_EMPTY) return empty;
+    if (a.kind == CPUID_INDEX_REF_FULL) return cpuid_index_copy(b, negate_b, dst);
+    if (b.kind == CPUID_INDEX_REF_FULL) return cpuid_index_copy(a, 0, dst);
+
+    uint64_t flip = negate_b ? ~0ull : 0, any = 0;
+    for (size_t i = 0; i < CPUID_INDEX_CHUNK_WORDS; i++) {
+        uint64_t w = a.words[i] & (b.words[i] ^ flip);
+        dst[i] = w;
+        any   |= w;
+    }
+    if (any == 0) return empty;
+    CPUID_H(index_value) v = { CPUID_INDEX_REF_LITERAL, dst };
+    return v;
+}
+
+static CPUID_H(index_value) cpuid_index_or(CPUID_H(index_value) a, CPUID_H(index_value) b, uint64_t *dst) {
+    static const CPUID_H(index_value) full = { CPUID_INDEX_REF_FULL, NULL };
+
+    if (a.kind == CPUID_INDEX_REF_FULL || b.kind == CPUID_INDEX_REF_FULL) return full;
+    if (a.kind == CPUID_INDEX_REF_EMPTY) return cpuid_index_copy(b, 0, dst);
+    if (b.kind == CPUID_INDEX_REF_EMPTY) return cpuid_index_copy(a, 0, dst);
+
+    uint64_t all = ~0ull;
+    for (size_t i = 0; i < CPUID_INDEX_CHUNK_WORDS; i++) {
+        uint64_t w = a.words[i] | b.words[i];
+        dst[i] = w;
+        all   &= w;
+    }
+    if (all == ~0ull) return full;
+    CPUID_H(index_value) v = { CPUID_INDEX_REF_LITERAL, dst };
+    return v;
+}
+
+/*
+ * Comparacion con una constante sobre los bit-slices del campo, del bit mas alto al mas bajo:
+ * gt son las filas ya mayores que la constante y eq las que coinciden en los bits vistos.
+ */
+static CPUID_H(index_value) cpuid_index_eval_compare(
+    const CPUID_H(index) *index, size_t chunk, const CPUID_H(index_op) *op, uint64_t *dst
+) {
+    uint64_t gt_words[CPUID_INDEX_CHUNK_WORDS], eq_words[CPUID_INDEX_CHUNK_WORDS], tmp[CPUID_INDEX_CHUNK_WORDS];
+    CPUID_H(index_value) gt = { CPUID_INDEX_REF_EMPTY, NULL };
+    CPUID_H(index_value) eq = { CPUID_INDEX_REF_FULL,  NULL };
+
+    for (uint32_t k = op->width; k-- > 0;) {
+        CPUID_H(index_value) slice = cpuid_index_fetch(index, chunk, op->column + k);
+        if ((op->value >> k) & 1) {
+            eq = cpuid_index_and(eq, slice, 0, eq_words);
+        } else {
+            gt = cpuid_index_or(gt, cpuid_index_and(eq, slice, 0, tmp), gt_words);
+            eq = cpuid_index_and(eq, slice, 1, eq_words);
+        }
+        if (eq.kind == CPUID_INDEX_REF_EMPTY) break;    // gt ya no cambia
+    }
+
+    switch (op->compare) {
+        case CPUID_INDEX_GT: return cpuid_index_copy(gt, 0, dst);
+        case CPUID_INDEX_LE: return cpuid_index_copy(gt, 1, dst);
+        case CPUID_INDEX_EQ: return cpuid_index_copy(eq, 0, dst);
+        case CPUID_INDEX_NE: return cpuid_index_copy(eq, 1, dst);
+        case CPUID_INDEX_GE: return cpuid_index_or(gt, eq, dst);
+        default:             return cpuid_index_copy(cpuid_index_or(gt, eq, tmp), 1, dst);
+    }
+}
+
+static inline unsigned cpuid_index_popcount(uint64_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+    return (unsigned)__builtin_popcountll(x);
+#else
+    x = x - ((x >> 1) & 0x5555555555555555ULL);
+    x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+    x = (x + (x >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+    return (unsigned)((x * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+// cuenta las filas del bloque (rows validas) y las escribe en out si no es NULL
+static size_t cpuid_index_store(CPUID_H(index_value) v, size_t rows, uint64_t *out) {
+    size_t   total = 0;
+    uint64_t tail  = rows % 64 != 0 ? (1ull << (rows % 64)) - 1 : ~0ull;
+    size_t   used  = (rows + 63) / 64;
+
+    if (out == NULL && v.kind != CPUID_INDEX_REF_LITERAL) return v.kind == CPUID_INDEX_REF_FULL ? rows : 0;
+    for (size_t i = 0; i < CPUID_INDEX_CHUNK_WORDS; i++) {
+        uint64_t w = 0;
+        if (i < used) {
+            w = v.kind == CPUID_INDEX_REF_FULL ? ~0ull : v.kind == CPUID_INDEX_REF_EMPTY ? 0 : v.words[i];
+            if (i == used - 1) w &= tail;
+        }
+        if (out != NULL) out[i] = w;
+        total += cpuid_index_popcount(w);
+    }
+    return total;
+}
+
+// comprueba que el programa no se sale de la pila ni de las columnas (puede no venir de compile)
+static int cpuid_index_check(const CPUID_H(index) *index, const CPUID_H(index_query) *query) {
+    size_t depth = 0;
+    if (query->n_ops == 0 || query->n_ops > CPUID_INDEX_MAX_OPS) return -1;
+    for (size_t i = 0; i < query->n_ops; i++) {
+        const CPUID_H(index_op) *op = &query->ops[i];
+        switch (op->code) {
+            case CPUID_INDEX_OP_COLUMN:
+                if (op->column >= index->header->n_columns) return -1;
+                depth++;
+                break;
+            case CPUID_INDEX_OP_COMPARE:
+                if (op->width == 0 || op->width > 32 || op->width > index->header->n_columns) return -1;
+                if (op->column > index->header->n_columns - op->width) return -1;
+                depth++;
+                break;
+            case CPUID_INDEX_OP_EMPTY:
+            case CPUID_INDEX_OP_FULL:
+                depth++;
+                break;
+            case CPUID_INDEX_OP_NOT:
+                if (depth < 1) return -1;
+                break;
+            case CPUID_INDEX_OP_AND:
+            case CPUID_INDEX_OP_OR:
+                if (depth < 2) return -1;
+                depth--;
+                break;
+            default:
+                return -1;
+        }
+        if (depth > CPUID_INDEX_MAX_DEPTH) return -1;
+    }
+    return depth == 1 ? 0 : -1;
+}
+
+size_t cpuid_index_eval(const CPUID_H(index) *index, const CPUID_H(index_query) *query, uint64_t *out) {
+    uint64_t             slots[CPUID_INDEX_MAX_DEPTH][CPUID_INDEX_CHUNK_WORDS];
+    CPUID_H(index_value) stack[CPUID_INDEX_MAX_DEPTH];
+    const CPUID_H(index_header) *h = index->header;
+    size_t total = 0;
+
+    if (cpuid_index_check(index, query) != 0) {
+        if (out != NULL) memset(out, 0, sizeof(*out) * cpuid_index_words(index));
+        return 0;
+    }
+
+    for (size_t chunk = 0; chunk < h->n_chunks; chunk++) {
+        size_t sp = 0;
+        for (size_t i = 0; i < query->n_ops; i++) {
+            const CPUID_H(index_op) *op = &query->ops[i];
+            switch (op->code) {
+                case CPUID_INDEX_OP_EMPTY:
+                case CPUID_INDEX_OP_FULL:
+                    stack[sp].kind  = op->code == CPUID_INDEX_OP_FULL ? CPUID_INDEX_REF_FULL : CPUID_INDEX_REF_EMPTY;
+                    stack[sp].words = NULL;
+                    sp++;
+                    break;
+                case CPUID_INDEX_OP_COLUMN:
+                    stack[sp++] = cpuid_index_fetch(index, chunk, op->column);
+                    break;
+                case CPUID_INDEX_OP_COMPARE:
+                    stack[sp] = cpuid_index_eval_compare(index, chunk, op, slots[sp]);
+                    sp++;
+                    break;
+                case CPUID_INDEX_OP_NOT:
+                    stack[sp - 1] = cpuid_index_copy(stack[sp - 1], 1, slots[sp - 1]);
+                    break;
+                case CPUID_INDEX_OP_AND:
+                    stack[sp - 2] = cpuid_index_and(stack[sp - 2], stack[sp - 1], 0, slots[sp - 2]);
+                    sp--;
+                    break;
+                case CPUID_INDEX_OP_OR:
+                    stack[sp - 2] = cpuid_index_or(stack[sp - 2], stack[sp - 1], slots[sp - 2]);
+                    sp--;
+                    break;
+            }
+        }
+
+        size_t first = chunk * CPUID_INDEX_CHUNK_ROWS;
+        size_t rows  = h->n_rows - first < CPUID_INDEX_CHUNK_ROWS ? h->n_rows - first : CPUID_INDEX_CHUNK_ROWS;
+        total += cpuid_index_store(stack[0], rows, out != NULL ? out + chunk * CPUID_INDEX_CHUNK_WORDS : NULL);
+    }
+    return total;
+}
+
+#endif
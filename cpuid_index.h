@@ -0,0 +1,184 @@
+#ifndef __CPUID_INDEX_H__
+#define __CPUID_INDEX_H__
+
+/*
+ * Indice de capacidades de una flota. Responde consultas como
+ *
+ *      AVX512_VNNI & l3_total_kb >= 32768 & !hypervisor = "Microsoft Hv"
+ *
+ * sobre millones de hosts sin volver a recorrer sus snapshots.
+ *
+ * Cada fila es un host y cada columna un bitmap sobre las filas:
+ *  - una por caracteristica de cpuid_features (los nombres repetidos en varias hojas son una
+ *    sola columna, el OR de todas ellas),
+ *  - una por cada valor distinto de vendor y de hypervisor ("vendor=GenuineIntel"),
+ *  - y por cada campo numerico de CPUID_H(host_info) tantas columnas como bits tiene el mayor
+ *    valor de la flota (bit-slices: la columna k tiene los hosts con el bit k del valor a 1).
+ *    Una comparacion con una constante (<, <=, =, !=, >=, >) se resuelve con una pasada de
+ *    AND/OR sobre esas columnas, asi que el resultado es exacto para cualquier umbral.
+ *
+ * Los bitmaps se parten en bloques de CPUID_INDEX_CHUNK_ROWS filas. El bloque de una columna
+ * es vacio, lleno o un literal de 64 palabras de 64 bits, y los literales identicos se guardan
+ * una sola vez. Con las filas agrupadas por snapshot (los hosts iguales seguidos) casi todos
+ * los bloques son vacios o llenos y el indice ocupa poco mas que los nombres de los hosts.
+ *
+ * La consulta se evalua bloque a bloque con una pila de bitmaps de 512 bytes que cabe en L1:
+ * los bloques vacios y llenos se resuelven sin tocar memoria y los literales con bucles de
+ * AND/OR/ANDN sobre palabras de 64 bits que el compilador vectoriza (SSE2, o AVX2/AVX-512 si
+ * se compila para ellas).
+ *
+ * Fichero (orden de bytes de la maquina; secciones alineadas a 8 bytes y literales a 64):
+ *
+ *      CPUID_H(index_header)
+ *      CPUID_H(index_column) columns[n_columns]
+ *      uint32_t              refs[n_chunks][n_columns]   0 vacio, 1 lleno, 2 + k literal k
+ *      uint64_t              literals[n_literals][CPUID_INDEX_CHUNK_WORDS]
+ *      uint32_t              name_offsets[n_rows + 1]    host de la fila i: names[off[i], off[i + 1])
+ *      char                  names[]
+ *
+ * Se abre con mmap (o se lee entero donde no hay mmap) y se consulta sin copiarlo.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "cpuid_features.h"
+
+#define CPUID_INDEX_MAGIC        "CPUIDIX1"
+#define CPUID_INDEX_CHUNK_ROWS   4096
+#define CPUID_INDEX_CHUNK_WORDS  (CPUID_INDEX_CHUNK_ROWS / 64)
+#define CPUID_INDEX_NAME_MAX     48
+#define CPUID_INDEX_MAX_OPS      256
+#define CPUID_INDEX_MAX_DEPTH    32
+
+typedef enum CPUID_H(index_column_kind) {
+    CPUID_INDEX_FEATURE  = 0,
+    CPUID_INDEX_CATEGORY = 1,   // name es "campo=valor"
+    CPUID_INDEX_SLICE    = 2,   // bit slice de un campo numerico, name es el campo
+} CPUID_H(index_column_kind);
+
+typedef struct CPUID_H(index_header) {
+    char     magic[8];
+    uint32_t n_rows;
+    uint32_t n_chunks;
+    uint32_t n_columns;
+    uint32_t n_literals;
+    uint64_t columns_offset;
+    uint64_t refs_offset;
+    uint64_t literals_offset;
+    uint64_t names_offset;      // name_offsets y detras names
+    uint64_t size;
+} CPUID_H(index_header);
+
+typedef struct CPUID_H(index_column) {
+    char     name[CPUID_INDEX_NAME_MAX];
+    uint32_t kind;              // CPUID_H(index_column_kind)
+    uint32_t slice;             // bit del valor para CPUID_INDEX_SLICE
+} CPUID_H(index_column);
+
+// lo que se indexa de un snapshot (un perfil lo comparten todos los hosts con el mismo snapshot)
+typedef struct CPUID_H(index_profile) {
+    CPUID_H(featureset) features;
+    CPUID_H(host_info)  info;
+} CPUID_H(index_profile);
+
+/*
+ * Escribe el indice de n_rows hosts: la fila i es el host names[i] con el perfil
+ * profiles[row_profile[i]]. Conviene que las filas con el mismo perfil vayan seguidas.
+ * El fichero se escribe en <path>.tmp y se renombra al final, asi los lectores que ya lo
+ * tienen abierto siguen viendo el anterior. Devuelve 0, o -1 si fallo (sin memoria o E/S).
+ */
+int cpuid_index_write(
+    const char *path,
+    const char *const *names, const uint32_t *row_profile, size_t n_rows,
+    const CPUID_H(index_profile) *profiles, size_t n_profiles
+);
+
+typedef struct CPUID_H(index) {
+    const unsigned char          *base;
+    size_t                        size;
+    int                           mapped;     // 1 con mmap, 0 leido con malloc
+    const CPUID_H(index_header)  *header;
+    const CPUID_H(index_column)  *columns;
+    const uint32_t               *refs;
+    const uint64_t               *literals;
+    const uint32_t               *name_offsets;
+    const char                   *names;
+} CPUID_H(index);
+
+/*
+ * Abre y valida el indice. Devuelve 0, o -1 si no se pudo leer o no es un indice valido.
+ */
+int cpuid_index_open(CPUID_H(index) *index, const char *path);
+void cpuid_index_close(CPUID_H(index) *index);
+
+/*
+ * Nombre del host de una fila (sin '\0'; la longitud en len).
+ */
+const char *cpuid_index_host(const CPUID_H(index) *index, size_t row, size_t *len);
+
+// palabras de 64 bits del bitmap de resultado de cpuid_index_eval
+static inline size_t cpuid_index_words(const CPUID_H(index) *index) {
+    return (size_t)index->header->n_chunks * CPUID_INDEX_CHUNK_WORDS;
+}
+
+typedef enum CPUID_H(index_opcode) {
+    CPUID_INDEX_OP_EMPTY   = 0,
+    CPUID_INDEX_OP_FULL    = 1,
+    CPUID_INDEX_OP_COLUMN  = 2,
+    CPUID_INDEX_OP_COMPARE = 3,
+    CPUID_INDEX_OP_NOT     = 4,
+    CPUID_INDEX_OP_AND     = 5,
+    CPUID_INDEX_OP_OR      = 6,
+} CPUID_H(index_opcode);
+
+typedef enum CPUID_H(index_compare) {
+    CPUID_INDEX_LT = 0,
+    CPUID_INDEX_LE = 1,
+    CPUID_INDEX_EQ = 2,
+    CPUID_INDEX_NE = 3,
+    CPUID_INDEX_GE = 4,
+    CPUID_INDEX_GT = 5,
+} CPUID_H(index_compare);
+
+typedef struct CPUID_H(index_op) {
+    uint32_t code;      // CPUID_H(index_opcode)
+    uint32_t column;    // OP_COLUMN: la columna; OP_COMPARE: el slice 0 del campo
+    uint32_t width;     // OP_COMPARE: slices del campo
+    uint32_t compare;   // OP_COMPARE: CPUID_H(index_compare)
+    uint32_t value;     // OP_COMPARE: la constante
+} CPUID_H(index_op);
+
+// consulta compilada: programa en notacion postfija
+typedef struct CPUID_H(index_query) {
+    CPUID_H(index_op) ops[CPUID_INDEX_MAX_OPS];
+    size_t            n_ops;
+} CPUID_H(index_query);
+
+/*
+ * Compila una consulta contra las columnas del indice:
+ *
+ *      expr   := term { "|" term }
+ *      term   := factor { "&" factor }
+ *      factor := "!" factor | "(" expr ")" | NOMBRE | NOMBRE cmp NUMERO | CAMPO ("=" | "!=") valor
+ *
+ * NOMBRE es una caracteristica o un campo numerico (family, model, stepping, l2_kb, l3_kb,
+ * l3_total_kb, threads, cores), sin distinguir mayusculas; CAMPO es vendor o hypervisor y
+ * valor un nombre o una cadena entre comillas. "&&" y "||" valen igual que "&" y "|".
+ * Un valor de vendor o hypervisor que no esta en la flota no da error: no lo cumple ningun host.
+ *
+ * Devuelve 0, o -1 con un mensaje en error (que puede ser NULL) si la consulta no es valida.
+ */
+int cpuid_index_compile(
+    const CPUID_H(index) *index, const char *text, CPUID_H(index_query) *query, char *error, size_t error_cap
+);
+
+/*
+ * Evalua la consulta. Si out no es NULL escribe en el el bitmap del resultado
+ * (cpuid_index_words palabras, bit i de la palabra w = fila w * 64 + i).
+ * Devuelve el numero de hosts que la cumplen.
+ */
+size_t cpuid_index_eval(const CPUID_H(index) *index, const CPUID_H(index_query) *query, uint64_t *out);
+
+#include "cpuid_index.c"
+#endif
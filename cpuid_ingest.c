@@ -0,0 +1,371 @@
+#ifndef __CPUID_INGEST_C__
+#define __CPUID_INGEST_C__
+
+#include "cpuid_ingest.h"
+
+#include <stdio.h>
+#include <string.h>
+
+/*
+ * Hash de 64 bits por palabras de 64 bits (mezcla de MurmurHash3 x64 y su fmix64 final).
+ * No es criptografico: solo tiene que separar snapshots distintos de una misma flota.
+ */
+static inline uint64_t cpuid_ingest_rotl(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+static inline uint64_t cpuid_ingest_mix(uint64_t h, uint64_t k) {
+    k *= 0x87c37b91114253d5ULL;
+    k  = cpuid_ingest_rotl(k, 31);
+    k *= 0x4cf5ad432745937fULL;
+    h ^= k;
+    return cpuid_ingest_rotl(h, 27) * 5 + 0x52dce729;
+}
+
+static inline uint64_t cpuid_ingest_final(uint64_t h, uint64_t len) {
+    h ^= len;
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+uint64_t cpuid_ingest_block(CPUID_H(record) *block, size_t n) {
+    uint64_t h = 0x9e3779b97f4a7c15ULL;
+
+    for (size_t i = 0; i < n; i++) {
+        CPUID_H(record) *r = &block[i];
+        r->cpu  = 0;
+        r->eax &= ~cpuid_diff_variant_mask(r->leaf, CPUID_DIFF_EAX);
+        r->ebx &= ~cpuid_diff_variant_mask(r->leaf, CPUID_DIFF_EBX);
+        r->ecx &= ~cpuid_diff_variant_mask(r->leaf, CPUID_DIFF_ECX);
+        r->edx &= ~cpuid_diff_variant_mask(r->leaf, CPUID_DIFF_EDX);
+
+        h = cpuid_ingest_mix(h, ((uint64_t)r->subleaf << 32) | r->leaf);
+        h = cpuid_ingest_mix(h, ((uint64_t)r->ebx     << 32) | r->eax);
+        h = cpuid_ingest_mix(h, ((uint64_t)r->edx     << 32) | r->ecx);
+        h = cpuid_ingest_mix(h, r->status);
+    }
+    return cpuid_ingest_final(h, n);
+}
+
+/*
+ * Analizador minimo de JSON para las lineas de cpuid_json: cursor sobre [p, end).
+ */
+typedef struct CPUID_H(ingest_cursor) {
+    const char *p;
+    const char *end;
+} CPUID_H(ingest_cursor);
+
+static inline void cpuid_ingest_ws(CPUID_H(ingest_cursor) *c) {
+    while (c->p < c->end && (*c->p == ' ' || *c->p == '\t' || *c->p == '\r' || *c->p == '\n')) c->p++;
+}
+
+static inline int cpuid_ingest_expect(CPUID_H(ingest_cursor) *c, char ch) {
+    cpuid_ingest_ws(c);
+    if (c->p >= c->end || *c->p != ch) return -1;
+    c->p++;
+    return 0;
+}
+
+/*
+ * Lee una cadena; si out no es NULL copia como mucho cap - 1 bytes. Los escapes \uXXXX
+ * fuera de ASCII se guardan como '?'.
+ */
+static int cpuid_ingest_string(CPUID_H(ingest_cursor) *c, char *out, size_t cap) {
+    size_t n = 0;
+    if (cpuid_ingest_expect(c, '"') != 0) return -1;
+
+    while (c->p < c->end && *c->p != '"') {
+        char ch = *c->p++;
+        if (ch == '\\') {
+            if (c->p >= c->end) return -1;
+            ch = *c->p++;
+            switch (ch) {
+                case 'n': ch = '\n'; break;
+                case 't': ch = '\t'; break;
+                case 'r': ch = '\r'; break;
+                case 'b': ch = '\b'; break;
+                case 'f': ch = '\f'; break;
+                case 'u': {
+                    unsigned value = 0;
+                    if (c->end - c->p < 4) return -1;
+                    for (int i = 0; i < 4; i++) {
+                        char h = *c->p++;
+                        value <<= 4;
+                        if      (h >= '0' && h <= '9') value |= (unsigned)(h - '0');
+                        else if (h >= 'a' && h <= 'f') value |= (unsigned)(h - 'a' + 10);
+                        else if (h >= 'A' && h <= 'F') value |= (unsigned)(h - 'A' + 10);
+                        else return -1;
+                    }
+                    ch = value < 0x80 ? (char)value : '?';
+                    break;
+                }
+                default: break; // \" \\ \/
+            }
+        }
+        if (out != NULL && n + 1 < cap) out[n++] = ch;
+    }
+    if (c->p >= c->end) return -1;
+    c->p++;
+    if (out != NULL && cap != 0) out[n] = '\0';
+    return 0;
+}
+
+static int cpuid_ingest_u32(CPUID_H(ingest_cursor) *c, uint32_t *value) {
+    uint64_t v = 0;
+    cpuid_ingest_ws(c);
+    if (c->p >= c->end || *c->p < '0' || *c->p > '9') return -1;
+    while (c->p < c->end && *c->p >= '0' && *c->p <= '9') {
+        v = v * 10 + (uint64_t)(*c->p++ - '0');
+        if (v > 0xffffffffu) return -1;
+    }
+    *value = (uint32_t)v;
+    return 0;
+}
+
+// salta un valor cualquiera (cadena, numero, literal, objeto o array)
+static int cpuid_ingest_skip(CPUID_H(ingest_cursor) *c) {
+    cpuid_ingest_ws(c);
+    if (c->p >= c->end) return -1;
+    if (*c->p == '"') return cpuid_ingest_string(c, NULL, 0);
+
+    if (*c->p == '{' || *c->p == '[') {
+        int depth = 0;
+        while (c->p < c->end) {
+            char ch = *c->p;
+            if (ch == '"') {
+                if (cpuid_ingest_string(c, NULL, 0) != 0) return -1;
+                continue;
+            }
+            c->p++;
+            if (ch == '{' || ch == '[') depth++;
+            else if ((ch == '}' || ch == ']') && --depth == 0) return 0;
+        }
+        return -1;
+    }
+
+    while (c->p < c->end && *c->p != ',' && *c->p != '}' && *c->p != ']') c->p++;
+    return 0;
+}
+
+/*
+ * Iteran sobre un objeto o un array ya abierto ('{' o '[' consumido). Devuelven 1 si hay otro
+ * elemento (y en el caso del objeto dejan su clave en key y el cursor en el valor), 0 al llegar
+ * al cierre y -1 si la entrada no es valida.
+ */
+static int cpuid_ingest_next_item(CPUID_H(ingest_cursor) *c, char close, int *first) {
+    cpuid_ingest_ws(c);
+    if (c->p >= c->end) return -1;
+    if (*c->p == close) {
+        c->p++;
+        return 0;
+    }
+    if (!*first && *c->p++ != ',') return -1;
+    *first = 0;
+    return 1;
+}
+
+static int cpuid_ingest_next_key(CPUID_H(ingest_cursor) *c, char *key, size_t cap, int *first) {
+    int more = cpuid_ingest_next_item(c, '}', first);
+    if (more != 1) return more;
+    if (cpuid_ingest_string(c, key, cap) != 0 || cpuid_ingest_expect(c, ':') != 0) return -1;
+    return 1;
+}
+
+static int cpuid_ingest_leaf(CPUID_H(ingest_cursor) *c, CPUID_H(record) *r) {
+    char key[16];
+    int  first = 1, more;
+
+    memset(r, 0, sizeof(*r));
+    if (cpuid_ingest_expect(c, '{') != 0) return -1;
+    while ((more = cpuid_ingest_next_key(c, key, sizeof(key), &first)) == 1) {
+        uint32_t *field = NULL;
+        if      (strcmp(key, "leaf")    == 0) field = &r->leaf;
+        else if (strcmp(key, "subleaf") == 0) field = &r->subleaf;
+        else if (strcmp(key, "eax")     == 0) field = &r->eax;
+        else if (strcmp(key, "ebx")     == 0) field = &r->ebx;
+        else if (strcmp(key, "ecx")     == 0) field = &r->ecx;
+        else if (strcmp(key, "edx")     == 0) field = &r->edx;
+        if ((field != NULL ? cpuid_ingest_u32(c, field) : cpuid_ingest_skip(c)) != 0) return -1;
+    }
+    return more;
+}
+
+int cpuid_ingest_parse_line(
+    const char *line, size_t len, char *host, size_t host_cap,
+    CPUID_H(record) *out, size_t max, size_t *n_out
+) {
+    CPUID_H(ingest_cursor) cursor = { line, line + len }, *c = &cursor;
+    uint32_t cpu = 0, status = CPUID_RECORD_OK;
+    size_t   n = 0;
+    char     key[16];
+    int      first = 1, more;
+
+    if (host_cap != 0) host[0] = '\0';
+    if (cpuid_ingest_expect(c, '{') != 0) return -1;
+
+    while ((more = cpuid_ingest_next_key(c, key, sizeof(key), &first)) == 1) {
+        int error;  // 0 si el valor se leyo bien
+        if (strcmp(key, "host") == 0) {
+            error = cpuid_ingest_string(c, host, host_cap);
+        } else if (strcmp(key, "cpu") == 0) {
+            error = cpuid_ingest_u32(c, &cpu);
+        } else if (strcmp(key, "status") == 0) {
+            error = cpuid_ingest_u32(c, &status);
+        } else if (strcmp(key, "leaves") == 0) {
+            int item_first = 1;
+            if (cpuid_ingest_expect(c, '[') != 0) return -1;
+            while ((error = cpuid_ingest_next_item(c, ']', &item_first)) == 1) {
+                if (n == max || cpuid_ingest_leaf(c, &out[n]) != 0) return -1;
+                n++;
+            }
+        } else {
+            error = cpuid_ingest_skip(c);
+        }
+        if (error != 0) return -1;
+    }
+    if (more < 0) return -1;
+
+    // cpu y status pueden ir antes o despues de "leaves"
+    for (size_t i = 0; i < n; i++) {
+        out[i].cpu    = cpu;
+        out[i].status = status;
+    }
+    *n_out = n;
+    return 0;
+}
+
+void cpuid_store_init(CPUID_H(store) *store, const char *dir, uint64_t *seen, size_t seen_cap) {
+    memset(store, 0, sizeof(*store));
+    snprintf(store->dir, sizeof(store->dir), "%s", dir);
+    store->seen     = seen;
+    store->seen_cap = seen_cap;
+    if (seen != NULL) memset(seen, 0, sizeof(*seen) * seen_cap);
+}
+
+// devuelve 1 si key esta en la cache
+static int cpuid_store_seen(const CPUID_H(store) *store, uint64_t key) {
+    if (store->seen == NULL || store->seen_cap == 0) return 0;
+    if (key == 0) key = 1;
+
+    size_t mask = store->seen_cap - 1;
+    for (size_t i = (size_t)key & mask; ; i = (i + 1) & mask) {
+        if (store->seen[i] == key) return 1;
+        if (store->seen[i] == 0) return 0;
+    }
+}
+
+// anade key a la cache; solo se llama cuando el fichero ya esta en el almacen
+static void cpuid_store_remember(CPUID_H(store) *store, uint64_t key) {
+    if (store->seen == NULL || store->seen_cap == 0 || cpuid_store_seen(store, key)) return;
+    if (key == 0) key = 1;
+
+    if (store->seen_used + 1 > store->seen_cap / 4 * 3) {
+        memset(store->seen, 0, sizeof(*store->seen) * store->seen_cap);
+        store->seen_used = 0;
+    }
+    size_t mask = store->seen_cap - 1;
+    for (size_t i = (size_t)key & mask; ; i = (i + 1) & mask) {
+        if (store->seen[i] == 0) {
+            store->seen[i] = key;
+            store->seen_used++;
+            return;
+        }
+    }
+}
+
+int cpuid_store_put(CPUID_H(store) *store, uint64_t hash, const char *ext, const void *data, size_t len) {
+    // la extension entra en la clave: un .cpu y un .snap con el mismo hash son ficheros distintos
+    uint64_t key = hash ^ ((uint64_t)(unsigned char)ext[0] * 0x9e3779b97f4a7c15ULL);
+    if (cpuid_store_seen(store, key)) return 0;
+
+    char path[CPUID_INGEST_MAX_PATH + 32];
+    snprintf(path, sizeof(path), "%s/%08x%08x.%s", store->dir, (unsigned)(hash >> 32), (unsigned)hash, ext);
+
+    // "x" (C11): falla si el fichero ya existe, de otra ejecucion o de otro proceso
+    FILE *file = fopen(path, "wbx");
+    if (file == NULL) {
+        FILE *existing = fopen(path, "rb");
+        if (existing == NULL) return -1;
+        fclose(existing);
+        cpuid_store_remember(store, key);
+        return 0;
+    }
+    int ok = fwrite(data, 1, len, file) == len;
+    ok &= fclose(file) == 0;
+    if (!ok) {
+        remove(path);
+        return -1;
+    }
+    // la clave entra en la cache solo con el fichero escrito: tras un fallo se vuelve a intentar
+    cpuid_store_remember(store, key);
+    store->written++;
+    return 1;
+}
+
+long cpuid_store_get(const CPUID_H(store) *store, uint64_t hash, const char *ext, void *data, size_t cap) {
+    char path[CPUID_INGEST_MAX_PATH + 32];
+    snprintf(path, sizeof(path), "%s/%08x%08x.%s", store->dir, (unsigned)(hash >> 32), (unsigned)hash, ext);
+
+    FILE *file = fopen(path, "rb");
+    if (file == NULL) return -1;
+    size_t len = fread(data, 1, cap, file);
+    // un byte mas indica que el fichero no cabe
+    int    ok  = !ferror(file) && (len < cap || fgetc(file) == EOF);
+    fclose(file);
+    return ok ? (long)len : -1;
+}
+
+void cpuid_ingest_host_reset(CPUID_H(ingest_host) *host, const char *name) {
+    snprintf(host->name, sizeof(host->name), "%s", name);
+    host->n_variants = 0;
+    host->n_cpus     = 0;
+    host->dropped    = 0;
+}
+
+int cpuid_ingest_host_add(CPUID_H(ingest_host) *host, CPUID_H(store) *store, CPUID_H(record) *block, size_t n) {
+    uint64_t hash = cpuid_ingest_block(block, n);
+    host->n_cpus++;
+
+    for (size_t i = 0; i < host->n_variants; i++) {
+        if (host->variants[i] == hash) return 0;
+    }
+    if (host->n_variants == CPUID_INGEST_MAX_VARIANTS) {
+        host->dropped++;
+        return 0;
+    }
+    // el bloque solo entra en el snapshot si su .cpu quedo guardado
+    if (cpuid_store_put(store, hash, "cpu", block, sizeof(*block) * n) < 0) {
+        host->dropped++;
+        return -1;
+    }
+    host->variants[host->n_variants++] = hash;
+    return 0;
+}
+
+uint64_t cpuid_ingest_host_finish(CPUID_H(ingest_host) *host, CPUID_H(store) *store) {
+    // con bloques fuera de variants el identificador no describiria el host
+    if (host->n_variants == 0 || host->dropped != 0) return 0;
+
+    // insercion: casi siempre hay 1 o 2 variantes
+    for (size_t i = 1; i < host->n_variants; i++) {
+        uint64_t v = host->variants[i];
+        size_t   j = i;
+        for (; j > 0 && host->variants[j - 1] > v; j--) host->variants[j] = host->variants[j - 1];
+        host->variants[j] = v;
+    }
+
+    uint64_t id = 0x9e3779b97f4a7c15ULL;
+    for (size_t i = 0; i < host->n_variants; i++) id = cpuid_ingest_mix(id, host->variants[i]);
+    id = cpuid_ingest_final(id, host->n_variants);
+    if (id == 0) id = 1;
+
+    // un id sin su .snap dejaria el host apuntando a un snapshot que no existe
+    if (cpuid_store_put(store, id, "snap", host->variants, sizeof(host->variants[0]) * host->n_variants) < 0) return 0;
+    return id;
+}
+
+#endif
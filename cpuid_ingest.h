@@ -0,0 +1,103 @@
+#ifndef __CPUID_INGEST_H__
+#define __CPUID_INGEST_H__
+
+/*
+ * Ingesta de snapshots de muchos hosts con deduplicacion.
+ *
+ * Cada CPU de un host es un bloque de CPUID_H(record) (el formato de cpuid_snapshot.h). El bloque
+ * se normaliza (numero de CPU a 0 y campos que dependen del procesador logico a 0, los mismos
+ * que ignora cpuid_diff con CPUID_DIFF_NORMALIZE) y se resume con un hash de 64 bits. Las CPU
+ * identicas de un host, y los hosts identicos de una flota, dan el mismo hash.
+ *
+ * El snapshot de un host es el conjunto de hashes distintos de sus CPU (normalmente uno, dos en
+ * procesadores hibridos) y su identificador es el hash de ese conjunto ordenado.
+ *
+ * El almacen es un directorio direccionado por contenido:
+ *      <hash>.cpu   registros normalizados de un bloque (tabla de CPUID_H(record))
+ *      <id>.snap    hashes de los bloques de un snapshot (uint64_t, orden creciente)
+ * Cada fichero se escribe una sola vez; una cache de tamano fijo de hashes ya guardados evita
+ * volver a tocar el sistema de ficheros para los snapshots repetidos.
+ *
+ * Toda la memoria la da el llamador, asi que el consumo no depende del numero de hosts.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "cpuid_diff.h"
+
+#define CPUID_INGEST_MAX_HOST     256   // bytes del nombre de host, con el '\0'
+#define CPUID_INGEST_MAX_VARIANTS 64    // bloques distintos por host
+#define CPUID_INGEST_MAX_PATH     1024
+
+/*
+ * Normaliza el bloque en sitio y devuelve su hash.
+ */
+uint64_t cpuid_ingest_block(CPUID_H(record) *block, size_t n);
+
+/*
+ * Lee una linea NDJSON con el formato de cpuid_json (un objeto por CPU). Copia el campo "host"
+ * en host (cadena vacia si no esta) y escribe los registros de "leaves" en out, con el cpu
+ * y el status del objeto. Las claves desconocidas se ignoran.
+ *
+ * Devuelve 0 y el numero de registros en n_out, o -1 si la linea no es valida o tiene mas
+ * de max registros.
+ */
+int cpuid_ingest_parse_line(
+    const char *line, size_t len, char *host, size_t host_cap,
+    CPUID_H(record) *out, size_t max, size_t *n_out
+);
+
+typedef struct CPUID_H(store) {
+    char      dir[CPUID_INGEST_MAX_PATH];
+    uint64_t *seen;        // cache de hashes guardados (direccionamiento abierto, 0 = libre)
+    size_t    seen_cap;    // potencia de 2
+    size_t    seen_used;
+    size_t    written;     // ficheros nuevos escritos
+} CPUID_H(store);
+
+/*
+ * seen debe tener seen_cap entradas (potencia de 2). Cuando se llena a 3/4 se vacia:
+ * es solo una cache, el almacen sigue siendo correcto.
+ */
+void cpuid_store_init(CPUID_H(store) *store, const char *dir, uint64_t *seen, size_t seen_cap);
+
+/*
+ * Guarda data como <dir>/<hash>.<ext> si no existe. Devuelve 1 si se escribio,
+ * 0 si ya estaba y -1 si hubo un error.
+ */
+int cpuid_store_put(CPUID_H(store) *store, uint64_t hash, const char *ext, const void *data, size_t len);
+
+/*
+ * Lee <dir>/<hash>.<ext> en data. Devuelve los bytes leidos, o -1 si no existe, no se pudo
+ * leer o ocupa mas de cap bytes.
+ */
+long cpuid_store_get(const CPUID_H(store) *store, uint64_t hash, const char *ext, void *data, size_t cap);
+
+typedef struct CPUID_H(ingest_host) {
+    char     name[CPUID_INGEST_MAX_HOST];
+    uint64_t variants[CPUID_INGEST_MAX_VARIANTS];
+    size_t   n_variants;
+    size_t   n_cpus;
+    size_t   dropped;    // bloques distintos fuera de variants (sin sitio o sin guardar)
+} CPUID_H(ingest_host);
+
+void cpuid_ingest_host_reset(CPUID_H(ingest_host) *host, const char *name);
+
+/*
+ * Normaliza un bloque de una CPU del host, lo guarda en el almacen si es nuevo y lo anade
+ * al snapshot del host. Devuelve -1 si fallo el almacen (el bloque no se anade y cuenta en
+ * host->dropped).
+ */
+int cpuid_ingest_host_add(CPUID_H(ingest_host) *host, CPUID_H(store) *store, CPUID_H(record) *block, size_t n);
+
+/*
+ * Cierra el snapshot del host: calcula su identificador y guarda el .snap si es nuevo.
+ * Devuelve el identificador, o 0 si el host no tenia CPU, si algun bloque quedo fuera del
+ * snapshot (host->dropped != 0; mas de CPUID_INGEST_MAX_VARIANTS bloques distintos o un .cpu
+ * que no se pudo guardar) o si no se pudo guardar el .snap.
+ */
+uint64_t cpuid_ingest_host_finish(CPUID_H(ingest_host) *host, CPUID_H(store) *store);
+
+#include "cpuid_ingest.c"
+#endif
@@ -0,0 +1,219 @@
+#ifndef __CPUID_JSON_C__
+#define __CPUID_JSON_C__
+
+#include "cpuid_json.h"
+
+#include <string.h>
+
+/*
+ * Cotas por elemento usadas en cpuid_json_size. Un registro ocupa como mucho
+ * {"leaf":N,"subleaf":N,"eax":N,"ebx":N,"ecx":N,"edx":N}, con N de hasta 10 cifras (~120 bytes).
+ * La cabecera de una CPU incluye vendor y brand (12 y 48 caracteres, hasta 6 bytes cada uno
+ * si hubiera que escaparlos) y los 64 nombres de caracteristicas.
+ */
+#define CPUID_JSON_RECORD_MAX 128
+#define CPUID_JSON_CPU_MAX    2048
+#define CPUID_JSON_DOC_MAX    64
+
+typedef struct CPUID_H(json_name) {
+    const char *name;
+    uint8_t     len;
+} CPUID_H(json_name);
+
+#define CPUID_JSON_NAME(name, bit) [bit] = { #name, sizeof(#name) - 1 },
+static const CPUID_H(json_name) cpuid_json_names_ecx[32] = { CPUID_FEAT_ECX_FIELDS(CPUID_JSON_NAME) };
+static const CPUID_H(json_name) cpuid_json_names_edx[32] = { CPUID_FEAT_EDX_FIELDS(CPUID_JSON_NAME) };
+#undef CPUID_JSON_NAME
+
+// copia un literal sin calcular su longitud en tiempo de ejecucion
+#define CPUID_JSON_LIT(p, lit) (memcpy((p), (lit), sizeof(lit) - 1), (p) + sizeof(lit) - 1)
+
+static inline char *cpuid_json_u32(char *p, uint32_t value) {
+    char   digits[10];
+    size_t n = 0;
+    do {
+        digits[n++] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+    while (n != 0) *p++ = digits[--n];
+    return p;
+}
+
+/*
+ * Cadena JSON a partir de los bytes de un registro de CPUID. Se corta en el primer '\0'
+ * y, como en la cadena de marca, se quitan los espacios iniciales.
+ */
+static char *cpuid_json_string(char *p, const char *s, size_t n) {
+    static const char hex[] = "0123456789abcdef";
+    size_t i = 0;
+
+    while (i < n && s[i] == ' ') i++;
+    *p++ = '"';
+    for (; i < n && s[i] != '\0'; i++) {
+        unsigned char c = (unsigned char)s[i];
+        if (c == '"' || c == '\\') {
+            *p++ = '\\';
+            *p++ = (char)c;
+        } else if (c < 0x20 || c >= 0x7f) {
+            p = CPUID_JSON_LIT(p, "\\u00");
+            *p++ = hex[c >> 4];
+            *p++ = hex[c & 0xf];
+        } else {
+            *p++ = (char)c;
+        }
+    }
+    *p++ = '"';
+    return p;
+}
+
+static char *cpuid_json_names(char *p, const CPUID_H(json_name) *names, uint32_t reg) {
+    int first = 1;
+    *p++ = '[';
+    for (int bit = 0; bit < 32; bit++) {
+        if (!((reg >> bit) & 1) || names[bit].name == NULL) continue;
+        if (names[bit].len == sizeof("RESERVADO") - 1 && memcmp(names[bit].name, "RESERVADO", names[bit].len) == 0) continue;
+        if (!first) *p++ = ',';
+        first = 0;
+        *p++ = '"';
+        memcpy(p, names[bit].name, names[bit].len);
+        p += names[bit].len;
+        *p++ = '"';
+    }
+    *p++ = ']';
+    return p;
+}
+
+static const CPUID_H(record) *cpuid_json_find(const CPUID_H(record) *block, size_t n_leaves, uint32_t leaf) {
+    for (size_t j = 0; j < n_leaves; j++) {
+        if (block[j].leaf == leaf && block[j].subleaf == 0) return &block[j];
+    }
+    return NULL;
+}
+
+/*
+ * Objeto de una CPU: campos decodificados de las hojas 0, 1 y 80000002h-80000004h
+ * (si estan en el snapshot) y la lista de registros en bruto.
+ */
+static char *cpuid_json_cpu(char *p, const CPUID_H(record) *block, size_t n_leaves, const char *host, size_t host_len) {
+    const CPUID_H(record) *leaf0 = cpuid_json_find(block, n_leaves, CPUID_GETVENDORSTRING);
+    const CPUID_H(record) *leaf1 = cpuid_json_find(block, n_leaves, CPUID_GETFEATURES);
+
+    *p++ = '{';
+    if (host != NULL) {
+        p = CPUID_JSON_LIT(p, "\"host\":");
+        p = cpuid_json_string(p, host, host_len);
+        *p++ = ',';
+    }
+    p = CPUID_JSON_LIT(p, "\"cpu\":");
+    p = cpuid_json_u32(p, block->cpu);
+    p = CPUID_JSON_LIT(p, ",\"status\":");
+    p = cpuid_json_u32(p, block->status);
+
+    if (leaf0 != NULL) {
+        uint32_t vendor[3] = { leaf0->ebx, leaf0->edx, leaf0->ecx };
+        p = CPUID_JSON_LIT(p, ",\"vendor\":");
+        p = cpuid_json_string(p, (const char *)vendor, sizeof(vendor));
+    }
+
+    const CPUID_H(record) *brand[3] = {
+        cpuid_json_find(block, n_leaves, CPUID_INTELBRANDSTRING),
+        cpuid_json_find(block, n_leaves, CPUID_INTELBRANDSTRINGMORE),
+        cpuid_json_find(block, n_leaves, CPUID_INTELBRANDSTRINGEND),
+    };
+    if (brand[0] != NULL && brand[1] != NULL && brand[2] != NULL) {
+        uint32_t text[12];
+        for (int i = 0; i < 3; i++) {
+            text[i * 4 + 0] = brand[i]->eax;
+            text[i * 4 + 1] = brand[i]->ebx;
+            text[i * 4 + 2] = brand[i]->ecx;
+            text[i * 4 + 3] = brand[i]->edx;
+        }
+        p = CPUID_JSON_LIT(p, ",\"brand\":");
+        p = cpuid_json_string(p, (const char *)text, sizeof(text));
+    }
+
+    if (leaf1 != NULL) {
+        Processor_Info_and_Feature_Bits info;
+        Additional_Information_Feature_Bits extra;
+        memcpy(&info,  &leaf1->eax, sizeof(info));
+        memcpy(&extra, &leaf1->ebx, sizeof(extra));
+
+        // familia y modelo "visibles": los campos extendidos solo cuentan en ciertas familias
+        uint32_t family = info.Family_ID;
+        uint32_t model  = info.Model;
+        if (info.Family_ID == 0xf) family += info.Extended_Family_ID;
+        if (info.Family_ID == 0x6 || info.Family_ID == 0xf) model += (uint32_t)info.Extended_Model_ID << 4;
+
+        p = CPUID_JSON_LIT(p, ",\"family\":");
+        p = cpuid_json_u32(p, family);
+        p = CPUID_JSON_LIT(p, ",\"model\":");
+        p = cpuid_json_u32(p, model);
+        p = CPUID_JSON_LIT(p, ",\"stepping\":");
+        p = cpuid_json_u32(p, info.Stepping_ID);
+        p = CPUID_JSON_LIT(p, ",\"signature\":");
+        p = cpuid_json_u32(p, leaf1->eax);
+        p = CPUID_JSON_LIT(p, ",\"apic_id\":");
+        p = cpuid_json_u32(p, extra.Local_APIC_ID);
+        p = CPUID_JSON_LIT(p, ",\"clflush_line\":");
+        p = cpuid_json_u32(p, extra.CLFLUSH * 8);
+        p = CPUID_JSON_LIT(p, ",\"max_logical\":");
+        p = cpuid_json_u32(p, extra.Max_ID_addressable);
+        // por separado: TSC y RESERVADO aparecen en los dos registros con significados distintos
+        p = CPUID_JSON_LIT(p, ",\"features\":{\"edx\":");
+        p = cpuid_json_names(p, cpuid_json_names_edx, leaf1->edx);
+        p = CPUID_JSON_LIT(p, ",\"ecx\":");
+        p = cpuid_json_names(p, cpuid_json_names_ecx, leaf1->ecx);
+        *p++ = '}';
+    }
+
+    p = CPUID_JSON_LIT(p, ",\"leaves\":[");
+    for (size_t j = 0; j < n_leaves; j++) {
+        const CPUID_H(record) *r = &block[j];
+        if (j != 0) *p++ = ',';
+        p = CPUID_JSON_LIT(p, "{\"leaf\":");
+        p = cpuid_json_u32(p, r->leaf);
+        p = CPUID_JSON_LIT(p, ",\"subleaf\":");
+        p = cpuid_json_u32(p, r->subleaf);
+        p = CPUID_JSON_LIT(p, ",\"eax\":");
+        p = cpuid_json_u32(p, r->eax);
+        p = CPUID_JSON_LIT(p, ",\"ebx\":");
+        p = cpuid_json_u32(p, r->ebx);
+        p = CPUID_JSON_LIT(p, ",\"ecx\":");
+        p = cpuid_json_u32(p, r->ecx);
+        p = CPUID_JSON_LIT(p, ",\"edx\":");
+        p = cpuid_json_u32(p, r->edx);
+        *p++ = '}';
+    }
+    p = CPUID_JSON_LIT(p, "]}");
+    return p;
+}
+
+size_t cpuid_json_size(const CPUID_H(snapshot) *snapshot, const char *host) {
+    // el nombre de host se repite en cada CPU, hasta 6 bytes por caracter escapado
+    size_t host_max = host != NULL ? 16 + 6 * strlen(host) : 0;
+    return CPUID_JSON_DOC_MAX
+         + snapshot->n_cpus    * (CPUID_JSON_CPU_MAX + host_max)
+         + snapshot->n_records * CPUID_JSON_RECORD_MAX;
+}
+
+size_t cpuid_json_dump(
+    const CPUID_H(snapshot) *snapshot, CPUID_H(json_format) format, const char *host, char *buf, size_t cap
+) {
+    // con la cota comprobada una vez, la escritura no necesita comprobar limites
+    if (cap < cpuid_json_size(snapshot, host)) return 0;
+    size_t host_len = host != NULL ? strlen(host) : 0;
+
+    char *p = buf;
+    if (format == CPUID_JSON) p = CPUID_JSON_LIT(p, "{\"cpus\":[");
+
+    for (size_t i = 0; i < snapshot->n_cpus; i++) {
+        if (format == CPUID_JSON && i != 0) *p++ = ',';
+        p = cpuid_json_cpu(p, snapshot->records + i * snapshot->n_leaves, snapshot->n_leaves, host, host_len);
+        if (format == CPUID_JSON_LINES) *p++ = '\n';
+    }
+
+    if (format == CPUID_JSON) p = CPUID_JSON_LIT(p, "]}\n");
+    return (size_t)(p - buf);
+}
+
+#endif
@@ -0,0 +1,52 @@
+#ifndef __CPUID_JSON_H__
+#define __CPUID_JSON_H__
+
+/*
+ * Volcado de un snapshot en JSON o NDJSON para consumo por maquinas (agentes de inventario, ...).
+ *
+ * A diferencia de las funciones print* de cpuid.c, que pasan cada linea por printf_color y
+ * su interprete de etiquetas #{...}, aqui todo el volcado se escribe a mano en un unico buffer
+ * reservado de antemano (el tamano maximo se conoce por el numero de CPU y de registros) y se
+ * envia a la salida con una sola llamada a write (cpuid_sink_write_fd).
+ *
+ * Formato (una entrada de "cpus" por CPU, en el orden del snapshot):
+ *
+ *      {"cpus":[{"host":"nodo-17","cpu":0,"status":0,"vendor":"GenuineIntel","brand":"...",
+ *                "family":6,"model":158,"stepping":10,"signature":591594,
+ *                "apic_id":0,"clflush_line":64,"max_logical":16,
+ *                "features":{"edx":["FPU","VME",...],"ecx":["SSE3",...]},
+ *                "leaves":[{"leaf":0,"subleaf":0,"eax":22,"ebx":...,"ecx":...,"edx":...},...]}]}
+ *
+ * En NDJSON cada CPU es un objeto independiente (el mismo que un elemento de "cpus") seguido
+ * de '\n'. "host" solo aparece si se indica un nombre de host (NDJSON de varios hosts en un
+ * mismo flujo, ver ingest.c). status es CPUID_RECORD_NOT_PINNED si no se pudo ejecutar CPUID
+ * en esa CPU.
+ * Los registros se emiten como numeros decimales sin signo.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "cpuid_snapshot.h"
+
+typedef enum CPUID_H(json_format) {
+    CPUID_JSON        = 0, // un documento con todas las CPU
+    CPUID_JSON_LINES  = 1, // NDJSON: un objeto por CPU y linea
+} CPUID_H(json_format);
+
+/*
+ * Cota superior en bytes del volcado de snapshot (para reservar el buffer una unica vez).
+ * host puede ser NULL.
+ */
+size_t cpuid_json_size(const CPUID_H(snapshot) *snapshot, const char *host);
+
+/*
+ * Escribe el volcado de snapshot en buf, con el campo "host" en cada CPU si host no es NULL.
+ * Devuelve los bytes escritos (sin '\0'), o 0 si cap es menor que cpuid_json_size(snapshot, host).
+ */
+size_t cpuid_json_dump(
+    const CPUID_H(snapshot) *snapshot, CPUID_H(json_format) format, const char *host, char *buf, size_t cap
+);
+
+#include "cpuid_json.c"
+#endif
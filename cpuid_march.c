@@ -0,0 +1,182 @@
+#ifndef __CPUID_MARCH_C__
+#define __CPUID_MARCH_C__
+
+#include "cpuid_march.h"
+
+#include <string.h>
+
+#define CPUID_MARCH_MAX_DEPTH 16
+#define CPUID_MARCH_NAME_MAX  32
+
+static const CPUID_H(march_target) cpuid_march_table[] = {
+    // niveles de la psABI de x86-64 (ABM es LZCNT y LAHF_LM es LAHF/SAHF en modo de 64 bits)
+    { "x86-64",         1, NULL,             "FPU CMOV CX8 MMX FXSR SSE SSE2 SYSCALL" },
+    { "x86-64-v2",      2, "x86-64",         "CX16 LAHF_LM POPCNT SSE3 SSE4_1 SSE4_2 SSSE3" },
+    { "x86-64-v3",      3, "x86-64-v2",      "AVX AVX2 BMI1 BMI2 F16C FMA ABM MOVBE XSAVE OSXSAVE" },
+    { "x86-64-v4",      4, "x86-64-v3",      "AVX512F AVX512BW AVX512CD AVX512DQ AVX512VL" },
+
+    // Intel
+    { "core2",          0, "x86-64",         "SSE3 SSSE3 CX16" },
+    { "nehalem",        0, "core2",          "SSE4_1 SSE4_2 POPCNT LAHF_LM" },
+    { "westmere",       0, "nehalem",        "PCLMUL AES" },
+    { "sandybridge",    0, "westmere",       "AVX XSAVE XSAVEOPT" },
+    { "ivybridge",      0, "sandybridge",    "FSGSBASE RDRAND F16C" },
+    { "haswell",        0, "ivybridge",      "AVX2 BMI1 BMI2 ABM FMA MOVBE" },
+    { "broadwell",      0, "haswell",        "ADX RDSEED PREFETCHW" },
+    { "skylake",        0, "broadwell",      "CLFLUSHOPT XSAVEC XSAVES" },
+    { "skylake-avx512", 0, "skylake",        "AVX512F AVX512CD AVX512VL AVX512BW AVX512DQ PKU CLWB" },
+    { "cascadelake",    0, "skylake-avx512", "AVX512_VNNI" },
+    { "cooperlake",     0, "cascadelake",    "AVX512_BF16" },
+    { "icelake-server", 0, "skylake-avx512", "AVX512_VBMI AVX512_IFMA SHA UMIP AVX512_VNNI GFNI VAES AVX512_VBMI2 "
+                                             "VPCLMULQDQ AVX512_BITALG RDPID AVX512_VPOPCNTDQ" },
+    { "sapphirerapids", 0, "icelake-server", "MOVDIRI MOVDIR64B CLDEMOTE WAITPKG SERIALIZE AMX_TILE AMX_INT8 "
+                                             "AMX_BF16 AVX_VNNI AVX512_FP16 AVX512_BF16" },
+    { "alderlake",      0, "skylake",        "CLWB GFNI MOVDIR64B MOVDIRI PKU RDPID SERIALIZE SHA VAES "
+                                             "VPCLMULQDQ WAITPKG AVX_VNNI CLDEMOTE" },
+
+    // AMD
+    { "znver1",         0, "x86-64-v3",      "SSE4A ADX RDSEED PREFETCHW CLZERO CLFLUSHOPT XSAVEOPT XSAVEC XSAVES "
+                                             "SHA AES PCLMUL FSGSBASE RDRAND" },
+    { "znver2",         0, "znver1",         "CLWB RDPID" },
+    { "znver3",         0, "znver2",         "VAES VPCLMULQDQ PKU" },
+    { "znver4",         0, "znver3",         "AVX512F AVX512CD AVX512BW AVX512DQ AVX512VL AVX512_BF16 AVX512_VBMI "
+                                             "AVX512_VBMI2 GFNI AVX512_VNNI AVX512_BITALG AVX512_IFMA AVX512_VPOPCNTDQ" },
+};
+
+#define CPUID_MARCH_N (sizeof(cpuid_march_table) / sizeof(cpuid_march_table[0]))
+
+size_t cpuid_march_count(void) {
+    return CPUID_MARCH_N;
+}
+
+const CPUID_H(march_target) *cpuid_march_at(size_t target) {
+    return target < CPUID_MARCH_N ? &cpuid_march_table[target] : NULL;
+}
+
+int cpuid_march_find(const char *name) {
+    for (size_t i = 0; i < CPUID_MARCH_N; i++) {
+        if (cpuid_features_same_name(cpuid_march_table[i].name, name)) return (int)i;
+    }
+    return -1;
+}
+
+/*
+ * Recorre las caracteristicas del objetivo, de la raiz hacia el. Por cada una llama a visit
+ * con el nombre (copiado en un buffer propio) y devuelve la suma de lo que devuelve visit.
+ */
+typedef size_t (*cpuid_march_visitor)(const char *name, void *context);
+
+static size_t cpuid_march_walk(size_t target, cpuid_march_visitor visit, void *context) {
+    const CPUID_H(march_target) *chain[CPUID_MARCH_MAX_DEPTH];
+    size_t                       depth = 0;
+
+    for (const CPUID_H(march_target) *t = cpuid_march_at(target); t != NULL && depth < CPUID_MARCH_MAX_DEPTH;) {
+        chain[depth++] = t;
+        int parent = t->parent != NULL ? cpuid_march_find(t->parent) : -1;
+        t = parent >= 0 ? &cpuid_march_table[parent] : NULL;
+    }
+
+    size_t total = 0;
+    char   name[CPUID_MARCH_NAME_MAX];
+    while (depth != 0) {
+        for (const char *p = chain[--depth]->features; *p != '\0';) {
+            while (*p == ' ') p++;
+            size_t len = 0;
+            while (p[len] != '\0' && p[len] != ' ') len++;
+            if (len != 0 && len < sizeof(name)) {
+                memcpy(name, p, len);
+                name[len] = '\0';
+                total += visit(name, context);
+            }
+            p += len;
+        }
+    }
+    return total;
+}
+
+typedef struct cpuid_march_list {
+    const CPUID_H(featureset) *have;    // NULL para listar todas
+    CPUID_H(featureset)        seen;    // para contar una vez las que se repiten en varios niveles
+    const char               **names;
+    size_t                     max;
+    size_t                     n;
+} cpuid_march_list;
+
+static size_t cpuid_march_collect(const char *name, void *context) {
+    cpuid_march_list *list = context;
+    int               id   = cpuid_feature_find(name);
+
+    // un nombre que no esta en cpuid_features no lo cumple ningun host
+    if (id >= 0) {
+        if (cpuid_featureset_test(&list->seen, (size_t)id)) return 0;
+        list->seen.bits[id / 64] |= 1ull << (id % 64);
+        if (list->have != NULL && cpuid_featureset_has(list->have, name)) return 0;
+    }
+    // el nombre de la tabla de cpuid_features: el buffer de cpuid_march_walk no dura
+    if (list->names != NULL && list->n < list->max) {
+        list->names[list->n] = id >= 0 ? cpuid_feature_table[id].name : "?";
+    }
+    list->n++;
+    return 1;
+}
+
+size_t cpuid_march_features(size_t target, const char **names, size_t max) {
+    cpuid_march_list list = { NULL, { { 0 } }, names, names != NULL ? max : 0, 0 };
+    cpuid_march_walk(target, cpuid_march_collect, &list);
+    return list.n;
+}
+
+size_t cpuid_march_missing(const CPUID_H(featureset) *have, size_t target, const char **names, size_t max) {
+    cpuid_march_list list = { have, { { 0 } }, names, names != NULL ? max : 0, 0 };
+    cpuid_march_walk(target, cpuid_march_collect, &list);
+    return list.n;
+}
+
+int cpuid_march_level(const CPUID_H(featureset) *have) {
+    int level = 0;
+    for (size_t i = 0; i < CPUID_MARCH_N; i++) {
+        const CPUID_H(march_target) *t = &cpuid_march_table[i];
+        if (t->level > level && cpuid_march_satisfies(have, i)) level = t->level;
+    }
+    return level;
+}
+
+const char *cpuid_march_level_name(int level) {
+    for (size_t i = 0; i < CPUID_MARCH_N; i++) {
+        if (level != 0 && cpuid_march_table[i].level == level) return cpuid_march_table[i].name;
+    }
+    return NULL;
+}
+
+int cpuid_march_classify(const CPUID_H(featureset) *have, CPUID_H(march_report) *report) {
+    memset(report, 0, sizeof(*report));
+    for (size_t i = 0; i < CPUID_MARCH_N; i++) {
+        int level = cpuid_march_table[i].level;
+        if (level == 0) continue;
+        report->n_missing[level] = cpuid_march_missing(have, i, report->missing[level], CPUID_MARCH_MISSING_MAX);
+        if (report->n_missing[level] == 0 && level > report->level) report->level = level;
+    }
+    return report->level;
+}
+
+int cpuid_march_host_level(CPUID_H(march_report) *report) {
+    CPUID_H(featureset) have;
+    cpuid_features_current(&have);
+    return cpuid_march_classify(&have, report);
+}
+
+int cpuid_march_best(const CPUID_H(featureset) *have) {
+    int    best      = -1;
+    size_t best_size = 0;
+    for (size_t i = 0; i < CPUID_MARCH_N; i++) {
+        if (cpuid_march_table[i].level != 0 || !cpuid_march_satisfies(have, i)) continue;
+        size_t size = cpuid_march_features(i, NULL, 0);
+        if (best < 0 || size > best_size) {
+            best      = (int)i;
+            best_size = size;
+        }
+    }
+    return best;
+}
+
+#endif
@@ -0,0 +1,105 @@
+#ifndef __CPUID_MARCH_H__
+#define __CPUID_MARCH_H__
+
+/*
+ * Objetivos de compilacion de x86-64: los niveles de la psABI (x86-64, x86-64-v2, -v3 y -v4)
+ * y los -march con nombre de GCC y Clang (nehalem, haswell, skylake-avx512, znver3, ...),
+ * cada uno con las caracteristicas de cpuid_features que necesita un binario compilado para el.
+ *
+ * Un objetivo hereda las caracteristicas de su padre y anade las suyas. Solo se piden las
+ * extensiones que el compilador puede generar sin que el programa las pida: las que dependen
+ * del sistema o del firmware (SGX, HLE/RTM, KL, PCONFIG, WBNOINVD, UINTR, ENQCMD, TSXLDTRK,
+ * MONITORX, PTWRITE, HRESET) no se piden aunque el -march las active, porque muchos hosts
+ * las tienen ocultas y un binario normal no las usa.
+ *
+ * Las caracteristicas hay que mirarlas con cpuid_features_usable o cpuid_features_current:
+ * un host con AVX-512 en CPUID cuyo sistema no guarda los registros ZMM no puede ejecutar un
+ * binario para x86-64-v4.
+ */
+
+#include <stddef.h>
+
+#include "cpuid_features.h"
+
+typedef struct CPUID_H(march_target) {
+    const char *name;       // el valor de -march
+    int         level;      // 1-4 para x86-64-vN, 0 para los objetivos con nombre
+    const char *parent;     // NULL para x86-64
+    const char *features;   // nombres de cpuid_features separados por espacios (sin los del padre)
+} CPUID_H(march_target);
+
+/*
+ * Tabla de objetivos: primero los niveles de menor a mayor y despues los objetivos con nombre,
+ * cada uno detras de su padre.
+ */
+size_t cpuid_march_count(void);
+const CPUID_H(march_target) *cpuid_march_at(size_t target);
+
+/*
+ * Indice del objetivo con ese nombre (sin distinguir mayusculas), o -1.
+ */
+int cpuid_march_find(const char *name);
+
+/*
+ * Todas las caracteristicas que necesita el objetivo (las suyas y las de sus antecesores).
+ * Escribe como maximo max nombres en names (que puede ser NULL) y devuelve el total.
+ */
+size_t cpuid_march_features(size_t target, const char **names, size_t max);
+
+/*
+ * Caracteristicas del objetivo que no estan en have. Escribe como maximo max nombres en names
+ * (que puede ser NULL) y devuelve el total: 0 si un host con have puede ejecutar el binario.
+ */
+size_t cpuid_march_missing(const CPUID_H(featureset) *have, size_t target, const char **names, size_t max);
+
+static inline int cpuid_march_satisfies(const CPUID_H(featureset) *have, size_t target) {
+    return cpuid_march_missing(have, target, NULL, 0) == 0;
+}
+
+/*
+ * Mayor nivel de la psABI (1-4) que cumple have, o 0 si no llega a x86-64.
+ */
+int cpuid_march_level(const CPUID_H(featureset) *have);
+
+/*
+ * Nombre del nivel ("x86-64", "x86-64-v2", ...), o NULL si level no es 1-4. Para los niveles
+ * 2-4 es tambien el subdirectorio de glibc-hwcaps donde se instalan las variantes de una
+ * biblioteca (lib/glibc-hwcaps/x86-64-v3/libfoo.so).
+ */
+const char *cpuid_march_level_name(int level);
+
+#define CPUID_MARCH_LEVELS      4
+#define CPUID_MARCH_MISSING_MAX 32   // caracteristicas de x86-64-v4 contando las de sus padres
+
+typedef struct CPUID_H(march_report) {
+    int         level;                                      // mayor nivel que se cumple, 0-4
+    size_t      n_missing[CPUID_MARCH_LEVELS + 1];          // [n]: las que faltan para x86-64-vN
+    const char *missing[CPUID_MARCH_LEVELS + 1][CPUID_MARCH_MISSING_MAX];
+} CPUID_H(march_report);
+
+/*
+ * Nivel de la psABI de have con lo que falta para cada nivel (n_missing[1..4] y missing).
+ * Devuelve report->level.
+ */
+int cpuid_march_classify(const CPUID_H(featureset) *have, CPUID_H(march_report) *report);
+
+/*
+ * Lo mismo para la CPU actual, con cpuid_features_current (XGETBV en lugar de la hoja 0Dh).
+ * Es lo que hay que mirar al arrancar para elegir la variante de una biblioteca o un plugin:
+ *
+ *      CPUID_H(march_report) report;
+ *      for (int level = cpuid_march_host_level(&report); level > 1; level--) {
+ *          snprintf(path, sizeof(path), "plugins/%s/plugin.so", cpuid_march_level_name(level));
+ *          if ((handle = dlopen(path, RTLD_NOW)) != NULL) break;
+ *      }
+ */
+int cpuid_march_host_level(CPUID_H(march_report) *report);
+
+/*
+ * Objetivo con nombre que cumple have y necesita mas caracteristicas (el que mas aprovecha el
+ * host), o -1 si no cumple ninguno. Con empates gana el primero de la tabla.
+ */
+int cpuid_march_best(const CPUID_H(featureset) *have);
+
+#include "cpuid_march.c"
+#endif
@@ -0,0 +1,228 @@
+#ifndef __CPUID_MEMBENCH_C__
+#define __CPUID_MEMBENCH_C__
+
+#include "cpuid_membench.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define CPUID_MEMBENCH_HAS_SSE2 1
+#else
+    #define CPUID_MEMBENCH_HAS_SSE2 0
+#endif
+
+#define CPUID_MEMBENCH_MIN_MEMORY  (64ull << 20)
+#define CPUID_MEMBENCH_BYTES       (256ull << 20)   // trafico minimo por medida de ancho de banda
+#define CPUID_MEMBENCH_LOADS       (1u << 21)       // cargas minimas por medida de latencia
+
+// evita que el compilador elimine los bucles de medida
+static volatile uint64_t cpuid_membench_sink;
+
+static size_t cpuid_membench_leaf(uint32_t leaf, CPUID_H(cache_level) *levels, size_t n, size_t max) {
+    uint32_t eax, ebx, ecx, edx;
+
+    call_cpuid(leaf & 0x80000000, 0, &eax, &ebx, &ecx, &edx);
+    if (eax < leaf) return n;
+    for (uint32_t subleaf = 0; subleaf < 32; subleaf++) {
+        call_cpuid(leaf, subleaf, &eax, &ebx, &ecx, &edx);
+        uint32_t type = eax & 0x1f;
+        if (type == 0) break;
+        if (type == 2) continue;            // instrucciones
+        if (n < max) {
+            CPUID_H(cache_level) *l = &levels[n];
+            l->level  = (eax >> 5) & 0x7;
+            l->type   = type;
+            l->line   = (ebx & 0xfff) + 1;
+            l->size   = (uint64_t)((ebx >> 22) + 1) * (((ebx >> 12) & 0x3ff) + 1) * l->line * ((uint64_t)ecx + 1);
+            l->shared = ((eax >> 14) & 0xfff) + 1;
+        }
+        n++;
+    }
+    return n;
+}
+
+static int cpuid_membench_level_cmp(const void *a, const void *b) {
+    const CPUID_H(cache_level) *x = a, *y = b;
+    return x->level != y->level ? (x->level < y->level ? -1 : 1) : 0;
+}
+
+size_t cpuid_membench_caches(CPUID_H(cache_level) *levels, size_t max) {
+    // la hoja 4 en AMD no describe nada; en Intel 8000001Dh esta reservada
+    size_t n = cpuid_membench_leaf(0x00000004, levels, 0, max);
+    if (n == 0) n = cpuid_membench_leaf(0x8000001d, levels, 0, max);
+    qsort(levels, n < max ? n : max, sizeof(*levels), cpuid_membench_level_cmp);
+    return n;
+}
+
+static int cpuid_membench_u64_cmp(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t*)a, y = *(const uint64_t*)b;
+    return x < y ? -1 : x > y;
+}
+
+size_t cpuid_membench_sizes(const CPUID_H(cache_level) *levels, size_t n_levels, uint64_t memory_size, uint64_t *sizes, size_t max) {
+    uint64_t candidates[2 * CPUID_MEMBENCH_MAX_LEVELS + 1], largest = 0;
+    size_t   n = 0;
+
+    for (size_t i = 0; i < n_levels && i < CPUID_MEMBENCH_MAX_LEVELS; i++) {
+        candidates[n++] = levels[i].size / 2;
+        candidates[n++] = levels[i].size * 2;
+        if (levels[i].size > largest) largest = levels[i].size;
+    }
+    if (memory_size == 0) {
+        memory_size = largest * 4;
+        if (memory_size < CPUID_MEMBENCH_MIN_MEMORY) memory_size = CPUID_MEMBENCH_MIN_MEMORY;
+    }
+    // por debajo del doble de la ultima cache no quedaria ningun conjunto solo en memoria
+    if (memory_size < largest * 2) memory_size = largest * 2;
+    candidates[n++] = memory_size;
+    qsort(candidates, n, sizeof(*candidates), cpuid_membench_u64_cmp);
+
+    size_t out = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (candidates[i] == 0 || candidates[i] > memory_size) continue;
+        if (out > 0 && candidates[i] == sizes[out - 1]) continue;
+        if (out < max) sizes[out++] = candidates[i];
+    }
+    return out;
+}
+
+double cpuid_membench_latency(void *buffer, size_t size, size_t stride, double tsc_hz) {
+    size_t         n     = size / stride;
+    unsigned char *base  = buffer;
+    uint32_t      *order = malloc(sizeof(*order) * (n != 0 ? n : 1));
+    uint64_t       x     = 88172645463325252ull;
+    if (order == NULL || n < 2) {
+        free(order);
+        return 0;
+    }
+
+    // ciclo aleatorio por todos los nodos (algoritmo de Sattolo)
+    for (size_t i = 0; i < n; i++) order[i] = (uint32_t)i;
+    for (size_t i = n - 1; i > 0; i--) {
+        x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+        size_t   j   = (size_t)(x % i);
+        uint32_t tmp = order[i];
+        order[i] = order[j];
+        order[j] = tmp;
+    }
+    for (size_t i = 0; i < n; i++) {
+        void *next = base + (size_t)order[(i + 1) % n] * stride;
+        memcpy(base + (size_t)order[i] * stride, &next, sizeof(next));
+    }
+    free(order);
+
+    size_t loads = n * 2 > CPUID_MEMBENCH_LOADS ? n * 2 : CPUID_MEMBENCH_LOADS;
+    void  *p     = base;
+    for (size_t i = 0; i < n; i++) p = *(void**)p;     // calienta la cache y el TLB
+
+    uint64_t begin = cpuid_tsc_read();
+    for (size_t i = 0; i < loads; i++) p = *(void**)p;
+    uint64_t end   = cpuid_tsc_read();
+
+    cpuid_membench_sink += (uintptr_t)p;
+    return (double)(end - begin) * 1e9 / tsc_hz / (double)loads;
+}
+
+#if CPUID_MEMBENCH_HAS_SSE2
+/*
+ * Todos los tipos usan las mismas cargas y almacenamientos de 16 bytes (MOVDQA, MOVNTDQ), cuatro
+ * por iteracion, para que solo cambie el patron de acceso y no el ancho de las instrucciones
+ * (memcpy o un bucle del compilador usarian AVX en unos casos y SSE2 en otros).
+ */
+static void cpuid_membench_pass(CPUID_H(membench_kind) kind, __m128i *vector, size_t n) {
+    switch (kind) {
+        case CPUID_MEMBENCH_READ: {
+            // cuatro acumuladores independientes para no esperar a la suma anterior
+            __m128i s0 = _mm_setzero_si128(), s1 = s0, s2 = s0, s3 = s0;
+            for (size_t i = 0; i + 4 <= n; i += 4) {
+                s0 = _mm_add_epi64(s0, _mm_load_si128(&vector[i]));
+                s1 = _mm_add_epi64(s1, _mm_load_si128(&vector[i + 1]));
+                s2 = _mm_add_epi64(s2, _mm_load_si128(&vector[i + 2]));
+                s3 = _mm_add_epi64(s3, _mm_load_si128(&vector[i + 3]));
+            }
+            s0 = _mm_add_epi64(_mm_add_epi64(s0, s1), _mm_add_epi64(s2, s3));
+            cpuid_membench_sink += (uint64_t)_mm_cvtsi128_si32(s0);
+            break;
+        }
+        case CPUID_MEMBENCH_WRITE: {
+            __m128i value = _mm_set1_epi32((int)n);
+            for (size_t i = 0; i + 4 <= n; i += 4) {
+                _mm_store_si128(&vector[i],     value);
+                _mm_store_si128(&vector[i + 1], value);
+                _mm_store_si128(&vector[i + 2], value);
+                _mm_store_si128(&vector[i + 3], value);
+            }
+            break;
+        }
+        case CPUID_MEMBENCH_COPY: {
+            // primera mitad sobre la segunda
+            __m128i *to = vector + n / 2;
+            for (size_t i = 0; i + 4 <= n / 2; i += 4) {
+                __m128i v0 = _mm_load_si128(&vector[i]);
+                __m128i v1 = _mm_load_si128(&vector[i + 1]);
+                __m128i v2 = _mm_load_si128(&vector[i + 2]);
+                __m128i v3 = _mm_load_si128(&vector[i + 3]);
+                _mm_store_si128(&to[i],     v0);
+                _mm_store_si128(&to[i + 1], v1);
+                _mm_store_si128(&to[i + 2], v2);
+                _mm_store_si128(&to[i + 3], v3);
+            }
+            break;
+        }
+        case CPUID_MEMBENCH_NT_WRITE: {
+            __m128i value = _mm_set1_epi32((int)n);
+            for (size_t i = 0; i + 4 <= n; i += 4) {
+                _mm_stream_si128(&vector[i],     value);
+                _mm_stream_si128(&vector[i + 1], value);
+                _mm_stream_si128(&vector[i + 2], value);
+                _mm_stream_si128(&vector[i + 3], value);
+            }
+            _mm_sfence();
+            break;
+        }
+        default:
+            break;
+    }
+}
+#endif
+
+double cpuid_membench_bandwidth(CPUID_H(membench_kind) kind, void *buffer, size_t size, double tsc_hz) {
+#if CPUID_MEMBENCH_HAS_SSE2
+    size_t n = size / sizeof(__m128i);
+    if (n < 8 || kind >= CPUID_MEMBENCH_KINDS) return 0;
+
+    size_t passes = (size_t)(CPUID_MEMBENCH_BYTES / size);
+    if (passes == 0) passes = 1;
+
+    cpuid_membench_pass(kind, buffer, n);    // calienta la cache y el TLB
+    uint64_t begin = cpuid_tsc_read();
+    for (size_t i = 0; i < passes; i++) cpuid_membench_pass(kind, buffer, n);
+    uint64_t end   = cpuid_tsc_read();
+
+    double seconds = (double)(end - begin) / tsc_hz;
+    return seconds > 0 ? (double)size * (double)passes / seconds / 1e9 : 0;
+#else
+    (void)kind; (void)buffer; (void)size; (void)tsc_hz;
+    return 0;
+#endif
+}
+
+void cpuid_membench_run(
+    CPUID_H(membench_result) *result, void *buffer, uint64_t size,
+    const CPUID_H(cache_level) *levels, size_t n_levels, double tsc_hz
+) {
+    memset(result, 0, sizeof(*result));
+    result->size = size;
+    for (size_t i = 0; i < n_levels && result->level == 0; i++) {
+        if (size <= levels[i].size) result->level = levels[i].level;
+    }
+    size_t line = n_levels != 0 ? levels[0].line : 64;
+    result->latency_ns = cpuid_membench_latency(buffer, (size_t)size, line, tsc_hz);
+    for (int kind = 0; kind < CPUID_MEMBENCH_KINDS; kind++) {
+        result->gbps[kind] = cpuid_membench_bandwidth((CPUID_H(membench_kind))kind, buffer, (size_t)size, tsc_hz);
+    }
+}
+
+#endif
@@ -0,0 +1,85 @@
+#ifndef __CPUID_MEMBENCH_H__
+#define __CPUID_MEMBENCH_H__
+
+/*
+ * Latencia y ancho de banda de cada nivel de la jerarquia de memoria.
+ *
+ * Los tamanos de cache salen de la hoja 4 (Intel) o 8000001Dh (AMD): ways * particiones *
+ * linea * sets, como en cpuid_features_cache_kb. Con ellos se eligen conjuntos de trabajo a
+ * ambos lados de cada nivel (la mitad y el doble) y uno de memoria (4 veces la ultima cache)
+ * y en cada uno se mide:
+ *
+ *  - latencia de carga: recorrido de punteros en orden aleatorio, un nodo por linea, para que
+ *    ni el prefetcher ni la ejecucion fuera de orden adelanten la siguiente carga (con paginas
+ *    de 4 KiB incluye los fallos de TLB a partir de unos cientos de KiB);
+ *  - ancho de banda de lectura, escritura, copia y escritura no temporal (MOVNTDQ, que no
+ *    trae la linea a la cache antes de escribirla), todos con accesos SSE2 de 16 bytes para
+ *    que sean comparables entre si.
+ *
+ * El tiempo se toma con el TSC, con su ritmo medido frente al reloj del sistema (cpuid_tsc_hz;
+ * el TSC invariante, CPUID.80000007h:EDX[8], no cambia con la frecuencia del nucleo). Un perfil
+ * muy por debajo de lo esperado para el procesador delata, por ejemplo, prefetchers
+ * desactivados en la BIOS (lectura secuencial casi tan lenta como la latencia) o canales de
+ * memoria sin poblar (ancho de banda de memoria bajo con latencia normal).
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "cpuid_percpu.h"
+#include "cpuid_tsc.h"
+
+#define CPUID_MEMBENCH_MAX_LEVELS 8
+
+typedef enum CPUID_H(membench_kind) {
+    CPUID_MEMBENCH_READ = 0,
+    CPUID_MEMBENCH_WRITE,
+    CPUID_MEMBENCH_COPY,            // cuenta lo leido y lo escrito
+    CPUID_MEMBENCH_NT_WRITE,
+    CPUID_MEMBENCH_KINDS
+} CPUID_H(membench_kind);
+
+typedef struct CPUID_H(cache_level) {
+    uint32_t level;
+    uint32_t type;                  // 1 datos, 3 unificada
+    uint64_t size;                  // bytes
+    uint32_t line;
+    uint32_t shared;                // procesadores logicos que la comparten
+} CPUID_H(cache_level);
+
+typedef struct CPUID_H(membench_result) {
+    uint64_t size;                  // bytes del conjunto de trabajo
+    uint32_t level;                 // nivel mas pequeno en el que cabe, 0 si solo en memoria
+    double   latency_ns;
+    double   gbps[CPUID_MEMBENCH_KINDS];    // 10^9 bytes por segundo, 0 si no se pudo medir
+} CPUID_H(membench_result);
+
+/*
+ * Caches de datos y unificadas, ordenadas por nivel. Devuelve cuantas hay (puede ser mayor
+ * que max; solo se escriben las max primeras).
+ */
+size_t cpuid_membench_caches(CPUID_H(cache_level) *levels, size_t max);
+
+/*
+ * Conjuntos de trabajo para las caches dadas, en orden creciente y sin repetir: la mitad y el
+ * doble de cada nivel y memory_size (0 usa 4 veces la mayor cache, al menos 64 MiB; nunca
+ * menos del doble de la mayor cache, para que el ultimo conjunto quede fuera de las caches).
+ */
+size_t cpuid_membench_sizes(const CPUID_H(cache_level) *levels, size_t n_levels, uint64_t memory_size, uint64_t *sizes, size_t max);
+
+// nanosegundos por carga recorriendo size bytes de buffer, un nodo cada stride bytes
+double cpuid_membench_latency(void *buffer, size_t size, size_t stride, double tsc_hz);
+
+// ancho de banda en 10^9 bytes/s sobre size bytes de buffer (alineado a 64), o 0 si no se puede
+double cpuid_membench_bandwidth(CPUID_H(membench_kind) kind, void *buffer, size_t size, double tsc_hz);
+
+/*
+ * Mide todo en un conjunto de trabajo. buffer debe tener al menos size bytes alineados a 64.
+ */
+void   cpuid_membench_run(
+    CPUID_H(membench_result) *result, void *buffer, uint64_t size,
+    const CPUID_H(cache_level) *levels, size_t n_levels, double tsc_hz
+);
+
+#include "cpuid_membench.c"
+#endif
@@ -0,0 +1,154 @@
+#ifndef __CPUID_PARALLELISM_C__
+#define __CPUID_PARALLELISM_C__
+
+#include "cpuid_parallelism.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// nucleo de una CPU usable, para contar nucleos distintos ordenando
+typedef struct cpuid_parallelism_core {
+    uint32_t core;
+    uint32_t type;
+} cpuid_parallelism_core;
+
+static int cpuid_parallelism_core_cmp(const void *a, const void *b) {
+    const cpuid_parallelism_core *x = a, *y = b;
+    return x->core != y->core ? (x->core < y->core ? -1 : 1) : 0;
+}
+
+// CPU por periodo de un cgroup, o 0 si no tiene limite (o no tiene el fichero)
+static double cpuid_parallelism_level_quota(const char *dir, int version) {
+    char   text[64], max[32];
+    double quota, period;
+
+    if (version == 2) {
+        // "max 100000" o "50000 100000"
+        if (cpuid_topology_read(text, sizeof(text), "%s/cpu.max", dir) != 0) return 0;
+        if (sscanf(text, "%31s %lf", max, &period) != 2 || strcmp(max, "max") == 0 || period <= 0) return 0;
+        quota = strtod(max, NULL);
+    } else {
+        // cpu.cfs_quota_us vale -1 sin limite
+        if (cpuid_topology_read(text, sizeof(text), "%s/cpu.cfs_quota_us", dir) != 0) return 0;
+        quota = strtod(text, NULL);
+        if (cpuid_topology_read(text, sizeof(text), "%s/cpu.cfs_period_us", dir) != 0) return 0;
+        period = strtod(text, NULL);
+        if (period <= 0) return 0;
+    }
+    return quota > 0 ? quota / period : 0;
+}
+
+// la cuota mas restrictiva del cgroup del proceso y sus antecesores
+static double cpuid_parallelism_quota(const char *root) {
+    char   dir[CPUID_WATCH_PATH_MAX], base[CPUID_WATCH_PATH_MAX], group[CPUID_WATCH_PATH_MAX];
+    double quota = 0;
+
+    int version = cpuid_watch_cgroup(root, "cpu", base, group);
+    if (version == 0) return 0;
+    for (;;) {
+        if (snprintf(dir, sizeof(dir), "%s%s", base, group) < (int)sizeof(dir)) {
+            double level = cpuid_parallelism_level_quota(dir, version);
+            if (level > 0 && (quota == 0 || level < quota)) quota = level;
+        }
+        char *slash = strrchr(group, '/');
+        if (slash == NULL) break;
+        *slash = '\0';
+    }
+    return quota;
+}
+
+int cpuid_parallelism_query(
+    CPUID_H(parallelism) *par, const char *root,
+    const uint32_t *cpus, size_t n_cpus, const CPUID_H(topology) *topo
+) {
+    char                    path[CPUID_WATCH_PATH_MAX];
+    CPUID_H(cpumask)        online, cpuset;
+    CPUID_H(topology)       own_topo = { 0 };
+    CPUID_H(snapshot)       snapshot = { 0 };
+    uint32_t               *own_cpus = NULL, *usable = NULL;
+    cpuid_parallelism_core *cores    = NULL;
+    int                     status   = -1;
+
+    memset(par, 0, sizeof(*par));
+    if (root == NULL) root = "";
+
+    if (cpus == NULL) {
+        n_cpus   = cpuid_affinity_cpus(NULL, 0);
+        own_cpus = malloc(sizeof(*own_cpus) * (n_cpus != 0 ? n_cpus : 1));
+        if (own_cpus == NULL) goto done;
+        size_t total = cpuid_affinity_cpus(own_cpus, n_cpus);
+        if (total < n_cpus) n_cpus = total;
+        cpus = own_cpus;
+    }
+
+    // afinidad, CPU conectadas y cpuset (sin los ficheros no se limita nada)
+    int has_online = snprintf(path, sizeof(path), "%s/sys/devices/system/cpu/online", root) < (int)sizeof(path)
+        && cpuid_watch_read_mask(path, &online) == 0;
+    cpuid_watch_cpuset_path(root, path, sizeof(path));
+    int has_cpuset = path[0] != '\0' && cpuid_watch_read_mask(path, &cpuset) == 0;
+
+    usable = malloc(sizeof(*usable) * (n_cpus != 0 ? n_cpus : 1));
+    if (usable == NULL) goto done;
+    for (size_t i = 0; i < n_cpus; i++) {
+        if (has_online && !cpuid_cpumask_test(&online, cpus[i])) continue;
+        if (has_cpuset && !cpuid_cpumask_test(&cpuset, cpus[i])) continue;
+        usable[par->cpus++] = cpus[i];
+    }
+
+    if (topo == NULL && par->cpus != 0) {
+        if (cpuid_snapshot_take(&snapshot, NULL, 0, usable, par->cpus, 0) < 0) goto done;
+        if (cpuid_topology_from_cpuid(&own_topo, &snapshot) != 0) goto done;
+        topo = &own_topo;
+    }
+
+    // nucleo y tipo de cada CPU usable; las que no estan en la topologia cuentan como un nucleo
+    cores = malloc(sizeof(*cores) * (par->cpus != 0 ? par->cpus : 1));
+    if (cores == NULL) goto done;
+    size_t n_cores = 0;
+    for (uint32_t i = 0; i < par->cpus; i++) {
+        const CPUID_H(topology_cpu) *t = NULL;
+        for (size_t k = 0; topo != NULL && k < topo->n_cpus && t == NULL; k++) {
+            if (topo->cpus[k].cpu == usable[i]) t = &topo->cpus[k];
+        }
+        if (t == NULL || t->values[CPUID_TOPO_CORE] == CPUID_TOPO_UNKNOWN) {
+            par->cores++;
+            continue;
+        }
+        cores[n_cores].core = t->values[CPUID_TOPO_CORE];
+        cores[n_cores].type = t->values[CPUID_TOPO_CORE_TYPE];
+        n_cores++;
+    }
+    qsort(cores, n_cores, sizeof(*cores), cpuid_parallelism_core_cmp);
+
+    uint32_t hybrid_cores = 0;
+    par->smt = par->cpus != 0 ? 1 : 0;
+    for (size_t i = 0; i < n_cores;) {
+        size_t end = i;
+        while (end < n_cores && cores[end].core == cores[i].core) end++;
+        par->cores++;
+        if ((uint32_t)(end - i) > par->smt) par->smt = (uint32_t)(end - i);
+        if (cores[i].type == 0x40) par->p_cores++;
+        if (cores[i].type == 0x20) par->e_cores++;
+        if (cores[i].type != CPUID_TOPO_UNKNOWN) hybrid_cores++;
+        i = end;
+    }
+    if (hybrid_cores == 0) par->p_cores = par->cores;
+
+    par->quota   = cpuid_parallelism_quota(root);
+    par->compute = par->p_cores != 0 ? par->p_cores : par->cores;
+    if (par->quota > 0 && par->compute > (uint32_t)par->quota) par->compute = (uint32_t)par->quota;
+    if (par->compute == 0) par->compute = 1;
+    par->io = par->cpus != 0 ? par->cpus : 1;
+    status  = 0;
+
+done:
+    free(cores);
+    cpuid_topology_free(&own_topo);
+    cpuid_snapshot_free(&snapshot);
+    free(usable);
+    free(own_cpus);
+    return status;
+}
+
+#endif
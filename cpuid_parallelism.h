@@ -0,0 +1,62 @@
+#ifndef __CPUID_PARALLELISM_H__
+#define __CPUID_PARALLELISM_H__
+
+/*
+ * Cuantos hilos de trabajo tiene sentido crear.
+ *
+ * Dimensionar un pool con Max_ID_addressable o con el numero de CPU logicas del sistema
+ * sobresuscribe dentro de un contenedor limitado: el proceso solo puede ejecutarse en las CPU
+ * de su mask de afinidad y de su cpuset, y con una cuota de CFS (cpu.max en cgroup v2,
+ * cpu.cfs_quota_us / cpu.cfs_period_us en v1) solo consume unas pocas CPU por periodo aunque
+ * vea muchas. Se combina:
+ *
+ *      CPU usables     afinidad del proceso, CPU conectadas y cpuset (ver cpuid_watch.h)
+ *      nucleos         grupos de nucleo de cpuid_topology entre las CPU usables, y de ellos
+ *                      los de tipo Core (nucleos P) en los procesadores hibridos
+ *      cuota           la menor de las de el cgroup del proceso y sus antecesores
+ *
+ * y se recomienda, por tipo de trabajo:
+ *
+ *      CPUID_WORKLOAD_COMPUTE  un hilo por nucleo P usable, sin pasar de la cuota (al menos 1)
+ *      CPUID_WORKLOAD_IO       un hilo por CPU logica usable
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "cpuid_topology.h"
+
+typedef enum CPUID_H(workload) {
+    CPUID_WORKLOAD_COMPUTE = 0,     // calculo: un hilo por nucleo fisico
+    CPUID_WORKLOAD_IO      = 1,     // E/S: los hilos esperan la mayor parte del tiempo
+} CPUID_H(workload);
+
+typedef struct CPUID_H(parallelism) {
+    uint32_t cpus;          // CPU logicas usables
+    uint32_t cores;         // nucleos distintos entre ellas
+    uint32_t p_cores;       // nucleos P (todos si el procesador no es hibrido)
+    uint32_t e_cores;       // nucleos E
+    uint32_t smt;           // hilos por nucleo (el maximo entre las CPU usables)
+    double   quota;         // CPU de cuota por periodo, 0 sin limite
+    uint32_t compute;       // hilos recomendados para CPUID_WORKLOAD_COMPUTE
+    uint32_t io;            // hilos recomendados para CPUID_WORKLOAD_IO
+} CPUID_H(parallelism);
+
+/*
+ * Rellena par. Con root (NULL o "" para el sistema) se leen RAIZ/sys/devices/system/cpu/online,
+ * RAIZ/proc/self/cgroup y los ficheros del cgroup bajo RAIZ/sys/fs/cgroup. cpus es el mask de
+ * afinidad (NULL para el del proceso) y topo la topologia de esas CPU (NULL para tomar un
+ * snapshot y decodificarla con cpuid_topology_from_cpuid). Devuelve 0, o -1 si no hay
+ * memoria o no se pudo leer CPUID.
+ */
+int cpuid_parallelism_query(
+    CPUID_H(parallelism) *par, const char *root,
+    const uint32_t *cpus, size_t n_cpus, const CPUID_H(topology) *topo
+);
+
+static inline uint32_t cpuid_parallelism_workers(const CPUID_H(parallelism) *par, CPUID_H(workload) workload) {
+    return workload == CPUID_WORKLOAD_IO ? par->io : par->compute;
+}
+
+#include "cpuid_parallelism.c"
+#endif
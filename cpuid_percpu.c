@@ -0,0 +1,175 @@
+#ifndef __CPUID_PERCPU_C__
+#define __CPUID_PERCPU_C__
+
+#include "cpuid_percpu.h"
+#include "cpuid_atomic.h"
+
+#include <string.h>
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <errno.h>
+    #include <pthread.h>
+    #include <sched.h>
+#endif
+
+// limite de hilos de trabajo aunque se pidan mas
+#define CPUID_COLLECT_THREADS_LIMIT 256
+
+size_t cpuid_affinity_cpus(uint32_t *cpus, size_t max) {
+    size_t total = 0;
+#if defined(_WIN32)
+    // sin soporte de grupos de procesadores: solo las 64 CPU del grupo del proceso
+    DWORD_PTR process_mask, system_mask;
+    if (!GetProcessAffinityMask(GetCurrentProcess(), &process_mask, &system_mask)) return 0;
+
+    for (uint32_t cpu = 0; cpu < sizeof(DWORD_PTR) * 8; cpu++) {
+        if (((process_mask >> cpu) & 1) == 0) continue;
+        if (total < max) cpus[total] = cpu;
+        total++;
+    }
+#elif defined(__linux__)
+    // el tamaño del cpu_set_t del kernel no se conoce, se duplica hasta que sched_getaffinity lo acepte
+    for (size_t ncpus = 1024; ncpus <= (1u << 20); ncpus *= 2) {
+        cpu_set_t *set  = CPU_ALLOC(ncpus);
+        size_t     size = CPU_ALLOC_SIZE(ncpus);
+        if (set == NULL) return 0;
+
+        CPU_ZERO_S(size, set);
+        if (sched_getaffinity(0, size, set) == 0) {
+            for (uint32_t cpu = 0; cpu < ncpus; cpu++) {
+                if (!CPU_ISSET_S(cpu, size, set)) continue;
+                if (total < max) cpus[total] = cpu;
+                total++;
+            }
+            CPU_FREE(set);
+            return total;
+        }
+        CPU_FREE(set);
+        if (errno != EINVAL) return 0;
+    }
+#else
+    // sin API de afinidad conocida: se trata el proceso como si tuviera una unica CPU
+    if (max > 0) cpus[0] = 0;
+    total = 1;
+#endif
+    return total;
+}
+
+int cpuid_pin_current_thread(uint32_t cpu) {
+#if defined(_WIN32)
+    if (cpu >= sizeof(DWORD_PTR) * 8) return -1;
+    if (SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1 << cpu) == 0) return -1;
+    Sleep(0); // ceder la CPU para que el planificador mueva el hilo a la CPU indicada
+    return 0;
+#elif defined(__linux__)
+    // sched_setaffinity sobre el hilo actual (pid 0) migra el hilo antes de retornar
+    cpu_set_t *set  = CPU_ALLOC(cpu + 1);
+    size_t     size = CPU_ALLOC_SIZE(cpu + 1);
+    if (set == NULL) return -1;
+
+    CPU_ZERO_S(size, set);
+    CPU_SET_S(cpu, size, set);
+    int status = sched_setaffinity(0, size, set);
+    CPU_FREE(set);
+    return status == 0 ? 0 : -1;
+#else
+    (void)cpu;
+    return -1;
+#endif
+}
+
+typedef struct cpuid_collect_job {
+    const CPUID_H(leaf_request) *leaves;
+    size_t                       n_leaves;
+    const uint32_t              *cpus;
+    size_t                       n_cpus;
+    CPUID_H(record)             *out;
+    uint32_t                     next;    // siguiente indice de cpus a procesar (atomico)
+    uint32_t                     pinned;  // CPU en las que se pudo fijar un hilo (atomico)
+} cpuid_collect_job;
+
+static void cpuid_collect_run(cpuid_collect_job *job) {
+    for (;;) {
+        uint32_t i = cpuid_atomic_fetch_add_u32(&job->next, 1);
+        if (i >= job->n_cpus) break;
+
+        CPUID_H(record) *row = job->out + (size_t)i * job->n_leaves;
+        uint32_t cpu    = job->cpus[i];
+        int      pinned = cpuid_pin_current_thread(cpu) == 0;
+
+        for (size_t j = 0; j < job->n_leaves; j++) {
+            CPUID_H(record) *record = &row[j];
+            record->cpu     = cpu;
+            record->leaf    = job->leaves[j].leaf;
+            record->subleaf = job->leaves[j].subleaf;
+            if (pinned) {
+                call_cpuid(record->leaf, record->subleaf, &record->eax, &record->ebx, &record->ecx, &record->edx);
+                record->status = CPUID_RECORD_OK;
+            } else {
+                record->eax = record->ebx = record->ecx = record->edx = 0;
+                record->status = CPUID_RECORD_NOT_PINNED;
+            }
+        }
+        if (pinned) cpuid_atomic_fetch_add_u32(&job->pinned, 1);
+    }
+}
+
+#ifdef _WIN32
+static DWORD WINAPI cpuid_collect_worker(LPVOID arg) {
+    cpuid_collect_run((cpuid_collect_job*)arg);
+    return 0;
+}
+#else
+static void *cpuid_collect_worker(void *arg) {
+    cpuid_collect_run((cpuid_collect_job*)arg);
+    return NULL;
+}
+#endif
+
+int cpuid_collect(
+    const CPUID_H(leaf_request) *leaves, size_t n_leaves,
+    const uint32_t *cpus, size_t n_cpus,
+    CPUID_H(record) *out, unsigned n_threads
+) {
+    cpuid_collect_job job = {
+        .leaves = leaves, .n_leaves = n_leaves,
+        .cpus   = cpus,   .n_cpus   = n_cpus,
+        .out    = out,    .next     = 0, .pinned = 0
+    };
+    if (n_cpus == 0 || n_leaves == 0) return 0;
+
+    if (n_threads == 0) n_threads = CPUID_COLLECT_MAX_THREADS;
+    if (n_threads > n_cpus) n_threads = (unsigned)n_cpus;
+    if (n_threads > CPUID_COLLECT_THREADS_LIMIT) n_threads = CPUID_COLLECT_THREADS_LIMIT;
+
+    /*
+     * El hilo que llama no participa: fijarlo cambiaria la afinidad del llamador (por ejemplo
+     * un hilo de Python). Si solo se pudieron crear algunos hilos, estos procesan todas las CPU.
+     */
+    unsigned created = 0;
+#ifdef _WIN32
+    HANDLE threads[CPUID_COLLECT_THREADS_LIMIT];
+    for (; created < n_threads; created++) {
+        threads[created] = CreateThread(NULL, 0, cpuid_collect_worker, &job, 0, NULL);
+        if (threads[created] == NULL) break;
+    }
+    for (unsigned t = 0; t < created; t++) {
+        WaitForSingleObject(threads[t], INFINITE);
+        CloseHandle(threads[t]);
+    }
+#else
+    pthread_t threads[CPUID_COLLECT_THREADS_LIMIT];
+    for (; created < n_threads; created++) {
+        if (pthread_create(&threads[created], NULL, cpuid_collect_worker, &job) != 0) break;
+    }
+    for (unsigned t = 0; t < created; t++) {
+        pthread_join(threads[t], NULL);
+    }
+#endif
+    if (created == 0) return -1;
+    return (int)job.pinned;
+}
+
+#endif
@@ -0,0 +1,84 @@
+#ifndef __CPUID_PERCPU_H__
+#define __CPUID_PERCPU_H__
+
+/*
+ * Consulta de CPUID en todas las CPU logicas del proceso.
+ *
+ * Varias hojas (1, 4, 0Bh, 1Ah, 1Fh, ...) devuelven valores distintos segun el procesador logico
+ * que ejecute la instruccion (APIC ID, tipo de nucleo, ...), por lo que para obtener la vista
+ * completa hay que fijar un hilo en cada CPU y ejecutar CPUID alli (como hace pruebas5.c con
+ * SetProcessAffinityMask). cpuid_collect reparte las CPU entre varios hilos de trabajo: cada
+ * hilo se fija en una CPU, ejecuta todas las hojas pedidas y escribe los resultados en un buffer
+ * reservado por el llamador, sin reservar memoria ni tomar locks.
+ *
+ * En Linux se necesita _GNU_SOURCE antes de cualquier include del sistema (CPU_SET,
+ * pthread_setaffinity_np); si este es el primer include se define aqui.
+ */
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "cpuid.h"
+
+// hoja y subhoja (EAX y ECX de entrada) a consultar
+typedef struct CPUID_H(leaf_request) {
+    uint32_t leaf;
+    uint32_t subleaf;
+} CPUID_H(leaf_request);
+
+typedef enum CPUID_H(record_status) {
+    CPUID_RECORD_OK         = 0,
+    CPUID_RECORD_NOT_PINNED = 1, // no se pudo fijar el hilo en la CPU, los registros valen 0
+} CPUID_H(record_status);
+
+/*
+ * Resultado de una hoja en una CPU. 32 bytes sin relleno para que una tabla de registros
+ * pueda exponerse tal cual (por ejemplo con el buffer protocol de Python).
+ */
+typedef struct CPUID_H(record) {
+    uint32_t cpu;      // numero de CPU logica del sistema operativo
+    uint32_t leaf;
+    uint32_t subleaf;
+    uint32_t eax;
+    uint32_t ebx;
+    uint32_t ecx;
+    uint32_t edx;
+    uint32_t status;   // CPUID_H(record_status)
+} CPUID_H(record);
+
+// numero de hilos de trabajo por defecto como maximo en cpuid_collect
+#define CPUID_COLLECT_MAX_THREADS 32
+
+/*
+ * Rellena cpus con las CPU logicas del mask de afinidad del proceso (en orden creciente).
+ * Devuelve el numero total de CPU del mask, que puede ser mayor que max; en ese caso
+ * solo se escriben las max primeras. Devuelve 0 si no se pudo consultar.
+ */
+size_t cpuid_affinity_cpus(uint32_t *cpus, size_t max);
+
+/*
+ * Fija el hilo actual en la CPU logica indicada. Devuelve 0 si tuvo exito.
+ */
+int cpuid_pin_current_thread(uint32_t cpu);
+
+/*
+ * Ejecuta las n_leaves hojas de leaves en cada una de las n_cpus CPU de cpus.
+ * out debe tener espacio para n_cpus * n_leaves registros; el resultado de leaves[j]
+ * en cpus[i] queda en out[i * n_leaves + j].
+ * n_threads = 0 usa min(n_cpus, CPUID_COLLECT_MAX_THREADS) hilos.
+ *
+ * Devuelve el numero de CPU en las que se pudo fijar un hilo, o -1 si no se pudieron
+ * crear los hilos. No llama a ninguna funcion de Python, asi que puede ejecutarse con
+ * el GIL liberado.
+ */
+int cpuid_collect(
+    const CPUID_H(leaf_request) *leaves, size_t n_leaves,
+    const uint32_t *cpus, size_t n_cpus,
+    CPUID_H(record) *out, unsigned n_threads
+);
+
+#include "cpuid_percpu.c"
+#endif
@@ -0,0 +1,199 @@
+#ifndef __CPUID_POOL_C__
+#define __CPUID_POOL_C__
+
+#include "cpuid_pool.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static inline void cpuid_pool_pause(void) {
+#if defined(_MSC_VER) && !defined(__GNUC__)
+    _mm_pause();
+#else
+    __asm__ volatile ("pause");
+#endif
+}
+
+static inline void cpuid_pool_lock(CPUID_H(pool_domain) *domain) {
+    while (!cpuid_atomic_cas_u32(&domain->lock, 0, 1)) {
+        while (cpuid_atomic_load_u32(&domain->lock) != 0) cpuid_pool_pause();
+    }
+}
+
+static inline void cpuid_pool_unlock(CPUID_H(pool_domain) *domain) {
+    cpuid_atomic_store_u32(&domain->lock, 0);
+}
+
+// posicion de key en keys[0..*n), que se anade al final si no esta
+static uint32_t cpuid_pool_key(uint32_t *keys, uint32_t *n, uint32_t key) {
+    for (uint32_t i = 0; i < *n; i++) {
+        if (keys[i] == key) return i;
+    }
+    keys[*n] = key;
+    return (*n)++;
+}
+
+static int cpuid_pool_build(CPUID_H(pool) *pool, uint32_t flags, const CPUID_H(topology) *topo) {
+    size_t    n        = topo->n_cpus;
+    uint32_t *l3_keys  = malloc(sizeof(*l3_keys) * (n != 0 ? n : 1));
+    uint32_t *pkg_keys = malloc(sizeof(*pkg_keys) * (n != 0 ? n : 1));
+    uint32_t *packages = malloc(sizeof(*packages) * (n != 0 ? n : 1));   // por dominio
+    uint32_t  n_packages = 0, max_cpu = 0;
+    int       status   = -1;
+
+    if (l3_keys == NULL || pkg_keys == NULL || packages == NULL) goto done;
+    for (size_t i = 0; i < n; i++) {
+        if (topo->cpus[i].cpu > max_cpu) max_cpu = topo->cpus[i].cpu;
+    }
+    pool->n_by_cpu = n != 0 ? max_cpu + 1 : 0;
+    pool->by_cpu   = malloc(sizeof(*pool->by_cpu) * (pool->n_by_cpu != 0 ? pool->n_by_cpu : 1));
+    if (pool->by_cpu == NULL) goto done;
+    for (uint32_t cpu = 0; cpu < pool->n_by_cpu; cpu++) pool->by_cpu[cpu] = UINT32_MAX;
+
+    // dominios por clave de L3 (la del paquete si no se conoce; se separan con el bit alto)
+    for (size_t i = 0; i < n; i++) {
+        const uint32_t *v   = topo->cpus[i].values;
+        uint32_t        pkg = v[CPUID_TOPO_PACKAGE] != CPUID_TOPO_UNKNOWN ? v[CPUID_TOPO_PACKAGE] : 0;
+        uint32_t        key = v[CPUID_TOPO_L3] != CPUID_TOPO_UNKNOWN ? v[CPUID_TOPO_L3] & 0x7fffffffu : 0x80000000u | pkg;
+        if (flags & CPUID_POOL_GLOBAL) key = 0;
+
+        uint32_t before = pool->n_domains;
+        uint32_t domain = cpuid_pool_key(l3_keys, &pool->n_domains, key);
+        if (pool->n_domains != before) packages[domain] = cpuid_pool_key(pkg_keys, &n_packages, pkg);
+        pool->by_cpu[topo->cpus[i].cpu] = domain;
+    }
+    if (pool->n_domains == 0) pool->n_domains = 1;
+    // las CPU que no estan en la topologia se reparten entre los dominios
+    for (uint32_t cpu = 0; cpu < pool->n_by_cpu; cpu++) {
+        if (pool->by_cpu[cpu] == UINT32_MAX) pool->by_cpu[cpu] = cpu % pool->n_domains;
+    }
+
+    pool->domains = calloc(pool->n_domains, sizeof(*pool->domains));
+    if (pool->domains == NULL) goto done;
+    for (uint32_t d = 0; d < pool->n_domains; d++) {
+        CPUID_H(pool_domain) *domain = cpuid_arena_calloc(&pool->arena, 1, sizeof(*domain));
+        if (domain == NULL) goto done;
+        domain->package = n != 0 ? packages[d] : 0;
+        cpuid_slab_init(&domain->slab, pool->owner_offset + sizeof(uint32_t), pool->align);
+        pool->domains[d] = domain;
+    }
+    status = 0;
+
+done:
+    free(l3_keys);
+    free(pkg_keys);
+    free(packages);
+    return status;
+}
+
+int cpuid_pool_init(
+    CPUID_H(pool) *pool, size_t object_size, size_t align, size_t capacity, uint32_t flags,
+    const CPUID_H(topology) *topo
+) {
+    CPUID_H(snapshot) snapshot;
+    CPUID_H(topology) own_topo = { 0 };
+
+    memset(pool, 0, sizeof(*pool));
+    pool->object_size  = object_size;
+    // detras del objeto y del puntero de la lista de libres del slab, que pisa el principio
+    pool->owner_offset = (object_size > sizeof(void*) ? object_size : sizeof(void*));
+    pool->owner_offset = (pool->owner_offset + sizeof(uint32_t) - 1) / sizeof(uint32_t) * sizeof(uint32_t);
+    pool->align        = align != 0 ? align : sizeof(void*);
+    pool->capacity     = capacity;
+    cpuid_arena_init(&pool->arena, 0, 0);
+
+    if (topo == NULL) {
+        if (cpuid_snapshot_take(&snapshot, NULL, 0, NULL, 0, 0) < 0) return -1;
+        int status = cpuid_topology_from_cpuid(&own_topo, &snapshot);
+        cpuid_snapshot_free(&snapshot);
+        if (status != 0) return -1;
+        topo = &own_topo;
+    }
+    int status = cpuid_pool_build(pool, flags, topo);
+    cpuid_topology_free(&own_topo);
+    cpuid_current_init();
+    if (status != 0) cpuid_pool_free(pool);
+    return status;
+}
+
+// objeto libre de otro dominio: primero los del mismo paquete y despues el resto
+static void *cpuid_pool_steal(CPUID_H(pool) *pool, uint32_t self) {
+    uint32_t package = pool->domains[self]->package;
+    for (int same = 1; same >= 0; same--) {
+        for (uint32_t k = 1; k < pool->n_domains; k++) {
+            CPUID_H(pool_domain) *victim = pool->domains[(self + k) % pool->n_domains];
+            if ((victim->package == package) != same) continue;
+            // lectura sin el lock, solo para no bloquear dominios que no tienen libres
+            if (cpuid_atomic_load_u32(&victim->free_count) == 0) continue;
+
+            cpuid_pool_lock(victim);
+            void *object = NULL;
+            if (victim->free_count != 0) {
+                object = cpuid_slab_alloc(&victim->slab);
+                cpuid_atomic_store_u32(&victim->free_count, victim->free_count - 1);
+            }
+            cpuid_pool_unlock(victim);
+            if (object != NULL) return object;
+        }
+    }
+    return NULL;
+}
+
+// objeto del slab del dominio (con el lock tomado); a los nuevos se les apunta su dominio
+static void *cpuid_pool_take(CPUID_H(pool) *pool, CPUID_H(pool_domain) *domain, uint32_t self) {
+    int   fresh  = domain->free_count == 0;
+    void *object = cpuid_slab_alloc(&domain->slab);
+    if (object == NULL) return NULL;
+    if (fresh) {
+        domain->created++;
+        memcpy((unsigned char*)object + pool->owner_offset, &self, sizeof(self));
+    } else {
+        cpuid_atomic_store_u32(&domain->free_count, domain->free_count - 1);
+    }
+    return object;
+}
+
+void *cpuid_pool_alloc(CPUID_H(pool) *pool) {
+    uint32_t              self   = cpuid_pool_current(pool);
+    CPUID_H(pool_domain) *domain = pool->domains[self];
+    void                 *object = NULL;
+
+    cpuid_pool_lock(domain);
+    domain->allocs++;
+    int pressure = domain->free_count == 0 && pool->capacity != 0 && domain->created >= pool->capacity;
+    if (!pressure) object = cpuid_pool_take(pool, domain, self);
+    cpuid_pool_unlock(domain);
+    if (object != NULL || !pressure) return object;
+
+    // sin libres y con el cupo lleno: se roba y, si nadie tiene, se crea de todos modos
+    object = cpuid_pool_steal(pool, self);
+    cpuid_pool_lock(domain);
+    if (object != NULL) domain->steals++;
+    else                object = cpuid_pool_take(pool, domain, self);
+    cpuid_pool_unlock(domain);
+    return object;
+}
+
+void cpuid_pool_release(CPUID_H(pool) *pool, void *object) {
+    uint32_t owner;
+    if (object == NULL) return;
+    memcpy(&owner, (unsigned char*)object + pool->owner_offset, sizeof(owner));
+
+    CPUID_H(pool_domain) *domain = pool->domains[owner];
+    cpuid_pool_lock(domain);
+    cpuid_slab_release(&domain->slab, object);
+    cpuid_atomic_store_u32(&domain->free_count, domain->free_count + 1);
+    cpuid_pool_unlock(domain);
+}
+
+void cpuid_pool_free(CPUID_H(pool) *pool) {
+    for (uint32_t d = 0; pool->domains != NULL && d < pool->n_domains; d++) {
+        if (pool->domains[d] != NULL) cpuid_slab_free(&pool->domains[d]->slab);
+    }
+    cpuid_arena_free(&pool->arena);
+    free(pool->domains);
+    free(pool->by_cpu);
+    memset(pool, 0, sizeof(*pool));
+}
+
+#endif
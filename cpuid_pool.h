@@ -0,0 +1,90 @@
+#ifndef __CPUID_POOL_H__
+#define __CPUID_POOL_H__
+
+/*
+ * Pool de objetos de tamano fijo con un dominio por L3.
+ *
+ * En maquinas con varios CCX (AMD) o varios paquetes, que un hilo reutilice un objeto liberado
+ * por un hilo de otra L3 obliga a traer sus lineas de esa L3 (o de otro paquete). El pool tiene
+ * un CPUID_H(slab) por cada grupo de CPU que comparte L3 segun la topologia (hoja 4 EAX[25:14]
+ * o 8000001Dh en AMD, ver cpuid_topology.h), y cada hilo reserva del dominio de la CPU en la
+ * que se ejecuta (cpuid_current_cpu):
+ *
+ *      cpuid_pool_init(&pool, sizeof(struct peticion), 0, 4096, 0, NULL);
+ *      struct peticion *p = cpuid_pool_alloc(&pool);
+ *      ...
+ *      cpuid_pool_release(&pool, p);      // vuelve a su dominio, lo libere quien lo libere
+ *
+ * Cada objeto recuerda su dominio, asi que siempre vuelve a la lista de libres de la L3 cuya
+ * memoria ocupa. Con capacity != 0 un dominio que ya ha creado capacity objetos y no tiene
+ * libres roba uno libre a otro dominio (primero los del mismo paquete) antes de crear mas; solo
+ * si nadie tiene libres sigue creando. Con CPUID_POOL_GLOBAL todo va a un unico dominio, para
+ * comparar.
+ *
+ * Cada dominio se protege con un spinlock propio, en su propio bloque de
+ * cpuid_alloc_interference_size() bytes, asi que solo compiten los hilos de la misma L3.
+ *
+ * Cada objeto ocupa object_size bytes mas 4 con el indice de su dominio, redondeado a la
+ * alineacion pedida: con la de un puntero (por defecto) un objeto de 16 bytes ocupa 24, y con
+ * cpuid_alloc_interference_size() ocupa 128 en Intel pero dos objetos de hilos distintos nunca
+ * comparten linea.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "cpuid_alloc.h"
+#include "cpuid_atomic.h"
+#include "cpuid_current.h"
+#include "cpuid_topology.h"
+
+#define CPUID_POOL_GLOBAL 0x1       // un solo dominio para todas las CPU
+
+typedef struct CPUID_H(pool_domain) {
+    uint32_t      lock;
+    uint32_t      package;          // indice denso del paquete, para robar primero en el mismo
+    uint32_t      free_count;       // objetos en la lista de libres; se escribe con el lock y
+                                    // se lee sin el con cpuid_atomic_load_u32 al robar
+    CPUID_H(slab) slab;
+    size_t        created;          // objetos creados en este dominio
+    uint64_t      allocs;
+    uint64_t      steals;           // objetos tomados de otros dominios
+} CPUID_H(pool_domain);
+
+typedef struct CPUID_H(pool) {
+    size_t                object_size;
+    size_t                owner_offset;     // donde guarda cada objeto el indice de su dominio
+    size_t                align;            // alineacion y granulo de cada objeto
+    size_t                capacity;         // objetos por dominio antes de robar, 0 sin limite
+    CPUID_H(arena)        arena;            // memoria de los dominios
+    CPUID_H(pool_domain) **domains;
+    uint32_t              n_domains;
+    uint32_t             *by_cpu;           // numero de CPU -> dominio
+    uint32_t              n_by_cpu;
+} CPUID_H(pool);
+
+/*
+ * Crea un dominio por L3 de topo (o de la topologia de CPUID de las CPU del mask de afinidad si
+ * es NULL); las CPU sin L3 conocida van al dominio de su paquete. align es la alineacion de
+ * cada objeto (potencia de 2; 0 usa la de un puntero). Devuelve 0, o -1 sin memoria.
+ */
+int   cpuid_pool_init(
+    CPUID_H(pool) *pool, size_t object_size, size_t align, size_t capacity, uint32_t flags,
+    const CPUID_H(topology) *topo
+);
+
+// objeto sin inicializar, o NULL sin memoria
+void *cpuid_pool_alloc(CPUID_H(pool) *pool);
+
+void  cpuid_pool_release(CPUID_H(pool) *pool, void *object);
+
+void  cpuid_pool_free(CPUID_H(pool) *pool);
+
+// dominio de la CPU actual
+static inline uint32_t cpuid_pool_current(const CPUID_H(pool) *pool) {
+    uint32_t cpu = cpuid_current_cpu();
+    return cpu < pool->n_by_cpu ? pool->by_cpu[cpu] : cpu % pool->n_domains;
+}
+
+#include "cpuid_pool.c"
+#endif
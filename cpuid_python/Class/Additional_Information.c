@@ -0,0 +1,90 @@
+#include "Class.h"
+#ifndef __CLASS_ADDITIONAL_INFORMATION_C__
+#define __CLASS_ADDITIONAL_INFORMATION_C__
+#include "Additional_Information.h"
+
+#include <string.h>
+
+static PyType_Slot Method_Additional_Information_Class(slots)[] = {
+    {Py_tp_repr,    (void *)Method_Additional_Information_Class(repr)},
+    {Py_tp_str,     (void *)Method_Additional_Information_Class(str)},
+    {Py_tp_doc,     (void *)Method_Additional_Information_Class(doc)},
+    {Py_tp_getset,  Method_Additional_Information_Class(getsetters)},
+    {Py_tp_init,    (void *)Method_Additional_Information_Class(init)},
+    {Py_tp_new,     (void *)PyType_GenericNew},
+    {0, NULL}
+};
+
+static PyType_Spec Method_Additional_Information_Class(spec) = {
+    .name      = "cpuid_x86.Additional_Information_Feature_Bits",
+    .basicsize = sizeof(Additional_Info),
+    .itemsize  = 0,
+    .flags     = CLASS_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE, /* no guarda referencias, no necesita GC */
+    .slots     = Method_Additional_Information_Class(slots),
+};
+
+static PyTypeObject *Method_Additional_Information_Class(create_type)(PyObject *module) {
+    return (PyTypeObject *)PyType_FromModuleAndSpec(module, &Method_Additional_Information_Class(spec), NULL);
+}
+
+static PyObject* Method_Additional_Information_Class(get_field)(Additional_Info *self, void *closure) {
+    switch ((Additional_Info_field)(uintptr_t)closure) {
+        case Additional_Info_Brand_Index:         return PyLong_FromUnsignedLong(self->ebx.Brand_Index);
+        case Additional_Info_CLFLUSH_Line_Size:   return PyLong_FromUnsignedLong(self->ebx.CLFLUSH * 8);
+        case Additional_Info_Max_Addressable_IDs: return PyLong_FromUnsignedLong(self->ebx.Max_ID_addressable);
+        case Additional_Info_Local_APIC_ID:       return PyLong_FromUnsignedLong(self->ebx.Local_APIC_ID);
+    }
+    Py_RETURN_NONE;
+}
+
+static PyObject* Method_Additional_Information_Class(from_register)(PyTypeObject *type, uint32_t ebx) {
+    Additional_Info *self = (Additional_Info *)type->tp_alloc(type, 0);
+    if (self == NULL) return NULL;
+
+    memcpy(&self->ebx, &ebx, sizeof(ebx));
+    return (PyObject *)self;
+}
+
+// Método __init__
+static int Method_Additional_Information_Class(init)(Additional_Info *self, PyObject *args, PyObject *kwds) {
+    static char *kwlist[] = {"ebx", NULL};
+    PyObject *ebx_obj = Py_None;
+    uint32_t eax = 0, ebx = 0, ecx = 0, edx = 0;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|O", kwlist, &ebx_obj)) {
+        return -1;
+    }
+
+    if (ebx_obj == Py_None) {
+        // para amd a de llamarse a 0x80000008
+        call_cpuid(CPUID_GETFEATURES, 0, &eax, &ebx, &ecx, &edx);
+    } else {
+        ebx = (uint32_t)PyLong_AsUnsignedLongMask(ebx_obj);
+        if (PyErr_Occurred()) return -1;
+    }
+
+    CLASS_BEGIN_CRITICAL_SECTION(self);
+    memcpy(&self->ebx, &ebx, sizeof(ebx));
+    CLASS_END_CRITICAL_SECTION();
+    debug_print_cpuid("Additional_Information_Feature_Bits: ebx=0x%08x\n", ebx);
+    return 0;
+}
+
+static PyObject* Method_Additional_Information_Class(str)(Additional_Info *self) {
+    return PyUnicode_FromFormat(
+        "Brand Index: %u\n"
+        "CLFLUSH Line Size: %u bytes\n"
+        "Max Addressable IDs: %u\n"
+        "Local APIC ID: %u",
+        (unsigned)self->ebx.Brand_Index, (unsigned)self->ebx.CLFLUSH * 8,
+        (unsigned)self->ebx.Max_ID_addressable, (unsigned)self->ebx.Local_APIC_ID
+    );
+}
+
+static PyObject* Method_Additional_Information_Class(repr)(Additional_Info *self) {
+    uint32_t ebx;
+    memcpy(&ebx, &self->ebx, sizeof(ebx));
+    return PyUnicode_FromFormat("Additional_Information_Feature_Bits(ebx=0x%08x)", ebx);
+}
+
+#endif
@@ -0,0 +1,65 @@
+#include "Class.h"
+#ifndef __CLASS_ADDITIONAL_INFORMATION_H__
+#define __CLASS_ADDITIONAL_INFORMATION_H__
+
+#include <stdint.h>
+#include "../../cpuid.h"
+
+/*
+ * Version nativa de cpuid_0x1.Additional_Information_Feature_Bits, respaldada por la
+ * estructura Additional_Information_Feature_Bits de cpuid.h (EBX de CPUID EAX=1).
+ */
+#define Method_Additional_Information_Class(name) Additional_Information_ ## name
+
+typedef struct {
+    PyObject_HEAD
+    Additional_Information_Feature_Bits ebx;
+} Additional_Info;
+
+// campos que expone la clase, closure de los getters
+typedef enum Additional_Info_field {
+    Additional_Info_Brand_Index,
+    Additional_Info_CLFLUSH_Line_Size,
+    Additional_Info_Max_Addressable_IDs,
+    Additional_Info_Local_APIC_ID
+} Additional_Info_field;
+
+PyDoc_STRVAR(Method_Additional_Information_Class(doc),
+    "Additional_Information_Feature_Bits(ebx=None)\n\n"
+    "Informacion adicional de CPUID EAX=1 (registro EBX). Si ebx es None se obtiene\n"
+    "llamando a CPUID.");
+
+// Metodos Inprescindibles y porpias de Python
+static PyTypeObject *Method_Additional_Information_Class(create_type) (PyObject *module);
+static int       Method_Additional_Information_Class(init)             (Additional_Info *self, PyObject *args, PyObject *kwds);
+static PyObject* Method_Additional_Information_Class(str)              (Additional_Info *self);
+static PyObject* Method_Additional_Information_Class(repr)             (Additional_Info *self);
+
+// Crea una instancia directamente desde C, sin pasar por __init__
+static PyObject* Method_Additional_Information_Class(from_register)    (PyTypeObject *type, uint32_t ebx);
+
+// metodos getter
+static PyObject* Method_Additional_Information_Class(get_field)        (Additional_Info *self, void *closure);
+
+static PyGetSetDef Method_Additional_Information_Class(getsetters)[] = {
+    {
+        "Brand_Index", (getter)Method_Additional_Information_Class(get_field), NULL,
+        "Brand Index, bits 7-0", (void*)Additional_Info_Brand_Index
+    },
+    {
+        "CLFLUSH_Line_Size", (getter)Method_Additional_Information_Class(get_field), NULL,
+        "Tamaño de linea de CLFLUSH en bytes (bits 15-8 * 8)", (void*)Additional_Info_CLFLUSH_Line_Size
+    },
+    {
+        "Max_Addressable_IDs", (getter)Method_Additional_Information_Class(get_field), NULL,
+        "Numero maximo de IDs direccionables para procesadores logicos, bits 23-16", (void*)Additional_Info_Max_Addressable_IDs
+    },
+    {
+        "Local_APIC_ID", (getter)Method_Additional_Information_Class(get_field), NULL,
+        "ID de APIC local del procesador logico que ejecuto CPUID, bits 31-24", (void*)Additional_Info_Local_APIC_ID
+    },
+    {NULL}  // Sentinel
+};
+
+#include "Additional_Information.c"
+#endif
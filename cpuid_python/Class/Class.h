@@ -4,4 +4,79 @@
 
 #include "../global.h"
 
-#endif
\ No newline at end of file
+/*
+ * Estado del modulo (multi-phase init, PEP 489). Cada interprete que importa cpuid_x86 tiene
+ * su propio modulo con sus propios tipos (heap types creados con PyType_FromModuleAndSpec),
+ * por lo que no hay objetos de Python compartidos entre subinterpretes. Los metodos que
+ * necesitan crear instancias de otra clase del modulo buscan el tipo aqui.
+ */
+typedef struct cpuid_module_state {
+    PyTypeObject *Cpuid_type;
+    PyTypeObject *Register_type;
+    PyTypeObject *Processor_Info_type;
+    PyTypeObject *Additional_Information_type;
+    PyTypeObject *Information_Feature_Bits_type;
+    PyTypeObject *Snapshot_type;
+    PyObject     *StringTooShortError;
+} cpuid_module_state;
+
+static struct PyModuleDef cpuid_native; // definido en cpuid_py.c
+
+static inline cpuid_module_state *Class_module_state(PyObject *module) {
+    return (cpuid_module_state *)PyModule_GetState(module);
+}
+
+/*
+ * Estado del modulo que definio type (o una de sus clases base, si type es una subclase
+ * creada desde Python). Devuelve NULL con una excepcion si no se encuentra.
+ */
+static inline cpuid_module_state *Class_state_from_type(PyTypeObject *type) {
+#if PY_VERSION_HEX >= 0x030B0000
+    PyObject *module = PyType_GetModuleByDef(type, &cpuid_native);
+#else
+    while (type != NULL && !((type->tp_flags & Py_TPFLAGS_HEAPTYPE) && ((PyHeapTypeObject *)type)->ht_module)) {
+        type = type->tp_base;
+    }
+    PyObject *module = type ? PyType_GetModule(type) : NULL;
+    if (module == NULL && !PyErr_Occurred()) PyErr_SetString(PyExc_TypeError, "tipo ajeno al modulo cpuid_x86");
+#endif
+    return module ? Class_module_state(module) : NULL;
+}
+
+/*
+ * Las clases son heap types: en lugar de un PyTypeObject estatico compartido por todos los
+ * interpretes, cada modulo crea sus tipos con Method_X_Class(create_type), a partir de un
+ * PyType_Spec (PyType_FromModuleAndSpec ya llama a PyType_Ready). Los tipos con GC deben
+ * visitar su tipo en traverse y todas las instancias sueltan la referencia a su tipo en dealloc.
+ */
+
+// los tipos del modulo no se pueden modificar desde Python, igual que los tipos estaticos
+#ifdef Py_TPFLAGS_IMMUTABLETYPE
+    #define CLASS_TPFLAGS_DEFAULT (Py_TPFLAGS_DEFAULT | Py_TPFLAGS_IMMUTABLETYPE)
+#else
+    #define CLASS_TPFLAGS_DEFAULT Py_TPFLAGS_DEFAULT
+#endif
+
+/*
+ * Secciones criticas por objeto para CPython sin GIL (3.13t). Con GIL (o antes de 3.13)
+ * solo abren y cierran un bloque.
+ */
+#ifdef Py_BEGIN_CRITICAL_SECTION
+    #define CLASS_BEGIN_CRITICAL_SECTION(op) Py_BEGIN_CRITICAL_SECTION(op)
+    #define CLASS_END_CRITICAL_SECTION()     Py_END_CRITICAL_SECTION()
+#else
+    #define CLASS_BEGIN_CRITICAL_SECTION(op) {
+    #define CLASS_END_CRITICAL_SECTION()     }
+#endif
+
+/*
+ * Escribe un str en sys.stdout (como print(text, end="")). Se usa en los metodos print_vals
+ * para respetar las redirecciones de sys.stdout hechas desde Python.
+ */
+static inline int Class_write_stdout(PyObject *text) {
+    PyObject *out = PySys_GetObject("stdout"); // referencia prestada
+    if (out == NULL || out == Py_None) return 0;
+    return PyFile_WriteObject(text, out, Py_PRINT_RAW);
+}
+
+#endif
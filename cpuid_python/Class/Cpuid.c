@@ -3,110 +3,38 @@
 #define __CLASS_CPUID_C__
 #include "Cpuid.h"
 
-static void Method_Cpuid_Class(init_type_object)(void) {
-    Method_Cpuid_Class(type_Class) = (PyTypeObject){
-        /*
-        * Este tipo también tiene algunos métodos personalizados, por lo que necesitamos pasar 
-        * una matriz a PyTypeObject.tp_methods.
-        * Finalmente, necesitamos construir nuestros nuevos objetos para tener una función 
-        * PyTypeObject.tp_new configurada.
-        * Esta es la definición de una clase llamada Cpuid de Python y una Cpuid de C. Las 
-        * instancias se definen mediante la estructura de cola en la parte superior. El tipo 
-        * implementa solo un subconjunto de las funciones posibles.
-        * Preparar un tipo
-        * Nuestra estructura Cpuid_type tiene muchos miembros NULL porque queremos heredar 
-        * su valor de nuestra clase base, que en este caso es object. Si volvemos a mirar 
-        * el código en PyObject_Repr() anterior, podemos ver que no estamos haciendo una 
-        * comprobación de NULL ni un recorrido de clase, simplemente obtenemos 
-        * PyTypeObject.tp_repr y lo llamamos. Para evitar estas comprobaciones, Python 
-        * tiene una función llamada PyType_Ready() que copia los slots de la clase base. 
-        * Esta función también copia todos los métodos que están almacenados en PyTypeObject.tp_dict.
-        * 
-        * Para preparar un tipo, llame a PyType_Ready() en PyMODINIT_FUNC para el módulo 
-        * que define la clase.
-        */
-        PyVarObject_HEAD_INIT(&PyType_Type, 0)
-        "cpuid.Cpuid",                                               /* tp_name */
-        sizeof(Cpuid),                                               /* tp_basicsize 
-                                                                     * PyTypeObject.tp_basicsize se establece para que 
-                                                                     * tenga el tamaño de la estructura de cola de salida. 
-                                                                     * Esto significa que las instancias de una Cpuid tienen 
-                                                                     * el tamaño de una Cpuid.
-                                                                     */
-        0,                                                           /* tp_itemsize 
-                                                                     * PyTypeObject.tp_itemsize se establece en 0 porque todas las 
-                                                                     * instancias de una Cpuid usan la misma cantidad de espacio. 
-                                                                     * Este campo está diseñado para implementar colecciones 
-                                                                     * compactas como tuple.
-                                                                     */
-        (destructor)Method_Cpuid_Class(dealloc),                 /* tp_dealloc 
-                                                                     * PyTypeObject.tp_dealloc se establece en una función 
-                                                                     * de desasignación. Esta función necesita liberar 
-                                                                     * la referencia de la cola a q_elements.
-                                                                     */
-        0,                                                           /* tp_print */
-        0,                                                           /* tp_getattr */
-        0,                                                           /* tp_setattr */
-        0,                                                           /* tp_reserved */
-        (reprfunc)Method_Cpuid_Class(repr),                       /* tp_repr */
-        0,                                                           /* tp_as_number */
-        0,                                                           /* tp_as_sequence */
-        0,                                                           /* tp_as_mapping */
-        0,                                                           /* tp_hash */
-        0,                                                           /* tp_call */
-        0,                                                           /* tp_str */
-        0,                                                           /* tp_getattro */
-        0,                                                           /* tp_setattro */
-        0,                                                           /* tp_as_buffer */
-        Py_TPFLAGS_DEFAULT |
-        Py_TPFLAGS_HAVE_GC,                                          /* tp_flags 
-                                                                      * PyTypeObject.tp_flags se establece en 
-                                                                      * Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_GC. Esto 
-                                                                      * significa que tenemos tanto los indicadores predeterminados 
-                                                                      * como el bit HAVE_GC. Debido a que el bit 
-                                                                      * Py_TPFLAGS_HAVE_GC está configurado, también tenemos una 
-                                                                      * función PyTypeObject.tp_traverse y una función 
-                                                                      * PyTypeObject.tp_clear.
-                                                                      */
-        .tp_doc             = Method_Cpuid_Class(doc),                             /* tp_doc */ // != PyDoc_STR
-        .tp_traverse        = (traverseproc) Method_Cpuid_Class(traverse),         /* tp_traverse */ //(traverseproc) Cpuid_traverse,
-        .tp_clear           = (inquiry) Method_Cpuid_Class(clear),                 /* tp_clear */ //(inquiry) Cpuid_clear,        
-        .tp_richcompare     = 0,                                     /* tp_richcompare */
-        .tp_weaklistoffset  = 0,                                     /* tp_weaklistoffset */
-        .tp_iter            = 0,                                     /* tp_iter */
-        .tp_iternext        = 0,                                     /* tp_iternext */
-        .tp_methods         = Method_Cpuid_Class(methods),                         /* tp_methods */
-        .tp_members         = 0,                                     /* tp_members */
-        .tp_getset          = Method_Cpuid_Class(getsetters),        /* tp_getset 
-                                                                      * Metodos getter y setter para los atributos de 
-                                                                      * la clase.
-                                                                      */
-        .tp_base            = 0,                                     /* tp_base */
-        .tp_dict            = 0,                                     /* tp_dict */
-        .tp_descr_get       = 0,                                     /* tp_descr_get */
-        .tp_descr_set       = 0,                                     /* tp_descr_set */
-        .tp_dictoffset      = 0,                                     /* tp_dictoffset */
-        .tp_init            = (initproc)Method_Cpuid_Class(init), /* 
-                                                                      * tp_init 
-                                                                      * MyClass.__init__ --> tp_init
-                                                                      */
-        .tp_alloc           = 0,                                      /* tp_alloc */
-        .tp_new             = Method_Cpuid_Class(new),             /* tp_new 
-                                                                       * Si PyTypeObject.tp_new es NULL, no puede crear 
-                                                                       * nuevas instancias de la clase.
-                                                                       */
-    };
-    // Finalmente, llamamos a PyType_Ready
-    if (PyType_Ready(&Method_Cpuid_Class(type_Class)) < 0)
-        return;
+static PyType_Slot Method_Cpuid_Class(slots)[] = {
+    {Py_tp_dealloc,  (void *)Method_Cpuid_Class(dealloc)},
+    {Py_tp_repr,     (void *)Method_Cpuid_Class(repr)},
+    {Py_tp_doc,      (void *)Method_Cpuid_Class(doc)},
+    {Py_tp_traverse, (void *)Method_Cpuid_Class(traverse)},
+    {Py_tp_clear,    (void *)Method_Cpuid_Class(clear)},
+    {Py_tp_methods,  Method_Cpuid_Class(methods)},
+    {Py_tp_getset,   Method_Cpuid_Class(getsetters)},
+    {Py_tp_init,     (void *)Method_Cpuid_Class(init)},
+    {Py_tp_new,      (void *)Method_Cpuid_Class(new)},
+    {0, NULL}
+};
+
+static PyType_Spec Method_Cpuid_Class(spec) = {
+    .name      = "cpuid_x86.Cpuid",
+    .basicsize = sizeof(Cpuid),
+    .itemsize  = 0,
+    .flags     = CLASS_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_GC,
+    .slots     = Method_Cpuid_Class(slots),
+};
+
+static PyTypeObject *Method_Cpuid_Class(create_type)(PyObject *module) {
+    return (PyTypeObject *)PyType_FromModuleAndSpec(module, &Method_Cpuid_Class(spec), NULL);
 }
 
 static PyObject* Method_Cpuid_Class(get_reg)(Cpuid *self, void *closure) {
-    if (self->reg == NULL) {
-        Py_RETURN_NONE;
-    }
-    Py_INCREF(self->reg);
-    return (PyObject *)self->reg;
+    PyObject *reg;
+    CLASS_BEGIN_CRITICAL_SECTION(self);
+    reg = self->reg ? (PyObject *)self->reg : Py_None;
+    Py_INCREF(reg);
+    CLASS_END_CRITICAL_SECTION();
+    return reg;
 }
 static int       Method_Cpuid_Class(set_reg)(Cpuid *self, PyObject *value, void *closure){
     if (value == NULL) {
@@ -114,11 +42,16 @@ static int       Method_Cpuid_Class(set_reg)(Cpuid *self, PyObject *value, void
         return -1;
     }
 
+    cpuid_module_state *state = Class_state_from_type(Py_TYPE(self));
+    if (state == NULL) return -1;
+
     // verificar si el objeto value es una instancia de una clase Register
-    if (PyObject_IsInstance(value, (PyObject *)&Method_Register_Class(type_Class))) {
-        Py_XDECREF(self->reg);  // Decrementa la referencia al objeto anterior, si existe
-        Py_INCREF(value);       // Incrementa la referencia al nuevo objeto
-        self->reg = (Register *)value;
+    if (PyObject_TypeCheck(value, state->Register_type)) {
+        // Py_XSETREF suelta la referencia al objeto anterior despues de sustituirlo
+        Py_INCREF(value);
+        CLASS_BEGIN_CRITICAL_SECTION(self);
+        Py_XSETREF(self->reg, (Register *)value);
+        CLASS_END_CRITICAL_SECTION();
     } else {
         PyErr_SetString(PyExc_ValueError, "Mo es una instancia de Register");
         return -1;
@@ -132,15 +65,20 @@ static int Method_Cpuid_Class(init)(Cpuid *self, PyObject *args, PyObject *kwds)
     static char *kwlist[] = {"register", NULL};
 
     Py_ssize_t maxsize = 10;  // valor por defecto
-    
+
+    cpuid_module_state *state = Class_state_from_type(Py_TYPE(self));
+    if (state == NULL) return -1;
+
     // Parseamos los argumentos de __init__(self, value=0)
-    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O!", kwlist, &Register_type_Class, &reg_obj)) {
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O!", kwlist, state->Register_type, &reg_obj)) {
         PyErr_SetString(PyExc_TypeError, "Se requiere una instancia de Register");
         return -1;
     }
-    
-    self->reg = (Register *)reg_obj;
-    Py_INCREF(self->reg);  // Incrementamos la referencia al objeto Register
+
+    int status = 0;
+    Py_INCREF(reg_obj);  // Incrementamos la referencia al objeto Register
+    CLASS_BEGIN_CRITICAL_SECTION(self);
+    Py_XSETREF(self->reg, (Register *)reg_obj);
 
     debug_print_cpuid("Parsed args: maxsize=%zd,eax=0x%08x, ebx=0x%08x, ecx=0x%08x, edx=0x%08x\n",
         maxsize, self->reg->eax, self->reg->ebx, self->reg->ecx, self->reg->edx);
@@ -159,9 +97,11 @@ static int Method_Cpuid_Class(init)(Cpuid *self, PyObject *args, PyObject *kwds)
         self->q_elements = PyList_New(0);
         if (self->q_elements == NULL) {
             debug_print_cpuid("Failed to create q_elements\n");
-            return -1;
+            status = -1;
         }
     }
+    CLASS_END_CRITICAL_SECTION();
+    if (status < 0) return -1;
     debug_print_cpuid("Exiting Cpuid_init successfully\n");
     return 0;
 }
@@ -195,8 +135,11 @@ static PyObject* Method_Cpuid_Class(cpuid)(Cpuid *self, PyObject *args) {
         .ecx = 0, .edx = 0
     };
     
-    // Parseamos los argumentos de cpuid(self, eax, ecx)
-    if (!PyArg_ParseTuple(args, "kk", &(my_regs.eax), &(my_regs.ecx))) {
+    cpuid_module_state *state = Class_state_from_type(Py_TYPE(self));
+    if (state == NULL) return NULL;
+
+    // Parseamos los argumentos de cpuid(self, eax, ecx), "I" para no desbordar los uint32_t
+    if (!PyArg_ParseTuple(args, "II", &(my_regs.eax), &(my_regs.ecx))) {
         PyErr_SetString(PyExc_TypeError, "Se esperan dos argumentos: eax(pagina) y ecx(subpagina)");
         return NULL;
     }
@@ -208,13 +151,17 @@ static PyObject* Method_Cpuid_Class(cpuid)(Cpuid *self, PyObject *args) {
         &(my_regs.eax), &(my_regs.ebx),
         &(my_regs.ecx), &(my_regs.edx)
     );
-    self->reg->eax = my_regs.eax; self->reg->ebx = my_regs.ebx;
-    self->reg->ecx = my_regs.ecx; self->reg->edx = my_regs.edx;
+    CLASS_BEGIN_CRITICAL_SECTION(self);
+    if (self->reg != NULL) {
+        self->reg->eax = my_regs.eax; self->reg->ebx = my_regs.ebx;
+        self->reg->ecx = my_regs.ecx; self->reg->edx = my_regs.edx;
+    }
+    CLASS_END_CRITICAL_SECTION();
     PyObject *reg_args = Py_BuildValue(
         "kkkk", my_regs.eax, my_regs.ebx, my_regs.ecx, my_regs.edx
     );
     PyObject *reg_obj = PyObject_CallObject(
-        (PyObject *) &Method_Register_Class(type_Class), 
+        (PyObject *) state->Register_type,
         reg_args
     );
     Py_DECREF(reg_args);
@@ -244,8 +191,10 @@ static void Method_Cpuid_Class(dealloc)(Cpuid *self) {
 
     Py_XDECREF(self->reg);  // Liberamos la referencia a Register
     
-    // Llamamos al deallocador del tipo para liberar la memoria de self
-    Py_TYPE(self)->tp_free((PyObject *)self);
+    // Llamamos al deallocador del tipo para liberar la memoria de self y soltamos el tipo (heap type)
+    PyTypeObject *type = Py_TYPE(self);
+    type->tp_free((PyObject *)self);
+    Py_DECREF(type);
 }
 
 static PyObject* Method_Cpuid_Class(repr)(Cpuid *self) {
@@ -288,6 +237,7 @@ static int Method_Cpuid_Class(traverse)(Cpuid *self, visitproc visit, void *arg)
     // Si q_elements tiene una referencia a un objeto Python, la recorremos
     Py_VISIT(self->q_elements);
     Py_VISIT(self->reg);
+    Py_VISIT(Py_TYPE(self));
     return 0;
 }
 static int Method_Cpuid_Class(clear)(Cpuid *self) {
@@ -119,10 +119,9 @@ typedef struct {
 } Cpuid;
 
 PyDoc_STRVAR(Method_Cpuid_Class(doc), "My objects");
-static PyTypeObject Method_Cpuid_Class(type_Class);
 
 // Metodos Inprescindibles y porpias de Python
-static void      Method_Cpuid_Class(init_type_object) (void);
+static PyTypeObject *Method_Cpuid_Class(create_type) (PyObject *module);
 static int       Method_Cpuid_Class(init)             (Cpuid *self, PyObject *args, PyObject *kwds);
 static PyObject *Method_Cpuid_Class(new)              (PyTypeObject *type, PyObject *args, PyObject *kwds);
 static void      Method_Cpuid_Class(dealloc)          (Cpuid *self);
@@ -0,0 +1,269 @@
+#include "Class.h"
+#ifndef __CLASS_INFORMATION_FEATURE_BITS_C__
+#define __CLASS_INFORMATION_FEATURE_BITS_C__
+#include "Information_Feature_Bits.h"
+
+#include <string.h>
+#include "../../cpuid_atomic.h"
+
+// Tablas bit -> nombre generadas desde las X-macro de cpuid.h
+#define FEATURE_BITS_NAME(name, bit) [bit] = #name,
+static const char *const Method_Information_Feature_Bits_Class(names_edx)[32] = { CPUID_FEAT_EDX_FIELDS(FEATURE_BITS_NAME) };
+static const char *const Method_Information_Feature_Bits_Class(names_ecx)[32] = { CPUID_FEAT_ECX_FIELDS(FEATURE_BITS_NAME) };
+#undef FEATURE_BITS_NAME
+
+static inline uint32_t Method_Information_Feature_Bits_Class(reg_value)(Feature_Bits *self, int reg) {
+    uint32_t value;
+    if (reg == FEATURE_BITS_REG_ECX) memcpy(&value, &self->ecx, sizeof(value));
+    else                             memcpy(&value, &self->edx, sizeof(value));
+    return value;
+}
+
+/*
+ * Busca una tecnologia por nombre. Devuelve el codigo (reg << 8 | bit) o -1 si no existe.
+ * Se busca primero en EDX para que los nombres repetidos se resuelvan igual que los atributos.
+ */
+static int Method_Information_Feature_Bits_Class(lookup)(const char *name) {
+    for (int bit = 0; bit < 32; bit++) {
+        if (strcmp(Method_Information_Feature_Bits_Class(names_edx)[bit], name) == 0)
+            return (FEATURE_BITS_REG_EDX << 8) | bit;
+    }
+    for (int bit = 0; bit < 32; bit++) {
+        if (strcmp(Method_Information_Feature_Bits_Class(names_ecx)[bit], name) == 0)
+            return (FEATURE_BITS_REG_ECX << 8) | bit;
+    }
+    return -1;
+}
+
+static int Method_Information_Feature_Bits_Class(test)(Feature_Bits *self, int code) {
+    return (Method_Information_Feature_Bits_Class(reg_value)(self, code >> 8) >> (code & 0x1f)) & 1;
+}
+
+// 0 = sin construir, 1 = construyendose, 2 = lista
+static uint32_t Method_Information_Feature_Bits_Class(getsetters_state);
+
+static void Method_Information_Feature_Bits_Class(build_getsetters)(void) {
+    uint32_t *state = &Method_Information_Feature_Bits_Class(getsetters_state);
+    if (cpuid_atomic_load_u32(state) == 2) return;
+    if (!cpuid_atomic_cas_u32(state, 0, 1)) {
+        // otro interprete la esta construyendo, es cuestion de microsegundos
+        while (cpuid_atomic_load_u32(state) != 2) { }
+        return;
+    }
+
+    PyGetSetDef *getset = Method_Information_Feature_Bits_Class(getsetters);
+    size_t count = 0;
+
+    // un getter por bit, sin repetir nombres (TSC y RESERVADO existen en ECX y EDX)
+    for (int reg = FEATURE_BITS_REG_EDX; reg <= FEATURE_BITS_REG_ECX; reg++) {
+        const char *const *names = (reg == FEATURE_BITS_REG_EDX)
+            ? Method_Information_Feature_Bits_Class(names_edx)
+            : Method_Information_Feature_Bits_Class(names_ecx);
+        for (int bit = 0; bit < 32; bit++) {
+            if (Method_Information_Feature_Bits_Class(lookup)(names[bit]) != ((reg << 8) | bit)) continue;
+            getset[count++] = (PyGetSetDef){
+                (char*)names[bit], (getter)Method_Information_Feature_Bits_Class(get_bit),
+                NULL, NULL, FEATURE_BITS_CLOSURE(reg, bit)
+            };
+        }
+    }
+    getset[count++] = (PyGetSetDef){
+        "ecx", (getter)Method_Information_Feature_Bits_Class(get_reg), NULL,
+        "Valor del registro ECX", FEATURE_BITS_CLOSURE(FEATURE_BITS_REG_ECX, 0)
+    };
+    getset[count++] = (PyGetSetDef){
+        "edx", (getter)Method_Information_Feature_Bits_Class(get_reg), NULL,
+        "Valor del registro EDX", FEATURE_BITS_CLOSURE(FEATURE_BITS_REG_EDX, 0)
+    };
+    getset[count++] = (PyGetSetDef){
+        "_features", (getter)Method_Information_Feature_Bits_Class(get_features), NULL,
+        "Lista [[(nombre, bit) de EDX], [(nombre, bit) de ECX]]", NULL
+    };
+    getset[count] = (PyGetSetDef){NULL};  // Sentinel
+    cpuid_atomic_store_u32(state, 2);
+}
+
+static PyType_Slot Method_Information_Feature_Bits_Class(slots)[] = {
+    {Py_tp_repr,    (void *)Method_Information_Feature_Bits_Class(repr)},
+    {Py_tp_str,     (void *)Method_Information_Feature_Bits_Class(str)},
+    {Py_tp_doc,     (void *)Method_Information_Feature_Bits_Class(doc)},
+    {Py_tp_methods, Method_Information_Feature_Bits_Class(methods)},
+    {Py_tp_getset,  Method_Information_Feature_Bits_Class(getsetters)},
+    {Py_tp_init,    (void *)Method_Information_Feature_Bits_Class(init)},
+    {Py_tp_new,     (void *)PyType_GenericNew},
+    {0, NULL}
+};
+
+static PyType_Spec Method_Information_Feature_Bits_Class(spec) = {
+    .name      = "cpuid_x86.Information_Feature_Bits",
+    .basicsize = sizeof(Feature_Bits),
+    .itemsize  = 0,
+    .flags     = CLASS_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE, /* no guarda referencias, no necesita GC */
+    .slots     = Method_Information_Feature_Bits_Class(slots),
+};
+
+static PyTypeObject *Method_Information_Feature_Bits_Class(create_type)(PyObject *module) {
+    Method_Information_Feature_Bits_Class(build_getsetters)();
+    return (PyTypeObject *)PyType_FromModuleAndSpec(module, &Method_Information_Feature_Bits_Class(spec), NULL);
+}
+
+static PyObject* Method_Information_Feature_Bits_Class(get_bit)(Feature_Bits *self, void *closure) {
+    return PyBool_FromLong(Method_Information_Feature_Bits_Class(test)(self, (int)(uintptr_t)closure));
+}
+
+static PyObject* Method_Information_Feature_Bits_Class(get_reg)(Feature_Bits *self, void *closure) {
+    return PyLong_FromUnsignedLong(Method_Information_Feature_Bits_Class(reg_value)(self, (int)((uintptr_t)closure >> 8)));
+}
+
+static PyObject* Method_Information_Feature_Bits_Class(get_features)(Feature_Bits *self, void *closure) {
+    PyObject *result = PyList_New(2);
+    if (result == NULL) return NULL;
+
+    for (int reg = FEATURE_BITS_REG_EDX; reg <= FEATURE_BITS_REG_ECX; reg++) {
+        const char *const *names = (reg == FEATURE_BITS_REG_EDX)
+            ? Method_Information_Feature_Bits_Class(names_edx)
+            : Method_Information_Feature_Bits_Class(names_ecx);
+        PyObject *list = PyList_New(32);
+        if (list == NULL) {
+            Py_DECREF(result);
+            return NULL;
+        }
+        PyList_SET_ITEM(result, reg, list);
+        for (int bit = 0; bit < 32; bit++) {
+            PyObject *item = Py_BuildValue("(si)", names[bit], bit);
+            if (item == NULL) {
+                Py_DECREF(result);
+                return NULL;
+            }
+            PyList_SET_ITEM(list, bit, item);
+        }
+    }
+    return result;
+}
+
+static PyObject* Method_Information_Feature_Bits_Class(from_registers)(PyTypeObject *type, uint32_t ecx, uint32_t edx) {
+    Feature_Bits *self = (Feature_Bits *)type->tp_alloc(type, 0);
+    if (self == NULL) return NULL;
+
+    memcpy(&self->ecx, &ecx, sizeof(ecx));
+    memcpy(&self->edx, &edx, sizeof(edx));
+    return (PyObject *)self;
+}
+
+// Método __init__
+static int Method_Information_Feature_Bits_Class(init)(Feature_Bits *self, PyObject *args, PyObject *kwds) {
+    static char *kwlist[] = {"ecx", "edx", NULL};
+    PyObject *ecx_obj = Py_None, *edx_obj = Py_None;
+    uint32_t eax = 0, ebx = 0, ecx = 0, edx = 0;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|OO", kwlist, &ecx_obj, &edx_obj)) {
+        return -1;
+    }
+
+    // si falta alguno de los registros se obtiene con CPUID EAX=1
+    if (ecx_obj == Py_None || edx_obj == Py_None) {
+        call_cpuid(CPUID_GETFEATURES, 0, &eax, &ebx, &ecx, &edx);
+    }
+    if (ecx_obj != Py_None) {
+        ecx = (uint32_t)PyLong_AsUnsignedLongMask(ecx_obj);
+        if (PyErr_Occurred()) return -1;
+    }
+    if (edx_obj != Py_None) {
+        edx = (uint32_t)PyLong_AsUnsignedLongMask(edx_obj);
+        if (PyErr_Occurred()) return -1;
+    }
+
+    CLASS_BEGIN_CRITICAL_SECTION(self);
+    memcpy(&self->ecx, &ecx, sizeof(ecx));
+    memcpy(&self->edx, &edx, sizeof(edx));
+    CLASS_END_CRITICAL_SECTION();
+    debug_print_cpuid("Information_Feature_Bits: ecx=0x%08x, edx=0x%08x\n", ecx, edx);
+    return 0;
+}
+
+static PyObject* Method_Information_Feature_Bits_Class(has_feature)(Feature_Bits *self, PyObject *arg) {
+    const char *name = PyUnicode_AsUTF8(arg);
+    if (name == NULL) return NULL;
+
+    int code = Method_Information_Feature_Bits_Class(lookup)(name);
+    return PyBool_FromLong(code >= 0 && Method_Information_Feature_Bits_Class(test)(self, code));
+}
+
+/*
+ * Comun para has_all_features y has_any_feature: cuenta cuantas de las tecnologias
+ * de args estan presentes. Devuelve -1 si algun argumento no es un str.
+ */
+static Py_ssize_t Method_Information_Feature_Bits_Class(count_features)(Feature_Bits *self, PyObject *args) {
+    Py_ssize_t present = 0;
+    for (Py_ssize_t i = 0; i < PyTuple_GET_SIZE(args); i++) {
+        const char *name = PyUnicode_AsUTF8(PyTuple_GET_ITEM(args, i));
+        if (name == NULL) return -1;
+        int code = Method_Information_Feature_Bits_Class(lookup)(name);
+        present += (code >= 0 && Method_Information_Feature_Bits_Class(test)(self, code));
+    }
+    return present;
+}
+
+static PyObject* Method_Information_Feature_Bits_Class(has_all_features)(Feature_Bits *self, PyObject *args) {
+    Py_ssize_t present = Method_Information_Feature_Bits_Class(count_features)(self, args);
+    if (present < 0) return NULL;
+    return PyBool_FromLong(present == PyTuple_GET_SIZE(args));
+}
+
+static PyObject* Method_Information_Feature_Bits_Class(has_any_feature)(Feature_Bits *self, PyObject *args) {
+    Py_ssize_t present = Method_Information_Feature_Bits_Class(count_features)(self, args);
+    if (present < 0) return NULL;
+    return PyBool_FromLong(present > 0);
+}
+
+static PyObject* Method_Information_Feature_Bits_Class(print_vals)(Feature_Bits *self, PyObject *unused) {
+    // 64 lineas de como mucho "HYPERVISOR: No soportado\n"
+    char buffer[64 * 32 + 64];
+    size_t len = (size_t)snprintf(buffer, sizeof(buffer), "Detalles de la CPU:\n==============================\n");
+
+    for (int reg = FEATURE_BITS_REG_EDX; reg <= FEATURE_BITS_REG_ECX; reg++) {
+        const char *const *names = (reg == FEATURE_BITS_REG_EDX)
+            ? Method_Information_Feature_Bits_Class(names_edx)
+            : Method_Information_Feature_Bits_Class(names_ecx);
+        for (int bit = 0; bit < 32; bit++) {
+            len += (size_t)snprintf(buffer + len, sizeof(buffer) - len, "%-10s: %s\n", names[bit],
+                Method_Information_Feature_Bits_Class(test)(self, (reg << 8) | bit) ? "Soportado" : "No soportado");
+        }
+    }
+
+    PyObject *text = PyUnicode_FromStringAndSize(buffer, (Py_ssize_t)len);
+    if (text == NULL) return NULL;
+    int status = Class_write_stdout(text);
+    Py_DECREF(text);
+    if (status < 0) return NULL;
+    Py_RETURN_NONE;
+}
+
+static PyObject* Method_Information_Feature_Bits_Class(str)(Feature_Bits *self) {
+    // "CPU Features: " + 64 nombres de como mucho 10 caracteres + ", "
+    char buffer[16 + 64 * 12];
+    size_t len = (size_t)snprintf(buffer, sizeof(buffer), "CPU Features: ");
+    int first = 1;
+
+    for (int reg = FEATURE_BITS_REG_EDX; reg <= FEATURE_BITS_REG_ECX; reg++) {
+        const char *const *names = (reg == FEATURE_BITS_REG_EDX)
+            ? Method_Information_Feature_Bits_Class(names_edx)
+            : Method_Information_Feature_Bits_Class(names_ecx);
+        for (int bit = 0; bit < 32; bit++) {
+            if (!Method_Information_Feature_Bits_Class(test)(self, (reg << 8) | bit)) continue;
+            len += (size_t)snprintf(buffer + len, sizeof(buffer) - len, "%s%s", first ? "" : ", ", names[bit]);
+            first = 0;
+        }
+    }
+    return PyUnicode_FromStringAndSize(buffer, (Py_ssize_t)len);
+}
+
+static PyObject* Method_Information_Feature_Bits_Class(repr)(Feature_Bits *self) {
+    return PyUnicode_FromFormat(
+        "Information_Feature_Bits(ecx=0x%08x, edx=0x%08x)",
+        Method_Information_Feature_Bits_Class(reg_value)(self, FEATURE_BITS_REG_ECX),
+        Method_Information_Feature_Bits_Class(reg_value)(self, FEATURE_BITS_REG_EDX)
+    );
+}
+
+#endif
@@ -0,0 +1,75 @@
+#include "Class.h"
+#ifndef __CLASS_INFORMATION_FEATURE_BITS_H__
+#define __CLASS_INFORMATION_FEATURE_BITS_H__
+
+#include <stdint.h>
+#include "../../cpuid.h"
+
+/*
+ * Version nativa de cpuid_0x1.Information_Feature_Bits. En lugar de crear un atributo
+ * de Python por cada bit en __init__, la instancia guarda los registros ECX y EDX de
+ * CPUID EAX=1 en las estructuras cpuid_feat_ecx y cpuid_feat_edx de cpuid.h, y cada
+ * atributo (SSE3, AVX, FPU, ...) es un getter en C que extrae el bit al leerse.
+ */
+#define Method_Information_Feature_Bits_Class(name) Information_Feature_Bits_ ## name
+
+typedef struct {
+    PyObject_HEAD
+    cpuid_feat_ecx ecx;    /* CPUID EAX=1: Feature Information en ECX */
+    cpuid_feat_edx edx;    /* CPUID EAX=1: Feature Information en EDX */
+} Feature_Bits;
+
+// indica de que registro es un bit en el closure de los getters
+#define FEATURE_BITS_REG_EDX 0
+#define FEATURE_BITS_REG_ECX 1
+#define FEATURE_BITS_CLOSURE(reg, bit) ((void*)(uintptr_t)(((reg) << 8) | (bit)))
+
+PyDoc_STRVAR(Method_Information_Feature_Bits_Class(doc),
+    "Information_Feature_Bits(ecx=None, edx=None)\n\n"
+    "Tecnologias soportadas por la CPU (CPUID EAX=1, registros ECX y EDX).\n"
+    "Si ecx o edx es None se obtienen llamando a CPUID. Los nombres repetidos\n"
+    "en ambos registros (TSC, RESERVADO) hacen referencia al bit de EDX.");
+
+// Metodos Inprescindibles y porpias de Python
+static PyTypeObject *Method_Information_Feature_Bits_Class(create_type) (PyObject *module);
+static int       Method_Information_Feature_Bits_Class(init)             (Feature_Bits *self, PyObject *args, PyObject *kwds);
+static PyObject* Method_Information_Feature_Bits_Class(str)              (Feature_Bits *self);
+static PyObject* Method_Information_Feature_Bits_Class(repr)             (Feature_Bits *self);
+
+// Crea una instancia directamente desde C, sin pasar por __init__
+static PyObject* Method_Information_Feature_Bits_Class(from_registers)   (PyTypeObject *type, uint32_t ecx, uint32_t edx);
+
+// metodos getter
+static PyObject* Method_Information_Feature_Bits_Class(get_bit)     (Feature_Bits *self, void *closure);
+static PyObject* Method_Information_Feature_Bits_Class(get_reg)     (Feature_Bits *self, void *closure);
+static PyObject* Method_Information_Feature_Bits_Class(get_features)(Feature_Bits *self, void *closure);
+
+// Metodos propios
+static PyObject* Method_Information_Feature_Bits_Class(has_feature)     (Feature_Bits *self, PyObject *arg);
+static PyObject* Method_Information_Feature_Bits_Class(has_all_features)(Feature_Bits *self, PyObject *args);
+static PyObject* Method_Information_Feature_Bits_Class(has_any_feature) (Feature_Bits *self, PyObject *args);
+static PyObject* Method_Information_Feature_Bits_Class(print_vals)      (Feature_Bits *self, PyObject *unused);
+
+static PyMethodDef Method_Information_Feature_Bits_Class(methods)[] = {
+    {"has_feature",      (PyCFunction)Method_Information_Feature_Bits_Class(has_feature),      METH_O,
+        "Devuelve True si la CPU soporta la tecnologia indicada (por ejemplo 'SSE3')"},
+    {"has_all_features", (PyCFunction)Method_Information_Feature_Bits_Class(has_all_features), METH_VARARGS,
+        "Devuelve True si TODAS las tecnologias indicadas estan presentes"},
+    {"has_any_feature",  (PyCFunction)Method_Information_Feature_Bits_Class(has_any_feature),  METH_VARARGS,
+        "Devuelve True si al menos una de las tecnologias indicadas esta presente"},
+    {"print_vals",       (PyCFunction)Method_Information_Feature_Bits_Class(print_vals),       METH_NOARGS,
+        "Imprime todas las tecnologias y si la CPU las soporta"},
+    {NULL}  // Indicador de fin de la lista de métodos
+};
+
+/*
+ * Los atributos por bit se generan en build_getsetters a partir de CPUID_FEAT_EDX_FIELDS y
+ * CPUID_FEAT_ECX_FIELDS (primero EDX, igual que en la version de Python), mas los atributos
+ * fijos ecx, edx y _features. 64 bits + 3 fijos + centinela.
+ * La tabla es del proceso y la comparten los tipos de todos los interpretes; se construye una
+ * unica vez aunque varios interpretes importen el modulo a la vez (ver build_getsetters).
+ */
+static PyGetSetDef Method_Information_Feature_Bits_Class(getsetters)[64 + 3 + 1];
+
+#include "Information_Feature_Bits.c"
+#endif
@@ -0,0 +1,198 @@
+#include "Class.h"
+#ifndef __CLASS_PROCESSOR_INFO_C__
+#define __CLASS_PROCESSOR_INFO_C__
+#include "Processor_Info.h"
+
+#include <string.h>
+
+static PyType_Slot Method_Processor_Info_Class(slots)[] = {
+    {Py_tp_dealloc,  (void *)Method_Processor_Info_Class(dealloc)},
+    {Py_tp_repr,     (void *)Method_Processor_Info_Class(repr)},
+    {Py_tp_doc,      (void *)Method_Processor_Info_Class(doc)},
+    {Py_tp_traverse, (void *)Method_Processor_Info_Class(traverse)},
+    {Py_tp_clear,    (void *)Method_Processor_Info_Class(clear)},
+    {Py_tp_methods,  Method_Processor_Info_Class(methods)},
+    {Py_tp_getset,   Method_Processor_Info_Class(getsetters)},
+    {Py_tp_init,     (void *)Method_Processor_Info_Class(init)},
+    {Py_tp_new,      (void *)PyType_GenericNew},
+    {0, NULL}
+};
+
+static PyType_Spec Method_Processor_Info_Class(spec) = {
+    .name      = "cpuid_x86.Processor_Info_and_Feature_Bits",
+    .basicsize = sizeof(Processor_Info),
+    .itemsize  = 0,
+    .flags     = CLASS_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_GC | Py_TPFLAGS_BASETYPE,
+    .slots     = Method_Processor_Info_Class(slots),
+};
+
+static PyTypeObject *Method_Processor_Info_Class(create_type)(PyObject *module) {
+    return (PyTypeObject *)PyType_FromModuleAndSpec(module, &Method_Processor_Info_Class(spec), NULL);
+}
+
+static inline uint32_t Method_Processor_Info_Class(eax_value)(Processor_Info *self) {
+    uint32_t eax;
+    memcpy(&eax, &self->eax, sizeof(eax));
+    return eax;
+}
+
+/*
+ * ((Family_ID == 0x06) || (Family_ID == 0x0f)) ? ((Extended_Model_ID << 4) + Model) : Model
+ */
+static inline unsigned long Method_Processor_Info_Class(model_number)(
+    unsigned long Family_ID, unsigned long Model, unsigned long Extended_Model_ID
+) {
+    return (Family_ID == 0x06 || Family_ID == 0x0f) ? ((Extended_Model_ID << 4) + Model) : Model;
+}
+
+static PyObject* Method_Processor_Info_Class(get_field)(Processor_Info *self, void *closure) {
+    uintptr_t shift = (uintptr_t)closure >> 8, width = (uintptr_t)closure & 0xff;
+    return PyLong_FromUnsignedLong((Method_Processor_Info_Class(eax_value)(self) >> shift) & ((1u << width) - 1));
+}
+
+static PyObject* Method_Processor_Info_Class(get_All_Model)(Processor_Info *self, void *closure) {
+    return PyLong_FromUnsignedLong(Method_Processor_Info_Class(model_number)(
+        self->eax.Family_ID, self->eax.Model, self->eax.Extended_Model_ID
+    ));
+}
+
+static PyObject* Method_Processor_Info_Class(get_CPUID_signature)(Processor_Info *self, void *closure) {
+    /* Ejemplo:
+    CPUID signature: 0x0671 (0671h)
+    Family:	           0x06 (06h)
+    Model:	           0x07 (07h)
+    Stepping:          0x01 (01h)
+    */
+    return PyLong_FromUnsignedLong(
+        ((unsigned long)self->eax.Family_ID << 8) + ((unsigned long)self->eax.Model << 4) + self->eax.Stepping_ID
+    );
+}
+
+static PyObject* Method_Processor_Info_Class(get_additional_info)(Processor_Info *self, void *closure) {
+    PyObject *value;
+    CLASS_BEGIN_CRITICAL_SECTION(self);
+    value = self->additional_info ? self->additional_info : Py_None;
+    Py_INCREF(value);
+    CLASS_END_CRITICAL_SECTION();
+    return value;
+}
+
+static PyObject* Method_Processor_Info_Class(get_extensions)(Processor_Info *self, void *closure) {
+    PyObject *value;
+    CLASS_BEGIN_CRITICAL_SECTION(self);
+    value = self->extensions ? self->extensions : Py_None;
+    Py_INCREF(value);
+    CLASS_END_CRITICAL_SECTION();
+    return value;
+}
+
+// Método __init__
+static int Method_Processor_Info_Class(init)(Processor_Info *self, PyObject *args, PyObject *kwds) {
+    static char *kwlist[] = {"eax", "ebx", "ecx", "edx", NULL};
+    PyObject *objs[4] = {Py_None, Py_None, Py_None, Py_None};
+    uint32_t regs[4] = {0, 0, 0, 0};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|OOOO", kwlist, &objs[0], &objs[1], &objs[2], &objs[3])) {
+        return -1;
+    }
+
+    // una unica llamada a CPUID para todos los registros que no se pasaron
+    if (objs[0] == Py_None || objs[1] == Py_None || objs[2] == Py_None || objs[3] == Py_None) {
+        call_cpuid(CPUID_GETFEATURES, 0, &regs[0], &regs[1], &regs[2], &regs[3]);
+    }
+    for (int i = 0; i < 4; i++) {
+        if (objs[i] == Py_None) continue;
+        regs[i] = (uint32_t)PyLong_AsUnsignedLongMask(objs[i]);
+        if (PyErr_Occurred()) return -1;
+    }
+
+    cpuid_module_state *state = Class_state_from_type(Py_TYPE(self));
+    if (state == NULL) return -1;
+    PyObject *additional_info = Method_Additional_Information_Class(from_register)(state->Additional_Information_type, regs[1]);
+    if (additional_info == NULL) return -1;
+    PyObject *extensions = Method_Information_Feature_Bits_Class(from_registers)(state->Information_Feature_Bits_type, regs[2], regs[3]);
+    if (extensions == NULL) {
+        Py_DECREF(additional_info);
+        return -1;
+    }
+    // sin GIL otro hilo puede estar leyendo o reinicializando la instancia
+    CLASS_BEGIN_CRITICAL_SECTION(self);
+    memcpy(&self->eax, &regs[0], sizeof(regs[0]));
+    Py_XSETREF(self->additional_info, additional_info);
+    Py_XSETREF(self->extensions, extensions);
+    CLASS_END_CRITICAL_SECTION();
+
+    debug_print_cpuid("Processor_Info_and_Feature_Bits: eax=0x%08x, ebx=0x%08x, ecx=0x%08x, edx=0x%08x\n",
+        regs[0], regs[1], regs[2], regs[3]);
+    return 0;
+}
+
+static PyObject* Method_Processor_Info_Class(get_model_number)(Processor_Info *self, PyObject *args, PyObject *kwds) {
+    static char *kwlist[] = {"Family_ID", "Model", "Extended_Model_ID", NULL};
+    PyObject *objs[3] = {Py_None, Py_None, Py_None};
+    unsigned long vals[3] = {self->eax.Family_ID, self->eax.Model, self->eax.Extended_Model_ID};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|OOO", kwlist, &objs[0], &objs[1], &objs[2])) {
+        return NULL;
+    }
+    // los argumentos que sean None toman el valor de la instancia
+    for (int i = 0; i < 3; i++) {
+        if (objs[i] == Py_None) continue;
+        vals[i] = PyLong_AsUnsignedLong(objs[i]);
+        if (PyErr_Occurred()) return NULL;
+    }
+    return PyLong_FromUnsignedLong(Method_Processor_Info_Class(model_number)(vals[0], vals[1], vals[2]));
+}
+
+static PyObject* Method_Processor_Info_Class(print_vals)(Processor_Info *self, PyObject *unused) {
+    PyObject *text = PyUnicode_FromFormat(
+        "Reserved1           :4  = 0x%x\n"
+        "Extended_Family_ID  :8  = 0x%x\n"
+        "Extended_Model_ID   :4  = 0x%x\n"
+        "Reserved2           :2  = 0x%x\n"
+        "Processor_Type      :2  = 0x%x\n"
+        "Family_ID           :4  = 0x%x\n"
+        "Model               :4  = 0x%x\n"
+        "Stepping_ID         :4  = 0x%x\n"
+        "All_Model               = 0x%x\n"
+        "CPUID signature         = 0x%x\n\n",
+        (unsigned)self->eax.Reserved1,      (unsigned)self->eax.Extended_Family_ID,
+        (unsigned)self->eax.Extended_Model_ID, (unsigned)self->eax.Reserved2,
+        (unsigned)self->eax.Processor_Type, (unsigned)self->eax.Family_ID,
+        (unsigned)self->eax.Model,          (unsigned)self->eax.Stepping_ID,
+        (unsigned)Method_Processor_Info_Class(model_number)(self->eax.Family_ID, self->eax.Model, self->eax.Extended_Model_ID),
+        (unsigned)((self->eax.Family_ID << 8) + (self->eax.Model << 4) + self->eax.Stepping_ID)
+    );
+    if (text == NULL) return NULL;
+    int status = Class_write_stdout(text);
+    Py_DECREF(text);
+    if (status < 0) return NULL;
+    Py_RETURN_NONE;
+}
+
+static PyObject* Method_Processor_Info_Class(repr)(Processor_Info *self) {
+    return PyUnicode_FromFormat("Processor_Info_and_Feature_Bits(eax=0x%08x)", Method_Processor_Info_Class(eax_value)(self));
+}
+
+static void Method_Processor_Info_Class(dealloc)(Processor_Info *self) {
+    PyTypeObject *type = Py_TYPE(self);
+    PyObject_GC_UnTrack(self);
+    Method_Processor_Info_Class(clear)(self);
+    type->tp_free((PyObject *)self);
+    Py_DECREF(type);
+}
+
+static int Method_Processor_Info_Class(traverse)(Processor_Info *self, visitproc visit, void *arg) {
+    Py_VISIT(Py_TYPE(self));
+    Py_VISIT(self->additional_info);
+    Py_VISIT(self->extensions);
+    return 0;
+}
+
+static int Method_Processor_Info_Class(clear)(Processor_Info *self) {
+    Py_CLEAR(self->additional_info);
+    Py_CLEAR(self->extensions);
+    return 0;
+}
+
+#endif
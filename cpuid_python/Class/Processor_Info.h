@@ -0,0 +1,87 @@
+#include "Class.h"
+#ifndef __CLASS_PROCESSOR_INFO_H__
+#define __CLASS_PROCESSOR_INFO_H__
+
+#include <stdint.h>
+#include "../../cpuid.h"
+#include "Additional_Information.h"
+#include "Information_Feature_Bits.h"
+
+/*
+ * Version nativa de cpuid_0x1.Processor_Info_and_Feature_Bits. Guarda EAX de CPUID EAX=1 en
+ * la estructura Processor_Info_and_Feature_Bits de cpuid.h; los campos (Stepping_ID, Model, ...)
+ * se extraen en C al leerse. additional_info y extensions son instancias de las clases nativas
+ * Additional_Information_Feature_Bits e Information_Feature_Bits creadas con la misma llamada a CPUID.
+ */
+#define Method_Processor_Info_Class(name) Processor_Info_ ## name
+
+typedef struct {
+    PyObject_HEAD
+    Processor_Info_and_Feature_Bits eax;
+    PyObject *additional_info;  /* Additional_Information_Feature_Bits (EBX) */
+    PyObject *extensions;       /* Information_Feature_Bits (ECX y EDX)      */
+} Processor_Info;
+
+// closure de los getters: (bit_inicial << 8) | ancho del campo
+#define PROCESSOR_INFO_CLOSURE(shift, width) ((void*)(uintptr_t)(((shift) << 8) | (width)))
+
+PyDoc_STRVAR(Method_Processor_Info_Class(doc),
+    "Processor_Info_and_Feature_Bits(eax=None, ebx=None, ecx=None, edx=None)\n\n"
+    "Version, familia y modelo del procesador (CPUID EAX=1). Los registros que sean\n"
+    "None se obtienen llamando a CPUID. En algunos procesadores el campo Processor_Type\n"
+    "esta reservado.");
+
+// Metodos Inprescindibles y porpias de Python
+static PyTypeObject *Method_Processor_Info_Class(create_type) (PyObject *module);
+static int       Method_Processor_Info_Class(init)             (Processor_Info *self, PyObject *args, PyObject *kwds);
+static void      Method_Processor_Info_Class(dealloc)          (Processor_Info *self);
+static PyObject* Method_Processor_Info_Class(repr)             (Processor_Info *self);
+static int       Method_Processor_Info_Class(traverse)         (Processor_Info *self, visitproc visit, void *arg);
+static int       Method_Processor_Info_Class(clear)            (Processor_Info *self);
+
+// metodos getter
+static PyObject* Method_Processor_Info_Class(get_field)          (Processor_Info *self, void *closure);
+static PyObject* Method_Processor_Info_Class(get_All_Model)      (Processor_Info *self, void *closure);
+static PyObject* Method_Processor_Info_Class(get_CPUID_signature)(Processor_Info *self, void *closure);
+static PyObject* Method_Processor_Info_Class(get_additional_info)(Processor_Info *self, void *closure);
+static PyObject* Method_Processor_Info_Class(get_extensions)     (Processor_Info *self, void *closure);
+
+// Metodos propios
+static PyObject* Method_Processor_Info_Class(get_model_number)(Processor_Info *self, PyObject *args, PyObject *kwds);
+static PyObject* Method_Processor_Info_Class(print_vals)      (Processor_Info *self, PyObject *unused);
+
+static PyMethodDef Method_Processor_Info_Class(methods)[] = {
+    {"get_model_number", (PyCFunction)(void(*)(void))Method_Processor_Info_Class(get_model_number), METH_VARARGS | METH_KEYWORDS,
+        "get_model_number(Family_ID=None, Model=None, Extended_Model_ID=None) -> modelo completo"},
+    {"print_vals",       (PyCFunction)Method_Processor_Info_Class(print_vals),                      METH_NOARGS,
+        "Imprime los campos de EAX"},
+    {NULL}  // Indicador de fin de la lista de métodos
+};
+
+#define PROCESSOR_INFO_GETSET(name, shift, width) \
+    { #name, (getter)Method_Processor_Info_Class(get_field), NULL, #name " :" #width, PROCESSOR_INFO_CLOSURE(shift, width) },
+
+static PyGetSetDef Method_Processor_Info_Class(getsetters)[] = {
+    CPUID_PROCESSOR_INFO_FIELDS(PROCESSOR_INFO_GETSET)
+    {
+        "All_Model", (getter)Method_Processor_Info_Class(get_All_Model), NULL,
+        "Modelo completo (incluye Extended_Model_ID en las familias 0x06 y 0x0f)", NULL
+    },
+    {
+        "CPUID_signature", (getter)Method_Processor_Info_Class(get_CPUID_signature), NULL,
+        "(Family_ID << 8) + (Model << 4) + Stepping_ID", NULL
+    },
+    {
+        "additional_info", (getter)Method_Processor_Info_Class(get_additional_info), NULL,
+        "Additional_Information_Feature_Bits obtenido de EBX", NULL
+    },
+    {
+        "extensions", (getter)Method_Processor_Info_Class(get_extensions), NULL,
+        "Information_Feature_Bits obtenido de ECX y EDX", NULL
+    },
+    {NULL}  // Sentinel
+};
+#undef PROCESSOR_INFO_GETSET
+
+#include "Processor_Info.c"
+#endif
@@ -80,103 +80,51 @@ static int Method_Register_Class(set_edx)(Register *self, PyObject *value, void
 }
 
 
-static void Method_Register_Class(init_type_object)(void) {
-    Method_Register_Class(type_Class) = (PyTypeObject){
-        PyVarObject_HEAD_INIT(&PyType_Type, 0)
-        "cpuid_x86.Register",                      /* tp_name */
-        sizeof(Register),                          /* tp_basicsize 
-                                                    * PyTypeObject.tp_basicsize se establece para que 
-                                                    * tenga el tamaño de la estructura de cola de salida. 
-                                                    * Esto significa que las instancias de una Register tienen 
-                                                    * el tamaño de una Register.
-                                                    */
-        0,                                          /* tp_itemsize 
-                                                    * PyTypeObject.tp_itemsize se establece en 0 porque todas las 
-                                                    * instancias de una Register usan la misma cantidad de espacio. 
-                                                    * Este campo está diseñado para implementar colecciones 
-                                                    * compactas como tuple.
-                                                    */
-        (destructor) Method_Register_Class(dealloc),                 /* tp_dealloc 
-                                                    * PyTypeObject.tp_dealloc se establece en una función 
-                                                    * de desasignación. Esta función necesita liberar 
-                                                    * la referencia de la cola a q_elements.
-                                                    */
-        0,                                          /* tp_print */
-        0,                                          /* tp_getattr */
-        0,                                          /* tp_setattr */
-        0,                                          /* tp_reserved */
-        (reprfunc) Method_Register_Class(repr),                      /* tp_repr */
-        0,                                          /* tp_as_number */
-        0,                                          /* tp_as_sequence */
-        0,                                          /* tp_as_mapping */
-        0,                                          /* tp_hash */
-        0,                                          /* tp_call */
-        0,                                          /* tp_str */
-        0,                                          /* tp_getattro */
-        0,                                          /* tp_setattro */
-        0,                                          /* tp_as_buffer */
-        Py_TPFLAGS_DEFAULT |
-        Py_TPFLAGS_HAVE_GC |
-        Py_TPFLAGS_BASETYPE,                         /* tp_flags 
-                                                    * PyTypeObject.tp_flags se establece en 
-                                                    * Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_GC. Esto 
-                                                    * significa que tenemos tanto los indicadores predeterminados 
-                                                    * como el bit HAVE_GC. Debido a que el bit 
-                                                    * Py_TPFLAGS_HAVE_GC está configurado, también tenemos una 
-                                                    * función PyTypeObject.tp_traverse y una función 
-                                                    * PyTypeObject.tp_clear.
-                                                    */
-        .tp_doc             = Method_Register_Class(doc),                 /* tp_doc */ // != PyDoc_STR
-        .tp_traverse        = (traverseproc) Method_Register_Class(traverse), /* tp_traverse */ //(traverseproc) Register_traverse,
-        .tp_clear           = (inquiry) Method_Register_Class(clear),        /* tp_clear */ //(inquiry) Register_clear,        
-        .tp_richcompare     = 0,                         /* tp_richcompare */
-        .tp_weaklistoffset  = 0,                         /* tp_weaklistoffset */
-        .tp_iter            = 0,                         /* tp_iter */
-        .tp_iternext        = 0,                         /* tp_iternext */
-        .tp_methods         = Method_Register_Class(methods),          /* tp_methods */
-        .tp_members         = 0,                         /* tp_members */
-        .tp_getset          = Method_Register_Class(getsetters),                         /* tp_getset */
-        .tp_base            = 0,                         /* tp_base */
-        .tp_dict            = 0,                         /* tp_dict */
-        .tp_descr_get       = 0,                         /* tp_descr_get */
-        .tp_descr_set       = 0,                         /* tp_descr_set */
-        .tp_dictoffset      = 0,                         /* tp_dictoffset */
-        .tp_init            = (initproc)Method_Register_Class(init),  /* 
-                                                        * tp_init 
-                                                        * MyClass.__init__ --> tp_init
-                                                        */
-        .tp_alloc           = 0,                          /* tp_alloc */
-        .tp_new             = Method_Register_Class(new),            /* tp_new 
-                                                        * Si PyTypeObject.tp_new es NULL, no puede crear 
-                                                        * nuevas instancias de la clase.
-                                                        */
-    };
-    // Finalmente, llamamos a PyType_Ready
-    if (PyType_Ready(&Method_Register_Class(type_Class)) < 0)
-        return;
+static PyType_Slot Method_Register_Class(slots)[] = {
+    {Py_tp_dealloc,  (void *)Method_Register_Class(dealloc)},
+    {Py_tp_repr,     (void *)Method_Register_Class(repr)},
+    {Py_tp_doc,      (void *)Method_Register_Class(doc)},
+    {Py_tp_traverse, (void *)Method_Register_Class(traverse)},
+    {Py_tp_clear,    (void *)Method_Register_Class(clear)},
+    {Py_tp_methods,  Method_Register_Class(methods)},
+    {Py_tp_getset,   Method_Register_Class(getsetters)},
+    {Py_tp_init,     (void *)Method_Register_Class(init)},
+    {Py_tp_new,      (void *)Method_Register_Class(new)},
+    {0, NULL}
+};
+
+static PyType_Spec Method_Register_Class(spec) = {
+    .name      = "cpuid_x86.Register",
+    .basicsize = sizeof(Register),
+    .itemsize  = 0,
+    .flags     = CLASS_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_GC | Py_TPFLAGS_BASETYPE,
+    .slots     = Method_Register_Class(slots),
+};
+
+static PyTypeObject *Method_Register_Class(create_type)(PyObject *module) {
+    return (PyTypeObject *)PyType_FromModuleAndSpec(module, &Method_Register_Class(spec), NULL);
 }
 
 // Método __init__
 static int Method_Register_Class(init)(Register *self, PyObject *args, PyObject *kwds) {
     static char *kwlist[] = {"eax", "ebx", "ecx", "edx", NULL};
-    // Inicializamos con valores por defecto
-    self->eax = 0;
-    self->ebx = 0;
-    self->ecx = 0;
-    self->edx = 0;
-    self->q_maxsize = 10;  // valor por defecto
-    
-    uint32_t eax = 0, ebx = 0, ecx = 0, edx = 0;
+    int status = 0;
+
+    // "I" escribe un unsigned int, "k" (unsigned long) desbordaria los uint32_t en Linux
+    unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
 
     // Parseamos los argumentos de __init__(self, value=0)
     if (!PyArg_ParseTupleAndKeywords(
-            args, kwds, "|kkkk", kwlist,
+            args, kwds, "|IIII", kwlist,
             &eax, &ebx, &ecx, &edx)
         ){
         debug_print_cpuid("PyArg_ParseTuple failed\n");
         return -1;
     }
 
+    // sin GIL otro hilo puede estar usando la instancia
+    CLASS_BEGIN_CRITICAL_SECTION(self);
+    self->q_maxsize = 10;  // valor por defecto
     self->eax = (uint32_t)eax;
     self->ebx = (uint32_t)ebx;
     self->ecx = (uint32_t)ecx;
@@ -191,11 +139,12 @@ static int Method_Register_Class(init)(Register *self, PyObject *args, PyObject
         self->q_elements = PyList_New(0);
         if (self->q_elements == NULL) {
             debug_print_cpuid("Failed to create q_elements in init\n");
-            return -1;
+            status = -1;
         }
     }
-    debug_print_cpuid("Exiting Register_init successfully\n");
-    return 0;
+    CLASS_END_CRITICAL_SECTION();
+    if (status == 0) debug_print_cpuid("Exiting Register_init successfully\n");
+    return status;
 
 }
 
@@ -254,8 +203,10 @@ static void Method_Register_Class(dealloc)(Register *self) {
      * utilizados en otro lugar.
      */
     
-    // Llamamos al deallocador del tipo para liberar la memoria de self
-    Py_TYPE(self)->tp_free((PyObject *)self);
+    // Llamamos al deallocador del tipo para liberar la memoria de self y soltamos el tipo (heap type)
+    PyTypeObject *type = Py_TYPE(self);
+    type->tp_free((PyObject *)self);
+    Py_DECREF(type);
 }
 
 static PyObject* Method_Register_Class(repr)(Register *self) {
@@ -298,6 +249,7 @@ static PyObject* Method_Register_Class(repr)(Register *self) {
 static int Method_Register_Class(traverse)(Register *self, visitproc visit, void *arg) {
     // Si q_elements tiene una referencia a un objeto Python, la recorremos
     Py_VISIT(self->q_elements);
+    Py_VISIT(Py_TYPE(self));
     return 0;
 }
 static int Method_Register_Class(clear)(Register *self) {
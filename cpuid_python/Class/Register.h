@@ -20,10 +20,9 @@ typedef struct {
 } Register;
 
 PyDoc_STRVAR(Method_Register_Class(doc), "Clase que contiene la informacion devuelta por CPUID");
-static PyTypeObject Method_Register_Class(type_Class);
 
 // Metodos Inprescindibles y porpias de Python
-static void      Method_Register_Class(init_type_object) (void);
+static PyTypeObject *Method_Register_Class(create_type) (PyObject *module);
 static int       Method_Register_Class(init)             (Register *self, PyObject *args, PyObject *kwds);
 static PyObject *Method_Register_Class(new)              (PyTypeObject *type, PyObject *args, PyObject *kwds);
 static void      Method_Register_Class(dealloc)          (Register *self);
@@ -0,0 +1,313 @@
+#include "Class.h"
+#ifndef __CLASS_SNAPSHOT_C__
+#define __CLASS_SNAPSHOT_C__
+#include "Snapshot.h"
+
+#include <string.h>
+
+// columnas de cada fila del buffer (campos de cpuid_record)
+#define SNAPSHOT_COLUMNS (Py_ssize_t)(sizeof(cpuid_record) / sizeof(uint32_t))
+
+static PyType_Slot Method_Snapshot_Class(slots)[] = {
+    {Py_tp_dealloc,    (void *)Method_Snapshot_Class(dealloc)},
+    {Py_tp_repr,       (void *)Method_Snapshot_Class(repr)},
+    {Py_tp_doc,        (void *)Method_Snapshot_Class(doc)},
+    {Py_tp_methods,    Method_Snapshot_Class(methods)},
+    {Py_tp_getset,     Method_Snapshot_Class(getsetters)},
+    {Py_tp_new,        (void *)Method_Snapshot_Class(new)},
+    {Py_sq_length,     (void *)Method_Snapshot_Class(length)},
+    {Py_sq_item,       (void *)Method_Snapshot_Class(item)},
+    {Py_bf_getbuffer,  (void *)Method_Snapshot_Class(getbuffer)},
+    {0, NULL}
+};
+
+static PyType_Spec Method_Snapshot_Class(spec) = {
+    .name      = "cpuid_x86.Snapshot",
+    .basicsize = sizeof(Snapshot),
+    .itemsize  = 0,
+    .flags     = CLASS_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE,
+    .slots     = Method_Snapshot_Class(slots),
+};
+
+static PyTypeObject *Method_Snapshot_Class(create_type)(PyObject *module) {
+    return (PyTypeObject *)PyType_FromModuleAndSpec(module, &Method_Snapshot_Class(spec), NULL);
+}
+
+/*
+ * leaves: secuencia de enteros (subhoja 0) o tuplas (hoja, subhoja).
+ */
+static int Method_Snapshot_Class(parse_leaves)(PyObject *obj, cpuid_leaf_request **leaves, size_t *n_leaves) {
+    PyObject *seq = PySequence_Fast(obj, "leaves debe ser una secuencia de hojas");
+    if (seq == NULL) return -1;
+
+    Py_ssize_t n = PySequence_Fast_GET_SIZE(seq);
+    cpuid_leaf_request *out = PyMem_RawMalloc(sizeof(*out) * (n + 1));
+    if (out == NULL) {
+        Py_DECREF(seq);
+        PyErr_NoMemory();
+        return -1;
+    }
+    for (Py_ssize_t i = 0; i < n; i++) {
+        PyObject *item = PySequence_Fast_GET_ITEM(seq, i);
+        unsigned long leaf, subleaf = 0;
+        if (PyTuple_Check(item)) {
+            if (!PyArg_ParseTuple(item, "kk", &leaf, &subleaf)) goto error;
+        } else {
+            leaf = PyLong_AsUnsignedLong(item);
+            if (PyErr_Occurred()) goto error;
+        }
+        out[i].leaf    = (uint32_t)leaf;
+        out[i].subleaf = (uint32_t)subleaf;
+    }
+    Py_DECREF(seq);
+    *leaves   = out;
+    *n_leaves = (size_t)n;
+    return 0;
+
+error:
+    PyMem_RawFree(out);
+    Py_DECREF(seq);
+    return -1;
+}
+
+static int Method_Snapshot_Class(parse_cpus)(PyObject *obj, uint32_t **cpus, size_t *n_cpus) {
+    PyObject *seq = PySequence_Fast(obj, "cpus debe ser una secuencia de enteros");
+    if (seq == NULL) return -1;
+
+    Py_ssize_t n = PySequence_Fast_GET_SIZE(seq);
+    uint32_t *out = PyMem_RawMalloc(sizeof(*out) * (n + 1));
+    if (out == NULL) {
+        Py_DECREF(seq);
+        PyErr_NoMemory();
+        return -1;
+    }
+    for (Py_ssize_t i = 0; i < n; i++) {
+        out[i] = (uint32_t)PyLong_AsUnsignedLong(PySequence_Fast_GET_ITEM(seq, i));
+        if (PyErr_Occurred()) {
+            PyMem_RawFree(out);
+            Py_DECREF(seq);
+            return -1;
+        }
+    }
+    Py_DECREF(seq);
+    *cpus   = out;
+    *n_cpus = (size_t)n;
+    return 0;
+}
+
+/*
+ * El snapshot se toma en __new__ y no cambia despues: los buffers exportados y los hilos que
+ * leen la tabla no necesitan locks ni contar exportaciones.
+ */
+static PyObject* Method_Snapshot_Class(new)(PyTypeObject *type, PyObject *args, PyObject *kwds) {
+    static char *kwlist[] = {"cpus", "leaves", "threads", NULL};
+    PyObject *cpus_obj = Py_None, *leaves_obj = Py_None;
+    unsigned int n_threads = 0;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|OOI", kwlist, &cpus_obj, &leaves_obj, &n_threads)) {
+        return NULL;
+    }
+
+    cpuid_leaf_request *leaves = NULL;
+    uint32_t           *cpus   = NULL;
+    size_t              n_leaves = 0, n_cpus = 0;
+    if (leaves_obj != Py_None && Method_Snapshot_Class(parse_leaves)(leaves_obj, &leaves, &n_leaves) < 0) return NULL;
+    if (cpus_obj != Py_None && Method_Snapshot_Class(parse_cpus)(cpus_obj, &cpus, &n_cpus) < 0) {
+        PyMem_RawFree(leaves);
+        return NULL;
+    }
+
+    cpuid_snapshot snapshot;
+    int pinned;
+    Py_BEGIN_ALLOW_THREADS
+    pinned = cpuid_snapshot_take(&snapshot, leaves, n_leaves, cpus, n_cpus, n_threads);
+    Py_END_ALLOW_THREADS
+
+    PyMem_RawFree(cpus);
+    PyMem_RawFree(leaves);
+    if (pinned < 0) {
+        PyErr_SetString(PyExc_OSError, "no se pudo tomar el snapshot de CPUID");
+        return NULL;
+    }
+
+    Snapshot *self = (Snapshot *)type->tp_alloc(type, 0);
+    if (self == NULL) {
+        cpuid_snapshot_free(&snapshot);
+        return NULL;
+    }
+    self->snapshot   = snapshot;
+    self->shape[0]   = (Py_ssize_t)snapshot.n_records;
+    self->shape[1]   = SNAPSHOT_COLUMNS;
+    self->strides[0] = (Py_ssize_t)sizeof(cpuid_record);
+    self->strides[1] = (Py_ssize_t)sizeof(uint32_t);
+
+    debug_print_cpuid("Snapshot: %zu CPU, %zu hojas, %d CPU fijadas\n", snapshot.n_cpus, snapshot.n_leaves, pinned);
+    return (PyObject *)self;
+}
+
+static int Method_Snapshot_Class(getbuffer)(Snapshot *self, Py_buffer *view, int flags) {
+    static cpuid_record empty; // buf no puede ser NULL aunque el snapshot este vacio
+
+    if ((flags & PyBUF_WRITABLE) == PyBUF_WRITABLE) {
+        PyErr_SetString(PyExc_BufferError, "el buffer de Snapshot es de solo lectura");
+        view->obj = NULL;
+        return -1;
+    }
+
+    view->obj        = (PyObject *)self;
+    view->buf        = self->snapshot.records ? (void *)self->snapshot.records : (void *)&empty;
+    view->len        = (Py_ssize_t)(self->snapshot.n_records * sizeof(cpuid_record));
+    view->readonly   = 1;
+    view->itemsize   = sizeof(uint32_t);
+    view->format     = (flags & PyBUF_FORMAT) ? "I" : NULL;
+    // sin PyBUF_ND el consumidor ve bytes sueltos (PyBUF_SIMPLE)
+    view->ndim       = (flags & PyBUF_ND) ? 2 : 1;
+    view->shape      = (flags & PyBUF_ND) ? self->shape : NULL;
+    view->strides    = ((flags & PyBUF_STRIDES) == PyBUF_STRIDES) ? self->strides : NULL;
+    view->suboffsets = NULL;
+    view->internal   = NULL;
+
+    Py_INCREF(self);
+    return 0;
+}
+
+static Py_ssize_t Method_Snapshot_Class(length)(Snapshot *self) {
+    return (Py_ssize_t)self->snapshot.n_records;
+}
+
+static PyObject* Method_Snapshot_Class(item)(Snapshot *self, Py_ssize_t index) {
+    if (index < 0 || (size_t)index >= self->snapshot.n_records) {
+        PyErr_SetString(PyExc_IndexError, "indice de Snapshot fuera de rango");
+        return NULL;
+    }
+    const cpuid_record *r = &self->snapshot.records[index];
+    return Py_BuildValue("(IIIIIIII)", r->cpu, r->leaf, r->subleaf, r->eax, r->ebx, r->ecx, r->edx, r->status);
+}
+
+/*
+ * Resuelve el argumento cpu (None = primera CPU del snapshot) y busca la hoja.
+ * Devuelve NULL sin excepcion si la hoja no esta, o con excepcion si cpu no es valido.
+ */
+static const cpuid_record *Method_Snapshot_Class(lookup)(Snapshot *self, PyObject *cpu_obj, uint32_t leaf, uint32_t subleaf) {
+    uint32_t cpu;
+    if (cpu_obj == Py_None) {
+        if (self->snapshot.n_records == 0) return NULL;
+        cpu = self->snapshot.records[0].cpu;
+    } else {
+        cpu = (uint32_t)PyLong_AsUnsignedLong(cpu_obj);
+        if (PyErr_Occurred()) return NULL;
+    }
+    const cpuid_record *r = cpuid_snapshot_find(&self->snapshot, cpu, leaf, subleaf);
+    // los registros de CPU en las que no se pudo fijar el hilo no son datos reales
+    if (r != NULL && r->status != CPUID_RECORD_OK) return NULL;
+    return r;
+}
+
+// como lookup pero la ausencia de la hoja es un KeyError
+static const cpuid_record *Method_Snapshot_Class(require)(Snapshot *self, PyObject *cpu_obj, uint32_t leaf) {
+    const cpuid_record *r = Method_Snapshot_Class(lookup)(self, cpu_obj, leaf, 0);
+    if (r == NULL && !PyErr_Occurred()) {
+        PyErr_Format(PyExc_KeyError, "la hoja 0x%x no esta en el snapshot para esa CPU", leaf);
+    }
+    return r;
+}
+
+static PyObject* Method_Snapshot_Class(find)(Snapshot *self, PyObject *args, PyObject *kwds) {
+    static char *kwlist[] = {"leaf", "subleaf", "cpu", NULL};
+    unsigned long leaf, subleaf = 0;
+    PyObject *cpu_obj = Py_None;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "k|kO", kwlist, &leaf, &subleaf, &cpu_obj)) return NULL;
+
+    const cpuid_record *r = Method_Snapshot_Class(lookup)(self, cpu_obj, (uint32_t)leaf, (uint32_t)subleaf);
+    if (r == NULL) {
+        if (PyErr_Occurred()) return NULL;
+        Py_RETURN_NONE;
+    }
+    return Py_BuildValue("(IIII)", r->eax, r->ebx, r->ecx, r->edx);
+}
+
+static PyObject* Method_Snapshot_Class(vendor)(Snapshot *self, PyObject *args, PyObject *kwds) {
+    static char *kwlist[] = {"cpu", NULL};
+    PyObject *cpu_obj = Py_None;
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|O", kwlist, &cpu_obj)) return NULL;
+
+    const cpuid_record *r = Method_Snapshot_Class(require)(self, cpu_obj, CPUID_GETVENDORSTRING);
+    if (r == NULL) return NULL;
+
+    // EBX, EDX, ECX en ese orden
+    char vendor[12];
+    memcpy(vendor,     &r->ebx, 4);
+    memcpy(vendor + 4, &r->edx, 4);
+    memcpy(vendor + 8, &r->ecx, 4);
+    return PyUnicode_DecodeLatin1(vendor, sizeof(vendor), NULL);
+}
+
+static PyObject* Method_Snapshot_Class(processor_info)(Snapshot *self, PyObject *args, PyObject *kwds) {
+    static char *kwlist[] = {"cpu", NULL};
+    PyObject *cpu_obj = Py_None;
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|O", kwlist, &cpu_obj)) return NULL;
+
+    const cpuid_record *r = Method_Snapshot_Class(require)(self, cpu_obj, CPUID_GETFEATURES);
+    if (r == NULL) return NULL;
+    cpuid_module_state *state = Class_state_from_type(Py_TYPE(self));
+    if (state == NULL) return NULL;
+    return PyObject_CallFunction((PyObject *)state->Processor_Info_type, "IIII",
+        r->eax, r->ebx, r->ecx, r->edx);
+}
+
+static PyObject* Method_Snapshot_Class(features)(Snapshot *self, PyObject *args, PyObject *kwds) {
+    static char *kwlist[] = {"cpu", NULL};
+    PyObject *cpu_obj = Py_None;
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|O", kwlist, &cpu_obj)) return NULL;
+
+    const cpuid_record *r = Method_Snapshot_Class(require)(self, cpu_obj, CPUID_GETFEATURES);
+    if (r == NULL) return NULL;
+    cpuid_module_state *state = Class_state_from_type(Py_TYPE(self));
+    if (state == NULL) return NULL;
+    return Method_Information_Feature_Bits_Class(from_registers)(state->Information_Feature_Bits_type, r->ecx, r->edx);
+}
+
+static PyObject* Method_Snapshot_Class(get_cpus)(Snapshot *self, void *closure) {
+    PyObject *cpus = PyTuple_New((Py_ssize_t)self->snapshot.n_cpus);
+    if (cpus == NULL) return NULL;
+    for (size_t row = 0; row < self->snapshot.n_cpus; row++) {
+        PyObject *cpu = PyLong_FromUnsignedLong(self->snapshot.records[row * self->snapshot.n_leaves].cpu);
+        if (cpu == NULL) {
+            Py_DECREF(cpus);
+            return NULL;
+        }
+        PyTuple_SET_ITEM(cpus, (Py_ssize_t)row, cpu);
+    }
+    return cpus;
+}
+
+static PyObject* Method_Snapshot_Class(get_leaves)(Snapshot *self, void *closure) {
+    // todas las CPU tienen las mismas hojas, se toman de la primera fila
+    size_t n_leaves = self->snapshot.n_cpus ? self->snapshot.n_leaves : 0;
+    PyObject *leaves = PyTuple_New((Py_ssize_t)n_leaves);
+    if (leaves == NULL) return NULL;
+    for (size_t j = 0; j < n_leaves; j++) {
+        const cpuid_record *r = &self->snapshot.records[j];
+        PyObject *leaf = Py_BuildValue("(II)", r->leaf, r->subleaf);
+        if (leaf == NULL) {
+            Py_DECREF(leaves);
+            return NULL;
+        }
+        PyTuple_SET_ITEM(leaves, (Py_ssize_t)j, leaf);
+    }
+    return leaves;
+}
+
+static PyObject* Method_Snapshot_Class(repr)(Snapshot *self) {
+    return PyUnicode_FromFormat("Snapshot(cpus=%zu, leaves=%zu)", self->snapshot.n_cpus, self->snapshot.n_leaves);
+}
+
+static void Method_Snapshot_Class(dealloc)(Snapshot *self) {
+    PyTypeObject *type = Py_TYPE(self);
+    cpuid_snapshot_free(&self->snapshot);
+    type->tp_free((PyObject *)self);
+    Py_DECREF(type);
+}
+
+#endif
@@ -0,0 +1,88 @@
+#include "Class.h"
+#ifndef __CLASS_SNAPSHOT_H__
+#define __CLASS_SNAPSHOT_H__
+
+#include <stdint.h>
+#include "../../cpuid_snapshot.h"
+#include "Processor_Info.h"
+#include "Information_Feature_Bits.h"
+
+/*
+ * Snapshot: tabla de registros de CPUID de varias CPU expuesta con el buffer protocol.
+ *
+ * La tabla es la de cpuid_snapshot.h (n filas de 8 uint32: cpu, hoja, subhoja, eax, ebx,
+ * ecx, edx, estado) y se exporta como un buffer de solo lectura de formato "I" y forma (n, 8),
+ * asi memoryview(s) o numpy.asarray(s) acceden a miles de registros sin crear un objeto por
+ * registro. Los metodos de decodificacion (find, processor_info, features, vendor) solo
+ * crean objetos de Python para los registros que se consultan.
+ */
+#define Method_Snapshot_Class(name) Snapshot_ ## name
+
+typedef struct {
+    PyObject_HEAD
+    cpuid_snapshot snapshot;   // no cambia despues de __new__
+    Py_ssize_t     shape[2];
+    Py_ssize_t     strides[2];
+} Snapshot;
+
+PyDoc_STRVAR(Method_Snapshot_Class(doc),
+    "Snapshot(cpus=None, leaves=None, threads=0)\n\n"
+    "Ejecuta CPUID en cada CPU de cpus (por defecto todas las del mask de afinidad) con\n"
+    "las hojas de leaves (enteros o tuplas (hoja, subhoja); por defecto todas las hojas\n"
+    "y subhojas validas de la CPU). El barrido se hace con el GIL liberado.\n"
+    "El objeto es inmutable, se puede compartir entre hilos sin locks.\n\n"
+    "El objeto soporta el buffer protocol: memoryview(s) es una tabla de solo lectura de\n"
+    "uint32 con forma (len(s), 8) y columnas cpu, hoja, subhoja, eax, ebx, ecx, edx, estado.");
+
+// Metodos Inprescindibles y porpias de Python
+static PyTypeObject *Method_Snapshot_Class(create_type) (PyObject *module);
+static PyObject*  Method_Snapshot_Class(new)              (PyTypeObject *type, PyObject *args, PyObject *kwds);
+static void       Method_Snapshot_Class(dealloc)          (Snapshot *self);
+static PyObject*  Method_Snapshot_Class(repr)             (Snapshot *self);
+static Py_ssize_t Method_Snapshot_Class(length)           (Snapshot *self);
+static PyObject*  Method_Snapshot_Class(item)             (Snapshot *self, Py_ssize_t index);
+static int        Method_Snapshot_Class(getbuffer)        (Snapshot *self, Py_buffer *view, int flags);
+
+// Conversion de argumentos compartida con cpuid_x86.collect. Reservan con PyMem_RawMalloc.
+static int Method_Snapshot_Class(parse_leaves)(PyObject *obj, cpuid_leaf_request **leaves, size_t *n_leaves);
+static int Method_Snapshot_Class(parse_cpus)  (PyObject *obj, uint32_t **cpus, size_t *n_cpus);
+
+// metodos getter
+static PyObject* Method_Snapshot_Class(get_cpus)     (Snapshot *self, void *closure);
+static PyObject* Method_Snapshot_Class(get_leaves)   (Snapshot *self, void *closure);
+
+// Metodos propios
+static PyObject* Method_Snapshot_Class(find)          (Snapshot *self, PyObject *args, PyObject *kwds);
+static PyObject* Method_Snapshot_Class(vendor)        (Snapshot *self, PyObject *args, PyObject *kwds);
+static PyObject* Method_Snapshot_Class(processor_info)(Snapshot *self, PyObject *args, PyObject *kwds);
+static PyObject* Method_Snapshot_Class(features)      (Snapshot *self, PyObject *args, PyObject *kwds);
+
+static PyMethodDef Method_Snapshot_Class(methods)[] = {
+    {
+        "find", (PyCFunction)(void(*)(void))Method_Snapshot_Class(find), METH_VARARGS | METH_KEYWORDS,
+        "find(leaf, subleaf=0, cpu=None) -> (eax, ebx, ecx, edx) o None\n"
+        "Registros de una hoja en una CPU (por defecto la primera del snapshot)."
+    },
+    {
+        "vendor", (PyCFunction)(void(*)(void))Method_Snapshot_Class(vendor), METH_VARARGS | METH_KEYWORDS,
+        "vendor(cpu=None) -> str\nCadena de fabricante de CPUID EAX=0."
+    },
+    {
+        "processor_info", (PyCFunction)(void(*)(void))Method_Snapshot_Class(processor_info), METH_VARARGS | METH_KEYWORDS,
+        "processor_info(cpu=None) -> Processor_Info_and_Feature_Bits\nDecodifica CPUID EAX=1 de una CPU."
+    },
+    {
+        "features", (PyCFunction)(void(*)(void))Method_Snapshot_Class(features), METH_VARARGS | METH_KEYWORDS,
+        "features(cpu=None) -> Information_Feature_Bits\nBits de caracteristicas de CPUID EAX=1 de una CPU."
+    },
+    {NULL}  // Sentinel
+};
+
+static PyGetSetDef Method_Snapshot_Class(getsetters)[] = {
+    {"cpus",   (getter)Method_Snapshot_Class(get_cpus),   NULL, "Tupla con las CPU del snapshot", NULL},
+    {"leaves", (getter)Method_Snapshot_Class(get_leaves), NULL, "Tupla de (hoja, subhoja) consultadas en cada CPU", NULL},
+    {NULL}  // Sentinel
+};
+
+#include "Snapshot.c"
+#endif
@@ -16,14 +16,20 @@ Incluido <stdio.h>, <string.h>, <errno.h>, y <stdlib.h>
 #else
 #error "cpuid.c ya se encuentra incluido"
 #endif
+// lo mismo para cpuid_sink.c, que cpuid.h incluye y tambien va en cpuid.o
+#ifndef __CPUID_SINK_C__
+#define __CPUID_SINK_C__
+#endif
 #include "../cpuid.h"
+#include "../cpuid_percpu.h"
 
 // Clases del modulo
 #include "Class/Cpuid.h"
 #include "Class/Register.h"
-
-FILE *fp;
-static PyObject *StringTooShortError = NULL;
+#include "Class/Processor_Info.h"
+#include "Class/Additional_Information.h"
+#include "Class/Information_Feature_Bits.h"
+#include "Class/Snapshot.h"
 
 static PyObject *method_fputs(PyObject *self, PyObject *args) {
     /*
@@ -52,6 +58,71 @@ static PyObject *method_fputs(PyObject *self, PyObject *args) {
     return PyLong_FromLong(bytes_copied);
 }
 
+static PyObject *method_collect(PyObject *self, PyObject *args, PyObject *kwds) {
+    static char *kwlist[] = {"leaves", "cpus", "threads", NULL};
+    PyObject *leaves_obj, *cpus_obj = Py_None;
+    unsigned int n_threads = 0;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|OI", kwlist, &leaves_obj, &cpus_obj, &n_threads)) {
+        return NULL;
+    }
+
+    cpuid_leaf_request *leaves = NULL;
+    uint32_t           *cpus   = NULL;
+    cpuid_record       *out    = NULL;
+    PyObject           *result = NULL;
+    size_t              n_leaves, n_cpus;
+
+    if (Method_Snapshot_Class(parse_leaves)(leaves_obj, &leaves, &n_leaves) < 0) return NULL;
+
+    if (cpus_obj == Py_None) {
+        // todas las CPU del mask de afinidad del proceso
+        n_cpus = cpuid_affinity_cpus(NULL, 0);
+        if (n_cpus == 0) {
+            PyErr_SetString(PyExc_OSError, "no se pudo obtener el mask de afinidad del proceso");
+            goto done;
+        }
+        cpus = PyMem_RawMalloc(sizeof(*cpus) * n_cpus);
+        if (cpus == NULL) { PyErr_NoMemory(); goto done; }
+        // el mask pudo cambiar entre las dos llamadas
+        size_t total = cpuid_affinity_cpus(cpus, n_cpus);
+        if (total < n_cpus) n_cpus = total;
+    } else if (Method_Snapshot_Class(parse_cpus)(cpus_obj, &cpus, &n_cpus) < 0) {
+        goto done;
+    }
+
+    out = PyMem_RawMalloc(sizeof(*out) * (n_cpus * n_leaves + 1));
+    if (out == NULL) { PyErr_NoMemory(); goto done; }
+
+    // los hilos de trabajo no tocan objetos de Python, el GIL se libera durante todo el barrido
+    int pinned;
+    Py_BEGIN_ALLOW_THREADS
+    pinned = cpuid_collect(leaves, n_leaves, cpus, n_cpus, out, n_threads);
+    Py_END_ALLOW_THREADS
+    if (pinned < 0) {
+        PyErr_SetString(PyExc_OSError, "no se pudieron crear los hilos de cpuid_collect");
+        goto done;
+    }
+
+    debug_print_cpuid("collect: %zu CPU, %zu hojas, %d CPU fijadas\n", n_cpus, n_leaves, pinned);
+
+    result = PyList_New((Py_ssize_t)(n_cpus * n_leaves));
+    if (result == NULL) goto done;
+    for (size_t i = 0; i < n_cpus * n_leaves; i++) {
+        PyObject *record = Py_BuildValue("(IIIIIIII)",
+            out[i].cpu, out[i].leaf, out[i].subleaf,
+            out[i].eax, out[i].ebx, out[i].ecx, out[i].edx, out[i].status);
+        if (record == NULL) { Py_CLEAR(result); goto done; }
+        PyList_SET_ITEM(result, (Py_ssize_t)i, record);
+    }
+
+done:
+    PyMem_RawFree(out);
+    PyMem_RawFree(cpus);
+    PyMem_RawFree(leaves);
+    return result;
+}
+
 /*
  * No usamos simplemente un const char* normal para la cadena de documentación 
  * porque CPython se puede compilar para que no incluya cadenas de documentación. 
@@ -61,6 +132,16 @@ static PyObject *method_fputs(PyObject *self, PyObject *args) {
  */
 PyDoc_STRVAR(cpuid_doc, "Func CPUID");
 PyDoc_STRVAR(cpuid_module_doc, "Modulo CPUID");
+PyDoc_STRVAR(collect_doc,
+"collect(leaves, cpus=None, threads=0)\n"
+"--\n\n"
+"Ejecuta CPUID con cada hoja de leaves (enteros o tuplas (hoja, subhoja)) en cada CPU\n"
+"de cpus (por defecto todas las del mask de afinidad del proceso).\n"
+"El barrido lo hacen hilos nativos fijados en cada CPU con el GIL liberado.\n"
+"threads=0 usa hasta 32 hilos.\n\n"
+"Devuelve una lista de tuplas (cpu, hoja, subhoja, eax, ebx, ecx, edx, estado),\n"
+"agrupadas por CPU en el orden de cpus. estado es CPUID_RECORD_OK, o\n"
+"CPUID_RECORD_NOT_PINNED si no se pudo fijar el hilo en esa CPU (registros a 0).");
 
 /*
  * Funciones del modulo con sus metadatos
@@ -72,75 +153,59 @@ static PyMethodDef cpuid_native_methods[] = {
         METH_VARARGS, 
         cpuid_doc
     },
+    {
+        "collect",
+        (PyCFunction)(void(*)(void))method_collect,
+        METH_VARARGS | METH_KEYWORDS,
+        collect_doc
+    },
     {NULL, NULL, 0, NULL}
 };
 
 /*
- *
- * Metadatos del modulo
- * 
+ * Crea las clases del modulo (heap types) y las guarda en el estado del modulo.
  */
-static struct PyModuleDef cpuid_native = {
-    PyModuleDef_HEAD_INIT,
-    "cpuid",
-    cpuid_module_doc,
-    -1,
-    cpuid_native_methods,
-    NULL,
-    NULL,
-    NULL,
-    NULL
-};
+static int cpuid_module_add_type(PyObject *module, PyTypeObject **slot, PyTypeObject *type, const char *name) {
+    if (type == NULL) {
+        debug_print_cpuid("No se pudo crear la clase %s\n", name);
+        return -1;
+    }
+    *slot = type;  // el estado se queda con la referencia nueva
+    return PyModule_AddObjectRef(module, name, (PyObject *)type);
+}
 
 /*
  *
- * Funcion inicializadora del modulo:
- * Una vez que definimos nuestra función y nuestro módulo, debemos indicarle a CPython cómo importar nuestro módulo. 
- * Para ello, debemos definir una única función con el tipo PyMODINIT_FUNC denominada PyInit_{name}, donde name es el 
- * nombre de nuestro módulo.
- * Esta función se ejecutará la primera vez que alguien escriba import fib.fib from python. Esto 
- * se puede considerar como el código que se ejecuta en el "ámbito del módulo" en un archivo Python normal. 
- * Al final de nuestra función, debemos devolver el módulo recién creado. Para crear un PyObject* a 
- * partir de un PyModule_Def, podemos usar PyModule_Create().
- * 
+ * Funcion de ejecucion del modulo (multi-phase init, PEP 489):
+ * Con multi-phase init, PyInit_cpuid_x86 ya no crea el modulo, solo devuelve su definicion.
+ * CPython crea un objeto modulo por cada interprete que lo importa (con su propio estado de
+ * tamaño sizeof(cpuid_module_state)) y luego llama a esta funcion para rellenarlo. Asi cada
+ * subinterprete tiene sus propias clases y excepciones y ningun objeto de Python se comparte
+ * entre interpretes.
+ *
  */
-PyMODINIT_FUNC PyInit_cpuid_x86(void) {
-    _ACTIVATE_COLORS_ANSI_WIN__();
+static int cpuid_module_exec(PyObject *module) {
+    cpuid_module_state *state = Class_module_state(module);
 
-    // Clase Cpuid
-    Method_Cpuid_Class(init_type_object)();
-    if (PyType_Ready(&Method_Cpuid_Class(type_Class)) < 0) {
-        debug_print_cpuid("PyType_Ready Cpuid Class failed\n");
-        return NULL;
-    }
-    
-    // Clase Registro
-    Method_Register_Class(init_type_object)();
-    if (PyType_Ready(&Method_Register_Class(type_Class)) < 0) {
-        debug_print_cpuid("PyType_Ready Register Class failed\n");
-        return NULL;
-    }
-
-
-    /* Assign module value */
-    PyObject *module = PyModule_Create(&cpuid_native);
-    if (module == NULL) return NULL;
+    _ACTIVATE_COLORS_ANSI_WIN__();
 
-    // Clase Cpuid
-    Py_INCREF(&Method_Cpuid_Class(type_Class));
-    if (PyModule_AddObject(module, "Cpuid", (PyObject *) &Method_Cpuid_Class(type_Class)) < 0) {
-        Py_DECREF(&Method_Cpuid_Class(type_Class));
-        Py_DECREF(module);
-        return NULL;
-    }
-    // Clase registro
-    Py_INCREF(&Method_Register_Class(type_Class));
-    if (PyModule_AddObject(module, "Register", (PyObject *) &Method_Register_Class(type_Class)) < 0) {
-        Py_DECREF(&Method_Register_Class(type_Class));
-        Py_DECREF(module);
-        return NULL;
-    }
+    if (cpuid_module_add_type(module, &state->Cpuid_type,
+            Method_Cpuid_Class(create_type)(module), "Cpuid") < 0) return -1;
+    if (cpuid_module_add_type(module, &state->Register_type,
+            Method_Register_Class(create_type)(module), "Register") < 0) return -1;
+    // Clases de CPUID EAX=1 (antes en cpuid_0x1.py)
+    if (cpuid_module_add_type(module, &state->Additional_Information_type,
+            Method_Additional_Information_Class(create_type)(module), "Additional_Information_Feature_Bits") < 0) return -1;
+    if (cpuid_module_add_type(module, &state->Information_Feature_Bits_type,
+            Method_Information_Feature_Bits_Class(create_type)(module), "Information_Feature_Bits") < 0) return -1;
+    if (cpuid_module_add_type(module, &state->Processor_Info_type,
+            Method_Processor_Info_Class(create_type)(module), "Processor_Info_and_Feature_Bits") < 0) return -1;
+    if (cpuid_module_add_type(module, &state->Snapshot_type,
+            Method_Snapshot_Class(create_type)(module), "Snapshot") < 0) return -1;
 
+    state->StringTooShortError = PyErr_NewException("cpuid_x86.StringTooShortError", NULL, NULL);
+    if (state->StringTooShortError == NULL) return -1;
+    if (PyModule_AddObjectRef(module, "StringTooShortError", state->StringTooShortError) < 0) return -1;
 
     /* Add int constant by name */
     //PyModule_AddIntConstant(module, "FPUTS_FLAG", 64);
@@ -260,6 +325,10 @@ PyMODINIT_FUNC PyInit_cpuid_x86(void) {
     PyModule_AddIntMacro(module, CPUID_VENDOR_UNISYS_S_PAR);
     PyModule_AddIntMacro(module, CPUID_VENDOR_LOCKHEED_MARTIN_LMHS);
 
+    // estados de los registros de collect
+    PyModule_AddIntMacro(module, CPUID_RECORD_OK);
+    PyModule_AddIntMacro(module, CPUID_RECORD_NOT_PINNED);
+
     // Processor Type values:
     PyModule_AddIntMacro(module, OEM_Processor);
     PyModule_AddIntMacro(module, Intel_Overdrive_Processor);
@@ -296,5 +365,82 @@ PyMODINIT_FUNC PyInit_cpuid_x86(void) {
     PyModule_AddIntMacro(module, CPUID_INTEL_SIZE_CACHE_L2_L3);
     PyModule_AddIntMacro(module, CPUID_CACHE_HIERARCHY_AND_TOPOLOGY_AMD);
 
-    return module; // retornar el modulo creado.
+    return 0;
+}
+
+static int cpuid_module_traverse(PyObject *module, visitproc visit, void *arg) {
+    cpuid_module_state *state = Class_module_state(module);
+    Py_VISIT(state->Cpuid_type);
+    Py_VISIT(state->Register_type);
+    Py_VISIT(state->Processor_Info_type);
+    Py_VISIT(state->Additional_Information_type);
+    Py_VISIT(state->Information_Feature_Bits_type);
+    Py_VISIT(state->Snapshot_type);
+    Py_VISIT(state->StringTooShortError);
+    return 0;
+}
+
+static int cpuid_module_clear(PyObject *module) {
+    cpuid_module_state *state = Class_module_state(module);
+    Py_CLEAR(state->Cpuid_type);
+    Py_CLEAR(state->Register_type);
+    Py_CLEAR(state->Processor_Info_type);
+    Py_CLEAR(state->Additional_Information_type);
+    Py_CLEAR(state->Information_Feature_Bits_type);
+    Py_CLEAR(state->Snapshot_type);
+    Py_CLEAR(state->StringTooShortError);
+    return 0;
+}
+
+static void cpuid_module_free(void *module) {
+    cpuid_module_clear((PyObject *)module);
+}
+
+/*
+ * Py_mod_multiple_interpreters (3.12+): el modulo no tiene estado global de Python, se puede
+ * importar en subinterpretes con GIL propio.
+ * Py_mod_gil (3.13+): el modulo no necesita el GIL en CPython sin GIL (3.13t). El estado
+ * compartido entre hilos es la tabla de atributos de Information_Feature_Bits (construida una
+ * vez con atomicos) y las instancias que se modifican usan secciones criticas por objeto.
+ */
+static PyModuleDef_Slot cpuid_native_slots[] = {
+    {Py_mod_exec, cpuid_module_exec},
+#ifdef Py_mod_multiple_interpreters
+    {Py_mod_multiple_interpreters, Py_MOD_PER_INTERPRETER_GIL_SUPPORTED},
+#endif
+#ifdef Py_mod_gil
+    {Py_mod_gil, Py_MOD_GIL_NOT_USED},
+#endif
+    {0, NULL}
+};
+
+/*
+ *
+ * Metadatos del modulo
+ * 
+ */
+static struct PyModuleDef cpuid_native = {
+    PyModuleDef_HEAD_INIT,
+    .m_name     = "cpuid_x86",
+    .m_doc      = cpuid_module_doc,
+    .m_size     = sizeof(cpuid_module_state),
+    .m_methods  = cpuid_native_methods,
+    .m_slots    = cpuid_native_slots,
+    .m_traverse = cpuid_module_traverse,
+    .m_clear    = cpuid_module_clear,
+    .m_free     = cpuid_module_free,
+};
+
+/*
+ *
+ * Funcion inicializadora del modulo:
+ * Una vez que definimos nuestra función y nuestro módulo, debemos indicarle a CPython cómo importar nuestro módulo. 
+ * Para ello, debemos definir una única función con el tipo PyMODINIT_FUNC denominada PyInit_{name}, donde name es el 
+ * nombre de nuestro módulo.
+ * Con multi-phase init esta función solo devuelve la definición del módulo (PyModuleDef_Init); CPython crea el
+ * módulo y ejecuta cpuid_module_exec en cada intérprete que lo importe.
+ * 
+ */
+PyMODINIT_FUNC PyInit_cpuid_x86(void) {
+    return PyModuleDef_Init(&cpuid_native);
 }
\ No newline at end of file
@@ -0,0 +1,230 @@
+#ifndef __CPUID_REVALIDATE_C__
+#define __CPUID_REVALIDATE_C__
+
+#include "cpuid_revalidate.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <errno.h>
+    #include <pthread.h>
+    #include <time.h>
+#endif
+
+static const CPUID_H(leaf_request) cpuid_fingerprint_leaves[CPUID_FINGERPRINT_LEAVES] = {
+    { 0x00000001, 0 }, { 0x00000007, 0 }, { 0x00000007, 1 },    // CPUID_CHANGE_FEATURES
+    { 0x00000015, 0 }, { 0x00000016, 0 },                       // CPUID_CHANGE_FREQUENCY
+    { 0x40000000, 0 }, { 0x40000010, 0 },                       // CPUID_CHANGE_HYPERVISOR
+};
+
+// primer registro de cada grupo de cpuid_fingerprint_leaves
+#define CPUID_FINGERPRINT_FREQUENCY  3
+#define CPUID_FINGERPRINT_HYPERVISOR 5
+
+void cpuid_fingerprint_take(CPUID_H(fingerprint) *fingerprint) {
+    uint32_t max_basic, max_hypervisor = 0, eax, ebx, ecx, edx;
+    uint64_t hash = 14695981039346656037ull;
+
+    call_cpuid(0, 0, &max_basic, &ebx, &ecx, &edx);
+    call_cpuid(1, 0, &eax, &ebx, &ecx, &edx);
+    if ((ecx >> 31) & 1) call_cpuid(0x40000000, 0, &max_hypervisor, &ebx, &ecx, &edx);
+
+    for (size_t i = 0; i < CPUID_FINGERPRINT_LEAVES; i++) {
+        CPUID_H(record) *r = &fingerprint->records[i];
+        memset(r, 0, sizeof(*r));
+        r->leaf    = cpuid_fingerprint_leaves[i].leaf;
+        r->subleaf = cpuid_fingerprint_leaves[i].subleaf;
+        if (r->leaf < 0x40000000 ? r->leaf <= max_basic : r->leaf <= max_hypervisor) {
+            call_cpuid(r->leaf, r->subleaf, &r->eax, &r->ebx, &r->ecx, &r->edx);
+        }
+        // el APIC ID inicial depende de la CPU en la que se ejecute
+        if (r->leaf == 1) r->ebx &= 0x00ffffff;
+
+        const unsigned char *bytes = (const unsigned char*)&r->eax;
+        for (size_t b = 0; b < 4 * sizeof(uint32_t); b++) {
+            hash = (hash ^ bytes[b]) * 1099511628211ull;
+        }
+    }
+    fingerprint->hash = hash;
+}
+
+void cpuid_revalidate_init(CPUID_H(revalidator) *rv) {
+    memset(rv, 0, sizeof(*rv));
+    rv->tolerance_ppm = CPUID_REVALIDATE_TSC_PPM;
+    cpuid_fingerprint_take(&rv->fingerprint);
+    cpuid_tsc_sample(&rv->tsc_start, &rv->ns_start);
+}
+
+int cpuid_revalidate_subscribe(CPUID_H(revalidator) *rv, CPUID_H(revalidate_callback) callback, void *context) {
+    if (rv->n_subscribers == CPUID_REVALIDATE_MAX_SUBSCRIBERS) return -1;
+    rv->subscribers[rv->n_subscribers].callback = callback;
+    rv->subscribers[rv->n_subscribers].context  = context;
+    rv->n_subscribers++;
+    return 0;
+}
+
+void cpuid_revalidate_unsubscribe(CPUID_H(revalidator) *rv, CPUID_H(revalidate_callback) callback, void *context) {
+    for (size_t i = 0; i < rv->n_subscribers; i++) {
+        if (rv->subscribers[i].callback != callback || rv->subscribers[i].context != context) continue;
+        memmove(&rv->subscribers[i], &rv->subscribers[i + 1], sizeof(rv->subscribers[0]) * (rv->n_subscribers - i - 1));
+        rv->n_subscribers--;
+        return;
+    }
+}
+
+static uint32_t cpuid_fingerprint_changes(const CPUID_H(fingerprint) *a, const CPUID_H(fingerprint) *b) {
+    uint32_t changes = 0;
+    for (size_t i = 0; i < CPUID_FINGERPRINT_LEAVES; i++) {
+        if (memcmp(&a->records[i].eax, &b->records[i].eax, 4 * sizeof(uint32_t)) == 0) continue;
+        if      (i >= CPUID_FINGERPRINT_HYPERVISOR) changes |= CPUID_CHANGE_HYPERVISOR;
+        else if (i >= CPUID_FINGERPRINT_FREQUENCY)  changes |= CPUID_CHANGE_FREQUENCY;
+        else                                        changes |= CPUID_CHANGE_FEATURES;
+    }
+    return changes;
+}
+
+uint32_t cpuid_revalidate_check(CPUID_H(revalidator) *rv) {
+    CPUID_H(fingerprint) now;
+    uint64_t             tsc, ns;
+    uint32_t             changes = 0;
+    double               before  = rv->tsc_hz;
+
+    cpuid_fingerprint_take(&now);
+    cpuid_tsc_sample(&tsc, &ns);
+    if (now.hash != rv->fingerprint.hash) changes |= cpuid_fingerprint_changes(&rv->fingerprint, &now);
+
+    if (tsc < rv->tsc_start) {
+        // TSC hacia atras: otro host sin ajustar el desplazamiento; se vuelve a medir el ritmo
+        changes          |= CPUID_CHANGE_TSC_RATE;
+        rv->tsc_hz        = 0;
+        rv->tsc_start     = tsc;
+        rv->ns_start      = ns;
+    } else if (ns - rv->ns_start >= CPUID_REVALIDATE_MIN_WINDOW_NS) {
+        double hz   = (double)(tsc - rv->tsc_start) * 1e9 / (double)(ns - rv->ns_start);
+        double diff = hz > before ? hz - before : before - hz;
+        // la referencia solo cambia con un cambio de ritmo, para que no derive poco a poco
+        if (before != 0 && diff * 1e6 > before * rv->tolerance_ppm) changes |= CPUID_CHANGE_TSC_RATE;
+        if (before == 0 || (changes & CPUID_CHANGE_TSC_RATE)) rv->tsc_hz = hz;
+        rv->tsc_start = tsc;
+        rv->ns_start  = ns;
+    }
+
+    rv->checks++;
+    if (changes == 0) return 0;
+    rv->events++;
+
+    CPUID_H(revalidate_event) event = {
+        .changes       = changes,
+        .before        = &rv->fingerprint,
+        .after         = &now,
+        .tsc_hz_before = before,
+        .tsc_hz_after  = rv->tsc_hz,
+    };
+    for (size_t i = 0; i < rv->n_subscribers; i++) {
+        rv->subscribers[i].callback(rv->subscribers[i].context, &event);
+    }
+    rv->fingerprint = now;
+    return changes;
+}
+
+struct CPUID_H(revalidate_thread) {
+    CPUID_H(revalidator) *rv;
+    unsigned              interval_ms;
+#ifdef _WIN32
+    HANDLE                thread;
+    HANDLE                stop;
+#else
+    pthread_t             thread;
+    pthread_mutex_t       lock;
+    pthread_cond_t        wake;
+    int                   stop;
+#endif
+};
+
+#ifdef _WIN32
+static DWORD WINAPI cpuid_revalidate_worker(LPVOID arg) {
+    CPUID_H(revalidate_thread) *t = arg;
+    while (WaitForSingleObject(t->stop, t->interval_ms) == WAIT_TIMEOUT) cpuid_revalidate_check(t->rv);
+    return 0;
+}
+#else
+static void *cpuid_revalidate_worker(void *arg) {
+    CPUID_H(revalidate_thread) *t = arg;
+
+    pthread_mutex_lock(&t->lock);
+    while (!t->stop) {
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_sec  += t->interval_ms / 1000;
+        deadline.tv_nsec += (long)(t->interval_ms % 1000) * 1000000;
+        if (deadline.tv_nsec >= 1000000000) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000;
+        }
+        while (!t->stop && pthread_cond_timedwait(&t->wake, &t->lock, &deadline) != ETIMEDOUT) {}
+        if (t->stop) break;
+
+        pthread_mutex_unlock(&t->lock);
+        cpuid_revalidate_check(t->rv);
+        pthread_mutex_lock(&t->lock);
+    }
+    pthread_mutex_unlock(&t->lock);
+    return NULL;
+}
+#endif
+
+int cpuid_revalidate_start(CPUID_H(revalidator) *rv, unsigned interval_ms) {
+    CPUID_H(revalidate_thread) *t;
+
+    if (rv->thread != NULL) return -1;
+    t = calloc(1, sizeof(*t));
+    if (t == NULL) return -1;
+    t->rv          = rv;
+    t->interval_ms = interval_ms != 0 ? interval_ms : 1;
+#ifdef _WIN32
+    t->stop = CreateEvent(NULL, TRUE, FALSE, NULL);
+    if (t->stop != NULL) t->thread = CreateThread(NULL, 0, cpuid_revalidate_worker, t, 0, NULL);
+    if (t->thread == NULL) {
+        if (t->stop != NULL) CloseHandle(t->stop);
+        free(t);
+        return -1;
+    }
+#else
+    pthread_mutex_init(&t->lock, NULL);
+    pthread_cond_init(&t->wake, NULL);
+    if (pthread_create(&t->thread, NULL, cpuid_revalidate_worker, t) != 0) {
+        pthread_cond_destroy(&t->wake);
+        pthread_mutex_destroy(&t->lock);
+        free(t);
+        return -1;
+    }
+#endif
+    rv->thread = t;
+    return 0;
+}
+
+void cpuid_revalidate_stop(CPUID_H(revalidator) *rv) {
+    CPUID_H(revalidate_thread) *t = rv->thread;
+    if (t == NULL) return;
+#ifdef _WIN32
+    SetEvent(t->stop);
+    WaitForSingleObject(t->thread, INFINITE);
+    CloseHandle(t->thread);
+    CloseHandle(t->stop);
+#else
+    pthread_mutex_lock(&t->lock);
+    t->stop = 1;
+    pthread_cond_signal(&t->wake);
+    pthread_mutex_unlock(&t->lock);
+    pthread_join(t->thread, NULL);
+    pthread_cond_destroy(&t->wake);
+    pthread_mutex_destroy(&t->lock);
+#endif
+    free(t);
+    rv->thread = NULL;
+}
+
+#endif
@@ -0,0 +1,105 @@
+#ifndef __CPUID_REVALIDATE_H__
+#define __CPUID_REVALIDATE_H__
+
+/*
+ * Deteccion de migraciones en caliente de maquinas virtuales.
+ *
+ * Al migrar una VM a otro host pueden cambiar la frecuencia del TSC, las hojas del hipervisor
+ * y, a veces, las caracteristicas expuestas, y las tablas de despacho o los factores de ciclos
+ * a nanosegundos calculados al arrancar dejan de valer sin que nadie avise. El revalidador
+ * guarda una huella de unas pocas hojas y en cada comprobacion la vuelve a calcular:
+ *
+ *      1 (sin el APIC ID), 7.0, 7.1    caracteristicas
+ *      15h, 16h                        relacion TSC / reloj de cristal y frecuencias
+ *      40000000h, 40000010h            hipervisor y frecuencia del TSC segun el hipervisor
+ *
+ * Ademas mide el ritmo del TSC contra el reloj monotono del sistema entre dos comprobaciones
+ * (sin esperar: solo un RDTSC y una lectura del reloj por comprobacion) y lo compara con el
+ * de referencia. Si algo cambia se llama a todos los suscriptores con lo que cambio.
+ *
+ * Una comprobacion son 9 CPUID (dentro de una VM cada uno sale al hipervisor y cuesta unos
+ * pocos microsegundos) mas el hash: con una comprobacion por segundo el coste queda en el
+ * orden de 2e-5 de una CPU. revalidate -b lo mide en la maquina.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "cpuid_percpu.h"
+#include "cpuid_tsc.h"
+
+#define CPUID_FINGERPRINT_LEAVES          7
+#define CPUID_REVALIDATE_MAX_SUBSCRIBERS  16
+#define CPUID_REVALIDATE_TSC_PPM          2000        // tolerancia por defecto del ritmo del TSC
+#define CPUID_REVALIDATE_MIN_WINDOW_NS    50000000ull // ventana minima para medir el ritmo
+
+// lo que cambio, en CPUID_H(revalidate_event).changes
+typedef enum CPUID_H(revalidate_change) {
+    CPUID_CHANGE_FEATURES   = 1 << 0,   // hojas 1 y 7
+    CPUID_CHANGE_FREQUENCY  = 1 << 1,   // hojas 15h y 16h
+    CPUID_CHANGE_HYPERVISOR = 1 << 2,   // hojas 40000000h y 40000010h
+    CPUID_CHANGE_TSC_RATE   = 1 << 3,   // el ritmo medido del TSC (o el TSC fue hacia atras)
+} CPUID_H(revalidate_change);
+
+typedef struct CPUID_H(fingerprint) {
+    uint64_t        hash;                               // FNV-1a de los registros
+    CPUID_H(record) records[CPUID_FINGERPRINT_LEAVES];  // las hojas que no existen valen 0
+} CPUID_H(fingerprint);
+
+typedef struct CPUID_H(revalidate_event) {
+    uint32_t                    changes;        // CPUID_H(revalidate_change)
+    const CPUID_H(fingerprint) *before;
+    const CPUID_H(fingerprint) *after;
+    double                      tsc_hz_before;  // 0 si todavia no se habia medido
+    double                      tsc_hz_after;
+} CPUID_H(revalidate_event);
+
+typedef void (*CPUID_H(revalidate_callback))(void *context, const CPUID_H(revalidate_event) *event);
+
+typedef struct CPUID_H(revalidate_thread) CPUID_H(revalidate_thread);
+
+typedef struct CPUID_H(revalidator) {
+    CPUID_H(fingerprint) fingerprint;
+    uint64_t             tsc_start;         // inicio de la ventana de medida del TSC
+    uint64_t             ns_start;
+    double               tsc_hz;            // ritmo de referencia, 0 hasta la primera ventana
+    uint32_t             tolerance_ppm;
+    struct {
+        CPUID_H(revalidate_callback) callback;
+        void                        *context;
+    }                    subscribers[CPUID_REVALIDATE_MAX_SUBSCRIBERS];
+    size_t               n_subscribers;
+    uint64_t             checks;            // comprobaciones hechas
+    uint64_t             events;            // comprobaciones con cambios
+    CPUID_H(revalidate_thread) *thread;     // NULL sin cpuid_revalidate_start
+} CPUID_H(revalidator);
+
+// calcula la huella en la CPU actual
+void cpuid_fingerprint_take(CPUID_H(fingerprint) *fingerprint);
+
+// toma la huella inicial y empieza la primera ventana del TSC
+void cpuid_revalidate_init(CPUID_H(revalidator) *rv);
+
+/*
+ * Anade un suscriptor. Devuelve 0, o -1 si ya hay CPUID_REVALIDATE_MAX_SUBSCRIBERS.
+ * Los suscriptores no se deben cambiar con el hilo de cpuid_revalidate_start en marcha.
+ */
+int  cpuid_revalidate_subscribe(CPUID_H(revalidator) *rv, CPUID_H(revalidate_callback) callback, void *context);
+void cpuid_revalidate_unsubscribe(CPUID_H(revalidator) *rv, CPUID_H(revalidate_callback) callback, void *context);
+
+/*
+ * Una comprobacion: vuelve a calcular la huella y mide el ritmo del TSC si la ventana dura
+ * al menos CPUID_REVALIDATE_MIN_WINDOW_NS. Devuelve los cambios (0 si no hubo) despues de
+ * avisar a los suscriptores.
+ */
+uint32_t cpuid_revalidate_check(CPUID_H(revalidator) *rv);
+
+/*
+ * Comprueba cada interval_ms en un hilo propio hasta cpuid_revalidate_stop (los suscriptores
+ * se llaman desde ese hilo). Devuelve 0, o -1 si no se pudo crear el hilo.
+ */
+int  cpuid_revalidate_start(CPUID_H(revalidator) *rv, unsigned interval_ms);
+void cpuid_revalidate_stop(CPUID_H(revalidator) *rv);
+
+#include "cpuid_revalidate.c"
+#endif
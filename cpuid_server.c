@@ -0,0 +1,486 @@
+#ifndef __CPUID_SERVER_C__
+#define __CPUID_SERVER_C__
+
+#include "cpuid_server.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#define CPUID_SERVER_SOCKETS 1
+#endif
+
+#ifdef __linux__
+#include <sys/epoll.h>
+#define CPUID_SERVER_EPOLL 1
+#endif
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+#define CPUID_SERVER_IN_BUFFER    4096
+#define CPUID_SERVER_OUT_BUFFER   16384
+#define CPUID_SERVER_MAX_EVENTS   256
+#define CPUID_SERVER_ACCEPT_RETRY 100   // ms sin aceptar tras EMFILE/ENFILE si no se cierra nadie
+#define CPUID_SERVER_MAX_RESPONSE (sizeof(CPUID_H(server_response)) + sizeof(uint32_t) * CPUID_SERVER_CPUS_MAX)
+
+_Static_assert(sizeof(CPUID_H(server_request))  == 24, "el tamano de la peticion es parte del protocolo");
+_Static_assert(sizeof(CPUID_H(server_response)) == 16, "el tamano de la respuesta es parte del protocolo");
+_Static_assert(sizeof(CPUID_H(server_info)) + sizeof(CPUID_H(server_response)) <= CPUID_SERVER_MAX_RESPONSE,
+    "CPUID_SERVER_MAX_RESPONSE no cubre CPUID_SERVER_INFO");
+
+#ifdef CPUID_SERVER_EPOLL
+
+struct CPUID_H(server_client) {
+    int           fd;
+    uint32_t      events;       // los que hay pedidos a epoll
+    size_t        slot;         // posicion en server->clients
+    size_t        in_len;
+    size_t        out_begin, out_end;
+    unsigned char in[CPUID_SERVER_IN_BUFFER];
+    unsigned char out[CPUID_SERVER_OUT_BUFFER];
+};
+
+// lo decodificado del snapshot y el mapa de CPU a bloque para las consultas de hojas
+static int cpuid_server_index(CPUID_H(server) *server) {
+    const CPUID_H(snapshot) *s = &server->snapshot;
+    uint32_t max_cpu = 0;
+    for (size_t row = 0; row < s->n_cpus; row++) {
+        uint32_t cpu = s->records[row * s->n_leaves].cpu;
+        if (cpu > max_cpu) max_cpu = cpu;
+    }
+
+    uint32_t *rows = malloc(sizeof(*rows) * ((size_t)max_cpu + 1));
+    if (rows == NULL) return -1;
+    for (uint32_t cpu = 0; cpu <= max_cpu; cpu++) rows[cpu] = UINT32_MAX;
+    for (size_t row = 0; row < s->n_cpus; row++) rows[s->records[row * s->n_leaves].cpu] = (uint32_t)row;
+    free(server->rows);
+    server->rows   = rows;
+    server->n_rows = s->n_cpus != 0 ? max_cpu + 1 : 0;
+
+    CPUID_H(server_info) *info = &server->info;
+    cpuid_features_current(&info->features);
+    for (size_t row = 0; row < s->n_cpus; row++) {
+        CPUID_H(featureset) usable;
+        cpuid_features_usable(s->records + row * s->n_leaves, s->n_leaves, &usable);
+        for (size_t w = 0; w < CPUID_FEATURESET_WORDS; w++) info->features.bits[w] &= usable.bits[w];
+    }
+    if (s->n_cpus != 0) cpuid_host_info_decode(s->records, s->n_leaves, &info->info);
+    else                memset(&info->info, 0, sizeof(info->info));
+    info->generation++;
+    info->n_cpus   = (uint32_t)s->n_cpus;
+    info->n_leaves = (uint32_t)s->n_leaves;
+    info->level    = cpuid_march_level(&info->features);
+    return 0;
+}
+
+// busqueda binaria en el bloque de la CPU (ordenado por hoja y subhoja)
+static const CPUID_H(record) *cpuid_server_find(const CPUID_H(server) *server, uint32_t cpu, uint32_t leaf, uint32_t subleaf) {
+    if (cpu >= server->n_rows || server->rows[cpu] == UINT32_MAX) return NULL;
+    const CPUID_H(record) *block = server->snapshot.records + (size_t)server->rows[cpu] * server->snapshot.n_leaves;
+    uint64_t key = (uint64_t)leaf << 32 | subleaf;
+
+    size_t low = 0, high = server->snapshot.n_leaves;
+    while (low < high) {
+        size_t   mid   = low + (high - low) / 2;
+        uint64_t probe = (uint64_t)block[mid].leaf << 32 | block[mid].subleaf;
+        if      (probe < key) low  = mid + 1;
+        else if (probe > key) high = mid;
+        else                  return block[mid].status == CPUID_RECORD_OK ? &block[mid] : NULL;
+    }
+    return NULL;
+}
+
+// escribe la respuesta a una peticion en el buffer de salida (hay sitio para CPUID_SERVER_MAX_RESPONSE)
+static void cpuid_server_answer(CPUID_H(server) *server, CPUID_H(server_client) *client, const CPUID_H(server_request) *request) {
+    CPUID_H(server_response) response;
+    unsigned char           *data = client->out + client->out_end + sizeof(response);
+
+    response.version = CPUID_SERVER_VERSION;
+    response.op      = request->op;
+    response.id      = request->id;
+    response.status  = CPUID_SERVER_OK;
+    response.length  = 0;
+
+    if (request->version != CPUID_SERVER_VERSION) {
+        response.status = CPUID_SERVER_BAD_REQUEST;
+    } else switch (request->op) {
+        case CPUID_SERVER_PING:
+            break;
+        case CPUID_SERVER_INFO:
+            memcpy(data, &server->info, sizeof(server->info));
+            response.length = sizeof(server->info);
+            break;
+        case CPUID_SERVER_LEAF: {
+            const CPUID_H(record) *r = cpuid_server_find(server, request->args[0], request->args[1], request->args[2]);
+            if (r == NULL) {
+                response.status = CPUID_SERVER_NOT_FOUND;
+                break;
+            }
+            memcpy(data, r, sizeof(*r));
+            response.length = sizeof(*r);
+            break;
+        }
+        case CPUID_SERVER_CPUS: {
+            // las CPU del snapshot en orden, desde la primera >= args[0]
+            uint32_t n = 0;
+            for (uint32_t cpu = request->args[0]; cpu < server->n_rows && n < CPUID_SERVER_CPUS_MAX; cpu++) {
+                if (server->rows[cpu] == UINT32_MAX) continue;
+                memcpy(data + sizeof(cpu) * n++, &cpu, sizeof(cpu));
+            }
+            response.length = (uint32_t)(sizeof(uint32_t) * n);
+            break;
+        }
+        default:
+            response.status = CPUID_SERVER_BAD_REQUEST;
+            break;
+    }
+
+    memcpy(client->out + client->out_end, &response, sizeof(response));
+    client->out_end += sizeof(response) + response.length;
+    server->requests++;
+}
+
+// responde las peticiones completas mientras quepa la respuesta; devuelve cuantas
+static size_t cpuid_server_process(CPUID_H(server) *server, CPUID_H(server_client) *client) {
+    size_t done = 0, used = 0;
+
+    // las respuestas ya escritas se mueven al principio para dejar sitio detras
+    if (client->out_begin != 0) {
+        memmove(client->out, client->out + client->out_begin, client->out_end - client->out_begin);
+        client->out_end  -= client->out_begin;
+        client->out_begin = 0;
+    }
+    while (client->in_len - used >= sizeof(CPUID_H(server_request))
+        && sizeof(client->out) - client->out_end >= CPUID_SERVER_MAX_RESPONSE) {
+        CPUID_H(server_request) request;
+        memcpy(&request, client->in + used, sizeof(request));
+        cpuid_server_answer(server, client, &request);
+        used += sizeof(request);
+        done++;
+    }
+    if (used != 0) {
+        memmove(client->in, client->in + used, client->in_len - used);
+        client->in_len -= used;
+    }
+    return done;
+}
+
+// escribe lo que admita el socket; -1 si la conexion ya no sirve
+static int cpuid_server_drain(CPUID_H(server_client) *client) {
+    while (client->out_begin < client->out_end) {
+        ssize_t n = send(client->fd, client->out + client->out_begin, client->out_end - client->out_begin, MSG_NOSIGNAL);
+        if (n > 0) {
+            client->out_begin += (size_t)n;
+        } else if (n < 0 && errno == EINTR) {
+            continue;
+        } else {
+            return n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+        }
+    }
+    client->out_begin = client->out_end = 0;
+    return 0;
+}
+
+/*
+ * Sin descriptores libres accept4 falla con la conexion todavia en la cola, y como el socket de
+ * escucha es de nivel epoll lo volveria a dar enseguida: se deja de vigilar hasta que se cierre
+ * un cliente o pasen CPUID_SERVER_ACCEPT_RETRY ms.
+ */
+static void cpuid_server_listen(CPUID_H(server) *server, int on) {
+    if (server->accept_paused == !on) return;
+    struct epoll_event event = { .events = EPOLLIN, .data.ptr = NULL };
+    if (epoll_ctl(server->epoll_fd, on ? EPOLL_CTL_ADD : EPOLL_CTL_DEL, server->listen_fd, &event) == 0) {
+        server->accept_paused = !on;
+    }
+}
+
+static void cpuid_server_drop(CPUID_H(server) *server, CPUID_H(server_client) *client) {
+    epoll_ctl(server->epoll_fd, EPOLL_CTL_DEL, client->fd, NULL);
+    close(client->fd);
+    // el ultimo ocupa el hueco
+    CPUID_H(server_client) *last = server->clients[--server->n_clients];
+    server->clients[client->slot] = last;
+    last->slot = client->slot;
+    free(client);
+    cpuid_server_listen(server, 1);
+}
+
+static void cpuid_server_accept(CPUID_H(server) *server) {
+    for (;;) {
+        int fd = accept4(server->listen_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EMFILE || errno == ENFILE) cpuid_server_listen(server, 0);
+            return;     // EAGAIN: no hay mas; cualquier otro error se reintenta en el siguiente evento
+        }
+
+        CPUID_H(server_client) *client = NULL;
+        if (server->n_clients < CPUID_SERVER_MAX_CLIENTS) client = malloc(sizeof(*client));
+        if (client == NULL) {
+            close(fd);
+            continue;
+        }
+        client->fd     = fd;
+        client->events = EPOLLIN;
+        client->slot   = server->n_clients;
+        client->in_len = client->out_begin = client->out_end = 0;
+
+        struct epoll_event event = { .events = EPOLLIN, .data.ptr = client };
+        if (epoll_ctl(server->epoll_fd, EPOLL_CTL_ADD, fd, &event) != 0) {
+            close(fd);
+            free(client);
+            continue;
+        }
+        server->clients[server->n_clients++] = client;
+    }
+}
+
+static void cpuid_server_serve(CPUID_H(server) *server, CPUID_H(server_client) *client, uint32_t events) {
+    if (events & (EPOLLERR | EPOLLHUP)) {
+        cpuid_server_drop(server, client);
+        return;
+    }
+    if ((events & EPOLLIN) && client->in_len < sizeof(client->in)) {
+        ssize_t n = recv(client->fd, client->in + client->in_len, sizeof(client->in) - client->in_len, 0);
+        if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+            cpuid_server_drop(server, client);
+            return;
+        }
+        if (n > 0) client->in_len += (size_t)n;
+    }
+
+    // se responde y se escribe hasta que no queden peticiones o el socket no admita mas
+    for (;;) {
+        size_t answered = cpuid_server_process(server, client);
+        size_t pending  = client->out_end - client->out_begin;
+        if (cpuid_server_drain(client) != 0) {
+            cpuid_server_drop(server, client);
+            return;
+        }
+        if (answered == 0 || client->out_end - client->out_begin == pending) break;
+    }
+
+    // sin sitio en la entrada se deja de leer hasta que el cliente lea sus respuestas
+    uint32_t wanted = (client->in_len < sizeof(client->in) ? EPOLLIN : 0) | (client->out_end > client->out_begin ? EPOLLOUT : 0);
+    if (wanted != client->events) {
+        struct epoll_event event = { .events = wanted, .data.ptr = client };
+        epoll_ctl(server->epoll_fd, EPOLL_CTL_MOD, client->fd, &event);
+        client->events = wanted;
+    }
+}
+
+int cpuid_server_open(CPUID_H(server) *server, const char *path, CPUID_H(snapshot) *snapshot) {
+    struct sockaddr_un address;
+
+    memset(server, 0, sizeof(*server));
+    server->listen_fd = server->epoll_fd = -1;
+    if (strlen(path) >= sizeof(address.sun_path) || strlen(path) >= sizeof(server->path)) return -1;
+    strcpy(server->path, path);
+
+    server->snapshot = *snapshot;
+    memset(snapshot, 0, sizeof(*snapshot));
+    if (cpuid_server_index(server) != 0) goto fail;
+
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, path);
+    unlink(path);
+
+    server->listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (server->listen_fd < 0) goto fail;
+    if (bind(server->listen_fd, (struct sockaddr *)&address, sizeof(address)) != 0) goto fail;
+    // cualquier proceso del host (o de un contenedor con el socket montado) puede consultar
+    chmod(path, 0666);
+    if (listen(server->listen_fd, SOMAXCONN) != 0) goto fail;
+
+    server->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (server->epoll_fd < 0) goto fail;
+    struct epoll_event event = { .events = EPOLLIN, .data.ptr = NULL };
+    if (epoll_ctl(server->epoll_fd, EPOLL_CTL_ADD, server->listen_fd, &event) != 0) goto fail;
+    return 0;
+
+fail:
+    cpuid_server_close(server);
+    return -1;
+}
+
+void cpuid_server_replace(CPUID_H(server) *server, CPUID_H(snapshot) *snapshot) {
+    CPUID_H(snapshot) old = server->snapshot;
+    server->snapshot = *snapshot;
+    memset(snapshot, 0, sizeof(*snapshot));
+    if (cpuid_server_index(server) != 0) {
+        // sin memoria para el mapa nuevo: se sigue sirviendo el anterior
+        cpuid_snapshot_free(&server->snapshot);
+        server->snapshot = old;
+        cpuid_server_index(server);
+        return;
+    }
+    cpuid_snapshot_free(&old);
+}
+
+int cpuid_server_run(CPUID_H(server) *server, int timeout_ms) {
+    struct epoll_event events[CPUID_SERVER_MAX_EVENTS];
+
+    if (server->accept_paused && (timeout_ms < 0 || timeout_ms > CPUID_SERVER_ACCEPT_RETRY)) {
+        timeout_ms = CPUID_SERVER_ACCEPT_RETRY;
+    }
+    int n = epoll_wait(server->epoll_fd, events, CPUID_SERVER_MAX_EVENTS, timeout_ms);
+    if (n < 0) return errno == EINTR ? 0 : -1;
+    if (n == 0) cpuid_server_listen(server, 1);
+    for (int i = 0; i < n; i++) {
+        if (events[i].data.ptr == NULL) cpuid_server_accept(server);
+        else                            cpuid_server_serve(server, events[i].data.ptr, events[i].events);
+    }
+    return n;
+}
+
+void cpuid_server_close(CPUID_H(server) *server) {
+    while (server->n_clients != 0) cpuid_server_drop(server, server->clients[server->n_clients - 1]);
+    if (server->epoll_fd >= 0) close(server->epoll_fd);
+    if (server->listen_fd >= 0) {
+        close(server->listen_fd);
+        unlink(server->path);
+    }
+    free(server->rows);
+    cpuid_snapshot_free(&server->snapshot);
+    memset(server, 0, sizeof(*server));
+    server->listen_fd = server->epoll_fd = -1;
+}
+
+#else
+
+int cpuid_server_open(CPUID_H(server) *server, const char *path, CPUID_H(snapshot) *snapshot) {
+    (void)path; (void)snapshot;
+    memset(server, 0, sizeof(*server));
+    return -1;
+}
+
+void cpuid_server_replace(CPUID_H(server) *server, CPUID_H(snapshot) *snapshot) {
+    (void)server;
+    cpuid_snapshot_free(snapshot);
+}
+
+int cpuid_server_run(CPUID_H(server) *server, int timeout_ms) {
+    (void)server; (void)timeout_ms;
+    return -1;
+}
+
+void cpuid_server_close(CPUID_H(server) *server) {
+    memset(server, 0, sizeof(*server));
+}
+
+#endif
+
+#ifdef CPUID_SERVER_SOCKETS
+
+int cpuid_client_connect(CPUID_H(client) *client, const char *path) {
+    struct sockaddr_un address;
+
+    memset(client, 0, sizeof(*client));
+    client->fd = -1;
+    if (strlen(path) >= sizeof(address.sun_path)) return -1;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, path);
+
+    client->fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (client->fd < 0) return -1;
+    if (connect(client->fd, (struct sockaddr *)&address, sizeof(address)) != 0) {
+        cpuid_client_close(client);
+        return -1;
+    }
+    return 0;
+}
+
+void cpuid_client_close(CPUID_H(client) *client) {
+    if (client->fd >= 0) close(client->fd);
+    client->fd = -1;
+    client->out_len = client->in_begin = client->in_end = 0;
+}
+
+int cpuid_client_flush(CPUID_H(client) *client) {
+    size_t sent = 0;
+    while (sent < client->out_len) {
+        ssize_t n = send(client->fd, client->out + sent, client->out_len - sent, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return -1;
+        sent += (size_t)n;
+    }
+    client->out_len = 0;
+    return 0;
+}
+
+int cpuid_client_send(CPUID_H(client) *client, uint16_t op, uint32_t id, uint32_t arg0, uint32_t arg1, uint32_t arg2) {
+    CPUID_H(server_request) request = { CPUID_SERVER_VERSION, op, id, { arg0, arg1, arg2 }, 0 };
+    if (sizeof(client->out) - client->out_len < sizeof(request) && cpuid_client_flush(client) != 0) return -1;
+    memcpy(client->out + client->out_len, &request, sizeof(request));
+    client->out_len += sizeof(request);
+    return 0;
+}
+
+// asegura que hay al menos need bytes leidos en el buffer de entrada
+static int cpuid_client_fill(CPUID_H(client) *client, size_t need) {
+    if (client->in_end - client->in_begin >= need) return 0;
+    if (client->in_begin != 0) {
+        memmove(client->in, client->in + client->in_begin, client->in_end - client->in_begin);
+        client->in_end  -= client->in_begin;
+        client->in_begin = 0;
+    }
+    while (client->in_end < need) {
+        ssize_t n = recv(client->fd, client->in + client->in_end, sizeof(client->in) - client->in_end, 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return -1;
+        client->in_end += (size_t)n;
+    }
+    return 0;
+}
+
+int cpuid_client_recv(CPUID_H(client) *client, CPUID_H(server_response) *response, void *data, size_t cap) {
+    if (cpuid_client_fill(client, sizeof(*response)) != 0) return -1;
+    memcpy(response, client->in + client->in_begin, sizeof(*response));
+    client->in_begin += sizeof(*response);
+
+    // los datos de una respuesta nunca pasan de CPUID_SERVER_MAX_RESPONSE, caben en el buffer
+    if (response->length > sizeof(client->in) || cpuid_client_fill(client, response->length) != 0) return -1;
+    if (data != NULL) memcpy(data, client->in + client->in_begin, response->length < cap ? response->length : cap);
+    client->in_begin += response->length;
+    return 0;
+}
+
+#else
+
+int cpuid_client_connect(CPUID_H(client) *client, const char *path) {
+    (void)path;
+    memset(client, 0, sizeof(*client));
+    client->fd = -1;
+    return -1;
+}
+
+void cpuid_client_close(CPUID_H(client) *client) {
+    client->fd = -1;
+}
+
+int cpuid_client_send(CPUID_H(client) *client, uint16_t op, uint32_t id, uint32_t arg0, uint32_t arg1, uint32_t arg2) {
+    (void)client; (void)op; (void)id; (void)arg0; (void)arg1; (void)arg2;
+    return -1;
+}
+
+int cpuid_client_flush(CPUID_H(client) *client) {
+    (void)client;
+    return -1;
+}
+
+int cpuid_client_recv(CPUID_H(client) *client, CPUID_H(server_response) *response, void *data, size_t cap) {
+    (void)client; (void)response; (void)data; (void)cap;
+    return -1;
+}
+
+#endif
+
+#endif
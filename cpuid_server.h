@@ -0,0 +1,147 @@
+#ifndef __CPUID_SERVER_H__
+#define __CPUID_SERVER_H__
+
+/*
+ * Servicio local de CPUID por un socket Unix.
+ *
+ * Dentro de un contenedor con seccomp restrictivo, o con un hipervisor que enmascara CPUID de
+ * forma distinta segun la vCPU, lo que ve un proceso al ejecutar CPUID puede no ser la vista
+ * del host. El servidor tiene el snapshot de todas las CPU del host (y lo decodificado: las
+ * caracteristicas usables, CPUID_H(host_info) y el nivel de x86-64) y lo sirve a los clientes
+ * que se conectan al socket, que se puede montar en los contenedores.
+ *
+ * Protocolo: peticiones de tamano fijo (CPUID_H(server_request), 24 bytes) y respuestas con
+ * una cabecera fija (CPUID_H(server_response), 16 bytes) seguida de length bytes. Todo en el
+ * orden de bytes de la maquina: el socket es local. Un cliente puede mandar muchas peticiones
+ * seguidas sin esperar respuesta (pipelining); las respuestas llegan en el mismo orden y con
+ * el id de la peticion.
+ *
+ *      CPUID_SERVER_PING   -                           sin datos
+ *      CPUID_SERVER_INFO   -                           CPUID_H(server_info)
+ *      CPUID_SERVER_LEAF   args = cpu, hoja, subhoja   CPUID_H(record)
+ *      CPUID_SERVER_CPUS   args[0] = primera           uint32_t cpus[] (hasta 32 por respuesta)
+ *
+ * El servidor es un bucle de epoll de un solo hilo (solo Linux): cada conexion tiene un buffer
+ * de entrada y otro de salida, se responden todas las peticiones completas que hay en el
+ * buffer de entrada y se escriben todas las respuestas con un solo write. Si un cliente no lee
+ * sus respuestas se deja de leer de el hasta que vacie el buffer de salida.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "cpuid_march.h"
+
+#define CPUID_SERVER_VERSION      1
+#define CPUID_SERVER_DEFAULT_PATH "/run/cpuid.sock"
+#define CPUID_SERVER_MAX_CLIENTS  4096
+#define CPUID_SERVER_CPUS_MAX     32      // CPU por respuesta de CPUID_SERVER_CPUS
+
+typedef enum CPUID_H(server_op) {
+    CPUID_SERVER_PING = 0,
+    CPUID_SERVER_INFO = 1,
+    CPUID_SERVER_LEAF = 2,
+    CPUID_SERVER_CPUS = 3,
+} CPUID_H(server_op);
+
+typedef enum CPUID_H(server_status) {
+    CPUID_SERVER_OK          =  0,
+    CPUID_SERVER_BAD_REQUEST = -1,   // version u operacion desconocida
+    CPUID_SERVER_NOT_FOUND   = -2,   // la CPU o la hoja no estan en el snapshot
+} CPUID_H(server_status);
+
+typedef struct CPUID_H(server_request) {
+    uint16_t version;       // CPUID_SERVER_VERSION
+    uint16_t op;            // CPUID_H(server_op)
+    uint32_t id;            // lo elige el cliente y vuelve en la respuesta
+    uint32_t args[3];
+    uint32_t reserved;
+} CPUID_H(server_request);
+
+typedef struct CPUID_H(server_response) {
+    uint16_t version;
+    uint16_t op;
+    uint32_t id;
+    int32_t  status;        // CPUID_H(server_status)
+    uint32_t length;        // bytes de datos detras de la cabecera
+} CPUID_H(server_response);
+
+typedef struct CPUID_H(server_info) {
+    uint64_t            generation;     // snapshots que ha tenido el servidor
+    uint32_t            n_cpus;
+    uint32_t            n_leaves;
+    int32_t             level;          // nivel de x86-64 (cpuid_march_level) comun a todas las CPU
+    uint32_t            reserved;
+    CPUID_H(featureset) features;       // usables en todas las CPU
+    CPUID_H(host_info)  info;
+} CPUID_H(server_info);
+
+typedef struct CPUID_H(server_client) CPUID_H(server_client);
+
+typedef struct CPUID_H(server) {
+    int                     listen_fd;
+    int                     epoll_fd;
+    char                    path[108];      // sun_path
+    CPUID_H(snapshot)       snapshot;
+    CPUID_H(server_info)    info;
+    uint32_t               *rows;           // rows[cpu]: bloque de la CPU en el snapshot, o UINT32_MAX
+    uint32_t                n_rows;
+    CPUID_H(server_client) *clients[CPUID_SERVER_MAX_CLIENTS];
+    size_t                  n_clients;
+    int                     accept_paused;  // listen_fd fuera de epoll tras EMFILE/ENFILE
+    uint64_t                requests;       // peticiones respondidas
+} CPUID_H(server);
+
+/*
+ * Crea el socket en path (borrando el que hubiera), con permisos para todos los usuarios, y se
+ * queda con el snapshot, tambien si falla (tiene que ser de cpuid_snapshot_take con las hojas
+ * por defecto, que van ordenadas por hoja y subhoja). Devuelve 0, o -1 si fallo.
+ */
+int cpuid_server_open(CPUID_H(server) *server, const char *path, CPUID_H(snapshot) *snapshot);
+
+/*
+ * Sustituye el snapshot (por ejemplo uno nuevo tras conectar CPU) y libera el anterior.
+ * Las peticiones que lleguen despues se responden con el nuevo.
+ */
+void cpuid_server_replace(CPUID_H(server) *server, CPUID_H(snapshot) *snapshot);
+
+/*
+ * Atiende eventos durante timeout_ms como mucho (-1 sin limite). Devuelve el numero de
+ * eventos atendidos, o -1 si fallo epoll.
+ */
+int cpuid_server_run(CPUID_H(server) *server, int timeout_ms);
+
+// cierra todas las conexiones, borra el socket y libera el snapshot
+void cpuid_server_close(CPUID_H(server) *server);
+
+/*
+ * Cliente. cpuid_client_send solo deja la peticion en el buffer; cpuid_client_flush las manda
+ * todas y cpuid_client_recv lee las respuestas en orden. Para una sola consulta:
+ *
+ *      cpuid_client_send(&client, CPUID_SERVER_LEAF, 1, cpu, 7, 0);
+ *      cpuid_client_flush(&client);
+ *      cpuid_client_recv(&client, &response, &record, sizeof(record));
+ */
+typedef struct CPUID_H(client) {
+    int            fd;
+    unsigned char  out[4096];
+    size_t         out_len;
+    unsigned char  in[8192];
+    size_t         in_begin, in_end;
+} CPUID_H(client);
+
+int  cpuid_client_connect(CPUID_H(client) *client, const char *path);
+void cpuid_client_close(CPUID_H(client) *client);
+
+// devuelve 0, o -1 si fallo al vaciar el buffer lleno
+int cpuid_client_send(CPUID_H(client) *client, uint16_t op, uint32_t id, uint32_t arg0, uint32_t arg1, uint32_t arg2);
+int cpuid_client_flush(CPUID_H(client) *client);
+
+/*
+ * Lee la siguiente respuesta: la cabecera en response y hasta cap bytes de datos en data
+ * (el resto se descarta). Devuelve 0, o -1 si se cerro la conexion o hubo un error.
+ */
+int cpuid_client_recv(CPUID_H(client) *client, CPUID_H(server_response) *response, void *data, size_t cap);
+
+#include "cpuid_server.c"
+#endif
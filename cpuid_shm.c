@@ -0,0 +1,285 @@
+#ifndef __CPUID_SHM_C__
+#define __CPUID_SHM_C__
+
+#include "cpuid_shm.h"
+#include "cpuid_atomic.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#define CPUID_SHM_POSIX 1
+#endif
+
+#define CPUID_SHM_PAGE       4096
+#define CPUID_SHM_READ_TRIES (1 << 16)
+#define CPUID_SHM_SPIN_TRIES 64         // intentos antes de ceder la CPU al publicador
+
+#ifdef CPUID_SHM_POSIX
+
+// tamano del segmento para n registros (pagina entera, mas un cuarto de margen para crecer)
+static size_t cpuid_shm_capacity(size_t n_records) {
+    size_t bytes = sizeof(CPUID_H(shm_header)) + sizeof(CPUID_H(record)) * (n_records + n_records / 4);
+    return (bytes + CPUID_SHM_PAGE - 1) / CPUID_SHM_PAGE * CPUID_SHM_PAGE;
+}
+
+static int cpuid_shm_header_valid(const CPUID_H(shm_header) *h, size_t size) {
+    return size >= sizeof(*h)
+        && memcmp(h->magic, CPUID_SHM_MAGIC, sizeof(h->magic)) == 0
+        && h->version     == CPUID_SHM_VERSION
+        && h->header_size == sizeof(*h)
+        && h->size        == size;
+}
+
+// marca el segmento como retirado con el seqlock tomado (los lectores lo ven en la siguiente lectura)
+static void cpuid_shm_retire(CPUID_H(shm_header) *h) {
+    uint32_t sequence = cpuid_atomic_load_u32(&h->sequence);
+    cpuid_atomic_store_u32(&h->sequence, sequence | 1);
+    cpuid_atomic_fence_release();
+    h->retired = 1;
+    cpuid_atomic_store_u32(&h->sequence, (sequence | 1) + 1);
+}
+
+static CPUID_H(shm_header) *cpuid_shm_map(int fd, size_t size, int writable) {
+    void *base = mmap(NULL, size, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+    return base == MAP_FAILED ? NULL : base;
+}
+
+// segmento para el publicador: el que ya existe si es valido y cabe el snapshot, o uno nuevo
+static int cpuid_shm_attach(CPUID_H(shm_publisher) *publisher, const char *name, size_t n_records) {
+    size_t need = sizeof(CPUID_H(shm_header)) + sizeof(CPUID_H(record)) * n_records;
+    struct stat st;
+
+    int fd = shm_open(name, O_RDWR, 0);
+    if (fd >= 0) {
+        CPUID_H(shm_header) *h = NULL;
+        if (fstat(fd, &st) == 0 && (size_t)st.st_size >= sizeof(*h)) h = cpuid_shm_map(fd, (size_t)st.st_size, 1);
+        close(fd);
+        if (h != NULL) {
+            if (cpuid_shm_header_valid(h, (size_t)st.st_size) && !h->retired && (size_t)st.st_size >= need) {
+                publisher->header = h;
+                publisher->size   = (size_t)st.st_size;
+                return 0;
+            }
+            // no sirve (otra version, retirado o pequeno): los lectores que lo tengan deben reabrir
+            if (cpuid_shm_header_valid(h, (size_t)st.st_size)) cpuid_shm_retire(h);
+            munmap(h, (size_t)st.st_size);
+        }
+        shm_unlink(name);
+    }
+
+    size_t size = cpuid_shm_capacity(n_records);
+    fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0644);
+    if (fd < 0) return -1;
+    // el umask del publicador no debe impedir que otros usuarios lo lean
+    if (fchmod(fd, 0644) != 0 || ftruncate(fd, (off_t)size) != 0) {
+        close(fd);
+        shm_unlink(name);
+        return -1;
+    }
+    CPUID_H(shm_header) *h = cpuid_shm_map(fd, size, 1);
+    close(fd);
+    if (h == NULL) {
+        shm_unlink(name);
+        return -1;
+    }
+
+    // ftruncate deja el segmento a cero: sequence 0 y sin publicaciones
+    memcpy(h->magic, CPUID_SHM_MAGIC, sizeof(h->magic));
+    h->version        = CPUID_SHM_VERSION;
+    h->header_size    = sizeof(*h);
+    h->size           = size;
+    h->records_offset = sizeof(*h);
+    publisher->header = h;
+    publisher->size   = size;
+    return 0;
+}
+
+int cpuid_shm_publish(CPUID_H(shm_publisher) *publisher, const char *name, const CPUID_H(snapshot) *snapshot) {
+    if (snapshot->n_cpus == 0 || snapshot->n_leaves == 0) return CPUID_SHM_ERROR;
+
+    // lo decodificado se calcula antes de tomar el seqlock para que dure lo menos posible
+    CPUID_H(featureset) features;
+    CPUID_H(host_info)  info;
+    cpuid_features_current(&features);
+    for (size_t cpu = 0; cpu < snapshot->n_cpus; cpu++) {
+        CPUID_H(featureset) usable;
+        cpuid_features_usable(snapshot->records + cpu * snapshot->n_leaves, snapshot->n_leaves, &usable);
+        for (size_t w = 0; w < CPUID_FEATURESET_WORDS; w++) features.bits[w] &= usable.bits[w];
+    }
+    cpuid_host_info_decode(snapshot->records, snapshot->n_leaves, &info);
+
+    CPUID_H(shm_header) *h = publisher->header;
+    if (h != NULL && (h->retired || publisher->size < h->records_offset + sizeof(CPUID_H(record)) * snapshot->n_records)) {
+        cpuid_shm_unpublish(publisher, name, 1);
+        h = NULL;
+    }
+    if (h == NULL) {
+        if (cpuid_shm_attach(publisher, name, snapshot->n_records) != 0) return CPUID_SHM_ERROR;
+        h = publisher->header;
+    }
+
+    uint32_t sequence = cpuid_atomic_load_u32(&h->sequence);
+    cpuid_atomic_store_u32(&h->sequence, sequence | 1);
+    cpuid_atomic_fence_release();
+
+    h->generation++;
+    h->published = (int64_t)time(NULL);
+    h->n_cpus    = (uint32_t)snapshot->n_cpus;
+    h->n_leaves  = (uint32_t)snapshot->n_leaves;
+    h->features  = features;
+    h->info      = info;
+    memcpy((unsigned char *)h + h->records_offset, snapshot->records, sizeof(CPUID_H(record)) * snapshot->n_records);
+
+    cpuid_atomic_store_u32(&h->sequence, (sequence | 1) + 1);
+    return CPUID_SHM_OK;
+}
+
+void cpuid_shm_unpublish(CPUID_H(shm_publisher) *publisher, const char *name, int destroy) {
+    // sin segmento propio se retira el que haya con ese nombre (el de otro publicador que termino)
+    if (publisher->header == NULL && destroy) {
+        struct stat st;
+        int         fd = shm_open(name, O_RDWR, 0);
+        if (fd >= 0) {
+            if (fstat(fd, &st) == 0 && (size_t)st.st_size >= sizeof(CPUID_H(shm_header))) {
+                publisher->header = cpuid_shm_map(fd, (size_t)st.st_size, 1);
+                publisher->size   = (size_t)st.st_size;
+                if (publisher->header != NULL && !cpuid_shm_header_valid(publisher->header, publisher->size)) {
+                    munmap(publisher->header, publisher->size);
+                    publisher->header = NULL;
+                }
+            }
+            close(fd);
+        }
+    }
+    if (publisher->header != NULL) {
+        if (destroy) cpuid_shm_retire(publisher->header);
+        munmap(publisher->header, publisher->size);
+    }
+    if (destroy) shm_unlink(name);
+    memset(publisher, 0, sizeof(*publisher));
+}
+
+int cpuid_shm_open(CPUID_H(shm) *shm, const char *name) {
+    struct stat st;
+    memset(shm, 0, sizeof(*shm));
+
+    int fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0) return CPUID_SHM_ERROR;
+    const CPUID_H(shm_header) *h = NULL;
+    if (fstat(fd, &st) == 0 && (size_t)st.st_size >= sizeof(*h)) h = cpuid_shm_map(fd, (size_t)st.st_size, 0);
+    close(fd);
+    if (h == NULL) return CPUID_SHM_ERROR;
+
+    if (!cpuid_shm_header_valid(h, (size_t)st.st_size)) {
+        munmap((void *)h, (size_t)st.st_size);
+        return CPUID_SHM_ERROR;
+    }
+    shm->header = h;
+    shm->size   = (size_t)st.st_size;
+    return CPUID_SHM_OK;
+}
+
+void cpuid_shm_close(CPUID_H(shm) *shm) {
+    if (shm->header != NULL) munmap((void *)shm->header, shm->size);
+    memset(shm, 0, sizeof(*shm));
+}
+
+#else
+
+int cpuid_shm_publish(CPUID_H(shm_publisher) *publisher, const char *name, const CPUID_H(snapshot) *snapshot) {
+    (void)publisher; (void)name; (void)snapshot;
+    return CPUID_SHM_ERROR;
+}
+
+void cpuid_shm_unpublish(CPUID_H(shm_publisher) *publisher, const char *name, int destroy) {
+    (void)name; (void)destroy;
+    memset(publisher, 0, sizeof(*publisher));
+}
+
+int cpuid_shm_open(CPUID_H(shm) *shm, const char *name) {
+    (void)name;
+    memset(shm, 0, sizeof(*shm));
+    return CPUID_SHM_ERROR;
+}
+
+void cpuid_shm_close(CPUID_H(shm) *shm) {
+    memset(shm, 0, sizeof(*shm));
+}
+
+#endif
+
+int cpuid_shm_read(const CPUID_H(shm) *shm, CPUID_H(shm_view) *view, CPUID_H(record) *records, size_t max) {
+    const CPUID_H(shm_header) *h = shm->header;
+    if (h == NULL) return CPUID_SHM_ERROR;
+
+    for (int tries = 0; tries < CPUID_SHM_READ_TRIES; tries++) {
+        uint32_t sequence = cpuid_atomic_load_u32(&h->sequence);
+        if (sequence & 1) {
+#ifdef CPUID_SHM_POSIX
+            // el publicador puede estar esperando CPU (en una VM con pocas vCPU, sobre todo)
+            if (tries >= CPUID_SHM_SPIN_TRIES) sched_yield();
+#endif
+            continue;
+        }
+
+        int      retired        = h->retired != 0;
+        uint64_t records_offset = h->records_offset;
+        view->generation = h->generation;
+        view->published  = h->published;
+        view->n_cpus     = h->n_cpus;
+        view->n_leaves   = h->n_leaves;
+        view->features   = h->features;
+        view->info       = h->info;
+
+        // los tamanos se comprueban antes de copiar: una lectura a medias puede traer basura
+        uint64_t n     = (uint64_t)view->n_cpus * view->n_leaves;
+        int      valid = records_offset >= sizeof(*h) && records_offset <= shm->size
+                      && n <= (shm->size - records_offset) / sizeof(CPUID_H(record));
+        if (valid && records != NULL) {
+            memcpy(records, (const unsigned char *)h + records_offset, sizeof(*records) * (size_t)(n < max ? n : max));
+        }
+
+        cpuid_atomic_fence_acquire();
+        if (cpuid_atomic_load_u32(&h->sequence) != sequence) continue;
+        if (retired) return CPUID_SHM_RETIRED;
+        return valid ? CPUID_SHM_OK : CPUID_SHM_ERROR;
+    }
+    return CPUID_SHM_BUSY;
+}
+
+int cpuid_shm_snapshot(const CPUID_H(shm) *shm, CPUID_H(shm_view) *view, CPUID_H(snapshot) *snapshot) {
+    memset(snapshot, 0, sizeof(*snapshot));
+
+    int status = cpuid_shm_read(shm, view, NULL, 0);
+    while (status == CPUID_SHM_OK) {
+        size_t           n       = (size_t)view->n_cpus * view->n_leaves;
+        CPUID_H(record) *records = malloc(sizeof(*records) * (n != 0 ? n : 1));
+        if (records == NULL) return CPUID_SHM_ERROR;
+
+        status = cpuid_shm_read(shm, view, records, n);
+        // si se publico otro snapshot entre las dos lecturas puede tener otro tamano
+        if (status == CPUID_SHM_OK && (size_t)view->n_cpus * view->n_leaves != n) {
+            free(records);
+            continue;
+        }
+        if (status != CPUID_SHM_OK) {
+            free(records);
+            break;
+        }
+        snapshot->records   = records;
+        snapshot->n_records = n;
+        snapshot->n_cpus    = view->n_cpus;
+        snapshot->n_leaves  = view->n_leaves;
+        return CPUID_SHM_OK;
+    }
+    return status;
+}
+
+#endif
@@ -0,0 +1,122 @@
+#ifndef __CPUID_SHM_H__
+#define __CPUID_SHM_H__
+
+/*
+ * Datos de CPUID publicados en memoria compartida para todos los procesos de un host.
+ *
+ * Un publicador ejecuta CPUID una vez (en una VM cada CPUID es una salida al hipervisor) y
+ * escribe en un segmento de /dev/shm el snapshot de todas las CPU junto con lo ya decodificado:
+ * las caracteristicas que se pueden usar en todas las CPU y CPUID_H(host_info) (caches,
+ * nucleos e hilos por paquete). Los procesos lo mapean en solo lectura y al arrancar no
+ * ejecutan ninguna instruccion CPUID: leer el segmento solo cuesta los fallos de pagina.
+ *
+ * El segmento lo protege un seqlock: el publicador pone sequence a impar, escribe y lo pone a
+ * par; el lector copia lo que necesita y repite si sequence era impar o cambio mientras tanto.
+ * Los lectores nunca escriben en el segmento, asi que no pueden bloquear al publicador.
+ * Tiene que haber un solo publicador por nombre.
+ *
+ * Si un snapshot nuevo no cabe (por ejemplo porque se conectaron CPU), el publicador marca el
+ * segmento como retirado, lo borra y crea otro con el mismo nombre: los lectores que tenian
+ * el anterior reciben CPUID_SHM_RETIRED y tienen que volver a abrirlo.
+ *
+ * Formato (orden de bytes de la maquina):
+ *
+ *      CPUID_H(shm_header)
+ *      CPUID_H(record) records[n_cpus * n_leaves]    el formato de cpuid_snapshot.h
+ *
+ * Solo hay implementacion con memoria compartida POSIX (shm_open); en el resto de sistemas
+ * las funciones devuelven CPUID_SHM_ERROR.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "cpuid_features.h"
+
+#define CPUID_SHM_MAGIC        "CPUIDSHM"
+#define CPUID_SHM_VERSION      1            // cambia con cualquier cambio del formato
+#define CPUID_SHM_DEFAULT_NAME "/cpuid"     // en Linux, /dev/shm/cpuid
+
+typedef enum CPUID_H(shm_status) {
+    CPUID_SHM_OK      =  0,
+    CPUID_SHM_ERROR   = -1,   // no existe, no es un segmento valido o es de otra version
+    CPUID_SHM_RETIRED = -2,   // el publicador lo sustituyo: cerrar y volver a abrir
+    CPUID_SHM_BUSY    = -3,   // el publicador no termino de escribir tras muchos intentos
+} CPUID_H(shm_status);
+
+typedef struct CPUID_H(shm_header) {
+    char                magic[8];
+    uint32_t            version;        // CPUID_SHM_VERSION
+    uint32_t            header_size;    // sizeof(CPUID_H(shm_header))
+    uint64_t            size;           // bytes del segmento
+    uint32_t            sequence;       // seqlock: impar mientras el publicador escribe
+    uint32_t            retired;        // 1 si hay un segmento nuevo con el mismo nombre
+    uint64_t            generation;     // publicaciones hechas en este segmento
+    int64_t             published;      // segundos desde 1970 de la ultima publicacion
+    uint32_t            n_cpus;
+    uint32_t            n_leaves;       // registros por CPU
+    uint64_t            records_offset;
+    CPUID_H(featureset) features;       // usables en todas las CPU (con XCR0 del publicador)
+    CPUID_H(host_info)  info;           // de la primera CPU del snapshot
+} CPUID_H(shm_header);
+
+/*
+ * Publicador. Empezar con el struct a cero; cada cpuid_shm_publish reutiliza el segmento si
+ * el snapshot cabe.
+ */
+typedef struct CPUID_H(shm_publisher) {
+    CPUID_H(shm_header) *header;
+    size_t               size;
+} CPUID_H(shm_publisher);
+
+/*
+ * Publica el snapshot (normalmente de todas las CPU, ver cpuid_snapshot_take) en el segmento
+ * name, que se crea con permisos de lectura para todos si no existe. Devuelve CPUID_SHM_OK o
+ * CPUID_SHM_ERROR.
+ */
+int cpuid_shm_publish(CPUID_H(shm_publisher) *publisher, const char *name, const CPUID_H(snapshot) *snapshot);
+
+/*
+ * Desmapea el segmento. Con destroy distinto de 0 ademas lo marca como retirado y lo borra.
+ */
+void cpuid_shm_unpublish(CPUID_H(shm_publisher) *publisher, const char *name, int destroy);
+
+// lector: el segmento mapeado en solo lectura
+typedef struct CPUID_H(shm) {
+    const CPUID_H(shm_header) *header;
+    size_t                     size;
+} CPUID_H(shm);
+
+// lo que se copia del segmento en cada lectura
+typedef struct CPUID_H(shm_view) {
+    uint64_t            generation;
+    int64_t             published;
+    uint32_t            n_cpus;
+    uint32_t            n_leaves;
+    CPUID_H(featureset) features;
+    CPUID_H(host_info)  info;
+} CPUID_H(shm_view);
+
+/*
+ * Mapea el segmento en solo lectura y comprueba la cabecera (magic, version y tamanos).
+ * Devuelve CPUID_SHM_OK o CPUID_SHM_ERROR.
+ */
+int cpuid_shm_open(CPUID_H(shm) *shm, const char *name);
+void cpuid_shm_close(CPUID_H(shm) *shm);
+
+/*
+ * Copia una publicacion completa: la cabecera decodificada en view y, si records no es NULL,
+ * los registros (max como maximo; el total es view->n_cpus * view->n_leaves).
+ * Devuelve CPUID_SHM_OK, CPUID_SHM_RETIRED, CPUID_SHM_BUSY o CPUID_SHM_ERROR si el contenido
+ * no es coherente.
+ */
+int cpuid_shm_read(const CPUID_H(shm) *shm, CPUID_H(shm_view) *view, CPUID_H(record) *records, size_t max);
+
+/*
+ * Como cpuid_shm_read, pero deja los registros en un snapshot nuevo (reservado con malloc,
+ * liberar con cpuid_snapshot_free) para usarlo con cpuid_snapshot_find, cpuid_diff, ...
+ */
+int cpuid_shm_snapshot(const CPUID_H(shm) *shm, CPUID_H(shm_view) *view, CPUID_H(snapshot) *snapshot);
+
+#include "cpuid_shm.c"
+#endif
@@ -0,0 +1,136 @@
+#ifndef __CPUID_SINK_C__
+#define __CPUID_SINK_C__
+
+#include "cpuid_sink.h"
+
+#include <string.h>
+#include <errno.h>
+
+#ifdef _WIN32
+    #include <io.h>
+#else
+    #include <unistd.h>
+#endif
+
+static void cpuid_sink_init(CPUID_H(sink) *sink, CPUID_H(sink_kind) kind, char *buffer, size_t capacity) {
+    memset(sink, 0, sizeof(*sink));
+    sink->kind     = kind;
+    sink->buffer   = buffer;
+    sink->capacity = buffer != NULL ? capacity : 0;
+}
+
+void cpuid_sink_buffer(CPUID_H(sink) *sink, char *buffer, size_t capacity) {
+    cpuid_sink_init(sink, CPUID_SINK_BUFFER, buffer, capacity);
+    if (sink->capacity != 0) buffer[0] = '\0';
+}
+
+void cpuid_sink_fd(CPUID_H(sink) *sink, int fd, char *staging, size_t capacity) {
+    cpuid_sink_init(sink, CPUID_SINK_FD, staging, capacity);
+    sink->target.fd = fd;
+}
+
+void cpuid_sink_file(CPUID_H(sink) *sink, FILE *file, char *staging, size_t capacity) {
+    cpuid_sink_init(sink, CPUID_SINK_FILE, staging, capacity);
+    sink->target.file = file;
+}
+
+void cpuid_sink_callback(
+    CPUID_H(sink) *sink, CPUID_H(sink_function) function, void *context, char *staging, size_t capacity
+) {
+    cpuid_sink_init(sink, CPUID_SINK_CALLBACK, staging, capacity);
+    sink->target.callback.function = function;
+    sink->target.callback.context  = context;
+}
+
+int cpuid_sink_write_fd(int fd, const char *data, size_t len) {
+    while (len != 0) {
+        #ifdef _WIN32
+        int written = _write(fd, data, len > 0x7fffffff ? 0x7fffffff : (unsigned)len);
+        #else
+        ssize_t written = write(fd, data, len);
+        #endif
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        data += written;
+        len  -= (size_t)written;
+    }
+    return 0;
+}
+
+// entrega data al destino final (fd, FILE* o callback)
+static void cpuid_sink_emit(CPUID_H(sink) *sink, const char *data, size_t len) {
+    if (len == 0 || sink->error) return;
+    switch (sink->kind) {
+        case CPUID_SINK_FD:
+            if (cpuid_sink_write_fd(sink->target.fd, data, len) != 0) sink->error = 1;
+            break;
+        case CPUID_SINK_FILE:
+            if (fwrite(data, 1, len, sink->target.file) != len) sink->error = 1;
+            break;
+        case CPUID_SINK_CALLBACK:
+            if (sink->target.callback.function(sink->target.callback.context, data, len) != len) sink->error = 1;
+            break;
+        case CPUID_SINK_BUFFER:
+            break;
+    }
+}
+
+void cpuid_sink_write(CPUID_H(sink) *sink, const char *data, size_t len) {
+    sink->total += len;
+
+    if (sink->kind == CPUID_SINK_BUFFER) {
+        // se reserva un byte para el '\0', como snprintf
+        if (sink->capacity == 0) return;
+        size_t room = sink->capacity - 1 - sink->used;
+        if (len > room) len = room;
+        memcpy(sink->buffer + sink->used, data, len);
+        sink->used += len;
+        sink->buffer[sink->used] = '\0';
+        return;
+    }
+
+    if (sink->used + len > sink->capacity) {
+        cpuid_sink_emit(sink, sink->buffer, sink->used);
+        sink->used = 0;
+        // lo que no cabe ni en el buffer vacio se envia directamente
+        if (len > sink->capacity) {
+            cpuid_sink_emit(sink, data, len);
+            return;
+        }
+    }
+    memcpy(sink->buffer + sink->used, data, len);
+    sink->used += len;
+}
+
+void cpuid_sink_puts(CPUID_H(sink) *sink, const char *str) {
+    cpuid_sink_write(sink, str, strlen(str));
+}
+
+void cpuid_sink_putc(CPUID_H(sink) *sink, char c) {
+    cpuid_sink_write(sink, &c, 1);
+}
+
+void cpuid_sink_hex(CPUID_H(sink) *sink, uint32_t value, int min_digits) {
+    static const char hex[] = "0123456789abcdef";
+    char digits[8];
+    int  n = 0;
+    do {
+        digits[7 - n++] = hex[value & 0xf];
+        value >>= 4;
+    } while (value != 0);
+    while (n < min_digits && n < 8) digits[7 - n++] = '0';
+    cpuid_sink_write(sink, digits + 8 - n, (size_t)n);
+}
+
+int cpuid_sink_flush(CPUID_H(sink) *sink) {
+    if (sink->kind != CPUID_SINK_BUFFER) {
+        cpuid_sink_emit(sink, sink->buffer, sink->used);
+        sink->used = 0;
+        if (sink->kind == CPUID_SINK_FILE && !sink->error && fflush(sink->target.file) != 0) sink->error = 1;
+    }
+    return sink->error ? -1 : 0;
+}
+
+#endif
@@ -0,0 +1,78 @@
+#ifndef __CPUID_SINK_H__
+#define __CPUID_SINK_H__
+
+/*
+ * Destino de salida de los decodificadores (cpuid_render_* de cpuid.c).
+ *
+ * Un sink puede escribir en:
+ *  - un buffer del llamador con limite, como snprintf: nunca se escribe fuera de capacity,
+ *    el buffer queda terminado en '\0' y total indica los bytes que habria hecho falta;
+ *  - un descriptor de fichero, un FILE* o una funcion callback. En estos casos se puede dar
+ *    un buffer intermedio: los datos se acumulan en el y solo se envian al destino cuando
+ *    se llena o con cpuid_sink_flush, de forma que un informe completo se entrega con una
+ *    sola escritura. Sin buffer intermedio cada escritura se pasa directamente al destino.
+ *
+ * El sink no reserva memoria ni usa printf.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/*
+ * Funcion de salida de un sink de tipo callback. Debe devolver el numero de bytes que
+ * acepta; si devuelve menos de len el sink queda marcado con error.
+ */
+typedef size_t (*CPUID_H(sink_function))(void *context, const char *data, size_t len);
+
+typedef enum CPUID_H(sink_kind) {
+    CPUID_SINK_BUFFER   = 0,
+    CPUID_SINK_FD       = 1,
+    CPUID_SINK_FILE     = 2,
+    CPUID_SINK_CALLBACK = 3,
+} CPUID_H(sink_kind);
+
+typedef struct CPUID_H(sink) {
+    CPUID_H(sink_kind) kind;
+    char   *buffer;    // destino (CPUID_SINK_BUFFER) o buffer intermedio (resto), puede ser NULL
+    size_t  capacity;
+    size_t  used;      // bytes ocupados en buffer
+    size_t  total;     // bytes producidos desde la inicializacion, se hayan podido guardar o no
+    int     error;     // distinto de 0 si fallo alguna escritura al destino
+    union {
+        int   fd;
+        FILE *file;
+        struct {
+            CPUID_H(sink_function) function;
+            void                  *context;
+        } callback;
+    } target;
+} CPUID_H(sink);
+
+// Inicializacion segun el destino. staging y capacity pueden ser NULL y 0.
+void cpuid_sink_buffer  (CPUID_H(sink) *sink, char *buffer, size_t capacity);
+void cpuid_sink_fd      (CPUID_H(sink) *sink, int fd, char *staging, size_t capacity);
+void cpuid_sink_file    (CPUID_H(sink) *sink, FILE *file, char *staging, size_t capacity);
+void cpuid_sink_callback(CPUID_H(sink) *sink, CPUID_H(sink_function) function, void *context, char *staging, size_t capacity);
+
+void cpuid_sink_write(CPUID_H(sink) *sink, const char *data, size_t len);
+void cpuid_sink_puts (CPUID_H(sink) *sink, const char *str);
+void cpuid_sink_putc (CPUID_H(sink) *sink, char c);
+
+// value en hexadecimal en minusculas, sin prefijo y con al menos min_digits cifras (como "%0*x")
+void cpuid_sink_hex  (CPUID_H(sink) *sink, uint32_t value, int min_digits);
+
+/*
+ * Envia al destino lo acumulado en el buffer intermedio (no hace nada en CPUID_SINK_BUFFER).
+ * Devuelve 0, o -1 si alguna escritura fallo desde la inicializacion.
+ */
+int cpuid_sink_flush(CPUID_H(sink) *sink);
+
+/*
+ * Escribe len bytes en el descriptor fd, repitiendo solo si la escritura es parcial o la
+ * interrumpe una senal. Devuelve 0 si se escribio todo y -1 si hubo un error.
+ */
+int cpuid_sink_write_fd(int fd, const char *data, size_t len);
+
+#include "cpuid_sink.c"
+#endif
@@ -0,0 +1,244 @@
+#ifndef __CPUID_SNAPSHOT_C__
+#define __CPUID_SNAPSHOT_C__
+
+#include "cpuid_snapshot.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// limites de cordura para CPU o hipervisores que devuelven basura en las hojas de maximos
+#define CPUID_SNAPSHOT_MAX_SUBLEAVES 64
+
+static inline void cpuid_snapshot_push(
+    CPUID_H(leaf_request) *leaves, size_t max, size_t *total, uint32_t leaf, uint32_t subleaf
+) {
+    if (*total < max) {
+        leaves[*total].leaf    = leaf;
+        leaves[*total].subleaf = subleaf;
+    }
+    (*total)++;
+}
+
+/*
+ * Expande una hoja segun el tipo de enumeracion de sus subhojas.
+ */
+static void cpuid_snapshot_push_leaf(CPUID_H(leaf_request) *leaves, size_t max, size_t *total, uint32_t leaf) {
+    uint32_t eax, ebx, ecx, edx;
+    call_cpuid(leaf, 0, &eax, &ebx, &ecx, &edx);
+
+    switch (leaf) {
+        // subhojas de cache hasta la que tiene tipo de cache nulo (EAX[4:0] = 0)
+        case 0x04: case 0x8000001D:
+            for (uint32_t sub = 0; sub < CPUID_SNAPSHOT_MAX_SUBLEAVES; sub++) {
+                if (sub != 0) call_cpuid(leaf, sub, &eax, &ebx, &ecx, &edx);
+                if ((eax & 0x1f) == 0) break;
+                cpuid_snapshot_push(leaves, max, total, leaf, sub);
+            }
+            break;
+
+        // niveles de topologia hasta el de tipo invalido (ECX[15:8] = 0), la subhoja 0 siempre
+        case 0x0B: case 0x1F: case 0x80000026:
+            cpuid_snapshot_push(leaves, max, total, leaf, 0);
+            for (uint32_t sub = 1; sub < CPUID_SNAPSHOT_MAX_SUBLEAVES && ((ecx >> 8) & 0xff) != 0; sub++) {
+                call_cpuid(leaf, sub, &eax, &ebx, &ecx, &edx);
+                if (((ecx >> 8) & 0xff) == 0) break;
+                cpuid_snapshot_push(leaves, max, total, leaf, sub);
+            }
+            break;
+
+        // EAX de la subhoja 0 es la subhoja maxima
+        case 0x07: case 0x14: case 0x17: case 0x18: case 0x1D: case 0x20: case 0x24:
+            for (uint32_t sub = 0; sub <= eax && sub < CPUID_SNAPSHOT_MAX_SUBLEAVES; sub++) {
+                cpuid_snapshot_push(leaves, max, total, leaf, sub);
+            }
+            break;
+
+        // EAX de la subhoja 0 es un mapa de bits de las subhojas validas
+        case 0x23:
+            cpuid_snapshot_push(leaves, max, total, leaf, 0);
+            for (uint32_t sub = 1; sub < 32; sub++) {
+                if ((eax >> sub) & 1) cpuid_snapshot_push(leaves, max, total, leaf, sub);
+            }
+            break;
+
+        // XSAVE: subhojas 0 y 1, y una por componente soportado en XCR0 o IA32_XSS
+        case 0x0D: {
+            uint64_t components = eax | ((uint64_t)edx << 32);
+            call_cpuid(leaf, 1, &eax, &ebx, &ecx, &edx);
+            components |= ecx | ((uint64_t)edx << 32);
+
+            cpuid_snapshot_push(leaves, max, total, leaf, 0);
+            cpuid_snapshot_push(leaves, max, total, leaf, 1);
+            for (uint32_t sub = 2; sub < 63; sub++) {
+                if ((components >> sub) & 1) cpuid_snapshot_push(leaves, max, total, leaf, sub);
+            }
+            break;
+        }
+
+        // SGX: subhojas 0 y 1 y las secciones EPC hasta la de tipo invalido (EAX[3:0] = 0)
+        case 0x12:
+            cpuid_snapshot_push(leaves, max, total, leaf, 0);
+            cpuid_snapshot_push(leaves, max, total, leaf, 1);
+            for (uint32_t sub = 2; sub < CPUID_SNAPSHOT_MAX_SUBLEAVES; sub++) {
+                call_cpuid(leaf, sub, &eax, &ebx, &ecx, &edx);
+                if ((eax & 0xf) == 0) break;
+                cpuid_snapshot_push(leaves, max, total, leaf, sub);
+            }
+            break;
+
+        // RDT monitorizacion (0Fh) y asignacion (10h), QoS de AMD (80000020h): numero fijo de recursos
+        case 0x0F:
+            for (uint32_t sub = 0; sub < 2; sub++) cpuid_snapshot_push(leaves, max, total, leaf, sub);
+            break;
+        case 0x10: case 0x80000020:
+            for (uint32_t sub = 0; sub < 4; sub++) cpuid_snapshot_push(leaves, max, total, leaf, sub);
+            break;
+
+        default:
+            cpuid_snapshot_push(leaves, max, total, leaf, 0);
+            break;
+    }
+}
+
+size_t cpuid_snapshot_default_leaves(CPUID_H(leaf_request) *leaves, size_t max) {
+    uint32_t eax, ebx, ecx, edx;
+    size_t   total = 0;
+
+    call_cpuid(CPUID_GETVENDORSTRING, 0, &eax, &ebx, &ecx, &edx);
+    uint32_t max_basic = eax > 0xff ? 0xff : eax;
+    for (uint32_t leaf = 0; leaf <= max_basic; leaf++) {
+        cpuid_snapshot_push_leaf(leaves, max, &total, leaf);
+    }
+
+    // hojas de hipervisor solo si CPUID.1:ECX[31] lo indica
+    call_cpuid(CPUID_GETFEATURES, 0, &eax, &ebx, &ecx, &edx);
+    if (max_basic >= 1 && (ecx >> 31) & 1) {
+        call_cpuid(CPUID_RESERVED_FOR_HYPERVISOR_USE, 0, &eax, &ebx, &ecx, &edx);
+        uint32_t max_hv = eax;
+        if (max_hv < CPUID_RESERVED_FOR_HYPERVISOR_USE || max_hv > CPUID_RESERVED_FOR_HYPERVISOR_USE + 0xff) {
+            max_hv = CPUID_RESERVED_FOR_HYPERVISOR_USE;
+        }
+        for (uint32_t leaf = CPUID_RESERVED_FOR_HYPERVISOR_USE; leaf <= max_hv; leaf++) {
+            cpuid_snapshot_push(leaves, max, &total, leaf, 0);
+        }
+    }
+
+    call_cpuid(CPUID_INTELEXTENDED, 0, &eax, &ebx, &ecx, &edx);
+    if ((eax & 0xffff0000) == CPUID_INTELEXTENDED) {
+        uint32_t max_ext = eax > CPUID_INTELEXTENDED + 0xff ? CPUID_INTELEXTENDED + 0xff : eax;
+        for (uint32_t leaf = CPUID_INTELEXTENDED; leaf <= max_ext; leaf++) {
+            cpuid_snapshot_push_leaf(leaves, max, &total, leaf);
+        }
+    }
+    return total;
+}
+
+int cpuid_snapshot_take(
+    CPUID_H(snapshot) *snapshot,
+    const CPUID_H(leaf_request) *leaves, size_t n_leaves,
+    const uint32_t *cpus, size_t n_cpus,
+    unsigned n_threads
+) {
+    CPUID_H(leaf_request) *own_leaves = NULL;
+    uint32_t              *own_cpus   = NULL;
+    int                    pinned     = -1;
+
+    memset(snapshot, 0, sizeof(*snapshot));
+
+    if (leaves == NULL) {
+        own_leaves = malloc(sizeof(*own_leaves) * CPUID_SNAPSHOT_MAX_LEAVES);
+        if (own_leaves == NULL) goto done;
+        n_leaves = cpuid_snapshot_default_leaves(own_leaves, CPUID_SNAPSHOT_MAX_LEAVES);
+        if (n_leaves > CPUID_SNAPSHOT_MAX_LEAVES) n_leaves = CPUID_SNAPSHOT_MAX_LEAVES;
+        leaves = own_leaves;
+    }
+
+    if (cpus == NULL) {
+        n_cpus = cpuid_affinity_cpus(NULL, 0);
+        if (n_cpus == 0) goto done;
+        own_cpus = malloc(sizeof(*own_cpus) * n_cpus);
+        if (own_cpus == NULL) goto done;
+        // el mask pudo cambiar entre las dos llamadas
+        size_t total = cpuid_affinity_cpus(own_cpus, n_cpus);
+        if (total < n_cpus) n_cpus = total;
+        cpus = own_cpus;
+    }
+
+    if (n_cpus != 0 && n_leaves != 0) {
+        snapshot->records = malloc(sizeof(*snapshot->records) * n_cpus * n_leaves);
+        if (snapshot->records == NULL) goto done;
+    }
+
+    pinned = cpuid_collect(leaves, n_leaves, cpus, n_cpus, snapshot->records, n_threads);
+    if (pinned < 0) {
+        free(snapshot->records);
+        snapshot->records = NULL;
+        goto done;
+    }
+    snapshot->n_records = n_cpus * n_leaves;
+    snapshot->n_cpus    = n_cpus;
+    snapshot->n_leaves  = n_leaves;
+
+done:
+    free(own_cpus);
+    free(own_leaves);
+    return pinned;
+}
+
+const CPUID_H(record) *cpuid_snapshot_find(
+    const CPUID_H(snapshot) *snapshot, uint32_t cpu, uint32_t leaf, uint32_t subleaf
+) {
+    // las CPU van en bloques de n_leaves registros: se salta de bloque en bloque hasta la CPU
+    for (size_t row = 0; row < snapshot->n_cpus; row++) {
+        const CPUID_H(record) *block = snapshot->records + row * snapshot->n_leaves;
+        if (block->cpu != cpu) continue;
+        for (size_t j = 0; j < snapshot->n_leaves; j++) {
+            if (block[j].leaf == leaf && block[j].subleaf == subleaf) return &block[j];
+        }
+        return NULL;
+    }
+    return NULL;
+}
+
+void cpuid_snapshot_free(CPUID_H(snapshot) *snapshot) {
+    free(snapshot->records);
+    memset(snapshot, 0, sizeof(*snapshot));
+}
+
+static inline char *cpuid_snapshot_hex32(char *out, uint32_t value) {
+    static const char hex[] = "0123456789abcdef";
+    for (int i = 7; i >= 0; i--) {
+        out[i] = hex[value & 0xf];
+        value >>= 4;
+    }
+    return out + 8;
+}
+
+void cpuid_snapshot_render_bits(CPUID_H(sink) *sink, const CPUID_H(snapshot) *snapshot) {
+    // varias lineas por escritura al sink
+    char   text[32 * CPUID_SNAPSHOT_BITS_LINE];
+    size_t used = 0;
+
+    for (size_t i = 0; i < snapshot->n_records; i++) {
+        const CPUID_H(record) *r = &snapshot->records[i];
+        char *p = text + used;
+
+        p = cpuid_snapshot_hex32(p, r->cpu);     *p++ = ' ';
+        p = cpuid_snapshot_hex32(p, r->leaf);    *p++ = ' ';
+        p = cpuid_snapshot_hex32(p, r->subleaf);
+        *p++ = ' '; p = cpuid_bits_expand(p, &r->eax, sizeof(r->eax));
+        *p++ = ' '; p = cpuid_bits_expand(p, &r->ebx, sizeof(r->ebx));
+        *p++ = ' '; p = cpuid_bits_expand(p, &r->ecx, sizeof(r->ecx));
+        *p++ = ' '; p = cpuid_bits_expand(p, &r->edx, sizeof(r->edx));
+        *p++ = '\n';
+
+        used += CPUID_SNAPSHOT_BITS_LINE;
+        if (used == sizeof(text)) {
+            cpuid_sink_write(sink, text, used);
+            used = 0;
+        }
+    }
+    cpuid_sink_write(sink, text, used);
+}
+
+#endif
@@ -0,0 +1,74 @@
+#ifndef __CPUID_SNAPSHOT_H__
+#define __CPUID_SNAPSHOT_H__
+
+/*
+ * Snapshot: tabla contigua de CPUID_H(record) (32 bytes cada uno) con el resultado de un
+ * conjunto de hojas en un conjunto de CPU. La tabla se guarda tal cual la rellena
+ * cpuid_collect, agrupada por CPU y, dentro de cada CPU, en el orden de las hojas pedidas,
+ * de forma que pueda exponerse sin copias (buffer protocol de Python, volcado a disco, ...).
+ */
+
+#include "cpuid_percpu.h"
+
+// hojas que como maximo genera cpuid_snapshot_default_leaves
+#define CPUID_SNAPSHOT_MAX_LEAVES 512
+
+typedef struct CPUID_H(snapshot) {
+    CPUID_H(record) *records;   // n_cpus * n_leaves registros
+    size_t           n_records;
+    size_t           n_cpus;
+    size_t           n_leaves;
+} CPUID_H(snapshot);
+
+/*
+ * Enumera las hojas y subhojas validas en la CPU actual: todas las hojas basicas hasta la
+ * maxima de CPUID EAX=0, las de hipervisor si CPUID.1:ECX[31] esta activo y las extendidas
+ * hasta la maxima de CPUID EAX=80000000h. Las hojas con subhojas (4, 7, 0Bh, 0Dh, 0Fh, 10h, 12h,
+ * 14h, 17h, 18h, 1Dh, 1Fh, 20h, 23h, 24h, 8000001Dh, 80000020h, 80000026h) se expanden
+ * segun el contador o la condicion de fin que define cada una.
+ *
+ * Escribe como maximo max hojas en leaves (en orden creciente de hoja y subhoja) y devuelve
+ * el total, que puede ser mayor que max.
+ */
+size_t cpuid_snapshot_default_leaves(CPUID_H(leaf_request) *leaves, size_t max);
+
+/*
+ * Rellena snapshot ejecutando las hojas indicadas (o las de cpuid_snapshot_default_leaves
+ * si leaves es NULL) en las CPU indicadas (o en todas las del mask de afinidad si cpus es NULL).
+ * La tabla se reserva con malloc; liberar con cpuid_snapshot_free.
+ *
+ * No llama a funciones de Python, se puede ejecutar con el GIL liberado.
+ * Devuelve el numero de CPU en las que se pudo fijar un hilo, o -1 si fallo (sin memoria,
+ * mask de afinidad vacio o no se pudieron crear los hilos); en ese caso snapshot queda vacio.
+ */
+int cpuid_snapshot_take(
+    CPUID_H(snapshot) *snapshot,
+    const CPUID_H(leaf_request) *leaves, size_t n_leaves,
+    const uint32_t *cpus, size_t n_cpus,
+    unsigned n_threads
+);
+
+/*
+ * Busca el registro de una hoja y subhoja en una CPU. Devuelve NULL si no esta en el snapshot.
+ */
+const CPUID_H(record) *cpuid_snapshot_find(
+    const CPUID_H(snapshot) *snapshot, uint32_t cpu, uint32_t leaf, uint32_t subleaf
+);
+
+void cpuid_snapshot_free(CPUID_H(snapshot) *snapshot);
+
+/*
+ * Vista de bits de toda la tabla en una pasada: una linea de ancho fijo por registro,
+ *
+ *      cccccccc hhhhhhhh ssssssss <32 bits de EAX> <EBX> <ECX> <EDX>\n
+ *
+ * con la CPU, la hoja y la subhoja en hexadecimal y los registros como printBits.
+ * Todas las lineas miden CPUID_SNAPSHOT_BITS_LINE bytes, asi que un buffer de
+ * n_records * CPUID_SNAPSHOT_BITS_LINE bytes (+1 para el '\0' de un sink de buffer)
+ * recibe la tabla completa.
+ */
+#define CPUID_SNAPSHOT_BITS_LINE (3 * 9 + 4 * 33)
+void cpuid_snapshot_render_bits(CPUID_H(sink) *sink, const CPUID_H(snapshot) *snapshot);
+
+#include "cpuid_snapshot.c"
+#endif
@@ -0,0 +1,174 @@
+#ifndef __CPUID_STATS_C__
+#define __CPUID_STATS_C__
+
+#include "cpuid_stats.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// nivel de la topologia del que sale cada nivel de grupos por encima de la CPU
+static const CPUID_H(topology_field) cpuid_stats_fields[CPUID_STATS_TOTAL] = {
+    CPUID_TOPO_FIELDS, CPUID_TOPO_CORE, CPUID_TOPO_L3, CPUID_TOPO_PACKAGE,
+};
+
+static int cpuid_stats_u32_cmp(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t*)a, y = *(const uint32_t*)b;
+    return x < y ? -1 : x > y;
+}
+
+/*
+ * Sustituye cada clave por su posicion entre las claves distintas. Devuelve cuantas hay, o -1
+ * sin memoria.
+ */
+static int cpuid_stats_densify(uint32_t *keys, uint32_t n) {
+    uint32_t *sorted = malloc(sizeof(*sorted) * (n != 0 ? n : 1));
+    if (sorted == NULL) return -1;
+    memcpy(sorted, keys, sizeof(*sorted) * n);
+    qsort(sorted, n, sizeof(*sorted), cpuid_stats_u32_cmp);
+
+    uint32_t distinct = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        if (i == 0 || sorted[i] != sorted[distinct - 1]) sorted[distinct++] = sorted[i];
+    }
+    for (uint32_t i = 0; i < n; i++) {
+        keys[i] = (uint32_t)((uint32_t*)bsearch(&keys[i], sorted, distinct, sizeof(*sorted), cpuid_stats_u32_cmp) - sorted);
+    }
+    free(sorted);
+    return (int)distinct;
+}
+
+static int cpuid_stats_build(CPUID_H(stats) *stats, uint32_t flags, const CPUID_H(topology) *topo) {
+    uint32_t  n       = topo->n_cpus != 0 ? (uint32_t)topo->n_cpus : 1;
+    uint32_t *group[CPUID_STATS_TOTAL] = { NULL };   // group[nivel][bloque]: grupo del bloque
+    int       status  = -1;
+
+    size_t unit   = cpuid_alloc_line_size() * ((flags & CPUID_STATS_LINE_PAIR) ? 2 : 1);
+    size_t bytes  = sizeof(uint64_t) * stats->n_items;
+    stats->stride = (bytes + unit - 1) / unit * unit;
+    stats->memory = malloc(stats->stride * n + unit);
+    stats->cpus   = malloc(sizeof(*stats->cpus) * n);
+    if (stats->memory == NULL || stats->cpus == NULL) goto done;
+    stats->blocks = (unsigned char*)(((uintptr_t)stats->memory + unit - 1) / unit * unit);
+    memset(stats->blocks, 0, stats->stride * n);
+
+    // clave de cada bloque en cada nivel; sin dato, la CPU es su propio grupo
+    uint32_t max_cpu = 0;
+    for (int level = CPUID_STATS_CORE; level < CPUID_STATS_TOTAL; level++) {
+        group[level] = malloc(sizeof(*group[level]) * n);
+        if (group[level] == NULL) goto done;
+    }
+    for (uint32_t b = 0; b < n; b++) {
+        stats->cpus[b] = topo->n_cpus != 0 ? topo->cpus[b].cpu : 0;
+        if (stats->cpus[b] > max_cpu) max_cpu = stats->cpus[b];
+        for (int level = CPUID_STATS_CORE; level < CPUID_STATS_TOTAL; level++) {
+            uint32_t value = topo->n_cpus != 0 ? topo->cpus[b].values[cpuid_stats_fields[level]] : 0;
+            group[level][b] = value != CPUID_TOPO_UNKNOWN ? value : 0x80000000u | stats->cpus[b];
+        }
+    }
+    stats->n_groups[CPUID_STATS_CPU]   = n;
+    stats->n_groups[CPUID_STATS_TOTAL] = 1;
+    for (int level = CPUID_STATS_CORE; level < CPUID_STATS_TOTAL; level++) {
+        int distinct = cpuid_stats_densify(group[level], n);
+        if (distinct < 0) goto done;
+        stats->n_groups[level] = (uint32_t)distinct;
+    }
+
+    // padre de cada grupo: el del primer bloque que lo contiene
+    for (int level = CPUID_STATS_CPU; level < CPUID_STATS_TOTAL; level++) {
+        stats->parent[level] = calloc(stats->n_groups[level], sizeof(*stats->parent[level]));
+        if (stats->parent[level] == NULL) goto done;
+    }
+    for (uint32_t b = n; b-- > 0;) {
+        stats->parent[CPUID_STATS_CPU][b] = group[CPUID_STATS_CORE][b];
+        stats->parent[CPUID_STATS_CORE][group[CPUID_STATS_CORE][b]] = group[CPUID_STATS_L3][b];
+        stats->parent[CPUID_STATS_L3][group[CPUID_STATS_L3][b]]     = group[CPUID_STATS_PACKAGE][b];
+    }
+
+    stats->n_by_cpu = max_cpu + 1;
+    stats->by_cpu   = malloc(sizeof(*stats->by_cpu) * stats->n_by_cpu);
+    if (stats->by_cpu == NULL) goto done;
+    for (uint32_t cpu = 0; cpu < stats->n_by_cpu; cpu++) stats->by_cpu[cpu] = cpu % n;
+    for (uint32_t b = 0; b < n; b++) stats->by_cpu[stats->cpus[b]] = b;
+    status = 0;
+
+done:
+    for (int level = CPUID_STATS_CORE; level < CPUID_STATS_TOTAL; level++) free(group[level]);
+    return status;
+}
+
+int cpuid_stats_init(
+    CPUID_H(stats) *stats, uint32_t n_counters, uint32_t n_histograms, uint32_t n_buckets,
+    uint32_t flags, const CPUID_H(topology) *topo
+) {
+    CPUID_H(snapshot) snapshot;
+    CPUID_H(topology) own_topo = { 0 };
+
+    memset(stats, 0, sizeof(*stats));
+    if (n_histograms != 0 && (n_buckets == 0 || n_buckets > CPUID_STATS_MAX_BUCKETS)) return -1;
+    stats->n_counters   = n_counters;
+    stats->n_histograms = n_histograms;
+    stats->n_buckets    = n_histograms != 0 ? n_buckets : 0;
+    stats->n_items      = n_counters + n_histograms * stats->n_buckets;
+
+    if (topo == NULL) {
+        if (cpuid_snapshot_take(&snapshot, NULL, 0, NULL, 0, 0) < 0) return -1;
+        int status = cpuid_topology_from_cpuid(&own_topo, &snapshot);
+        cpuid_snapshot_free(&snapshot);
+        if (status != 0) return -1;
+        topo = &own_topo;
+    }
+    int status = cpuid_stats_build(stats, flags, topo);
+    cpuid_topology_free(&own_topo);
+    cpuid_current_init();
+    if (status != 0) cpuid_stats_free(stats);
+    return status;
+}
+
+void cpuid_stats_free(CPUID_H(stats) *stats) {
+    free(stats->memory);
+    free(stats->by_cpu);
+    free(stats->cpus);
+    for (int level = 0; level < CPUID_STATS_LEVELS; level++) free(stats->parent[level]);
+    memset(stats, 0, sizeof(*stats));
+}
+
+int cpuid_stats_view_init(CPUID_H(stats_view) *view, const CPUID_H(stats) *stats) {
+    memset(view, 0, sizeof(*view));
+    view->stats = stats;
+    for (int level = 0; level < CPUID_STATS_LEVELS; level++) {
+        size_t n = (size_t)stats->n_groups[level] * stats->n_items;
+        view->values[level] = calloc(n != 0 ? n : 1, sizeof(uint64_t));
+        if (view->values[level] == NULL) {
+            cpuid_stats_view_free(view);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+void cpuid_stats_collect(CPUID_H(stats_view) *view) {
+    const CPUID_H(stats) *stats = view->stats;
+    uint32_t              items = stats->n_items;
+
+    for (uint32_t b = 0; b < stats->n_groups[CPUID_STATS_CPU]; b++) {
+        uint64_t *block = (uint64_t*)(stats->blocks + (size_t)b * stats->stride);
+        uint64_t *row   = &view->values[CPUID_STATS_CPU][(size_t)b * items];
+        for (uint32_t i = 0; i < items; i++) row[i] = cpuid_atomic_load_u64(&block[i]);
+    }
+    // cada nivel se suma a partir del anterior, no desde las CPU
+    for (int level = CPUID_STATS_CORE; level < CPUID_STATS_LEVELS; level++) {
+        memset(view->values[level], 0, sizeof(uint64_t) * stats->n_groups[level] * items);
+        for (uint32_t g = 0; g < stats->n_groups[level - 1]; g++) {
+            const uint64_t *row = &view->values[level - 1][(size_t)g * items];
+            uint64_t       *sum = &view->values[level][(size_t)stats->parent[level - 1][g] * items];
+            for (uint32_t i = 0; i < items; i++) sum[i] += row[i];
+        }
+    }
+}
+
+void cpuid_stats_view_free(CPUID_H(stats_view) *view) {
+    for (int level = 0; level < CPUID_STATS_LEVELS; level++) free(view->values[level]);
+    memset(view, 0, sizeof(*view));
+}
+
+#endif
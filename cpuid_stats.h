@@ -0,0 +1,132 @@
+#ifndef __CPUID_STATS_H__
+#define __CPUID_STATS_H__
+
+/*
+ * Contadores e histogramas por CPU, sumados por nucleo, L3 y paquete.
+ *
+ * Cada CPU tiene su propio bloque de contadores, alineado y con un tamano multiplo de la linea
+ * de cache (cpuid_alloc_line_size, de CPUID.1:EBX.CLFLUSH y de la hoja 4 / 8000001Dh), o de
+ * dos lineas con CPUID_STATS_LINE_PAIR para que el prefetcher de la linea adyacente no arrastre
+ * el bloque de otra CPU. Sumar es una suma atomica relajada en el bloque de la CPU actual
+ * (cpuid_current_cpu), que nadie mas escribe salvo si el hilo migra justo entonces, asi que la
+ * linea no rebota entre nucleos:
+ *
+ *      cpuid_stats_add(&stats, PETICIONES, 1);
+ *      cpuid_stats_record(&stats, LATENCIA_NS, ns);     // cubeta log2(ns)
+ *
+ * cpuid_stats_collect copia los bloques en una vista y los suma subiendo por la jerarquia
+ * (CPU -> nucleo -> L3 -> paquete -> total), sin reservar memoria: en 256 CPU es leer 256
+ * bloques y unas pocas sumas por grupo, de sobra para exportar cada segundo.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "cpuid_alloc.h"
+#include "cpuid_atomic.h"
+#include "cpuid_current.h"
+#include "cpuid_topology.h"
+
+#define CPUID_STATS_MAX_BUCKETS 65      // la cubeta 0 es el valor 0 y la b cubre [2^(b-1), 2^b)
+#define CPUID_STATS_LINE_PAIR   0x1     // bloques de dos lineas (prefetch de la linea adyacente)
+
+typedef enum CPUID_H(stats_level) {
+    CPUID_STATS_CPU = 0,
+    CPUID_STATS_CORE,
+    CPUID_STATS_L3,
+    CPUID_STATS_PACKAGE,
+    CPUID_STATS_TOTAL,
+    CPUID_STATS_LEVELS
+} CPUID_H(stats_level);
+
+typedef struct CPUID_H(stats) {
+    uint32_t       n_counters;
+    uint32_t       n_histograms;
+    uint32_t       n_buckets;
+    uint32_t       n_items;                         // n_counters + n_histograms * n_buckets
+    size_t         stride;                          // bytes de cada bloque
+    unsigned char *blocks;                          // alineado a stride, un bloque por CPU de la topologia
+    void          *memory;
+    uint32_t      *by_cpu;                          // numero de CPU -> bloque
+    uint32_t       n_by_cpu;
+    uint32_t      *cpus;                            // bloque -> numero de CPU
+    uint32_t       n_groups[CPUID_STATS_LEVELS];    // n_groups[CPUID_STATS_CPU] es el numero de bloques
+    uint32_t      *parent[CPUID_STATS_LEVELS];      // grupo -> grupo del nivel siguiente (salvo el total)
+} CPUID_H(stats);
+
+// copia de los contadores sumada por niveles, rellenada por cpuid_stats_collect
+typedef struct CPUID_H(stats_view) {
+    const CPUID_H(stats) *stats;
+    uint64_t             *values[CPUID_STATS_LEVELS];   // values[nivel][grupo * n_items + elemento]
+} CPUID_H(stats_view);
+
+/*
+ * Reserva los bloques, uno por CPU de topo (o de la topologia de CPUID de las CPU del mask de
+ * afinidad si topo es NULL). Las CPU sin nucleo, L3 o paquete conocido forman su propio grupo.
+ * Devuelve 0, o -1 sin memoria o si n_buckets > CPUID_STATS_MAX_BUCKETS.
+ */
+int cpuid_stats_init(
+    CPUID_H(stats) *stats, uint32_t n_counters, uint32_t n_histograms, uint32_t n_buckets,
+    uint32_t flags, const CPUID_H(topology) *topo
+);
+
+void cpuid_stats_free(CPUID_H(stats) *stats);
+
+int  cpuid_stats_view_init(CPUID_H(stats_view) *view, const CPUID_H(stats) *stats);
+
+// copia los bloques y suma los niveles; no reserva memoria
+void cpuid_stats_collect(CPUID_H(stats_view) *view);
+
+void cpuid_stats_view_free(CPUID_H(stats_view) *view);
+
+// bloque de la CPU actual; una CPU que no estaba en la topologia comparte el de otra
+static inline uint64_t *cpuid_stats_block(const CPUID_H(stats) *stats) {
+    uint32_t cpu   = cpuid_current_cpu();
+    uint32_t block = cpu < stats->n_by_cpu ? stats->by_cpu[cpu] : cpu % stats->n_groups[CPUID_STATS_CPU];
+    return (uint64_t*)(stats->blocks + (size_t)block * stats->stride);
+}
+
+// cubeta de un valor en los histogramas: 0 para 0, floor(log2(value)) + 1 para el resto
+static inline uint32_t cpuid_stats_bucket(uint64_t value, uint32_t n_buckets) {
+    uint32_t bucket;
+    if (value == 0) return 0;
+#if defined(_MSC_VER) && !defined(__GNUC__)
+    unsigned long index;
+    #ifdef _WIN64
+        _BitScanReverse64(&index, value);
+    #else
+        if (value >> 32) { _BitScanReverse(&index, (unsigned long)(value >> 32)); index += 32; }
+        else             _BitScanReverse(&index, (unsigned long)value);
+    #endif
+    bucket = (uint32_t)index + 1;
+#else
+    bucket = 64 - (uint32_t)__builtin_clzll(value);
+#endif
+    return bucket < n_buckets ? bucket : n_buckets - 1;
+}
+
+static inline void cpuid_stats_add(const CPUID_H(stats) *stats, uint32_t counter, uint64_t value) {
+    cpuid_atomic_fetch_add_u64(&cpuid_stats_block(stats)[counter], value);
+}
+
+static inline void cpuid_stats_record(const CPUID_H(stats) *stats, uint32_t histogram, uint64_t value) {
+    uint64_t *buckets = cpuid_stats_block(stats) + stats->n_counters + (size_t)histogram * stats->n_buckets;
+    cpuid_atomic_fetch_add_u64(&buckets[cpuid_stats_bucket(value, stats->n_buckets)], 1);
+}
+
+static inline uint64_t cpuid_stats_counter(
+    const CPUID_H(stats_view) *view, CPUID_H(stats_level) level, uint32_t group, uint32_t counter
+) {
+    return view->values[level][(size_t)group * view->stats->n_items + counter];
+}
+
+// las n_buckets cubetas de un histograma
+static inline const uint64_t *cpuid_stats_histogram(
+    const CPUID_H(stats_view) *view, CPUID_H(stats_level) level, uint32_t group, uint32_t histogram
+) {
+    const CPUID_H(stats) *stats = view->stats;
+    return &view->values[level][(size_t)group * stats->n_items + stats->n_counters + (size_t)histogram * stats->n_buckets];
+}
+
+#include "cpuid_stats.c"
+#endif
@@ -0,0 +1,346 @@
+#ifndef __CPUID_TOPOLOGY_C__
+#define __CPUID_TOPOLOGY_C__
+
+#include "cpuid_topology.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CPUID_TOPO_CACHE_INDEXES 16     // cache/index0 .. index15 en sysfs
+
+static const char *const cpuid_topology_field_names[CPUID_TOPO_FIELDS] = {
+    "package", "die", "core", "l2", "l3", "apic_id", "core_type", "l2_kb", "l3_kb",
+};
+
+const char *cpuid_topology_field_name(CPUID_H(topology_field) field) {
+    return (unsigned)field < CPUID_TOPO_FIELDS ? cpuid_topology_field_names[field] : NULL;
+}
+
+int cpuid_topology_field_find(const char *name) {
+    for (int f = 0; f < CPUID_TOPO_FIELDS; f++) {
+        if (strcmp(cpuid_topology_field_names[f], name) == 0) return f;
+    }
+    return -1;
+}
+
+static int cpuid_topology_alloc(CPUID_H(topology) *topo, size_t n_cpus) {
+    topo->n_cpus = n_cpus;
+    topo->cpus   = malloc(sizeof(*topo->cpus) * (n_cpus != 0 ? n_cpus : 1));
+    if (topo->cpus == NULL) {
+        topo->n_cpus = 0;
+        return -1;
+    }
+    for (size_t i = 0; i < n_cpus; i++) {
+        for (int f = 0; f < CPUID_TOPO_FIELDS; f++) topo->cpus[i].values[f] = CPUID_TOPO_UNKNOWN;
+    }
+    return 0;
+}
+
+// bits necesarios para numerar count elementos (log2 redondeado hacia arriba)
+static inline uint32_t cpuid_topology_bits(uint32_t count) {
+    uint32_t bits = 0;
+    while (bits < 32 && (1ull << bits) < count) bits++;
+    return bits;
+}
+
+static inline uint32_t cpuid_topology_shift(uint32_t apic_id, uint32_t shift) {
+    return shift < 32 ? apic_id >> shift : 0;
+}
+
+// topologia de un bloque de registros de una CPU (el de un snapshot)
+static void cpuid_topology_decode(const CPUID_H(record) *block, size_t n, CPUID_H(topology_cpu) *t) {
+    uint32_t *v = t->values;
+    uint32_t  topo_leaf = 0;                    // 1Fh si tiene niveles, si no 0Bh, si no 0
+    uint32_t  apic_id = 0, legacy_id = 0;
+    uint32_t  smt_shift = 0, die_shift = CPUID_TOPO_UNKNOWN, package_shift = 0, previous_shift = 0;
+    uint32_t  legacy_threads = 1, legacy_cores = 0, amd_core_bits = 0, amd_smt = 0;
+    uint32_t  share[4] = { 0 };                 // procesadores que comparten la L2 y la L3
+    uint32_t  ext_l2_kb = 0, ext_l3_kb = 0;
+    int       hybrid = 0;
+
+    if (n == 0 || block[0].status != CPUID_RECORD_OK) return;
+
+    for (size_t j = 0; j < n; j++) {
+        const CPUID_H(record) *r = &block[j];
+        if ((r->leaf == 0x0B || r->leaf == 0x1F) && r->subleaf == 0 && ((r->ecx >> 8) & 0xff) != 0) {
+            if (topo_leaf != 0x1F) topo_leaf = r->leaf;
+        }
+    }
+
+    for (size_t j = 0; j < n; j++) {
+        const CPUID_H(record) *r = &block[j];
+        switch (r->leaf) {
+            case CPUID_GETFEATURES:
+                legacy_id = r->ebx >> 24;
+                if ((r->edx >> 28) & 1) legacy_threads = (r->ebx >> 16) & 0xff;
+                break;
+
+            case 0x04:
+            case 0x8000001D: {
+                uint32_t type  = r->eax & 0x1f;
+                uint32_t level = (r->eax >> 5) & 0x7;
+                if (r->leaf == 0x04 && r->subleaf == 0 && type != 0) legacy_cores = (r->eax >> 26) + 1;
+                if (type == 0 || type == 2 || level < 2 || level > 3 || share[level] != 0) break;
+                share[level] = ((r->eax >> 14) & 0xfff) + 1;
+                v[level == 2 ? CPUID_TOPO_L2_KB : CPUID_TOPO_L3_KB] = cpuid_features_cache_kb(r);
+                break;
+            }
+
+            case 0x07:
+                if (r->subleaf == 0) hybrid = (int)((r->edx >> 15) & 1);
+                break;
+
+            case 0x0B:
+            case 0x1F: {
+                uint32_t type  = (r->ecx >> 8) & 0xff;
+                uint32_t shift = r->eax & 0x1f;
+                if (r->leaf != topo_leaf || type == 0) break;
+                // cada nivel da los bits que hay que quitar al APIC ID para llegar al siguiente
+                apic_id = r->edx;
+                if (type == 1) smt_shift = shift;
+                if (type == 5) die_shift = previous_shift;
+                previous_shift = package_shift = shift;
+                break;
+            }
+
+            case 0x1A:
+                if (hybrid && r->eax != 0) v[CPUID_TOPO_CORE_TYPE] = r->eax >> 24;
+                break;
+
+            case 0x80000006:
+                ext_l2_kb = r->ecx >> 16;
+                ext_l3_kb = (r->edx >> 18) * 512;
+                break;
+
+            case 0x80000008:
+                amd_core_bits = (r->ecx >> 12) & 0xf;
+                break;
+
+            case 0x8000001E:
+                amd_smt = ((r->ebx >> 8) & 0xff) + 1;
+                break;
+        }
+    }
+
+    if (topo_leaf == 0) {
+        // sin hojas de topologia: HTT y nucleos por paquete de la hoja 4 (Intel) o 80000008h (AMD)
+        apic_id       = legacy_id;
+        package_shift = amd_core_bits != 0 ? amd_core_bits : cpuid_topology_bits(legacy_threads);
+        if (amd_smt != 0) smt_shift = cpuid_topology_bits(amd_smt);
+        else if (legacy_cores != 0) smt_shift = cpuid_topology_bits(legacy_threads / legacy_cores);
+    }
+    if (die_shift == CPUID_TOPO_UNKNOWN) die_shift = package_shift;
+
+    v[CPUID_TOPO_APIC_ID] = apic_id;
+    v[CPUID_TOPO_PACKAGE] = cpuid_topology_shift(apic_id, package_shift);
+    v[CPUID_TOPO_DIE]     = cpuid_topology_shift(apic_id, die_shift);
+    v[CPUID_TOPO_CORE]    = cpuid_topology_shift(apic_id, smt_shift);
+    if (share[2] != 0) v[CPUID_TOPO_L2] = cpuid_topology_shift(apic_id, cpuid_topology_bits(share[2]));
+    if (share[3] != 0) v[CPUID_TOPO_L3] = cpuid_topology_shift(apic_id, cpuid_topology_bits(share[3]));
+    if (v[CPUID_TOPO_L2_KB] == CPUID_TOPO_UNKNOWN && ext_l2_kb != 0) v[CPUID_TOPO_L2_KB] = ext_l2_kb;
+    if (v[CPUID_TOPO_L3_KB] == CPUID_TOPO_UNKNOWN && ext_l3_kb != 0) v[CPUID_TOPO_L3_KB] = ext_l3_kb;
+}
+
+int cpuid_topology_from_cpuid(CPUID_H(topology) *topo, const CPUID_H(snapshot) *snapshot) {
+    if (cpuid_topology_alloc(topo, snapshot->n_cpus) != 0) return -1;
+    for (size_t i = 0; i < snapshot->n_cpus; i++) {
+        const CPUID_H(record) *block = snapshot->records + i * snapshot->n_leaves;
+        topo->cpus[i].cpu = snapshot->n_leaves != 0 ? block->cpu : (uint32_t)i;
+        cpuid_topology_decode(block, snapshot->n_leaves, &topo->cpus[i]);
+    }
+    return 0;
+}
+
+// lee un fichero pequeno de sysfs; devuelve 0, o -1 si no existe
+static int cpuid_topology_read(char *text, size_t cap, const char *format, ...) {
+    char    path[CPUID_WATCH_PATH_MAX];
+    va_list args;
+
+    va_start(args, format);
+    int length = vsnprintf(path, sizeof(path), format, args);
+    va_end(args);
+    if (length < 0 || (size_t)length >= sizeof(path)) return -1;
+
+    FILE *f = fopen(path, "r");
+    if (f == NULL) return -1;
+    size_t n = fread(text, 1, cap - 1, f);
+    fclose(f);
+    text[n] = '\0';
+    text[strcspn(text, "\n")] = '\0';
+    return 0;
+}
+
+// primera CPU de un cpulist ("4-7,12" -> 4): identifica el grupo
+static uint32_t cpuid_topology_first(const char *list) {
+    CPUID_H(cpumask) mask;
+    uint32_t         first;
+    if (cpuid_cpumask_parse(list, &mask) != 0 || cpuid_cpumask_list(&mask, &first, 1) == 0) return CPUID_TOPO_UNKNOWN;
+    return first;
+}
+
+int cpuid_topology_from_sysfs(CPUID_H(topology) *topo, const char *root, const uint32_t *cpus, size_t n_cpus) {
+    CPUID_H(cpumask)   core_mask, atom_mask;
+    char               text[CPUID_WATCH_TEXT_MAX], line[256];
+    uint32_t          *apic_ids = NULL;
+
+    if (root == NULL) root = "";
+    if (cpuid_topology_alloc(topo, n_cpus) != 0) return -1;
+
+    // procesadores hibridos: cada tipo de nucleo tiene su PMU con la lista de sus CPU
+    int has_core = cpuid_topology_read(text, sizeof(text), "%s/sys/devices/cpu_core/cpus", root) == 0
+        && cpuid_cpumask_parse(text, &core_mask) == 0;
+    int has_atom = cpuid_topology_read(text, sizeof(text), "%s/sys/devices/cpu_atom/cpus", root) == 0
+        && cpuid_cpumask_parse(text, &atom_mask) == 0;
+
+    // "processor : N" seguido mas abajo de "apicid : M"
+    snprintf(text, sizeof(text), "%s/proc/cpuinfo", root);
+    FILE *cpuinfo = fopen(text, "r");
+    if (cpuinfo != NULL) {
+        apic_ids = malloc(sizeof(*apic_ids) * CPUID_CPUMASK_MAX_CPUS);
+        if (apic_ids != NULL) {
+            uint32_t processor = CPUID_TOPO_UNKNOWN;
+            for (uint32_t c = 0; c < CPUID_CPUMASK_MAX_CPUS; c++) apic_ids[c] = CPUID_TOPO_UNKNOWN;
+            while (fgets(line, sizeof(line), cpuinfo) != NULL) {
+                unsigned value;
+                if      (sscanf(line, "processor : %u", &value) == 1) processor = value;
+                else if (sscanf(line, "apicid : %u", &value) == 1 && processor < CPUID_CPUMASK_MAX_CPUS) apic_ids[processor] = value;
+            }
+        }
+        fclose(cpuinfo);
+    }
+
+    for (size_t i = 0; i < n_cpus; i++) {
+        CPUID_H(topology_cpu) *t   = &topo->cpus[i];
+        uint32_t               cpu = cpus[i];
+        char                   dir[CPUID_WATCH_PATH_MAX];
+        t->cpu = cpu;
+        if (snprintf(dir, sizeof(dir), "%s/sys/devices/system/cpu/cpu%u/", root, (unsigned)cpu) >= (int)sizeof(dir)) continue;
+
+        // nombres actuales y, si no existen, los de kernels anteriores a 5.x
+        if (cpuid_topology_read(text, sizeof(text), "%stopology/package_cpus_list", dir) == 0
+            || cpuid_topology_read(text, sizeof(text), "%stopology/core_siblings_list", dir) == 0) {
+            t->values[CPUID_TOPO_PACKAGE] = cpuid_topology_first(text);
+        }
+        if (cpuid_topology_read(text, sizeof(text), "%stopology/die_cpus_list", dir) == 0) {
+            t->values[CPUID_TOPO_DIE] = cpuid_topology_first(text);
+        }
+        if (cpuid_topology_read(text, sizeof(text), "%stopology/core_cpus_list", dir) == 0
+            || cpuid_topology_read(text, sizeof(text), "%stopology/thread_siblings_list", dir) == 0) {
+            t->values[CPUID_TOPO_CORE] = cpuid_topology_first(text);
+        }
+
+        for (int index = 0; index < CPUID_TOPO_CACHE_INDEXES; index++) {
+            unsigned level, kb;
+            if (cpuid_topology_read(text, sizeof(text), "%scache/index%d/level", dir, index) != 0) break;
+            level = (unsigned)strtoul(text, NULL, 10);
+            if (level < 2 || level > 3) continue;
+            if (cpuid_topology_read(text, sizeof(text), "%scache/index%d/type", dir, index) != 0
+                || strcmp(text, "Instruction") == 0) continue;
+
+            CPUID_H(topology_field) group = level == 2 ? CPUID_TOPO_L2 : CPUID_TOPO_L3;
+            CPUID_H(topology_field) size  = level == 2 ? CPUID_TOPO_L2_KB : CPUID_TOPO_L3_KB;
+            if (t->values[group] != CPUID_TOPO_UNKNOWN) continue;
+            if (cpuid_topology_read(text, sizeof(text), "%scache/index%d/shared_cpu_list", dir, index) == 0) {
+                t->values[group] = cpuid_topology_first(text);
+            }
+            // "2048K"; algunos kernels escriben "2M"
+            if (cpuid_topology_read(text, sizeof(text), "%scache/index%d/size", dir, index) == 0
+                && sscanf(text, "%u", &kb) == 1) {
+                t->values[size] = strchr(text, 'M') != NULL ? kb * 1024 : kb;
+            }
+        }
+
+        if (has_core && cpuid_cpumask_test(&core_mask, cpu)) t->values[CPUID_TOPO_CORE_TYPE] = 0x40;
+        if (has_atom && cpuid_cpumask_test(&atom_mask, cpu)) t->values[CPUID_TOPO_CORE_TYPE] = 0x20;
+        if (apic_ids != NULL && cpu < CPUID_CPUMASK_MAX_CPUS) t->values[CPUID_TOPO_APIC_ID] = apic_ids[cpu];
+    }
+    free(apic_ids);
+    return 0;
+}
+
+/*
+ * Primera CPU (entre las que ambas fuentes conocen) del grupo de la CPU i segun topo.
+ * Cuadratico en el numero de CPU, que se queda en unos millones de comparaciones.
+ */
+static uint32_t cpuid_topology_leader(
+    const CPUID_H(topology) *topo, const CPUID_H(topology) *other, CPUID_H(topology_field) field, size_t i
+) {
+    uint32_t group = topo->cpus[i].values[field];
+    for (size_t k = 0; k < i; k++) {
+        if (topo->cpus[k].values[field] == group && other->cpus[k].values[field] != CPUID_TOPO_UNKNOWN) {
+            return topo->cpus[k].cpu;
+        }
+    }
+    return topo->cpus[i].cpu;
+}
+
+size_t cpuid_topology_compare(
+    const CPUID_H(topology) *from_cpuid, const CPUID_H(topology) *from_sysfs,
+    CPUID_H(topology_mismatch) *mismatches, size_t max
+) {
+    size_t total = 0;
+    size_t n     = from_cpuid->n_cpus < from_sysfs->n_cpus ? from_cpuid->n_cpus : from_sysfs->n_cpus;
+
+    for (size_t i = 0; i < n; i++) {
+        const CPUID_H(topology_cpu) *a = &from_cpuid->cpus[i];
+        const CPUID_H(topology_cpu) *b = &from_sysfs->cpus[i];
+        if (a->cpu != b->cpu) continue;
+
+        for (int f = 0; f < CPUID_TOPO_FIELDS; f++) {
+            uint32_t va = a->values[f], vb = b->values[f];
+            if (va == CPUID_TOPO_UNKNOWN || vb == CPUID_TOPO_UNKNOWN) continue;
+            if (f < CPUID_TOPO_GROUPS) {
+                va = cpuid_topology_leader(from_cpuid, from_sysfs, (CPUID_H(topology_field))f, i);
+                vb = cpuid_topology_leader(from_sysfs, from_cpuid, (CPUID_H(topology_field))f, i);
+            }
+            if (va == vb) continue;
+            if (total < max) {
+                mismatches[total].cpu   = a->cpu;
+                mismatches[total].field = (CPUID_H(topology_field))f;
+                mismatches[total].cpuid = va;
+                mismatches[total].sysfs = vb;
+            }
+            total++;
+        }
+    }
+    return total;
+}
+
+int cpuid_topology_merge(
+    CPUID_H(topology) *out,
+    const CPUID_H(topology) *from_cpuid, const CPUID_H(topology) *from_sysfs,
+    const CPUID_H(topology_source) trusted[CPUID_TOPO_FIELDS]
+) {
+    memset(out, 0, sizeof(*out));
+    if (from_cpuid->n_cpus != from_sysfs->n_cpus) return -1;
+    for (size_t i = 0; i < from_cpuid->n_cpus; i++) {
+        if (from_cpuid->cpus[i].cpu != from_sysfs->cpus[i].cpu) return -1;
+    }
+    if (cpuid_topology_alloc(out, from_cpuid->n_cpus) != 0) return -1;
+
+    for (size_t i = 0; i < out->n_cpus; i++) out->cpus[i].cpu = from_cpuid->cpus[i].cpu;
+
+    /*
+     * La fuente se elige por campo y no por CPU: los identificadores de grupo de una fuente
+     * y de otra no se pueden mezclar.
+     */
+    for (int f = 0; f < CPUID_TOPO_FIELDS; f++) {
+        const CPUID_H(topology) *source = trusted != NULL && trusted[f] == CPUID_TOPO_FROM_SYSFS ? from_sysfs : from_cpuid;
+        const CPUID_H(topology) *other  = source == from_sysfs ? from_cpuid : from_sysfs;
+        size_t known = 0;
+        for (size_t i = 0; i < out->n_cpus; i++) known += source->cpus[i].values[f] != CPUID_TOPO_UNKNOWN;
+        if (known == 0) source = other;
+        for (size_t i = 0; i < out->n_cpus; i++) out->cpus[i].values[f] = source->cpus[i].values[f];
+    }
+    return 0;
+}
+
+void cpuid_topology_free(CPUID_H(topology) *topo) {
+    free(topo->cpus);
+    topo->cpus   = NULL;
+    topo->n_cpus = 0;
+}
+
+#endif
@@ -0,0 +1,113 @@
+#ifndef __CPUID_TOPOLOGY_H__
+#define __CPUID_TOPOLOGY_H__
+
+/*
+ * Topologia de las CPU segun CPUID y segun Linux, y las diferencias entre las dos.
+ *
+ * Desde CPUID se parte del x2APIC ID de cada CPU y de los desplazamientos de las hojas 1Fh
+ * (o 0Bh, o en su defecto 1, 4, 80000008h y 8000001Eh): los hilos de un mismo nucleo tienen
+ * el mismo apic_id >> desplazamiento de SMT, los de un paquete el mismo apic_id >> desplazamiento
+ * del paquete, y las caches (hojas 4 y 8000001Dh) se comparten entre los que tienen el mismo
+ * apic_id >> log2(procesadores que la comparten). El tipo de nucleo sale de la hoja 1Ah.
+ *
+ * Desde sysfs se leen RAIZ/sys/devices/system/cpu/cpuN/topology/{package,die,core}_cpus_list,
+ * cpuN/cache/indexM/{level,type,size,shared_cpu_list}, RAIZ/sys/devices/cpu_{core,atom}/cpus
+ * (tipo de nucleo en procesadores hibridos) y el apicid de RAIZ/proc/cpuinfo.
+ *
+ * Los identificadores de grupo de una fuente y otra no se parecen (uno es un APIC ID
+ * desplazado, otro la primera CPU del grupo), asi que los campos de grupo se comparan como
+ * particiones: hay diferencia si dos CPU estan en el mismo grupo segun una fuente y no segun
+ * la otra. Es lo que pasa con los hipervisores que exponen una topologia plana que no se
+ * corresponde con la del host (por ejemplo, CPUID dice que dos vCPU son hilos del mismo
+ * nucleo y Linux las trata como nucleos distintos).
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "cpuid_features.h"
+#include "cpuid_watch.h"
+
+#define CPUID_TOPO_UNKNOWN UINT32_MAX
+
+typedef enum CPUID_H(topology_field) {
+    // grupos: CPU del mismo paquete, die, nucleo, L2 o L3
+    CPUID_TOPO_PACKAGE = 0,
+    CPUID_TOPO_DIE,
+    CPUID_TOPO_CORE,
+    CPUID_TOPO_L2,
+    CPUID_TOPO_L3,
+    // valores
+    CPUID_TOPO_APIC_ID,
+    CPUID_TOPO_CORE_TYPE,       // 20h Atom (nucleo E), 40h Core (nucleo P), solo en hibridos
+    CPUID_TOPO_L2_KB,
+    CPUID_TOPO_L3_KB,
+    CPUID_TOPO_FIELDS
+} CPUID_H(topology_field);
+
+#define CPUID_TOPO_GROUPS (CPUID_TOPO_L3 + 1)
+
+typedef enum CPUID_H(topology_source) {
+    CPUID_TOPO_FROM_CPUID = 0,
+    CPUID_TOPO_FROM_SYSFS = 1,
+} CPUID_H(topology_source);
+
+typedef struct CPUID_H(topology_cpu) {
+    uint32_t cpu;
+    uint32_t values[CPUID_TOPO_FIELDS];     // CPUID_TOPO_UNKNOWN si la fuente no lo da
+} CPUID_H(topology_cpu);
+
+typedef struct CPUID_H(topology) {
+    CPUID_H(topology_cpu) *cpus;
+    size_t                 n_cpus;
+} CPUID_H(topology);
+
+typedef struct CPUID_H(topology_mismatch) {
+    uint32_t                cpu;
+    CPUID_H(topology_field) field;
+    // valores de cada fuente; en los grupos, la primera CPU del grupo de cpu segun esa fuente
+    uint32_t                cpuid;
+    uint32_t                sysfs;
+} CPUID_H(topology_mismatch);
+
+// nombre del campo ("package", "l3_kb", ...) y busqueda por nombre (-1 si no existe)
+const char *cpuid_topology_field_name(CPUID_H(topology_field) field);
+int cpuid_topology_field_find(const char *name);
+
+/*
+ * Topologia segun CPUID de las CPU del snapshot (en su orden). Las CPU en las que no se pudo
+ * fijar un hilo quedan con todos los campos desconocidos. Devuelve 0, o -1 sin memoria.
+ */
+int cpuid_topology_from_cpuid(CPUID_H(topology) *topo, const CPUID_H(snapshot) *snapshot);
+
+/*
+ * Topologia segun sysfs de las CPU indicadas (en ese orden), con las rutas bajo root
+ * (NULL o "" para las del sistema). Devuelve 0, o -1 sin memoria.
+ */
+int cpuid_topology_from_sysfs(CPUID_H(topology) *topo, const char *root, const uint32_t *cpus, size_t n_cpus);
+
+/*
+ * Diferencias entre las dos topologias (con las mismas CPU en el mismo orden). Escribe como
+ * maximo max diferencias y devuelve el total. Los campos desconocidos en alguna de las dos
+ * fuentes no cuentan.
+ */
+size_t cpuid_topology_compare(
+    const CPUID_H(topology) *from_cpuid, const CPUID_H(topology) *from_sysfs,
+    CPUID_H(topology_mismatch) *mismatches, size_t max
+);
+
+/*
+ * Topologia con cada campo de la fuente de confianza que indica trusted[campo] (o de la otra
+ * si esa no lo da en ninguna CPU). trusted puede ser NULL para usar CPUID en todos. Devuelve
+ * 0, o -1 sin memoria o si las dos topologias no tienen las mismas CPU.
+ */
+int cpuid_topology_merge(
+    CPUID_H(topology) *out,
+    const CPUID_H(topology) *from_cpuid, const CPUID_H(topology) *from_sysfs,
+    const CPUID_H(topology_source) trusted[CPUID_TOPO_FIELDS]
+);
+
+void cpuid_topology_free(CPUID_H(topology) *topo);
+
+#include "cpuid_topology.c"
+#endif
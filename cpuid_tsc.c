@@ -0,0 +1,61 @@
+#ifndef __CPUID_TSC_C__
+#define __CPUID_TSC_C__
+
+#include "cpuid_tsc.h"
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <time.h>
+#endif
+
+#define CPUID_TSC_SAMPLE_TRIES  3
+#define CPUID_TSC_SAMPLE_GAP_NS 20000   // hueco maximo entre las dos lecturas del reloj
+
+uint64_t cpuid_tsc_clock_ns(void) {
+#ifdef _WIN32
+    LARGE_INTEGER frequency, counter;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return (uint64_t)((double)counter.QuadPart * 1e9 / (double)frequency.QuadPart);
+#else
+    struct timespec ts;
+    #ifdef CLOCK_MONOTONIC_RAW
+    // sin los ajustes de NTP, que moverian el ritmo medido hasta 500 ppm
+    clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+    #else
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    #endif
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+void cpuid_tsc_sample(uint64_t *tsc, uint64_t *ns) {
+    for (int i = 0; i < CPUID_TSC_SAMPLE_TRIES; i++) {
+        uint64_t before = cpuid_tsc_clock_ns();
+        *tsc = cpuid_tsc_read();
+        uint64_t after = cpuid_tsc_clock_ns();
+        *ns = before + (after - before) / 2;
+        if (after - before <= CPUID_TSC_SAMPLE_GAP_NS) return;
+    }
+}
+
+double cpuid_tsc_hz(unsigned window_ms) {
+    uint64_t tsc0, ns0, tsc1, ns1;
+
+    cpuid_tsc_sample(&tsc0, &ns0);
+    do {
+        cpuid_tsc_sample(&tsc1, &ns1);
+    } while (ns1 - ns0 < (uint64_t)(window_ms != 0 ? window_ms : 1) * 1000000);
+    return (double)(tsc1 - tsc0) * 1e9 / (double)(ns1 - ns0);
+}
+
+int cpuid_tsc_invariant(void) {
+    uint32_t eax, ebx, ecx, edx;
+    call_cpuid(0x80000000, 0, &eax, &ebx, &ecx, &edx);
+    if (eax < 0x80000007) return 0;
+    call_cpuid(0x80000007, 0, &eax, &ebx, &ecx, &edx);
+    return (edx >> 8) & 1;
+}
+
+#endif
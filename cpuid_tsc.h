@@ -0,0 +1,54 @@
+#ifndef __CPUID_TSC_H__
+#define __CPUID_TSC_H__
+
+/*
+ * Lectura y calibrado del TSC.
+ *
+ * cpuid_tsc_read es un RDTSC sin serializar, para cronometrar bucles de miles de iteraciones
+ * (no sirve para medir unas pocas instrucciones). El ritmo del TSC se mide frente al reloj
+ * monotono del sistema (CLOCK_MONOTONIC_RAW en Linux, QueryPerformanceCounter en Windows):
+ *
+ *      double   hz    = cpuid_tsc_hz(100);
+ *      uint64_t begin = cpuid_tsc_read();
+ *      ...
+ *      double   ns    = (double)(cpuid_tsc_read() - begin) * 1e9 / hz;
+ *
+ * Solo tiene sentido si el TSC es invariante (cpuid_tsc_invariant): si no, su ritmo cambia con
+ * la frecuencia del nucleo.
+ */
+
+#include <stdint.h>
+
+#include "cpuid.h"
+
+#ifdef _MSC_VER
+    #include <intrin.h>
+#endif
+
+static inline uint64_t cpuid_tsc_read(void) {
+#ifdef _MSC_VER
+    return __rdtsc();
+#else
+    uint32_t lo, hi;
+    __asm__ volatile ("rdtsc" : "=a" (lo), "=d" (hi));
+    return ((uint64_t)hi << 32) | lo;
+#endif
+}
+
+// nanosegundos del reloj monotono del sistema, sin los ajustes de NTP donde se puede
+uint64_t cpuid_tsc_clock_ns(void);
+
+/*
+ * TSC y reloj leidos juntos: si el hilo se expulsa entre las dos lecturas la pareja no vale,
+ * asi que se lee el reloj antes y despues y se repite si hay demasiado hueco.
+ */
+void     cpuid_tsc_sample(uint64_t *tsc, uint64_t *ns);
+
+// ritmo del TSC en Hz, medido durante window_ms milisegundos (esperando activamente)
+double   cpuid_tsc_hz(unsigned window_ms);
+
+// distinto de 0 si el TSC es invariante (CPUID.80000007h:EDX[8])
+int      cpuid_tsc_invariant(void);
+
+#include "cpuid_tsc.c"
+#endif
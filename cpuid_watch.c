@@ -0,0 +1,339 @@
+#ifndef __CPUID_WATCH_C__
+#define __CPUID_WATCH_C__
+
+#include "cpuid_watch.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#define CPUID_WATCH_INOTIFY 1
+#define CPUID_WATCH_EVENTS  (IN_MODIFY | IN_CLOSE_WRITE | IN_CREATE | IN_MOVED_TO | IN_DELETE)
+#endif
+
+#define CPUID_WATCH_TEXT_MAX 8192   // un cpulist de 4096 CPU sueltas no cabe, pero no existe
+
+static int cpuid_watch_digit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+int cpuid_cpumask_parse(const char *text, CPUID_H(cpumask) *mask) {
+    const char *p = text;
+
+    memset(mask, 0, sizeof(*mask));
+    while (*p == ' ' || *p == '\t') p++;
+    while (*p != '\0' && *p != '\n') {
+        char         *end;
+        unsigned long first, last;
+
+        if (!cpuid_watch_digit(*p)) goto bad;
+        first = last = strtoul(p, &end, 10);
+        p = end;
+        if (*p == '-') {
+            if (!cpuid_watch_digit(*++p)) goto bad;
+            last = strtoul(p, &end, 10);
+            p = end;
+        }
+        if (first > last || last >= CPUID_CPUMASK_MAX_CPUS) goto bad;
+        for (unsigned long cpu = first; cpu <= last; cpu++) mask->bits[cpu / 64] |= 1ull << (cpu % 64);
+
+        if (*p == ',') p++;
+        else break;
+    }
+    while (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n') p++;
+    if (*p == '\0') return 0;
+
+bad:
+    memset(mask, 0, sizeof(*mask));
+    return -1;
+}
+
+size_t cpuid_cpumask_list(const CPUID_H(cpumask) *mask, uint32_t *cpus, size_t max) {
+    size_t total = 0;
+    for (uint32_t w = 0; w < CPUID_CPUMASK_MAX_CPUS / 64; w++) {
+        uint64_t bits = mask->bits[w];
+        for (uint32_t b = 0; bits != 0; b++, bits >>= 1) {
+            if (!(bits & 1)) continue;
+            if (total < max) cpus[total] = w * 64 + b;
+            total++;
+        }
+    }
+    return total;
+}
+
+/*
+ * Devuelve 0, -1 si no se pudo leer o no es una lista valida, o 1 si esta vacio: un fichero a
+ * medio escribir no dice que no haya CPU, asi que quien llama lo toma como "sin cambios".
+ */
+static int cpuid_watch_read_mask(const char *path, CPUID_H(cpumask) *mask) {
+    char   text[CPUID_WATCH_TEXT_MAX];
+    FILE  *f = fopen(path, "r");
+    if (f == NULL) return -1;
+    size_t n = fread(text, 1, sizeof(text) - 1, f);
+    fclose(f);
+    text[n] = '\0';
+    if (text[strspn(text, " \t\r\n")] == '\0') return 1;
+    return cpuid_cpumask_parse(text, mask);
+}
+
+static int cpuid_watch_exists(const char *path) {
+    FILE *f = fopen(path, "r");
+    if (f == NULL) return 0;
+    fclose(f);
+    return 1;
+}
+
+/*
+ * Cgroup del proceso para un controlador segun RAIZ/proc/self/cgroup: en base el directorio
+ * donde esta montada su jerarquia (RAIZ/sys/fs/cgroup en v2, RAIZ/sys/fs/cgroup/cpu,cpuacct
+ * en v1) y en group la ruta del cgroup dentro de ella ("" en la raiz). Con jerarquias mixtas
+ * manda la de v1 que tiene el controlador. Devuelve 1 (v1), 2 (v2) o 0 si no lo encuentra.
+ */
+static int cpuid_watch_cgroup(
+    const char *root, const char *controller, char base[CPUID_WATCH_PATH_MAX], char group[CPUID_WATCH_PATH_MAX]
+) {
+    char   path[CPUID_WATCH_PATH_MAX], line[CPUID_WATCH_PATH_MAX];
+    size_t length  = strlen(controller);
+    int    version = 0;
+
+    if (snprintf(path, sizeof(path), "%s/proc/self/cgroup", root) >= (int)sizeof(path)) return 0;
+    FILE *f = fopen(path, "r");
+    if (f == NULL) return 0;
+    // "0::/ruta" en cgroup v2, "N:cpu,cpuacct:/ruta" en cgroup v1
+    while (version != 1 && fgets(line, sizeof(line), f) != NULL) {
+        char *controllers = strchr(line, ':');
+        char *group_path  = controllers != NULL ? strchr(controllers + 1, ':') : NULL;
+        int   match       = 0;
+        if (group_path == NULL) continue;
+        *controllers++ = '\0';
+        *group_path++  = '\0';
+        group_path[strcspn(group_path, "\n")] = '\0';
+
+        if (strcmp(line, "0") == 0 && controllers[0] == '\0') {
+            match = 2;
+        } else {
+            for (char *c = controllers; *c != '\0'; c += strcspn(c, ",")) {
+                if (*c == ',') c++;
+                if (strncmp(c, controller, length) == 0 && (c[length] == ',' || c[length] == '\0')) match = 1;
+            }
+        }
+        if (match == 0) continue;
+        int n = match == 1 ? snprintf(base, CPUID_WATCH_PATH_MAX, "%s/sys/fs/cgroup/%s", root, controllers)
+                           : snprintf(base, CPUID_WATCH_PATH_MAX, "%s/sys/fs/cgroup", root);
+        if (n >= CPUID_WATCH_PATH_MAX) continue;
+        snprintf(group, CPUID_WATCH_PATH_MAX, "%s", strcmp(group_path, "/") == 0 ? "" : group_path);
+        version = match;
+    }
+    fclose(f);
+    return version;
+}
+
+/*
+ * Fichero de cpuset del cgroup del proceso. Si el cgroup no tiene el controlador cpuset
+ * activo (cgroup v2 sin "+cpuset" en el padre) el fichero no existe y se usa el del primer
+ * antecesor que lo tenga.
+ */
+static void cpuid_watch_cpuset_path(const char *root, char *out, size_t cap) {
+    char path[CPUID_WATCH_PATH_MAX], base[CPUID_WATCH_PATH_MAX], group[CPUID_WATCH_PATH_MAX];
+
+    out[0] = '\0';
+    int version = cpuid_watch_cgroup(root, "cpuset", base, group);
+    if (version == 0) return;
+    for (;;) {
+        int n = snprintf(path, sizeof(path), "%s%s/%s", base, group,
+            version == 1 ? "cpuset.effective_cpus" : "cpuset.cpus.effective");
+        if (n < (int)sizeof(path) && cpuid_watch_exists(path)) {
+            snprintf(out, cap, "%s", path);
+            return;
+        }
+        char *slash = strrchr(group, '/');
+        if (slash == NULL) return;
+        *slash = '\0';
+    }
+}
+
+#ifdef CPUID_WATCH_INOTIFY
+// se vigila el directorio y no el fichero para no perder la vigilancia si se sustituye con rename
+static void cpuid_watch_add(CPUID_H(watch) *watch, const char *file) {
+    char  dir[CPUID_WATCH_PATH_MAX];
+    if (watch->inotify_fd < 0 || file[0] == '\0') return;
+    snprintf(dir, sizeof(dir), "%s", file);
+    char *slash = strrchr(dir, '/');
+    if (slash != NULL) *slash = '\0';
+    inotify_add_watch(watch->inotify_fd, dir[0] != '\0' ? dir : "/", CPUID_WATCH_EVENTS);
+}
+#endif
+
+/*
+ * CPU conectadas y dentro del cpuset; tambien sigue al proceso si se mueve de cgroup. Devuelve
+ * 0, -1 si no se pudo leer online o 1 si alguno de los dos ficheros estaba vacio.
+ */
+static int cpuid_watch_read_usable(CPUID_H(watch) *watch, CPUID_H(cpumask) *usable) {
+    char             cpuset_path[CPUID_WATCH_PATH_MAX];
+    CPUID_H(cpumask) allowed;
+
+    int status = cpuid_watch_read_mask(watch->online_path, usable);
+    if (status != 0) return status;
+
+    cpuid_watch_cpuset_path(watch->root, cpuset_path, sizeof(cpuset_path));
+    if (strcmp(cpuset_path, watch->cpuset_path) != 0) {
+        memcpy(watch->cpuset_path, cpuset_path, sizeof(cpuset_path));
+#ifdef CPUID_WATCH_INOTIFY
+        cpuid_watch_add(watch, watch->cpuset_path);
+#endif
+    }
+    // un cgroup que desaparece entre las dos lecturas no limita nada
+    if (watch->cpuset_path[0] != '\0') {
+        status = cpuid_watch_read_mask(watch->cpuset_path, &allowed);
+        if (status == 1) return 1;
+        if (status == 0) {
+            for (size_t w = 0; w < CPUID_CPUMASK_MAX_CPUS / 64; w++) usable->bits[w] &= allowed.bits[w];
+        }
+    }
+    return 0;
+}
+
+int cpuid_watch_init(CPUID_H(watch) *watch, const char *root, CPUID_H(watch_callback) callback, void *context) {
+    uint32_t *cpus = NULL;
+
+    memset(watch, 0, sizeof(*watch));
+    watch->callback   = callback;
+    watch->context    = context;
+    watch->inotify_fd = -1;
+    snprintf(watch->root, sizeof(watch->root), "%s", root != NULL ? root : "");
+    if (snprintf(watch->online_path, sizeof(watch->online_path), "%s/sys/devices/system/cpu/online", watch->root)
+        >= (int)sizeof(watch->online_path)) return -1;
+
+#ifdef CPUID_WATCH_INOTIFY
+    watch->inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    cpuid_watch_add(watch, watch->online_path);
+#endif
+    if (cpuid_watch_read_usable(watch, &watch->usable) != 0) goto fail;
+
+    watch->leaves = malloc(sizeof(*watch->leaves) * CPUID_SNAPSHOT_MAX_LEAVES);
+    if (watch->leaves == NULL) goto fail;
+    watch->n_leaves = cpuid_snapshot_default_leaves(watch->leaves, CPUID_SNAPSHOT_MAX_LEAVES);
+    if (watch->n_leaves > CPUID_SNAPSHOT_MAX_LEAVES) watch->n_leaves = CPUID_SNAPSHOT_MAX_LEAVES;
+
+    size_t n_cpus = cpuid_cpumask_list(&watch->usable, NULL, 0);
+    cpus = malloc(sizeof(*cpus) * (n_cpus != 0 ? n_cpus : 1));
+    if (cpus == NULL) goto fail;
+    cpuid_cpumask_list(&watch->usable, cpus, n_cpus);
+    if (cpuid_snapshot_take(&watch->snapshot, watch->leaves, watch->n_leaves, cpus, n_cpus, 0) < 0) goto fail;
+    free(cpus);
+    return 0;
+
+fail:
+    free(cpus);
+    cpuid_watch_close(watch);
+    return -1;
+}
+
+int cpuid_watch_check(CPUID_H(watch) *watch) {
+    CPUID_H(cpumask)  usable, added_mask, removed_mask;
+    CPUID_H(snapshot) *snapshot = &watch->snapshot;
+    uint32_t         *added = NULL, *removed = NULL;
+    CPUID_H(record)  *fresh = NULL, *merged = NULL;
+    int               result = -1;
+
+    // un fichero vacio (a medio escribir) se vuelve a leer en la siguiente llamada
+    int status = cpuid_watch_read_usable(watch, &usable);
+    if (status != 0) return status < 0 ? -1 : 0;
+    if (memcmp(&usable, &watch->usable, sizeof(usable)) == 0) return 0;
+
+    for (size_t w = 0; w < CPUID_CPUMASK_MAX_CPUS / 64; w++) {
+        added_mask.bits[w]   = usable.bits[w] & ~watch->usable.bits[w];
+        removed_mask.bits[w] = watch->usable.bits[w] & ~usable.bits[w];
+    }
+    size_t n_added   = cpuid_cpumask_list(&added_mask, NULL, 0);
+    size_t n_removed = cpuid_cpumask_list(&removed_mask, NULL, 0);
+    size_t n_leaves  = watch->n_leaves;
+    size_t n_cpus    = snapshot->n_cpus - n_removed + n_added;
+
+    added   = malloc(sizeof(*added) * (n_added != 0 ? n_added : 1));
+    removed = malloc(sizeof(*removed) * (n_removed != 0 ? n_removed : 1));
+    fresh   = malloc(sizeof(*fresh) * (n_added * n_leaves != 0 ? n_added * n_leaves : 1));
+    merged  = malloc(sizeof(*merged) * (n_cpus * n_leaves != 0 ? n_cpus * n_leaves : 1));
+    if (added == NULL || removed == NULL || fresh == NULL || merged == NULL) goto done;
+    cpuid_cpumask_list(&added_mask, added, n_added);
+    cpuid_cpumask_list(&removed_mask, removed, n_removed);
+
+    // solo las CPU nuevas: las que siguen conservan sus registros
+    if (cpuid_collect(watch->leaves, n_leaves, added, n_added, fresh, 0) < 0) goto done;
+
+    // mezcla ordenada por CPU de los bloques que siguen y los nuevos
+    size_t row = 0, k = 0, out = 0;
+    while (row < snapshot->n_cpus || k < n_added) {
+        const CPUID_H(record) *block = row < snapshot->n_cpus ? snapshot->records + row * n_leaves : NULL;
+        if (block != NULL && cpuid_cpumask_test(&removed_mask, block->cpu)) {
+            row++;
+            continue;
+        }
+        if (block == NULL || (k < n_added && added[k] < block->cpu)) {
+            block = fresh + k++ * n_leaves;
+        } else {
+            row++;
+        }
+        memcpy(merged + out++ * n_leaves, block, sizeof(*block) * n_leaves);
+    }
+
+    free(snapshot->records);
+    snapshot->records   = merged;
+    snapshot->n_cpus    = out;
+    snapshot->n_leaves  = n_leaves;
+    snapshot->n_records = out * n_leaves;
+    merged        = NULL;
+    watch->usable = usable;
+
+    if (watch->callback != NULL) {
+        CPUID_H(watch_delta) delta = {
+            .added   = added,   .n_added   = n_added,
+            .removed = removed, .n_removed = n_removed,
+            .records = fresh,   .snapshot  = snapshot,
+        };
+        watch->callback(watch->context, &delta);
+    }
+    result = 1;
+
+done:
+    free(merged);
+    free(fresh);
+    free(removed);
+    free(added);
+    return result;
+}
+
+int cpuid_watch_wait(CPUID_H(watch) *watch, int timeout_ms) {
+#ifdef CPUID_WATCH_INOTIFY
+    if (watch->inotify_fd >= 0) {
+        struct pollfd pfd = { .fd = watch->inotify_fd, .events = POLLIN };
+        char          events[4096];
+        if (poll(&pfd, 1, timeout_ms) > 0) {
+            // solo despiertan: el estado se vuelve a leer entero
+            while (read(watch->inotify_fd, events, sizeof(events)) > 0) {}
+        }
+    } else if (timeout_ms > 0) {
+        poll(NULL, 0, timeout_ms);
+    }
+#else
+    (void)timeout_ms;
+#endif
+    return cpuid_watch_check(watch);
+}
+
+void cpuid_watch_close(CPUID_H(watch) *watch) {
+#ifdef CPUID_WATCH_INOTIFY
+    if (watch->inotify_fd >= 0) close(watch->inotify_fd);
+#endif
+    watch->inotify_fd = -1;
+    cpuid_snapshot_free(&watch->snapshot);
+    free(watch->leaves);
+    watch->leaves   = NULL;
+    watch->n_leaves = 0;
+}
+
+#endif
@@ -0,0 +1,109 @@
+#ifndef __CPUID_WATCH_H__
+#define __CPUID_WATCH_H__
+
+/*
+ * Seguimiento de las CPU que puede usar el proceso: las que estan conectadas
+ * (/sys/devices/system/cpu/online) y dentro de su cpuset (cpuset.cpus.effective del cgroup
+ * del proceso, o cpuset.effective_cpus con cgroup v1). Cuando cambia alguno de los dos se
+ * vuelve a ejecutar CPUID solo en las CPU nuevas (con cpuid_collect), se actualiza el snapshot
+ * y se llama al callback con las CPU que entran y las que salen.
+ *
+ * sysfs no genera eventos de inotify al cambiar online y cgroup no los genera en todos los
+ * kernels para cpuset.cpus.effective, asi que los ficheros se vuelven a leer cada vez que se
+ * llama a cpuid_watch_check (dos lecturas pequenas); cpuid_watch_wait ademas despierta antes
+ * con inotify cuando el cambio si lo genera (un fichero normal, como en las pruebas).
+ *
+ * Todas las rutas cuelgan de una raiz configurable: con "" son las del sistema y con otro
+ * directorio se puede montar un sysfs falso con la misma estructura:
+ *
+ *      RAIZ/sys/devices/system/cpu/online          "0-3,8-11"
+ *      RAIZ/proc/self/cgroup                       "0::/servicio" (opcional)
+ *      RAIZ/sys/fs/cgroup/servicio/cpuset.cpus.effective
+ *
+ * Sin fichero de cgroup o de cpuset se consideran permitidas todas las CPU conectadas.
+ * Las CPU del sysfs falso que no existen en la maquina quedan en el snapshot con
+ * status CPUID_RECORD_NOT_PINNED.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "cpuid_snapshot.h"
+
+#define CPUID_CPUMASK_MAX_CPUS 4096
+#define CPUID_WATCH_PATH_MAX   512
+
+typedef struct CPUID_H(cpumask) {
+    uint64_t bits[CPUID_CPUMASK_MAX_CPUS / 64];
+} CPUID_H(cpumask);
+
+/*
+ * Lee una lista de CPU en el formato de sysfs y cgroup ("0-3,8,10-11", vacia = ninguna).
+ * Devuelve 0, o -1 si el texto no es una lista valida o pasa de CPUID_CPUMASK_MAX_CPUS.
+ */
+int cpuid_cpumask_parse(const char *text, CPUID_H(cpumask) *mask);
+
+/*
+ * Escribe como maximo max CPU del mask en cpus (en orden creciente) y devuelve el total.
+ */
+size_t cpuid_cpumask_list(const CPUID_H(cpumask) *mask, uint32_t *cpus, size_t max);
+
+static inline int cpuid_cpumask_test(const CPUID_H(cpumask) *mask, uint32_t cpu) {
+    return cpu < CPUID_CPUMASK_MAX_CPUS && (int)((mask->bits[cpu / 64] >> (cpu % 64)) & 1);
+}
+
+// lo que cambio entre dos llamadas al callback
+typedef struct CPUID_H(watch_delta) {
+    const uint32_t          *added;         // CPU que ahora se pueden usar y antes no
+    size_t                   n_added;
+    const uint32_t          *removed;       // CPU que ya no se pueden usar
+    size_t                   n_removed;
+    const CPUID_H(record)   *records;       // n_added * snapshot->n_leaves: las hojas de added
+    const CPUID_H(snapshot) *snapshot;      // el snapshot ya actualizado, ordenado por CPU
+} CPUID_H(watch_delta);
+
+typedef void (*CPUID_H(watch_callback))(void *context, const CPUID_H(watch_delta) *delta);
+
+typedef struct CPUID_H(watch) {
+    char                   root[CPUID_WATCH_PATH_MAX];
+    char                   online_path[CPUID_WATCH_PATH_MAX];
+    char                   cpuset_path[CPUID_WATCH_PATH_MAX];  // "" sin cpuset
+    CPUID_H(cpumask)       usable;          // conectadas y permitidas
+    CPUID_H(leaf_request) *leaves;          // las de cpuid_snapshot_default_leaves
+    size_t                 n_leaves;
+    CPUID_H(snapshot)      snapshot;
+    CPUID_H(watch_callback) callback;
+    void                  *context;
+    int                    inotify_fd;      // -1 sin inotify
+} CPUID_H(watch);
+
+/*
+ * Lee los ficheros bajo root (NULL o "" para los del sistema) y toma el snapshot de las CPU
+ * que se pueden usar. No llama al callback. Devuelve 0, o -1 si no existe el fichero online
+ * o no hay memoria.
+ */
+int cpuid_watch_init(CPUID_H(watch) *watch, const char *root, CPUID_H(watch_callback) callback, void *context);
+
+/*
+ * Vuelve a leer los ficheros y, si cambiaron las CPU que se pueden usar, actualiza el snapshot
+ * y llama al callback. Devuelve 1 si hubo cambios, 0 si no y -1 si fallo (el snapshot no cambia).
+ */
+int cpuid_watch_check(CPUID_H(watch) *watch);
+
+/*
+ * Espera como mucho timeout_ms (o hasta un evento de inotify) y llama a cpuid_watch_check.
+ */
+int cpuid_watch_wait(CPUID_H(watch) *watch, int timeout_ms);
+
+/*
+ * Descriptor de inotify para meterlo en el bucle de eventos del llamador (se vuelve legible
+ * cuando puede haber cambios: llamar entonces a cpuid_watch_check), o -1.
+ */
+static inline int cpuid_watch_fd(const CPUID_H(watch) *watch) {
+    return watch->inotify_fd;
+}
+
+void cpuid_watch_close(CPUID_H(watch) *watch);
+
+#include "cpuid_watch.c"
+#endif
@@ -0,0 +1,192 @@
+/*
+ * cpuidd: servicio de CPUID del host por un socket Unix (ver cpuid_server.h).
+ *
+ *      cpuidd [-i SEGUNDOS] [SOCKET]           sirve el snapshot de todas las CPU; con -i lo
+ *                                              vuelve a tomar cada SEGUNDOS
+ *      cpuidd -q SOCKET [CPU HOJA [SUBHOJA]]   consulta el resumen del host o una hoja
+ *      cpuidd -b SOCKET [PETICIONES]           mide la latencia de ida y vuelta y cuantas
+ *                                              peticiones por segundo atiende con pipelining
+ *
+ * SOCKET es por defecto CPUID_SERVER_DEFAULT_PATH ("/run/cpuid.sock").
+ */
+
+// cpuid_percpu.h necesita _GNU_SOURCE en Linux antes de cualquier include del sistema
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
+#include "cpuid_server.h"
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define CPUIDD_PIPELINE 64      // peticiones en vuelo en la medida con pipelining
+
+static volatile sig_atomic_t cpuidd_stop;
+
+static void cpuidd_signal(int sig) {
+    (void)sig;
+    cpuidd_stop = 1;
+}
+
+static double cpuidd_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static int cpuidd_serve(const char *path, int interval) {
+    static CPUID_H(server) server;
+    CPUID_H(snapshot) snapshot;
+
+    if (cpuid_snapshot_take(&snapshot, NULL, 0, NULL, 0, 0) <= 0) {
+        fprintf(stderr, "no se pudo leer CPUID\n");
+        return 1;
+    }
+    if (cpuid_server_open(&server, path, &snapshot) != 0) {
+        fprintf(stderr, "no se pudo escuchar en %s\n", path);
+        return 1;
+    }
+    signal(SIGINT, cpuidd_signal);
+    signal(SIGTERM, cpuidd_signal);
+    fprintf(stderr, "%u CPU, escuchando en %s\n", (unsigned)server.info.n_cpus, path);
+
+    double next = cpuidd_now() + interval;
+    while (!cpuidd_stop) {
+        int timeout = interval > 0 ? (int)((next - cpuidd_now()) * 1000) : -1;
+        if (cpuid_server_run(&server, interval > 0 && timeout < 0 ? 0 : timeout) < 0) break;
+        if (interval > 0 && cpuidd_now() >= next) {
+            if (cpuid_snapshot_take(&snapshot, NULL, 0, NULL, 0, 0) > 0) cpuid_server_replace(&server, &snapshot);
+            next += interval;
+        }
+    }
+    fprintf(stderr, "%llu peticiones atendidas\n", (unsigned long long)server.requests);
+    cpuid_server_close(&server);
+    return 0;
+}
+
+static int cpuidd_query(const char *path, int argc, char **argv) {
+    static CPUID_H(client) client;
+    CPUID_H(server_response) response = { 0 };
+
+    if (cpuid_client_connect(&client, path) != 0) {
+        fprintf(stderr, "no se pudo conectar con %s\n", path);
+        return 1;
+    }
+
+    int failed = 1;
+    if (argc == 0) {
+        CPUID_H(server_info) info;
+        if (cpuid_client_send(&client, CPUID_SERVER_INFO, 1, 0, 0, 0) == 0 && cpuid_client_flush(&client) == 0
+            && cpuid_client_recv(&client, &response, &info, sizeof(info)) == 0 && response.status == CPUID_SERVER_OK) {
+            const char *level = cpuid_march_level_name(info.level);
+            printf("generacion:  %llu\n", (unsigned long long)info.generation);
+            printf("cpu:         %u, %u hojas por CPU\n", (unsigned)info.n_cpus, (unsigned)info.n_leaves);
+            printf("fabricante:  %s familia %u modelo %u stepping %u\n", info.info.vendor,
+                (unsigned)info.info.family, (unsigned)info.info.model, (unsigned)info.info.stepping);
+            printf("nivel:       %s\n", level != NULL ? level : "ninguno");
+            failed = 0;
+        }
+    } else {
+        CPUID_H(record) r;
+        uint32_t cpu     = (uint32_t)strtoul(argv[0], NULL, 0);
+        uint32_t leaf    = argc > 1 ? (uint32_t)strtoul(argv[1], NULL, 0) : 0;
+        uint32_t subleaf = argc > 2 ? (uint32_t)strtoul(argv[2], NULL, 0) : 0;
+        if (cpuid_client_send(&client, CPUID_SERVER_LEAF, 1, cpu, leaf, subleaf) == 0 && cpuid_client_flush(&client) == 0
+            && cpuid_client_recv(&client, &response, &r, sizeof(r)) == 0) {
+            if (response.status == CPUID_SERVER_OK) {
+                printf("cpu %u hoja %08x.%u: eax=%08x ebx=%08x ecx=%08x edx=%08x\n",
+                    (unsigned)cpu, (unsigned)leaf, (unsigned)subleaf, (unsigned)r.eax, (unsigned)r.ebx, (unsigned)r.ecx, (unsigned)r.edx);
+                failed = 0;
+            } else {
+                fprintf(stderr, "la CPU %u no tiene la hoja %08x.%u\n", (unsigned)cpu, (unsigned)leaf, (unsigned)subleaf);
+            }
+        }
+    }
+    if (failed && response.status == CPUID_SERVER_OK) fprintf(stderr, "error de comunicacion con %s\n", path);
+    cpuid_client_close(&client);
+    return failed;
+}
+
+static int cpuidd_bench(const char *path, unsigned long requests) {
+    static CPUID_H(client) client;
+    CPUID_H(server_response) response;
+    CPUID_H(record)          r;
+    uint32_t                 cpus[CPUID_SERVER_CPUS_MAX];
+
+    if (cpuid_client_connect(&client, path) != 0) {
+        fprintf(stderr, "no se pudo conectar con %s\n", path);
+        return 1;
+    }
+    // primera CPU del servidor, para pedir hojas que existen
+    if (cpuid_client_send(&client, CPUID_SERVER_CPUS, 0, 0, 0, 0) != 0 || cpuid_client_flush(&client) != 0
+        || cpuid_client_recv(&client, &response, cpus, sizeof(cpus)) != 0 || response.length == 0) {
+        fprintf(stderr, "error de comunicacion con %s\n", path);
+        cpuid_client_close(&client);
+        return 1;
+    }
+
+    // ida y vuelta: una peticion cada vez
+    unsigned long round_trips = requests / 10 != 0 ? requests / 10 : 1;
+    double        begin       = cpuidd_now();
+    for (unsigned long i = 0; i < round_trips; i++) {
+        cpuid_client_send(&client, CPUID_SERVER_LEAF, (uint32_t)i, cpus[0], 7, 0);
+        if (cpuid_client_flush(&client) != 0 || cpuid_client_recv(&client, &response, &r, sizeof(r)) != 0) goto broken;
+    }
+    double single = cpuidd_now() - begin;
+
+    // pipelining: CPUIDD_PIPELINE peticiones en vuelo
+    unsigned long sent = 0, received = 0, errors = 0;
+    begin = cpuidd_now();
+    while (received < requests) {
+        while (sent < requests && sent - received < CPUIDD_PIPELINE) {
+            cpuid_client_send(&client, CPUID_SERVER_LEAF, (uint32_t)sent, cpus[0], sent & 1 ? 1 : 7, 0);
+            sent++;
+        }
+        if (cpuid_client_flush(&client) != 0) goto broken;
+        while (received < sent) {
+            if (cpuid_client_recv(&client, &response, &r, sizeof(r)) != 0) goto broken;
+            if (response.id != (uint32_t)received || response.status != CPUID_SERVER_OK) errors++;
+            received++;
+        }
+    }
+    double pipelined = cpuidd_now() - begin;
+
+    printf("ida y vuelta:  %.1f us por peticion (%lu peticiones)\n", 1e6 * single / (double)round_trips, round_trips);
+    printf("pipelining:    %.0f peticiones/s (%lu peticiones, %d en vuelo, %lu errores)\n",
+        (double)requests / pipelined, requests, CPUIDD_PIPELINE, errors);
+    cpuid_client_close(&client);
+    return errors != 0;
+
+broken:
+    fprintf(stderr, "se cerro la conexion con %s\n", path);
+    cpuid_client_close(&client);
+    return 1;
+}
+
+int main(int argc, char **argv) {
+    const char *path = CPUID_SERVER_DEFAULT_PATH;
+
+    if (argc >= 3 && strcmp(argv[1], "-q") == 0 && argc <= 6) return cpuidd_query(argv[2], argc - 3, argv + 3);
+    if (argc >= 3 && strcmp(argv[1], "-b") == 0 && argc <= 4) {
+        unsigned long requests = argc == 4 ? strtoul(argv[3], NULL, 10) : 1000000;
+        return cpuidd_bench(argv[2], requests != 0 ? requests : 1);
+    }
+
+    int interval = 0, arg = 1;
+    if (arg + 1 < argc && strcmp(argv[arg], "-i") == 0) {
+        interval = atoi(argv[arg + 1]);
+        arg += 2;
+    }
+    if (arg < argc && argv[arg][0] != '-') path = argv[arg++];
+    if (arg == argc && interval >= 0) return cpuidd_serve(path, interval);
+
+    fprintf(stderr,
+        "uso: %s [-i SEGUNDOS] [SOCKET]\n"
+        "     %s -q SOCKET [CPU HOJA [SUBHOJA]]\n"
+        "     %s -b SOCKET [PETICIONES]\n", argv[0], argv[0], argv[0]);
+    return 2;
+}
@@ -0,0 +1,189 @@
+/*
+ * curcpu: CPU actual con RDPID/RDTSCP/sistema (ver cpuid_current.h).
+ *
+ *      curcpu                      metodo elegido y CPU en la que se ejecuta
+ *      curcpu -b [LLAMADAS]        nanosegundos por llamada de cada metodo y de CPUID
+ *      curcpu -s [HILOS] [SUMAS]   contador compartido frente a un contador por CPU
+ */
+
+// cpuid_percpu.h necesita _GNU_SOURCE en Linux antes de cualquier include del sistema
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
+#include "cpuid_current.h"
+#include "cpuid_percpu.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <pthread.h>
+#endif
+
+#define CURCPU_MAX_THREADS 256
+
+// un contador por linea de cache para que dos CPU no se quiten la linea al sumar
+typedef struct curcpu_shard {
+    uint64_t count;
+    char     pad[64 - sizeof(uint64_t)];
+} curcpu_shard;
+
+typedef struct curcpu_job {
+    uint64_t      sums;
+    uint64_t     *shared;   // NULL para sumar en shards
+    curcpu_shard *shards;
+    uint32_t      n_shards;
+} curcpu_job;
+
+static double curcpu_seconds(clock_t begin) {
+    return (double)(clock() - begin) / CLOCKS_PER_SEC;
+}
+
+static void curcpu_run(curcpu_job *job) {
+    if (job->shared != NULL) {
+        for (uint64_t i = 0; i < job->sums; i++) cpuid_atomic_fetch_add_u64(job->shared, 1);
+    } else {
+        // la CPU puede cambiar tras leerla: la suma sigue siendo atomica, pero casi nunca compite
+        for (uint64_t i = 0; i < job->sums; i++) {
+            cpuid_atomic_fetch_add_u64(&job->shards[cpuid_current_cpu() % job->n_shards].count, 1);
+        }
+    }
+}
+
+#ifdef _WIN32
+static DWORD WINAPI curcpu_worker(LPVOID arg) {
+    curcpu_run(arg);
+    return 0;
+}
+#else
+static void *curcpu_worker(void *arg) {
+    curcpu_run(arg);
+    return NULL;
+}
+#endif
+
+// ejecuta job en n_threads hilos y devuelve los segundos de CPU de todos ellos, o -1
+static double curcpu_threads(curcpu_job *job, unsigned n_threads) {
+#ifdef _WIN32
+    HANDLE threads[CURCPU_MAX_THREADS];
+#else
+    pthread_t threads[CURCPU_MAX_THREADS];
+#endif
+    unsigned started = 0;
+    clock_t  begin   = clock();
+
+    for (; started < n_threads; started++) {
+#ifdef _WIN32
+        threads[started] = CreateThread(NULL, 0, curcpu_worker, job, 0, NULL);
+        if (threads[started] == NULL) break;
+#else
+        if (pthread_create(&threads[started], NULL, curcpu_worker, job) != 0) break;
+#endif
+    }
+    for (unsigned i = 0; i < started; i++) {
+#ifdef _WIN32
+        WaitForSingleObject(threads[i], INFINITE);
+        CloseHandle(threads[i]);
+#else
+        pthread_join(threads[i], NULL);
+#endif
+    }
+    return started == n_threads ? curcpu_seconds(begin) : -1;
+}
+
+static int curcpu_bench(unsigned long calls) {
+    volatile uint32_t sink = 0;
+
+    for (int m = CPUID_CURRENT_RDPID; m <= CPUID_CURRENT_OS; m++) {
+        CPUID_H(current_method) method = (CPUID_H(current_method))m;
+        if (!cpuid_current_supported(method)) {
+            printf("%-8s no disponible\n", cpuid_current_method_name(method));
+            continue;
+        }
+        clock_t begin = clock();
+        for (unsigned long i = 0; i < calls; i++) sink += cpuid_current_cpu_with(method);
+        printf("%-8s %8.2f ns\n", cpuid_current_method_name(method), curcpu_seconds(begin) * 1e9 / (double)calls);
+    }
+
+    // APIC ID con CPUID, como referencia (en una VM cada CPUID sale al hipervisor)
+    static const uint32_t leaves[] = { 0x00000001, 0x0000000b };
+    for (size_t l = 0; l < sizeof(leaves) / sizeof(leaves[0]); l++) {
+        uint32_t eax, ebx, ecx, edx;
+        unsigned long n = calls / 100 != 0 ? calls / 100 : 1;
+        clock_t begin = clock();
+        for (unsigned long i = 0; i < n; i++) {
+            call_cpuid(leaves[l], 0, &eax, &ebx, &ecx, &edx);
+            sink += l == 0 ? ebx >> 24 : edx;
+        }
+        printf("cpuid %02xh %7.2f ns\n", (unsigned)leaves[l], curcpu_seconds(begin) * 1e9 / (double)n);
+    }
+    (void)sink;
+    return 0;
+}
+
+static int curcpu_sharded(unsigned n_threads, unsigned long sums) {
+    uint32_t n_cpus = (uint32_t)cpuid_affinity_cpus(NULL, 0);
+    uint32_t *cpus  = malloc(sizeof(*cpus) * (n_cpus != 0 ? n_cpus : 1));
+    if (cpus == NULL) return 1;
+    n_cpus = (uint32_t)cpuid_affinity_cpus(cpus, n_cpus);
+
+    // un fragmento por numero de CPU hasta la mayor del mask de afinidad
+    uint32_t n_shards = n_cpus != 0 ? cpus[n_cpus - 1] + 1 : 1;
+    free(cpus);
+    if (n_threads == 0) n_threads = n_cpus != 0 ? n_cpus : 1;
+    if (n_threads > CURCPU_MAX_THREADS) n_threads = CURCPU_MAX_THREADS;
+
+    curcpu_shard *shards = calloc(n_shards, sizeof(*shards));
+    uint64_t      shared = 0;
+    if (shards == NULL) return 1;
+    cpuid_current_init();
+
+    curcpu_job job     = { sums, &shared, NULL, 0 };
+    double     single  = curcpu_threads(&job, n_threads);
+    job.shared   = NULL;
+    job.shards   = shards;
+    job.n_shards = n_shards;
+    double     sharded = curcpu_threads(&job, n_threads);
+    if (single < 0 || sharded < 0) {
+        fprintf(stderr, "no se pudieron crear los hilos\n");
+        free(shards);
+        return 1;
+    }
+
+    uint64_t total = 0;
+    for (uint32_t i = 0; i < n_shards; i++) total += cpuid_atomic_load_u64(&shards[i].count);
+    double all = (double)sums * n_threads;
+
+    printf("metodo:      %s\n", cpuid_current_method_name(cpuid_current_init()));
+    printf("hilos:       %u, %lu sumas cada uno, %u fragmentos\n", n_threads, sums, (unsigned)n_shards);
+    printf("compartido:  %8.2f ns de CPU por suma (total %llu)\n", single * 1e9 / all, (unsigned long long)shared);
+    printf("por cpu:     %8.2f ns de CPU por suma (total %llu)\n", sharded * 1e9 / all, (unsigned long long)total);
+    free(shards);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    if (argc >= 2 && strcmp(argv[1], "-b") == 0 && argc <= 3) {
+        unsigned long calls = argc == 3 ? strtoul(argv[2], NULL, 10) : 10000000;
+        return curcpu_bench(calls != 0 ? calls : 1);
+    }
+    if (argc >= 2 && strcmp(argv[1], "-s") == 0 && argc <= 4) {
+        unsigned      n_threads = argc >= 3 ? (unsigned)strtoul(argv[2], NULL, 10) : 0;
+        unsigned long sums      = argc == 4 ? strtoul(argv[3], NULL, 10) : 10000000;
+        return curcpu_sharded(n_threads, sums != 0 ? sums : 1);
+    }
+    if (argc != 1) {
+        fprintf(stderr, "uso: %s [-b [LLAMADAS] | -s [HILOS] [SUMAS]]\n", argv[0]);
+        return 2;
+    }
+
+    CPUID_H(current_method) method = cpuid_current_init();
+    printf("metodo: %s\n", cpuid_current_method_name(method));
+    printf("cpu:    %u\n", (unsigned)cpuid_current_cpu());
+    return 0;
+}
@@ -0,0 +1,97 @@
+/*
+ * hotplug: sigue las CPU que se conectan o desconectan y los cambios del cpuset del proceso
+ * (ver cpuid_watch.h) y muestra cada cambio con el CPUID de las CPU nuevas.
+ *
+ *      hotplug [-r RAIZ] [-t MILISEGUNDOS]
+ *
+ * RAIZ es el directorio con el sysfs (por defecto el del sistema) y MILISEGUNDOS cada cuanto
+ * se vuelven a leer los ficheros si no llega ningun evento (por defecto 1000). Para probarlo
+ * sin tocar las CPU de la maquina:
+ *
+ *      mkdir -p /tmp/raiz/sys/devices/system/cpu /tmp/raiz/proc/self /tmp/raiz/sys/fs/cgroup/app
+ *      echo 0-3 > /tmp/raiz/sys/devices/system/cpu/online
+ *      echo 0::/app > /tmp/raiz/proc/self/cgroup
+ *      echo 0-1 > /tmp/raiz/sys/fs/cgroup/app/cpuset.cpus.effective
+ *      hotplug -r /tmp/raiz &
+ *      echo 0-3 > /tmp/raiz/sys/fs/cgroup/app/cpuset.cpus.effective
+ */
+
+// cpuid_percpu.h necesita _GNU_SOURCE en Linux antes de cualquier include del sistema
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
+#include "cpuid_watch.h"
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static volatile sig_atomic_t hotplug_stop;
+
+static void hotplug_signal(int sig) {
+    (void)sig;
+    hotplug_stop = 1;
+}
+
+static void hotplug_print_cpus(const char *label, const uint32_t *cpus, size_t n) {
+    printf("%s", label);
+    for (size_t i = 0; i < n; i++) printf(" %u", (unsigned)cpus[i]);
+    printf(n == 0 ? " -\n" : "\n");
+}
+
+static void hotplug_changed(void *context, const CPUID_H(watch_delta) *delta) {
+    (void)context;
+    hotplug_print_cpus("entran:", delta->added, delta->n_added);
+    hotplug_print_cpus("salen: ", delta->removed, delta->n_removed);
+
+    // firma (hoja 1 EAX) y APIC ID inicial (hoja 1 EBX[31:24]) de las CPU nuevas
+    size_t n_leaves = delta->snapshot->n_leaves;
+    for (size_t i = 0; i < delta->n_added; i++) {
+        const CPUID_H(record) *block = delta->records + i * n_leaves;
+        for (size_t j = 0; j < n_leaves; j++) {
+            if (block[j].leaf != 1) continue;
+            if (block[j].status != CPUID_RECORD_OK) printf("  cpu %u: no se pudo fijar un hilo\n", (unsigned)block[j].cpu);
+            else printf("  cpu %u: firma %08x, APIC ID %u\n", (unsigned)block[j].cpu, (unsigned)block[j].eax, (unsigned)(block[j].ebx >> 24));
+            break;
+        }
+    }
+    printf("snapshot: %zu CPU, %zu registros\n", delta->snapshot->n_cpus, delta->snapshot->n_records);
+    fflush(stdout);
+}
+
+int main(int argc, char **argv) {
+    static CPUID_H(watch) watch;
+    const char           *root    = NULL;
+    int                   timeout = 1000;
+
+    for (int arg = 1; arg < argc; arg += 2) {
+        if (arg + 1 == argc) goto usage;
+        if (strcmp(argv[arg], "-r") == 0) root = argv[arg + 1];
+        else if (strcmp(argv[arg], "-t") == 0 && (timeout = atoi(argv[arg + 1])) > 0) continue;
+        else goto usage;
+    }
+
+    if (cpuid_watch_init(&watch, root, hotplug_changed, NULL) != 0) {
+        fprintf(stderr, "no se pudo leer %s\n", watch.online_path[0] != '\0' ? watch.online_path : "la lista de CPU");
+        return 1;
+    }
+    signal(SIGINT, hotplug_signal);
+    signal(SIGTERM, hotplug_signal);
+
+    uint32_t cpus[CPUID_CPUMASK_MAX_CPUS];
+    hotplug_print_cpus("cpu:   ", cpus, cpuid_cpumask_list(&watch.usable, cpus, CPUID_CPUMASK_MAX_CPUS));
+    printf("cpuset: %s\n", watch.cpuset_path[0] != '\0' ? watch.cpuset_path : "ninguno");
+    fflush(stdout);
+
+    while (!hotplug_stop) {
+        if (cpuid_watch_wait(&watch, timeout) < 0) fprintf(stderr, "no se pudo leer %s\n", watch.online_path);
+    }
+    cpuid_watch_close(&watch);
+    return 0;
+
+usage:
+    fprintf(stderr, "uso: %s [-r RAIZ] [-t MILISEGUNDOS]\n", argv[0]);
+    return 2;
+}
@@ -0,0 +1,260 @@
+/*
+ * indexer: indice de capacidades de una flota (ver cpuid_index.h).
+ *
+ *      indexer build ALMACEN HOSTS INDICE   indexa los hosts de HOSTS (la salida de ingest,
+ *                                           lineas "host<TAB>id") con los snapshots de ALMACEN
+ *      indexer query INDICE CONSULTA [-c]   hosts que cumplen la consulta (con -c solo cuantos)
+ *      indexer columns INDICE               columnas del indice y hosts de cada una
+ *
+ * Por ejemplo:
+ *
+ *      ingest almacen < flota.ndjson > hosts.tsv
+ *      indexer build almacen hosts.tsv flota.idx
+ *      indexer query flota.idx 'AVX512_VNNI & l3_total_kb >= 32768 & !hypervisor = "Microsoft Hv"'
+ */
+
+// cpuid_percpu.h necesita _GNU_SOURCE en Linux antes de cualquier include del sistema
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
+#include "cpuid_ingest.h"
+#include "cpuid_index.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define INDEXER_BLOCK_MAX 4096      // registros de una CPU
+
+static CPUID_H(record) block[INDEXER_BLOCK_MAX];
+static char            out_staging[1 << 16];
+
+typedef struct indexer_row {
+    uint64_t id;
+    size_t   name;      // posicion en el blob de nombres
+} indexer_row;
+
+static const char *indexer_names;   // para indexer_order (qsort no tiene contexto)
+
+static int indexer_order(const void *a, const void *b) {
+    const indexer_row *x = a, *y = b;
+    if (x->id != y->id) return x->id < y->id ? -1 : 1;
+    return strcmp(indexer_names + x->name, indexer_names + y->name);
+}
+
+static int indexer_parse_id(const char *text, uint64_t *id) {
+    uint64_t value = 0;
+    int      n     = 0;
+    for (; n < 16; n++, text++) {
+        char ch = *text;
+        if      (ch >= '0' && ch <= '9') value = value << 4 | (uint64_t)(ch - '0');
+        else if (ch >= 'a' && ch <= 'f') value = value << 4 | (uint64_t)(ch - 'a' + 10);
+        else if (ch >= 'A' && ch <= 'F') value = value << 4 | (uint64_t)(ch - 'A' + 10);
+        else break;
+    }
+    *id = value;
+    return n == 16 && (*text == '\0' || *text == '\n' || *text == '\r') ? 0 : -1;
+}
+
+// perfil de un snapshot del almacen: las caracteristicas que pueden usar todas sus CPU
+static int indexer_load_profile(const CPUID_H(store) *store, uint64_t id, CPUID_H(index_profile) *profile) {
+    uint64_t variants[CPUID_INGEST_MAX_VARIANTS];
+    long     len = cpuid_store_get(store, id, "snap", variants, sizeof(variants));
+    if (len <= 0 || len % sizeof(variants[0]) != 0) return -1;
+
+    size_t n_variants = (size_t)len / sizeof(variants[0]);
+    for (size_t v = 0; v < n_variants; v++) {
+        long bytes = cpuid_store_get(store, variants[v], "cpu", block, sizeof(block));
+        if (bytes <= 0 || bytes % sizeof(block[0]) != 0) return -1;
+        size_t n = (size_t)bytes / sizeof(block[0]);
+
+        CPUID_H(featureset) features;
+        cpuid_features_usable(block, n, &features);
+        if (v == 0) {
+            profile->features = features;
+            cpuid_host_info_decode(block, n, &profile->info);
+        } else {
+            for (size_t w = 0; w < CPUID_FEATURESET_WORDS; w++) profile->features.bits[w] &= features.bits[w];
+        }
+    }
+    return 0;
+}
+
+static int indexer_build(const char *store_dir, const char *hosts_path, const char *index_path) {
+    CPUID_H(store)          store;
+    FILE                   *hosts    = fopen(hosts_path, "r");
+    char                   *blob     = NULL;
+    size_t                  blob_len = 0, blob_cap = 0;
+    indexer_row            *rows     = NULL;
+    size_t                  n_rows   = 0, rows_cap = 0;
+    CPUID_H(index_profile) *profiles = NULL;
+    uint32_t               *row_profile = NULL;
+    const char            **names    = NULL;
+    size_t                  errors   = 0;
+    int                     result   = 1;
+    char                    line[CPUID_INGEST_MAX_HOST + 64];
+
+    if (hosts == NULL) {
+        fprintf(stderr, "no se pudo abrir %s\n", hosts_path);
+        return 1;
+    }
+    cpuid_store_init(&store, store_dir, NULL, 0);
+
+    while (fgets(line, sizeof(line), hosts) != NULL) {
+        char    *tab = strchr(line, '\t');
+        uint64_t id;
+        if (tab == NULL || indexer_parse_id(tab + 1, &id) != 0) {
+            errors++;
+            continue;
+        }
+        size_t len = (size_t)(tab - line);
+
+        if (blob_len + len + 1 > blob_cap) {
+            size_t cap   = blob_cap != 0 ? blob_cap * 2 : 1 << 16;
+            char  *grown = realloc(blob, cap);
+            if (grown == NULL) goto done;
+            blob     = grown;
+            blob_cap = cap;
+        }
+        if (n_rows == rows_cap) {
+            size_t       cap   = rows_cap != 0 ? rows_cap * 2 : 1024;
+            indexer_row *grown = realloc(rows, sizeof(*rows) * cap);
+            if (grown == NULL) goto done;
+            rows     = grown;
+            rows_cap = cap;
+        }
+        memcpy(blob + blob_len, line, len);
+        blob[blob_len + len] = '\0';
+        rows[n_rows].id   = id;
+        rows[n_rows].name = blob_len;
+        n_rows++;
+        blob_len += len + 1;
+    }
+
+    // los hosts con el mismo snapshot seguidos: casi todos los bloques quedan vacios o llenos
+    indexer_names = blob;
+    if (n_rows != 0) qsort(rows, n_rows, sizeof(*rows), indexer_order);
+
+    profiles    = malloc(sizeof(*profiles) * (n_rows + 1));
+    row_profile = malloc(sizeof(*row_profile) * (n_rows + 1));
+    names       = malloc(sizeof(*names) * (n_rows + 1));
+    if (profiles == NULL || row_profile == NULL || names == NULL) goto done;
+
+    size_t n_profiles = 0, n_indexed = 0;
+    int    loaded     = 0;
+    for (size_t r = 0; r < n_rows; r++) {
+        if (r == 0 || rows[r].id != rows[r - 1].id) {
+            loaded = indexer_load_profile(&store, rows[r].id, &profiles[n_profiles]) == 0;
+            if (loaded) n_profiles++;
+            else {
+                fprintf(stderr, "snapshot %08x%08x no esta en %s\n", (unsigned)(rows[r].id >> 32), (unsigned)rows[r].id, store_dir);
+            }
+        }
+        if (!loaded) {
+            errors++;
+            continue;
+        }
+        row_profile[n_indexed] = (uint32_t)(n_profiles - 1);
+        names[n_indexed]       = blob + rows[r].name;
+        n_indexed++;
+    }
+
+    if (cpuid_index_write(index_path, names, row_profile, n_indexed, profiles, n_profiles) != 0) {
+        fprintf(stderr, "no se pudo escribir %s\n", index_path);
+        goto done;
+    }
+    fprintf(stderr, "%zu hosts, %zu snapshots distintos, %zu errores\n", n_indexed, n_profiles, errors);
+    result = errors != 0;
+
+done:
+    fclose(hosts);
+    free(names);
+    free(row_profile);
+    free(profiles);
+    free(rows);
+    free(blob);
+    return result;
+}
+
+static int indexer_query(const char *index_path, const char *text, int count_only) {
+    static CPUID_H(index_query) query;
+    CPUID_H(index) index;
+    char           error[128];
+
+    if (cpuid_index_open(&index, index_path) != 0) {
+        fprintf(stderr, "%s no es un indice valido\n", index_path);
+        return 1;
+    }
+    if (cpuid_index_compile(&index, text, &query, error, sizeof(error)) != 0) {
+        fprintf(stderr, "consulta: %s\n", error);
+        cpuid_index_close(&index);
+        return 2;
+    }
+
+    uint64_t *bits  = count_only ? NULL : malloc(sizeof(*bits) * (cpuid_index_words(&index) + 1));
+    size_t    total = cpuid_index_eval(&index, &query, bits);
+
+    CPUID_H(sink) out;
+    cpuid_sink_fd(&out, 1, out_staging, sizeof(out_staging));
+    if (bits != NULL) {
+        for (size_t w = 0; w < cpuid_index_words(&index); w++) {
+            for (uint64_t word = bits[w]; word != 0; word &= word - 1) {
+                size_t bit = 0;
+                while (!((word >> bit) & 1)) bit++;
+                size_t      len;
+                const char *host = cpuid_index_host(&index, w * 64 + bit, &len);
+                cpuid_sink_write(&out, host, len);
+                cpuid_sink_putc(&out, '\n');
+            }
+        }
+    } else if (!count_only) {
+        fprintf(stderr, "sin memoria\n");
+    }
+    int failed = cpuid_sink_flush(&out) != 0;
+    fprintf(stderr, "%zu de %u hosts\n", total, (unsigned)index.header->n_rows);
+
+    free(bits);
+    cpuid_index_close(&index);
+    return failed;
+}
+
+static int indexer_columns(const char *index_path) {
+    static CPUID_H(index_query) query;
+    CPUID_H(index) index;
+
+    if (cpuid_index_open(&index, index_path) != 0) {
+        fprintf(stderr, "%s no es un indice valido\n", index_path);
+        return 1;
+    }
+    for (uint32_t c = 0; c < index.header->n_columns; c++) {
+        const CPUID_H(index_column) *col = &index.columns[c];
+        query.n_ops           = 1;
+        query.ops[0].code     = CPUID_INDEX_OP_COLUMN;
+        query.ops[0].column   = c;
+        size_t hosts = cpuid_index_eval(&index, &query, NULL);
+        if (col->kind == CPUID_INDEX_SLICE) printf("%-24s bit %-2u %zu\n", col->name, (unsigned)col->slice, hosts);
+        else                                printf("%-31s %zu\n", col->name, hosts);
+    }
+    printf("%u hosts, %u columnas, %u literales\n",
+        (unsigned)index.header->n_rows, (unsigned)index.header->n_columns, (unsigned)index.header->n_literals);
+    cpuid_index_close(&index);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    if (argc == 5 && strcmp(argv[1], "build") == 0) return indexer_build(argv[2], argv[3], argv[4]);
+    if ((argc == 4 || argc == 5) && strcmp(argv[1], "query") == 0) {
+        int count_only = argc == 5 && strcmp(argv[4], "-c") == 0;
+        if (argc == 5 && !count_only) goto usage;
+        return indexer_query(argv[2], argv[3], count_only);
+    }
+    if (argc == 3 && strcmp(argv[1], "columns") == 0) return indexer_columns(argv[2]);
+
+usage:
+    fprintf(stderr,
+        "uso: %s build ALMACEN HOSTS INDICE\n"
+        "     %s query INDICE CONSULTA [-c]\n"
+        "     %s columns INDICE\n", argv[0], argv[0], argv[0]);
+    return 2;
+}
@@ -0,0 +1,166 @@
+/*
+ * ingest: ingesta de inventario de CPUID de una flota con deduplicacion.
+ *
+ *      ingest ALMACEN [fichero ...]
+ *
+ * Sin ficheros lee NDJSON de la entrada estandar, con el formato de "main --ndjson --host NOMBRE"
+ * (las lineas de un mismo host deben ir seguidas). Los ficheros que terminan en .cpuid o .bin
+ * son tablas de CPUID_H(record) tal cual (por ejemplo memoryview(cpuid_x86.Snapshot()) guardado
+ * en disco) y su host es el nombre del fichero sin extension; el resto se leen como NDJSON.
+ *
+ * Escribe en la salida estandar una linea "host<TAB>id" por host, y guarda en ALMACEN los
+ * bloques de CPU y los snapshots distintos (ver cpuid_ingest.h). La memoria es fija: una linea,
+ * los registros de una CPU, la cache de hashes y el buffer de salida.
+ */
+
+// cpuid_percpu.h necesita _GNU_SOURCE en Linux antes de cualquier include del sistema
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
+#include "cpuid_ingest.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define INGEST_LINE_MAX   (1 << 20)
+#define INGEST_BLOCK_MAX  4096       // registros de una CPU
+#define INGEST_SEEN_CAP   (1 << 16)  // entradas de la cache de hashes (512 KiB)
+
+static char             line[INGEST_LINE_MAX];
+static CPUID_H(record)  block[INGEST_BLOCK_MAX];
+static uint64_t         seen[INGEST_SEEN_CAP];
+static char             out_staging[1 << 16];
+
+typedef struct ingest_state {
+    CPUID_H(store)       store;
+    CPUID_H(ingest_host) host;
+    CPUID_H(sink)        out;
+    int                  host_open;
+    size_t               lines, records, hosts, errors;
+} ingest_state;
+
+static void ingest_finish_host(ingest_state *state) {
+    if (!state->host_open) return;
+    uint64_t id = cpuid_ingest_host_finish(&state->host, &state->store);
+    if (id != 0) {
+        cpuid_sink_puts(&state->out, state->host.name);
+        cpuid_sink_putc(&state->out, '\t');
+        cpuid_sink_hex(&state->out, (uint32_t)(id >> 32), 8);
+        cpuid_sink_hex(&state->out, (uint32_t)id, 8);
+        cpuid_sink_putc(&state->out, '\n');
+        state->hosts++;
+    } else if (state->host.n_cpus != 0) {
+        if (state->host.dropped != 0) {
+            fprintf(stderr, "%s: %zu bloques distintos fuera del snapshot, sin identificador\n",
+                state->host.name, state->host.dropped);
+        }
+        state->errors++;
+    }
+    state->host_open = 0;
+}
+
+static void ingest_block(ingest_state *state, const char *host, CPUID_H(record) *records, size_t n) {
+    if (!state->host_open || strcmp(state->host.name, host) != 0) {
+        ingest_finish_host(state);
+        cpuid_ingest_host_reset(&state->host, host);
+        state->host_open = 1;
+    }
+    if (cpuid_ingest_host_add(&state->host, &state->store, records, n) != 0) state->errors++;
+    state->records += n;
+}
+
+static void ingest_ndjson(ingest_state *state, FILE *file) {
+    char host[CPUID_INGEST_MAX_HOST];
+
+    while (fgets(line, sizeof(line), file) != NULL) {
+        size_t len = strlen(line);
+        state->lines++;
+
+        if (len != 0 && line[len - 1] != '\n' && !feof(file)) {
+            // linea demasiado larga: se descarta entera
+            int ch;
+            while ((ch = fgetc(file)) != EOF && ch != '\n') { }
+            state->errors++;
+            continue;
+        }
+
+        size_t n;
+        if (cpuid_ingest_parse_line(line, len, host, sizeof(host), block, INGEST_BLOCK_MAX, &n) != 0) {
+            state->errors++;
+            continue;
+        }
+        if (n != 0) ingest_block(state, host, block, n);
+    }
+}
+
+// tabla de registros en binario: las CPU van en bloques de registros consecutivos con el mismo cpu
+static void ingest_records(ingest_state *state, FILE *file, const char *host) {
+    CPUID_H(record) record;
+    size_t          n = 0;
+
+    while (fread(&record, sizeof(record), 1, file) == 1) {
+        if (n != 0 && (record.cpu != block[0].cpu || n == INGEST_BLOCK_MAX)) {
+            ingest_block(state, host, block, n);
+            n = 0;
+        }
+        block[n++] = record;
+    }
+    if (n != 0) ingest_block(state, host, block, n);
+}
+
+static int ingest_is_records(const char *path) {
+    const char *dot = strrchr(path, '.');
+    return dot != NULL && (strcmp(dot, ".cpuid") == 0 || strcmp(dot, ".bin") == 0);
+}
+
+// nombre del fichero sin directorio ni extension
+static void ingest_host_from_path(const char *path, char *host, size_t cap) {
+    const char *base = path;
+    for (const char *p = path; *p != '\0'; p++) {
+        if (*p == '/' || *p == '\\') base = p + 1;
+    }
+    const char *dot = strrchr(base, '.');
+    size_t len = dot != NULL ? (size_t)(dot - base) : strlen(base);
+    if (len >= cap) len = cap - 1;
+    memcpy(host, base, len);
+    host[len] = '\0';
+}
+
+int main(int argc, char **argv) {
+    static ingest_state state;
+
+    if (argc < 2) {
+        fprintf(stderr, "uso: %s ALMACEN [fichero ...]\n", argv[0]);
+        return 2;
+    }
+    cpuid_store_init(&state.store, argv[1], seen, INGEST_SEEN_CAP);
+    cpuid_sink_fd(&state.out, 1, out_staging, sizeof(out_staging));
+
+    if (argc == 2) {
+        ingest_ndjson(&state, stdin);
+    }
+    for (int i = 2; i < argc; i++) {
+        int   records = ingest_is_records(argv[i]);
+        FILE *file    = fopen(argv[i], records ? "rb" : "r");
+        if (file == NULL) {
+            fprintf(stderr, "no se pudo abrir %s\n", argv[i]);
+            state.errors++;
+            continue;
+        }
+        if (records) {
+            char host[CPUID_INGEST_MAX_HOST];
+            ingest_host_from_path(argv[i], host, sizeof(host));
+            ingest_records(&state, file, host);
+        } else {
+            ingest_ndjson(&state, file);
+        }
+        fclose(file);
+    }
+    ingest_finish_host(&state);
+
+    int failed = cpuid_sink_flush(&state.out) != 0;
+    fprintf(stderr, "%zu lineas, %zu registros, %zu hosts, %zu ficheros nuevos en el almacen, %zu errores\n",
+        state.lines, state.records, state.hosts, state.store.written, state.errors);
+    return failed || state.errors != 0;
+}
@@ -1,8 +1,58 @@
-#include "cpuid.h"
-#include <windows.h>
-
+// cpuid_percpu.h necesita _GNU_SOURCE en Linux antes de cualquier include del sistema
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
 
-int main() {
+#include "cpuid.h"
+#include "cpuid_json.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <unistd.h>
+    #define Sleep(ms) usleep((ms) * 1000)
+#endif
+
+/*
+ * main --json [--all-cpus] [--host NOMBRE]    volcado completo de las hojas de CPUID en un documento JSON
+ * main --ndjson [--all-cpus] [--host NOMBRE]  lo mismo, con un objeto JSON por CPU y linea
+ *
+ * En estos modos no se usa printf (ni printf_color): el volcado se escribe en un buffer
+ * reservado una vez y se envia con una sola llamada a write. Sin --all-cpus solo se consulta
+ * la primera CPU del mask de afinidad. Con --host cada CPU lleva el campo "host" (para ingest).
+ */
+static int dump_json(CPUID_H(json_format) format, int all_cpus, const char *host) {
+    CPUID_H(snapshot) snapshot;
+    uint32_t          first_cpu;
+    int               status = -1;
+
+    if (!all_cpus && cpuid_affinity_cpus(&first_cpu, 1) == 0) return -1;
+    if (cpuid_snapshot_take(&snapshot, NULL, 0, all_cpus ? NULL : &first_cpu, all_cpus ? 0 : 1, 0) < 0) return -1;
+
+    size_t cap = cpuid_json_size(&snapshot, host);
+    char  *buf = malloc(cap);
+    if (buf != NULL) {
+        size_t len = cpuid_json_dump(&snapshot, format, host, buf, cap);
+        status = cpuid_sink_write_fd(1, buf, len);
+        free(buf);
+    }
+    cpuid_snapshot_free(&snapshot);
+    return status;
+}
+
+int main(int argc, char **argv) {
+    int         json = -1, all_cpus = 0;
+    const char *host = NULL;
+    for (int i = 1; i < argc; i++) {
+        if      (strcmp(argv[i], "--json")     == 0) json = CPUID_JSON;
+        else if (strcmp(argv[i], "--ndjson")   == 0) json = CPUID_JSON_LINES;
+        else if (strcmp(argv[i], "--all-cpus") == 0) all_cpus = 1;
+        else if (strcmp(argv[i], "--host")     == 0 && i + 1 < argc) host = argv[++i];
+    }
+    if (json != -1) return dump_json((CPUID_H(json_format))json, all_cpus, host) == 0 ? 0 : 1;
 
     size_t val = get_flags();
     printf("flags                 0x%x = ", val);
@@ -0,0 +1,168 @@
+/*
+ * march: nivel de x86-64 y -march con los que se puede compilar para toda una flota.
+ *
+ *      march            esta maquina (las caracteristicas que tienen todas sus CPU)
+ *      march INDICE     los hosts de un indice de indexer (ver cpuid_index.h)
+ *      march --level    solo el nivel de la psABI de la CPU actual y lo que falta para cada
+ *                       nivel; el codigo de salida es el nivel (0-4), para usarlo en scripts
+ *
+ * Escribe las caracteristicas comunes a todos los hosts, el mayor nivel de la psABI y el -march
+ * con nombre que cumplen todos, y por cada objetivo cuantos hosts lo cumplen y cuantos se
+ * quedarian fuera si se compilara para el. Para los niveles que no cumplen todos los hosts
+ * lista las caracteristicas comunes que faltan. Por ejemplo:
+ *
+ *      indexer build almacen hosts.tsv flota.idx
+ *      march flota.idx
+ */
+
+// cpuid_percpu.h necesita _GNU_SOURCE en Linux antes de cualquier include del sistema
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
+#include "cpuid_snapshot.h"
+#include "cpuid_index.h"
+#include "cpuid_march.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define MARCH_QUERY_MAX 4096
+
+// caracteristicas usables en todas las CPU de esta maquina (con XCR0 de verdad)
+static int march_local(CPUID_H(featureset) *common) {
+    CPUID_H(snapshot) snapshot;
+    if (cpuid_snapshot_take(&snapshot, NULL, 0, NULL, 0, 0) <= 0) return -1;
+
+    cpuid_features_current(common);
+    for (size_t cpu = 0; cpu < snapshot.n_cpus; cpu++) {
+        CPUID_H(featureset) features;
+        cpuid_features_usable(snapshot.records + cpu * snapshot.n_leaves, snapshot.n_leaves, &features);
+        for (size_t w = 0; w < CPUID_FEATURESET_WORDS; w++) common->bits[w] &= features.bits[w];
+    }
+    cpuid_snapshot_free(&snapshot);
+    return 0;
+}
+
+// hosts del indice que cumplen el objetivo: el AND de las columnas de sus caracteristicas
+static size_t march_index_count(const CPUID_H(index) *index, size_t target) {
+    static CPUID_H(index_query) query;
+    const char *names[CPUID_FEATURESET_WORDS * 64];
+    char        text[MARCH_QUERY_MAX];
+    size_t      len = 0;
+
+    size_t n = cpuid_march_features(target, names, sizeof(names) / sizeof(names[0]));
+    for (size_t k = 0; k < n && len + 64 < sizeof(text); k++) {
+        len += (size_t)snprintf(text + len, sizeof(text) - len, k == 0 ? "%s" : " & %s", names[k]);
+    }
+    text[len] = '\0';
+    if (cpuid_index_compile(index, text, &query, NULL, 0) != 0) return 0;
+    return cpuid_index_eval(index, &query, NULL);
+}
+
+// las caracteristicas cuya columna tienen todos los hosts
+static void march_index_common(const CPUID_H(index) *index, CPUID_H(featureset) *common) {
+    static CPUID_H(index_query) query;
+
+    memset(common, 0, sizeof(*common));
+    for (uint32_t c = 0; c < index->header->n_columns; c++) {
+        if (index->columns[c].kind != CPUID_INDEX_FEATURE) continue;
+        query.n_ops         = 1;
+        query.ops[0].code   = CPUID_INDEX_OP_COLUMN;
+        query.ops[0].column = c;
+        int id = cpuid_feature_find(index->columns[c].name);
+        if (id >= 0 && cpuid_index_eval(index, &query, NULL) == index->header->n_rows) {
+            common->bits[id / 64] |= 1ull << (id % 64);
+        }
+    }
+}
+
+static void march_report(const CPUID_H(featureset) *common, const size_t *hosts, size_t n_hosts) {
+    const char *names[CPUID_FEATURESET_WORDS * 64];
+    size_t      max = sizeof(names) / sizeof(names[0]);
+
+    printf("comunes:");
+    for (size_t id = 0; id < cpuid_features_count(); id++) {
+        const char *name = cpuid_feature_at(id)->name;
+        // los nombres repetidos en varias hojas se escriben una vez, si alguna de ellas esta
+        if (cpuid_feature_find(name) == (int)id && cpuid_featureset_has(common, name)) printf(" %s", name);
+    }
+    printf("\n");
+
+    int level = cpuid_march_level(common);
+    int best  = cpuid_march_best(common);
+    const char *name = cpuid_march_level_name(level);
+    printf("nivel:   %s\n", name != NULL ? name : "ninguno");
+    printf("-march:  %s\n\n", best >= 0 ? cpuid_march_at((size_t)best)->name : (level != 0 ? "x86-64" : "ninguno"));
+
+    printf("%-16s %21s %21s\n", "objetivo", "cumplen", "excluidos");
+    for (size_t t = 0; t < cpuid_march_count(); t++) {
+        double share = n_hosts != 0 ? 100.0 * (double)hosts[t] / (double)n_hosts : 0.0;
+        printf("%-16s %12zu (%5.1f%%) %12zu (%5.1f%%)\n",
+            cpuid_march_at(t)->name, hosts[t], share, n_hosts - hosts[t], 100.0 - share);
+    }
+
+    if (level < 4) printf("\n");
+    for (size_t t = 0; t < cpuid_march_count(); t++) {
+        if (cpuid_march_at(t)->level <= level) continue;
+        size_t n = cpuid_march_missing(common, t, names, max);
+        printf("faltan para %s:", cpuid_march_at(t)->name);
+        for (size_t k = 0; k < n && k < max; k++) printf(" %s", names[k]);
+        printf("\n");
+    }
+}
+
+static int march_level(void) {
+    CPUID_H(march_report) report;
+    int                   level = cpuid_march_host_level(&report);
+    const char           *name  = cpuid_march_level_name(level);
+
+    printf("%s\n", name != NULL ? name : "ninguno");
+    for (int l = 1; l <= CPUID_MARCH_LEVELS; l++) {
+        if (report.n_missing[l] == 0) continue;
+        printf("faltan para %s:", cpuid_march_level_name(l));
+        for (size_t k = 0; k < report.n_missing[l] && k < CPUID_MARCH_MISSING_MAX; k++) printf(" %s", report.missing[l][k]);
+        printf("\n");
+    }
+    return level;
+}
+
+int main(int argc, char **argv) {
+    static size_t       hosts[64];
+    CPUID_H(featureset) common;
+    size_t              n_hosts;
+
+    if (argc > 2 || cpuid_march_count() > sizeof(hosts) / sizeof(hosts[0])) {
+        fprintf(stderr, "uso: %s [INDICE | --level]\n", argv[0]);
+        return 2;
+    }
+    if (argc == 2 && strcmp(argv[1], "--level") == 0) return march_level();
+
+    if (argc == 1) {
+        if (march_local(&common) != 0) {
+            fprintf(stderr, "no se pudo leer CPUID\n");
+            return 1;
+        }
+        n_hosts = 1;
+        for (size_t t = 0; t < cpuid_march_count(); t++) hosts[t] = (size_t)cpuid_march_satisfies(&common, t);
+    } else {
+        CPUID_H(index) index;
+        if (cpuid_index_open(&index, argv[1]) != 0) {
+            fprintf(stderr, "%s no es un indice valido\n", argv[1]);
+            return 1;
+        }
+        n_hosts = index.header->n_rows;
+        if (n_hosts == 0) {
+            fprintf(stderr, "%s no tiene hosts\n", argv[1]);
+            cpuid_index_close(&index);
+            return 1;
+        }
+        march_index_common(&index, &common);
+        for (size_t t = 0; t < cpuid_march_count(); t++) hosts[t] = march_index_count(&index, t);
+        cpuid_index_close(&index);
+    }
+
+    printf("hosts:   %zu\n", n_hosts);
+    march_report(&common, hosts, n_hosts);
+    return 0;
+}
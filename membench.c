@@ -0,0 +1,90 @@
+/*
+ * membench: perfil de latencia y ancho de banda de la jerarquia de memoria (ver
+ * cpuid_membench.h).
+ *
+ *      membench [MIB]      MIB es el conjunto de trabajo de memoria (por defecto 4 veces la
+ *                          mayor cache, al menos 64 MiB; si es menor que el doble de la mayor
+ *                          cache se sube a ese tamano con un aviso)
+ *
+ * El hilo se fija en la CPU en la que arranca para que las caches medidas sean las suyas.
+ */
+
+// cpuid_percpu.h necesita _GNU_SOURCE en Linux antes de cualquier include del sistema
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
+#include "cpuid_membench.h"
+#include "cpuid_current.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MEMBENCH_MAX_SIZES (2 * CPUID_MEMBENCH_MAX_LEVELS + 1)
+
+static void membench_size(char *out, size_t cap, uint64_t size) {
+    if (size >= (1ull << 20) && size % (1ull << 20) == 0) snprintf(out, cap, "%llu MiB", (unsigned long long)(size >> 20));
+    else                                                   snprintf(out, cap, "%llu KiB", (unsigned long long)(size >> 10));
+}
+
+int main(int argc, char **argv) {
+    CPUID_H(cache_level)     levels[CPUID_MEMBENCH_MAX_LEVELS];
+    CPUID_H(membench_result) result;
+    uint64_t                 sizes[MEMBENCH_MAX_SIZES];
+    char                     text[32];
+
+    if (argc > 2 || (argc == 2 && argv[1][0] == '-')) {
+        fprintf(stderr, "uso: %s [MIB]\n", argv[0]);
+        return 2;
+    }
+    uint64_t memory_size = argc == 2 ? (uint64_t)strtoull(argv[1], NULL, 10) << 20 : 0;
+
+    uint32_t cpu = cpuid_current_cpu();
+    if (cpuid_pin_current_thread(cpu) != 0) fprintf(stderr, "aviso: no se pudo fijar el hilo en la CPU %u\n", (unsigned)cpu);
+
+    size_t n_levels = cpuid_membench_caches(levels, CPUID_MEMBENCH_MAX_LEVELS);
+    if (n_levels > CPUID_MEMBENCH_MAX_LEVELS) n_levels = CPUID_MEMBENCH_MAX_LEVELS;
+    size_t n_sizes  = cpuid_membench_sizes(levels, n_levels, memory_size, sizes, MEMBENCH_MAX_SIZES);
+    if (n_sizes != 0 && memory_size != 0 && sizes[n_sizes - 1] > memory_size) {
+        membench_size(text, sizeof(text), sizes[n_sizes - 1]);
+        fprintf(stderr, "aviso: %s MiB cabe en las caches, se mide hasta %s\n", argv[1], text);
+    }
+
+    double tsc_hz = cpuid_tsc_hz(200);
+    printf("cpu %u, tsc %.3f MHz%s\n", (unsigned)cpu, tsc_hz / 1e6,
+        cpuid_tsc_invariant() ? "" : " (no invariante: los tiempos dependen de la frecuencia)");
+    for (size_t i = 0; i < n_levels; i++) {
+        membench_size(text, sizeof(text), levels[i].size);
+        printf("L%u%s %s, linea %u, compartida por %u\n", (unsigned)levels[i].level, levels[i].type == 1 ? "d" : "",
+            text, (unsigned)levels[i].line, (unsigned)levels[i].shared);
+    }
+    if (n_sizes == 0) return 1;
+
+    // un solo buffer del mayor tamano, alineado a 64, para todas las medidas
+    unsigned char *memory = malloc((size_t)sizes[n_sizes - 1] + 64);
+    if (memory == NULL) {
+        fprintf(stderr, "sin memoria para %llu bytes\n", (unsigned long long)sizes[n_sizes - 1]);
+        return 1;
+    }
+    void *buffer = (void*)(((uintptr_t)memory + 63) & ~(uintptr_t)63);
+    memset(buffer, 0, (size_t)sizes[n_sizes - 1]);
+
+    printf("\n%-10s %-6s %10s %10s %10s %10s %10s\n", "tamano", "nivel", "lat ns", "lect GB/s", "escr GB/s", "copia GB/s", "nt GB/s");
+    for (size_t i = 0; i < n_sizes; i++) {
+        cpuid_membench_run(&result, buffer, sizes[i], levels, n_levels, tsc_hz);
+        membench_size(text, sizeof(text), sizes[i]);
+        char level[16];
+        if (result.level != 0) snprintf(level, sizeof(level), "L%u", (unsigned)result.level);
+        else                   snprintf(level, sizeof(level), "mem");
+        printf("%-10s %-6s %10.2f", text, level, result.latency_ns);
+        for (int kind = 0; kind < CPUID_MEMBENCH_KINDS; kind++) {
+            if (result.gbps[kind] > 0) printf(" %10.2f", result.gbps[kind]);
+            else                       printf(" %10s", "-");
+        }
+        printf("\n");
+        fflush(stdout);
+    }
+    free(memory);
+    return 0;
+}
@@ -0,0 +1,151 @@
+/*
+ * pool: pool con un dominio por L3 frente a un pool global (ver cpuid_pool.h).
+ *
+ *      pool [HILOS] [OPERACIONES] [CAPACIDAD]
+ *
+ * Cada hilo se fija en una CPU del mask de afinidad y repite OPERACIONES veces: libera el objeto
+ * mas antiguo de sus 64 vivos, reserva uno nuevo y lo escribe entero. Se mide con un pool de
+ * un solo dominio (CPUID_POOL_GLOBAL) y con uno por L3; CAPACIDAD es el cupo por dominio antes
+ * de robar (0 sin limite).
+ */
+
+// cpuid_percpu.h necesita _GNU_SOURCE en Linux antes de cualquier include del sistema
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
+#include "cpuid_pool.h"
+#include "cpuid_percpu.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <pthread.h>
+#endif
+
+#define POOL_MAX_THREADS 256
+#define POOL_LIVE        64
+#define POOL_OBJECT      256
+
+typedef struct pool_job {
+    CPUID_H(pool) *pool;
+    uint32_t       cpu;
+    unsigned long  operations;
+    int            failed;
+} pool_job;
+
+static void pool_run(pool_job *job) {
+    void *live[POOL_LIVE] = { NULL };
+
+    cpuid_pin_current_thread(job->cpu);
+    for (unsigned long i = 0; i < job->operations; i++) {
+        size_t slot = i % POOL_LIVE;
+        cpuid_pool_release(job->pool, live[slot]);
+        live[slot] = cpuid_pool_alloc(job->pool);
+        if (live[slot] == NULL) {
+            job->failed = 1;
+            break;
+        }
+        memset(live[slot], (int)i, POOL_OBJECT);
+    }
+    for (size_t slot = 0; slot < POOL_LIVE; slot++) cpuid_pool_release(job->pool, live[slot]);
+}
+
+#ifdef _WIN32
+static DWORD WINAPI pool_worker(LPVOID arg) {
+    pool_run(arg);
+    return 0;
+}
+#else
+static void *pool_worker(void *arg) {
+    pool_run(arg);
+    return NULL;
+}
+#endif
+
+// devuelve los segundos de CPU de todos los hilos, o -1
+static double pool_measure(CPUID_H(pool) *pool, const uint32_t *cpus, size_t n_cpus, unsigned n_threads, unsigned long operations) {
+    static pool_job jobs[POOL_MAX_THREADS];
+#ifdef _WIN32
+    HANDLE    threads[POOL_MAX_THREADS];
+#else
+    pthread_t threads[POOL_MAX_THREADS];
+#endif
+    unsigned  started = 0;
+    int       failed  = 0;
+    clock_t   begin   = clock();
+
+    for (; started < n_threads; started++) {
+        jobs[started].pool       = pool;
+        jobs[started].cpu        = cpus[started % n_cpus];
+        jobs[started].operations = operations;
+        jobs[started].failed     = 0;
+#ifdef _WIN32
+        threads[started] = CreateThread(NULL, 0, pool_worker, &jobs[started], 0, NULL);
+        if (threads[started] == NULL) break;
+#else
+        if (pthread_create(&threads[started], NULL, pool_worker, &jobs[started]) != 0) break;
+#endif
+    }
+    for (unsigned i = 0; i < started; i++) {
+#ifdef _WIN32
+        WaitForSingleObject(threads[i], INFINITE);
+        CloseHandle(threads[i]);
+#else
+        pthread_join(threads[i], NULL);
+#endif
+        failed |= jobs[i].failed;
+    }
+    return started == n_threads && !failed ? (double)(clock() - begin) / CLOCKS_PER_SEC : -1;
+}
+
+int main(int argc, char **argv) {
+    if (argc > 4 || (argc >= 2 && argv[1][0] == '-')) {
+        fprintf(stderr, "uso: %s [HILOS] [OPERACIONES] [CAPACIDAD]\n", argv[0]);
+        return 2;
+    }
+    size_t    n_cpus = cpuid_affinity_cpus(NULL, 0);
+    uint32_t *cpus   = malloc(sizeof(*cpus) * (n_cpus != 0 ? n_cpus : 1));
+    if (cpus == NULL) return 1;
+    n_cpus = cpuid_affinity_cpus(cpus, n_cpus);
+    if (n_cpus == 0) cpus[n_cpus++] = 0;
+
+    unsigned      n_threads  = argc >= 2 ? (unsigned)strtoul(argv[1], NULL, 10) : (unsigned)n_cpus;
+    unsigned long operations = argc >= 3 ? strtoul(argv[2], NULL, 10) : 2000000;
+    size_t        capacity   = argc == 4 ? (size_t)strtoul(argv[3], NULL, 10) : 0;
+    if (n_threads == 0) n_threads = 1;
+    if (n_threads > POOL_MAX_THREADS) n_threads = POOL_MAX_THREADS;
+
+    static const char *const names[] = { "global", "por l3" };
+    for (int mode = 0; mode < 2; mode++) {
+        CPUID_H(pool) pool;
+        // objetos alineados a la linea para que los de hilos distintos no la compartan
+        if (cpuid_pool_init(&pool, POOL_OBJECT, cpuid_alloc_line_size(), capacity, mode == 0 ? CPUID_POOL_GLOBAL : 0, NULL) != 0) {
+            fprintf(stderr, "no se pudo crear el pool\n");
+            return 1;
+        }
+        double seconds = pool_measure(&pool, cpus, n_cpus, n_threads, operations);
+        if (seconds < 0) {
+            fprintf(stderr, "no se pudieron crear los hilos o sin memoria\n");
+            return 1;
+        }
+
+        uint64_t steals = 0;
+        size_t   created = 0;
+        for (uint32_t d = 0; d < pool.n_domains; d++) {
+            steals  += pool.domains[d]->steals;
+            created += pool.domains[d]->created;
+        }
+        printf("%-8s %u dominios, %8.2f ns de CPU por operacion, %llu objetos creados, %llu robados\n",
+            names[mode], (unsigned)pool.n_domains, seconds * 1e9 / ((double)operations * n_threads),
+            (unsigned long long)created, (unsigned long long)steals);
+        cpuid_pool_free(&pool);
+    }
+    free(cpus);
+    return 0;
+}
@@ -0,0 +1,124 @@
+/*
+ * publish: publica el CPUID de todas las CPU en memoria compartida (ver cpuid_shm.h).
+ *
+ *      publish [NOMBRE]                publica una vez y termina (el segmento se queda)
+ *      publish -i SEGUNDOS [NOMBRE]    vuelve a publicar cada SEGUNDOS
+ *      publish -r [NOMBRE]             lee el segmento como cualquier otro proceso y lo resume
+ *      publish -u [NOMBRE]             retira y borra el segmento
+ *
+ * NOMBRE es el del segmento de shm_open, por defecto CPUID_SHM_DEFAULT_NAME ("/cpuid").
+ * Por ejemplo, desde el arranque del host:
+ *
+ *      publish -i 60 &
+ */
+
+// cpuid_percpu.h necesita _GNU_SOURCE en Linux antes de cualquier include del sistema
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
+#include "cpuid_shm.h"
+#include "cpuid_march.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef _WIN32
+    #include <windows.h>
+    #define publish_sleep(seconds) Sleep((DWORD)(seconds) * 1000)
+#else
+    #include <unistd.h>
+    #define publish_sleep(seconds) sleep((unsigned)(seconds))
+#endif
+
+static int publish_once(CPUID_H(shm_publisher) *publisher, const char *name) {
+    CPUID_H(snapshot) snapshot;
+    if (cpuid_snapshot_take(&snapshot, NULL, 0, NULL, 0, 0) <= 0) {
+        fprintf(stderr, "no se pudo leer CPUID\n");
+        return 1;
+    }
+    int status = cpuid_shm_publish(publisher, name, &snapshot);
+    if (status != CPUID_SHM_OK) fprintf(stderr, "no se pudo publicar en %s\n", name);
+    else fprintf(stderr, "%zu CPU, %zu hojas publicadas en %s\n", snapshot.n_cpus, snapshot.n_leaves, name);
+    cpuid_snapshot_free(&snapshot);
+    return status != CPUID_SHM_OK;
+}
+
+static int publish_read(const char *name) {
+    CPUID_H(shm)          shm;
+    CPUID_H(shm_view)     view;
+    CPUID_H(march_report) report;
+
+    clock_t begin = clock();
+    if (cpuid_shm_open(&shm, name) != CPUID_SHM_OK) {
+        fprintf(stderr, "%s no existe o no es un segmento de esta version\n", name);
+        return 1;
+    }
+    int status = cpuid_shm_read(&shm, &view, NULL, 0);
+    clock_t end = clock();
+    cpuid_shm_close(&shm);
+
+    if (status != CPUID_SHM_OK) {
+        fprintf(stderr, "%s: %s\n", name, status == CPUID_SHM_RETIRED ? "retirado, volver a abrir" : "no se pudo leer");
+        return 1;
+    }
+
+    time_t      published = (time_t)view.published;
+    const char *level     = cpuid_march_level_name(cpuid_march_classify(&view.features, &report));
+    char        when[32];
+    strftime(when, sizeof(when), "%Y-%m-%d %H:%M:%S", localtime(&published));
+    printf("generacion:  %llu (%s)\n", (unsigned long long)view.generation, when);
+    printf("cpu:         %u, %u hojas por CPU\n", (unsigned)view.n_cpus, (unsigned)view.n_leaves);
+    printf("fabricante:  %s familia %u modelo %u stepping %u%s%s\n", view.info.vendor,
+        (unsigned)view.info.family, (unsigned)view.info.model, (unsigned)view.info.stepping,
+        view.info.hypervisor[0] != '\0' ? " hipervisor " : "", view.info.hypervisor);
+    printf("paquete:     %u nucleos, %u hilos, L2 %u KB, L3 %u KB\n",
+        (unsigned)view.info.cores, (unsigned)view.info.threads, (unsigned)view.info.l2_kb, (unsigned)view.info.l3_total_kb);
+    printf("nivel:       %s\n", level != NULL ? level : "ninguno");
+    printf("lectura:     %.1f us de CPU (sin ejecutar CPUID)\n", 1e6 * (double)(end - begin) / CLOCKS_PER_SEC);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    CPUID_H(shm_publisher) publisher;
+    const char            *name     = CPUID_SHM_DEFAULT_NAME;
+    int                    interval = 0;
+    char                   mode     = 'p';
+
+    memset(&publisher, 0, sizeof(publisher));
+    int arg = 1;
+    if (arg < argc && strcmp(argv[arg], "-i") == 0 && arg + 1 < argc) {
+        interval = atoi(argv[arg + 1]);
+        arg += 2;
+        if (interval <= 0) goto usage;
+    } else if (arg < argc && (strcmp(argv[arg], "-r") == 0 || strcmp(argv[arg], "-u") == 0)) {
+        mode = argv[arg][1];
+        arg++;
+    }
+    if (arg < argc) name = argv[arg++];
+    if (arg != argc || name[0] == '-') goto usage;
+
+    if (mode == 'r') return publish_read(name);
+    if (mode == 'u') {
+        cpuid_shm_unpublish(&publisher, name, 1);
+        return 0;
+    }
+
+    int failed = publish_once(&publisher, name);
+    while (interval != 0) {
+        publish_sleep(interval);
+        failed = publish_once(&publisher, name);
+    }
+    cpuid_shm_unpublish(&publisher, name, 0);
+    return failed;
+
+usage:
+    fprintf(stderr,
+        "uso: %s [NOMBRE]\n"
+        "     %s -i SEGUNDOS [NOMBRE]\n"
+        "     %s -r [NOMBRE]\n"
+        "     %s -u [NOMBRE]\n", argv[0], argv[0], argv[0], argv[0]);
+    return 2;
+}
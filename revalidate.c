@@ -0,0 +1,112 @@
+/*
+ * revalidate: vigila si la maquina virtual se migra a otro host (ver cpuid_revalidate.h).
+ *
+ *      revalidate [MILISEGUNDOS]       comprueba cada MILISEGUNDOS (por defecto 1000) y muestra
+ *                                      cada cambio de huella o de ritmo del TSC
+ *      revalidate -b [COMPROBACIONES]  mide cuanto cuesta una comprobacion y que parte de una
+ *                                      CPU supone una comprobacion por segundo
+ */
+
+// cpuid_percpu.h necesita _GNU_SOURCE en Linux antes de cualquier include del sistema
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
+#include "cpuid_revalidate.h"
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef _WIN32
+    #include <windows.h>
+    #define revalidate_nap() Sleep(100)
+#else
+    #define revalidate_nap() nanosleep(&(struct timespec){ 0, 100000000 }, NULL)
+#endif
+
+static volatile sig_atomic_t revalidate_stop;
+
+static void revalidate_signal(int sig) {
+    (void)sig;
+    revalidate_stop = 1;
+}
+
+static void revalidate_print_fingerprint(const char *label, const CPUID_H(fingerprint) *fp) {
+    printf("%s %016llx\n", label, (unsigned long long)fp->hash);
+    for (size_t i = 0; i < CPUID_FINGERPRINT_LEAVES; i++) {
+        const CPUID_H(record) *r = &fp->records[i];
+        printf("  %08x.%u: eax=%08x ebx=%08x ecx=%08x edx=%08x\n", (unsigned)r->leaf, (unsigned)r->subleaf,
+            (unsigned)r->eax, (unsigned)r->ebx, (unsigned)r->ecx, (unsigned)r->edx);
+    }
+}
+
+static void revalidate_changed(void *context, const CPUID_H(revalidate_event) *event) {
+    time_t now = time(NULL);
+    char   when[32];
+    (void)context;
+
+    strftime(when, sizeof(when), "%Y-%m-%d %H:%M:%S", localtime(&now));
+    printf("%s cambios:%s%s%s%s\n", when,
+        event->changes & CPUID_CHANGE_FEATURES   ? " caracteristicas" : "",
+        event->changes & CPUID_CHANGE_FREQUENCY  ? " frecuencias" : "",
+        event->changes & CPUID_CHANGE_HYPERVISOR ? " hipervisor" : "",
+        event->changes & CPUID_CHANGE_TSC_RATE   ? " ritmo-tsc" : "");
+    if (event->changes & CPUID_CHANGE_TSC_RATE) {
+        printf("  tsc: %.3f MHz -> %.3f MHz\n", event->tsc_hz_before / 1e6, event->tsc_hz_after / 1e6);
+    }
+    if (event->changes & ~(uint32_t)CPUID_CHANGE_TSC_RATE) {
+        revalidate_print_fingerprint("antes:  ", event->before);
+        revalidate_print_fingerprint("despues:", event->after);
+    }
+    fflush(stdout);
+}
+
+static int revalidate_bench(unsigned long checks) {
+    CPUID_H(revalidator) rv;
+    cpuid_revalidate_init(&rv);
+
+    clock_t begin = clock();
+    for (unsigned long i = 0; i < checks; i++) cpuid_revalidate_check(&rv);
+    double seconds = (double)(clock() - begin) / CLOCKS_PER_SEC;
+
+    double per_check = seconds / (double)checks;
+    printf("comprobacion:   %.2f us de CPU (%lu comprobaciones, %llu con cambios)\n",
+        per_check * 1e6, checks, (unsigned long long)rv.events);
+    printf("cada segundo:   %.5f%% de una CPU\n", per_check * 100.0);
+    printf("ritmo del tsc:  %.3f MHz\n", rv.tsc_hz / 1e6);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    CPUID_H(revalidator) rv;
+
+    if (argc >= 2 && strcmp(argv[1], "-b") == 0 && argc <= 3) {
+        unsigned long checks = argc == 3 ? strtoul(argv[2], NULL, 10) : 100000;
+        return revalidate_bench(checks != 0 ? checks : 1);
+    }
+    int interval = argc == 2 ? atoi(argv[1]) : 1000;
+    if (argc > 2 || interval <= 0) {
+        fprintf(stderr, "uso: %s [MILISEGUNDOS]\n     %s -b [COMPROBACIONES]\n", argv[0], argv[0]);
+        return 2;
+    }
+
+    cpuid_revalidate_init(&rv);
+    cpuid_revalidate_subscribe(&rv, revalidate_changed, NULL);
+    revalidate_print_fingerprint("huella:", &rv.fingerprint);
+    fflush(stdout);
+
+    signal(SIGINT, revalidate_signal);
+    signal(SIGTERM, revalidate_signal);
+    if (cpuid_revalidate_start(&rv, (unsigned)interval) != 0) {
+        fprintf(stderr, "no se pudo crear el hilo\n");
+        return 1;
+    }
+    while (!revalidate_stop) revalidate_nap();
+    cpuid_revalidate_stop(&rv);
+    printf("%llu comprobaciones, %llu con cambios, tsc %.3f MHz\n",
+        (unsigned long long)rv.checks, (unsigned long long)rv.events, rv.tsc_hz / 1e6);
+    return 0;
+}
@@ -1,3 +1,4 @@
+import os
 from distutils.core import setup, Extension
 
 """
@@ -21,7 +22,9 @@ def main():
                 "cpuid_x86", [
                     "cpuid_python/cpuid_py.c"
                 ],
-                extra_link_args = ['cpuid.o']
+                extra_link_args = ['cpuid.o'],
+                # cpuid_collect usa pthreads fuera de Windows
+                libraries       = [] if os.name == "nt" else ['pthread']
 
             )
         ],
@@ -0,0 +1,145 @@
+/*
+ * sharing: coste de la comparticion falsa y como la evita cpuid_alloc.h.
+ *
+ *      sharing [HILOS] [SUMAS]
+ *
+ * Cada hilo suma SUMAS veces en su propio contador, con los contadores de todos los hilos:
+ *
+ *      seguidos        uno tras otro en un array (8 bytes cada uno, varios por linea)
+ *      linea           separados cpuid_alloc_line_size() bytes
+ *      slab            en objetos de un CPUID_H(slab), separados cpuid_alloc_interference_size()
+ *
+ * Con un solo nucleo los tres cuestan lo mismo: hacen falta al menos dos hilos en CPU
+ * distintas para que la linea rebote.
+ */
+
+// cpuid_percpu.h necesita _GNU_SOURCE en Linux antes de cualquier include del sistema
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
+#include "cpuid_alloc.h"
+#include "cpuid_percpu.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <pthread.h>
+#endif
+
+#define SHARING_MAX_THREADS 256
+
+typedef struct sharing_job {
+    volatile uint64_t *counter;
+    unsigned long      sums;
+} sharing_job;
+
+static void sharing_run(sharing_job *job) {
+    // lectura y escritura normales: cada contador tiene un solo escritor
+    for (unsigned long i = 0; i < job->sums; i++) *job->counter += 1;
+}
+
+#ifdef _WIN32
+static DWORD WINAPI sharing_worker(LPVOID arg) {
+    sharing_run(arg);
+    return 0;
+}
+#else
+static void *sharing_worker(void *arg) {
+    sharing_run(arg);
+    return NULL;
+}
+#endif
+
+// un hilo por contador; devuelve los segundos de CPU de todos ellos, o -1
+static double sharing_measure(uint64_t **counters, unsigned n_threads, unsigned long sums) {
+    sharing_job jobs[SHARING_MAX_THREADS];
+#ifdef _WIN32
+    HANDLE      threads[SHARING_MAX_THREADS];
+#else
+    pthread_t   threads[SHARING_MAX_THREADS];
+#endif
+    unsigned    started = 0;
+    clock_t     begin   = clock();
+
+    for (; started < n_threads; started++) {
+        jobs[started].counter = counters[started];
+        jobs[started].sums    = sums;
+#ifdef _WIN32
+        threads[started] = CreateThread(NULL, 0, sharing_worker, &jobs[started], 0, NULL);
+        if (threads[started] == NULL) break;
+#else
+        if (pthread_create(&threads[started], NULL, sharing_worker, &jobs[started]) != 0) break;
+#endif
+    }
+    for (unsigned i = 0; i < started; i++) {
+#ifdef _WIN32
+        WaitForSingleObject(threads[i], INFINITE);
+        CloseHandle(threads[i]);
+#else
+        pthread_join(threads[i], NULL);
+#endif
+    }
+    return started == n_threads ? (double)(clock() - begin) / CLOCKS_PER_SEC : -1;
+}
+
+int main(int argc, char **argv) {
+    static uint64_t *counters[SHARING_MAX_THREADS];
+    CPUID_H(slab)    slab;
+    CPUID_H(arena)   arena;
+
+    if (argc > 3 || (argc >= 2 && argv[1][0] == '-')) {
+        fprintf(stderr, "uso: %s [HILOS] [SUMAS]\n", argv[0]);
+        return 2;
+    }
+    unsigned      n_threads = argc >= 2 ? (unsigned)strtoul(argv[1], NULL, 10) : (unsigned)cpuid_affinity_cpus(NULL, 0);
+    unsigned long sums      = argc == 3 ? strtoul(argv[2], NULL, 10) : 50000000;
+    if (n_threads < 2) n_threads = 2;
+    if (n_threads > SHARING_MAX_THREADS) n_threads = SHARING_MAX_THREADS;
+    if (sums == 0) sums = 1;
+
+    size_t line = cpuid_alloc_line_size();
+    printf("linea %u bytes, interferencia %u bytes, %u hilos, %lu sumas cada uno\n",
+        (unsigned)line, (unsigned)cpuid_alloc_interference_size(), n_threads, sums);
+
+    // contadores seguidos y separados una linea, de una arena alineada a la linea
+    cpuid_arena_init(&arena, line, 0);
+    uint64_t *packed = cpuid_arena_calloc(&arena, n_threads, sizeof(uint64_t));
+    unsigned char *spaced = cpuid_arena_calloc(&arena, n_threads, line);
+    cpuid_slab_init(&slab, sizeof(uint64_t), 0);
+    for (unsigned i = 0; i < n_threads; i++) {
+        uint64_t *object = cpuid_slab_alloc(&slab);
+        if (object == NULL) break;
+        *object     = 0;
+        counters[i] = object;
+    }
+    if (packed == NULL || spaced == NULL || slab.live != n_threads) {
+        fprintf(stderr, "sin memoria\n");
+        return 1;
+    }
+
+    static const char *const names[] = { "seguidos", "linea", "slab" };
+    uint64_t *layouts[3][SHARING_MAX_THREADS];
+    for (unsigned i = 0; i < n_threads; i++) {
+        layouts[0][i] = &packed[i];
+        layouts[1][i] = (uint64_t*)(spaced + (size_t)i * line);
+        layouts[2][i] = counters[i];
+    }
+    for (int l = 0; l < 3; l++) {
+        double seconds = sharing_measure(layouts[l], n_threads, sums);
+        if (seconds < 0) {
+            fprintf(stderr, "no se pudieron crear los hilos\n");
+            return 1;
+        }
+        printf("%-10s %8.3f ns de CPU por suma\n", names[l], seconds * 1e9 / ((double)sums * n_threads));
+    }
+
+    cpuid_slab_free(&slab);
+    cpuid_arena_free(&arena);
+    return 0;
+}
@@ -0,0 +1,171 @@
+/*
+ * stats: contadores e histogramas por CPU (ver cpuid_stats.h).
+ *
+ *      stats [HILOS] [SUMAS]   HILOS hilos sumando en un contador y un histograma y el resultado
+ *                              por CPU, nucleo, L3, paquete y total
+ *      stats -b [CPUS]         cuanto cuesta cpuid_stats_collect con una topologia inventada
+ *                              de CPUS CPU (por defecto 256: 2 paquetes, 16 nucleos por L3, SMT2)
+ */
+
+// cpuid_percpu.h necesita _GNU_SOURCE en Linux antes de cualquier include del sistema
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
+#include "cpuid_stats.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <pthread.h>
+#endif
+
+#define STATS_MAX_THREADS 256
+#define STATS_BUCKETS     16
+
+enum { STATS_SUMS = 0, STATS_BYTES = 1, STATS_COUNTERS };
+enum { STATS_SIZES = 0, STATS_HISTOGRAMS };
+
+typedef struct stats_job {
+    const CPUID_H(stats) *stats;
+    unsigned long         sums;
+} stats_job;
+
+static const char *const stats_level_names[CPUID_STATS_LEVELS] = { "cpu", "nucleo", "l3", "paquete", "total" };
+
+static void stats_run(stats_job *job) {
+    uint32_t x = 2463534242u;
+    for (unsigned long i = 0; i < job->sums; i++) {
+        // tamanos pseudoaleatorios para que el histograma tenga varias cubetas
+        x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+        uint32_t size = (x >> 16) >> (x & 0xf);
+        cpuid_stats_add(job->stats, STATS_SUMS, 1);
+        cpuid_stats_add(job->stats, STATS_BYTES, size);
+        cpuid_stats_record(job->stats, STATS_SIZES, size);
+    }
+}
+
+#ifdef _WIN32
+static DWORD WINAPI stats_worker(LPVOID arg) {
+    stats_run(arg);
+    return 0;
+}
+#else
+static void *stats_worker(void *arg) {
+    stats_run(arg);
+    return NULL;
+}
+#endif
+
+static int stats_demo(unsigned n_threads, unsigned long sums) {
+    CPUID_H(stats)      stats;
+    CPUID_H(stats_view) view;
+#ifdef _WIN32
+    HANDLE    threads[STATS_MAX_THREADS];
+#else
+    pthread_t threads[STATS_MAX_THREADS];
+#endif
+
+    if (cpuid_stats_init(&stats, STATS_COUNTERS, STATS_HISTOGRAMS, STATS_BUCKETS, 0, NULL) != 0
+        || cpuid_stats_view_init(&view, &stats) != 0) {
+        fprintf(stderr, "no se pudieron reservar los contadores\n");
+        return 1;
+    }
+    if (n_threads == 0) n_threads = stats.n_groups[CPUID_STATS_CPU];
+    if (n_threads > STATS_MAX_THREADS) n_threads = STATS_MAX_THREADS;
+
+    stats_job job     = { &stats, sums };
+    unsigned  started = 0;
+    for (; started < n_threads; started++) {
+#ifdef _WIN32
+        threads[started] = CreateThread(NULL, 0, stats_worker, &job, 0, NULL);
+        if (threads[started] == NULL) break;
+#else
+        if (pthread_create(&threads[started], NULL, stats_worker, &job) != 0) break;
+#endif
+    }
+    for (unsigned i = 0; i < started; i++) {
+#ifdef _WIN32
+        WaitForSingleObject(threads[i], INFINITE);
+        CloseHandle(threads[i]);
+#else
+        pthread_join(threads[i], NULL);
+#endif
+    }
+
+    cpuid_stats_collect(&view);
+    printf("linea %u bytes, bloque %u bytes, %u hilos\n",
+        (unsigned)cpuid_alloc_line_size(), (unsigned)stats.stride, started);
+    for (int level = 0; level < CPUID_STATS_LEVELS; level++) {
+        for (uint32_t g = 0; g < stats.n_groups[level]; g++) {
+            if (level == CPUID_STATS_CPU) printf("%-8s %-4u", stats_level_names[level], (unsigned)stats.cpus[g]);
+            else                          printf("%-8s %-4u", stats_level_names[level], (unsigned)g);
+            printf(" sumas=%-10llu bytes=%-14llu cubetas:",
+                (unsigned long long)cpuid_stats_counter(&view, (CPUID_H(stats_level))level, g, STATS_SUMS),
+                (unsigned long long)cpuid_stats_counter(&view, (CPUID_H(stats_level))level, g, STATS_BYTES));
+            const uint64_t *buckets = cpuid_stats_histogram(&view, (CPUID_H(stats_level))level, g, STATS_SIZES);
+            for (uint32_t b = 0; b < stats.n_buckets; b++) printf(" %llu", (unsigned long long)buckets[b]);
+            printf("\n");
+        }
+    }
+    cpuid_stats_view_free(&view);
+    cpuid_stats_free(&stats);
+    return 0;
+}
+
+static int stats_bench(uint32_t n_cpus) {
+    CPUID_H(topology)   topo;
+    CPUID_H(stats)      stats;
+    CPUID_H(stats_view) view;
+
+    topo.n_cpus = n_cpus;
+    topo.cpus   = calloc(n_cpus, sizeof(*topo.cpus));
+    if (topo.cpus == NULL) return 1;
+    for (uint32_t cpu = 0; cpu < n_cpus; cpu++) {
+        for (int f = 0; f < CPUID_TOPO_FIELDS; f++) topo.cpus[cpu].values[f] = CPUID_TOPO_UNKNOWN;
+        topo.cpus[cpu].cpu                         = cpu;
+        topo.cpus[cpu].values[CPUID_TOPO_CORE]    = cpu / 2;
+        topo.cpus[cpu].values[CPUID_TOPO_L3]      = cpu / 32;
+        topo.cpus[cpu].values[CPUID_TOPO_PACKAGE] = cpu / (n_cpus / 2 != 0 ? n_cpus / 2 : 1);
+    }
+    int status = cpuid_stats_init(&stats, STATS_COUNTERS, STATS_HISTOGRAMS, STATS_BUCKETS, 0, &topo);
+    cpuid_topology_free(&topo);
+    if (status != 0 || cpuid_stats_view_init(&view, &stats) != 0) {
+        fprintf(stderr, "no se pudieron reservar los contadores\n");
+        return 1;
+    }
+
+    unsigned long rounds = 10000;
+    clock_t begin = clock();
+    for (unsigned long i = 0; i < rounds; i++) cpuid_stats_collect(&view);
+    double per_collect = (double)(clock() - begin) / CLOCKS_PER_SEC / (double)rounds;
+
+    printf("grupos:         %u cpu, %u nucleos, %u l3, %u paquetes\n",
+        (unsigned)stats.n_groups[CPUID_STATS_CPU], (unsigned)stats.n_groups[CPUID_STATS_CORE],
+        (unsigned)stats.n_groups[CPUID_STATS_L3], (unsigned)stats.n_groups[CPUID_STATS_PACKAGE]);
+    printf("bloque:         %u bytes (%u valores)\n", (unsigned)stats.stride, (unsigned)stats.n_items);
+    printf("recoleccion:    %.2f us\n", per_collect * 1e6);
+    printf("cada segundo:   %.5f%% de una CPU\n", per_collect * 100.0);
+    cpuid_stats_view_free(&view);
+    cpuid_stats_free(&stats);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    if (argc >= 2 && strcmp(argv[1], "-b") == 0 && argc <= 3) {
+        unsigned long n_cpus = argc == 3 ? strtoul(argv[2], NULL, 10) : 256;
+        return stats_bench(n_cpus != 0 ? (uint32_t)n_cpus : 1);
+    }
+    if (argc > 3 || (argc >= 2 && argv[1][0] == '-')) {
+        fprintf(stderr, "uso: %s [HILOS] [SUMAS] | -b [CPUS]\n", argv[0]);
+        return 2;
+    }
+    unsigned      n_threads = argc >= 2 ? (unsigned)strtoul(argv[1], NULL, 10) : 0;
+    unsigned long sums      = argc == 3 ? strtoul(argv[2], NULL, 10) : 1000000;
+    return stats_demo(n_threads, sums);
+}
@@ -0,0 +1,133 @@
+/*
+ * topology: topologia de las CPU segun CPUID y segun sysfs, y sus diferencias
+ * (ver cpuid_topology.h).
+ *
+ *      topology [-r RAIZ] [CAMPO=cpuid|sysfs ...]
+ *      topology -m                     tabla densa de x2APIC IDs (ver cpuid_apicmap.h)
+ *
+ * Muestra la topologia con cada campo de la fuente indicada (CPUID si no se indica) y despues
+ * las diferencias entre las dos fuentes. Termina con 1 si hay diferencias. Por ejemplo, para
+ * colocar hilos con los nucleos que ve el planificador y los tamanos de cache de CPUID:
+ *
+ *      topology package=sysfs core=sysfs l3=sysfs
+ */
+
+// cpuid_percpu.h necesita _GNU_SOURCE en Linux antes de cualquier include del sistema
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
+#include "cpuid_apicmap.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TOPOLOGY_MISMATCHES_MAX 64     // diferencias que se muestran
+
+static void topology_print_value(uint32_t value, int width) {
+    if (value == CPUID_TOPO_UNKNOWN) printf(" %*s", width, "-");
+    else printf(" %*u", width, (unsigned)value);
+}
+
+static int topology_apicmap(void) {
+    CPUID_H(apicmap) map;
+    if (cpuid_apicmap_take(&map) != 0) {
+        fprintf(stderr, "no se pudo construir la tabla (sin memoria o APIC IDs repetidos)\n");
+        return 1;
+    }
+    printf("%6s %8s %5s %7s %8s\n", "indice", "apic_id", "cpu", "nucleo", "paquete");
+    for (uint32_t i = 0; i < map.n_entries; i++) {
+        const CPUID_H(apicmap_entry) *e = cpuid_apicmap_at(&map, i);
+        printf("%6u %8u %5u %7u %8u\n", (unsigned)i, (unsigned)e->apic_id, (unsigned)e->cpu, (unsigned)e->core, (unsigned)e->package);
+    }
+    size_t pages = 0;
+    for (size_t p = 0; p < map.n_pages; p++) pages += map.pages[p] != NULL;
+    printf("%u CPU, %u nucleos, %u paquetes; %zu paginas de APIC IDs (%zu bytes)\n",
+        (unsigned)map.n_entries, (unsigned)map.n_cores, (unsigned)map.n_packages, pages,
+        pages * sizeof(uint32_t) * CPUID_APICMAP_PAGE + map.n_pages * sizeof(uint32_t*));
+    cpuid_apicmap_free(&map);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    CPUID_H(topology_source)   trusted[CPUID_TOPO_FIELDS] = { CPUID_TOPO_FROM_CPUID };
+    CPUID_H(topology_mismatch) mismatches[TOPOLOGY_MISMATCHES_MAX];
+    CPUID_H(topology)          from_cpuid, from_sysfs, merged;
+    CPUID_H(snapshot)          snapshot;
+    const char                *root = NULL;
+
+    if (argc == 2 && strcmp(argv[1], "-m") == 0) return topology_apicmap();
+    for (int arg = 1; arg < argc; arg++) {
+        char *equals = strchr(argv[arg], '=');
+        if (strcmp(argv[arg], "-r") == 0 && arg + 1 < argc) {
+            root = argv[++arg];
+            continue;
+        }
+        if (equals == NULL) goto usage;
+        *equals = '\0';
+        int field = cpuid_topology_field_find(argv[arg]);
+        if (field < 0) goto usage;
+        if      (strcmp(equals + 1, "cpuid") == 0) trusted[field] = CPUID_TOPO_FROM_CPUID;
+        else if (strcmp(equals + 1, "sysfs") == 0) trusted[field] = CPUID_TOPO_FROM_SYSFS;
+        else goto usage;
+    }
+
+    if (cpuid_snapshot_take(&snapshot, NULL, 0, NULL, 0, 0) <= 0) {
+        fprintf(stderr, "no se pudo leer CPUID\n");
+        return 1;
+    }
+    uint32_t *cpus = malloc(sizeof(*cpus) * (snapshot.n_cpus != 0 ? snapshot.n_cpus : 1));
+    if (cpus == NULL || cpuid_topology_from_cpuid(&from_cpuid, &snapshot) != 0) {
+        fprintf(stderr, "sin memoria\n");
+        return 1;
+    }
+    for (size_t i = 0; i < from_cpuid.n_cpus; i++) cpus[i] = from_cpuid.cpus[i].cpu;
+    if (cpuid_topology_from_sysfs(&from_sysfs, root, cpus, from_cpuid.n_cpus) != 0
+        || cpuid_topology_merge(&merged, &from_cpuid, &from_sysfs, trusted) != 0) {
+        fprintf(stderr, "sin memoria\n");
+        return 1;
+    }
+
+    printf("%5s", "cpu");
+    for (int f = 0; f < CPUID_TOPO_FIELDS; f++) {
+        printf(" %9s%c", cpuid_topology_field_name((CPUID_H(topology_field))f), trusted[f] == CPUID_TOPO_FROM_SYSFS ? '*' : ' ');
+    }
+    printf("\n");
+    for (size_t i = 0; i < merged.n_cpus; i++) {
+        printf("%5u", (unsigned)merged.cpus[i].cpu);
+        for (int f = 0; f < CPUID_TOPO_FIELDS; f++) {
+            topology_print_value(merged.cpus[i].values[f], 9);
+            printf(" ");
+        }
+        printf("\n");
+    }
+    printf("(* de sysfs, el resto de CPUID)\n");
+
+    size_t total = cpuid_topology_compare(&from_cpuid, &from_sysfs, mismatches, TOPOLOGY_MISMATCHES_MAX);
+    printf("\n%zu diferencias entre CPUID y sysfs\n", total);
+    for (size_t i = 0; i < total && i < TOPOLOGY_MISMATCHES_MAX; i++) {
+        const CPUID_H(topology_mismatch) *m = &mismatches[i];
+        const char *name = cpuid_topology_field_name(m->field);
+        if (m->field < CPUID_TOPO_GROUPS) {
+            printf("  cpu %u %s: CPUID la agrupa con la cpu %u, sysfs con la cpu %u\n",
+                (unsigned)m->cpu, name, (unsigned)m->cpuid, (unsigned)m->sysfs);
+        } else {
+            printf("  cpu %u %s: CPUID %u, sysfs %u\n", (unsigned)m->cpu, name, (unsigned)m->cpuid, (unsigned)m->sysfs);
+        }
+    }
+    if (total > TOPOLOGY_MISMATCHES_MAX) printf("  ...\n");
+
+    cpuid_topology_free(&merged);
+    cpuid_topology_free(&from_sysfs);
+    cpuid_topology_free(&from_cpuid);
+    cpuid_snapshot_free(&snapshot);
+    free(cpus);
+    return total != 0;
+
+usage:
+    fprintf(stderr, "uso: %s [-r RAIZ] [CAMPO=cpuid|sysfs ...]\n     %s -m\ncampos:", argv[0], argv[0]);
+    for (int f = 0; f < CPUID_TOPO_FIELDS; f++) fprintf(stderr, " %s", cpuid_topology_field_name((CPUID_H(topology_field))f));
+    fprintf(stderr, "\n");
+    return 2;
+}
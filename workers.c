@@ -0,0 +1,68 @@
+/*
+ * workers: cuantos hilos de trabajo crear en este proceso (ver cpuid_parallelism.h).
+ *
+ *      workers [-r RAIZ] [-c LISTA]                resumen y recomendacion por tipo de trabajo
+ *      workers [-r RAIZ] [-c LISTA] compute|io     solo el numero, para scripts
+ *
+ * RAIZ es el directorio con sysfs, /proc y los cgroups (por defecto los del sistema) y LISTA
+ * sustituye al mask de afinidad del proceso ("0-15,32-47"). Por ejemplo:
+ *
+ *      make -j$(workers compute)
+ */
+
+// cpuid_percpu.h necesita _GNU_SOURCE en Linux antes de cualquier include del sistema
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
+#include "cpuid_parallelism.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+int main(int argc, char **argv) {
+    static CPUID_H(cpumask) affinity;
+    static uint32_t         cpus[CPUID_CPUMASK_MAX_CPUS];
+    CPUID_H(parallelism)    par;
+    const char             *root     = NULL;
+    const char             *workload = NULL;
+    size_t                  n_cpus   = 0;
+    int                     has_list = 0;
+
+    for (int arg = 1; arg < argc; arg++) {
+        if (strcmp(argv[arg], "-r") == 0 && arg + 1 < argc) {
+            root = argv[++arg];
+        } else if (strcmp(argv[arg], "-c") == 0 && arg + 1 < argc) {
+            if (cpuid_cpumask_parse(argv[++arg], &affinity) != 0) goto usage;
+            n_cpus   = cpuid_cpumask_list(&affinity, cpus, CPUID_CPUMASK_MAX_CPUS);
+            has_list = 1;
+        } else if (workload == NULL && (strcmp(argv[arg], "compute") == 0 || strcmp(argv[arg], "io") == 0)) {
+            workload = argv[arg];
+        } else {
+            goto usage;
+        }
+    }
+
+    if (cpuid_parallelism_query(&par, root, has_list ? cpus : NULL, n_cpus, NULL) != 0) {
+        fprintf(stderr, "no se pudo leer la topologia\n");
+        return 1;
+    }
+    if (workload != NULL) {
+        printf("%u\n", (unsigned)cpuid_parallelism_workers(&par, strcmp(workload, "io") == 0 ? CPUID_WORKLOAD_IO : CPUID_WORKLOAD_COMPUTE));
+        return 0;
+    }
+
+    printf("cpu usables:  %u\n", (unsigned)par.cpus);
+    printf("nucleos:      %u (%u P, %u E), %u hilos por nucleo\n",
+        (unsigned)par.cores, (unsigned)par.p_cores, (unsigned)par.e_cores, (unsigned)par.smt);
+    if (par.quota > 0) printf("cuota:        %.2f CPU\n", par.quota);
+    else               printf("cuota:        sin limite\n");
+    printf("calculo:      %u hilos\n", (unsigned)par.compute);
+    printf("e/s:          %u hilos\n", (unsigned)par.io);
+    return 0;
+
+usage:
+    fprintf(stderr, "uso: %s [-r RAIZ] [-c LISTA] [compute|io]\n", argv[0]);
+    return 2;
+}